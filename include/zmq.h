@@ -680,6 +680,16 @@ ZMQ_EXPORT void zmq_threadclose (void *thread_);
 #define ZMQ_BUSY_POLL 113
 #define ZMQ_HICCUP_MSG 114
 #define ZMQ_XSUB_VERBOSE_UNSUBSCRIBE 115
+#define ZMQ_UDP_BATCH_SIZE 116
+#define ZMQ_UDP_OFFLOAD 117
+#define ZMQ_TCP_ZEROCOPY_THRESHOLD 118
+#define ZMQ_RECV_SPIN 119
+#define ZMQ_FLUSH_MSGS 120
+#define ZMQ_FLUSH_BYTES 121
+#define ZMQ_SUB_RADIX_TREE 122
+#define ZMQ_XPUB_MATCH_CACHE 123
+#define ZMQ_LATENCY_STATS 124
+#define ZMQ_WSS_KTLS 125
 
 /*  DRAFT ZMQ_RECONNECT_STOP options                                          */
 #define ZMQ_RECONNECT_STOP_CONN_REFUSED 0x1
@@ -688,6 +698,13 @@ ZMQ_EXPORT void zmq_threadclose (void *thread_);
 
 /*  DRAFT Context options                                                     */
 #define ZMQ_ZERO_COPY_RECV 10
+#define ZMQ_IO_URING 11
+#define ZMQ_DECODER_BUFFER_HITS 13
+#define ZMQ_DECODER_BUFFER_MISSES 14
+#define ZMQ_IO_THREAD_NUMA_LOCAL 15
+#define ZMQ_IO_THREAD_HUGEPAGES 16
+#define ZMQ_IO_THREAD_SPIN 17
+#define ZMQ_CRYPTO_THREADS 18
 
 /*  DRAFT Context methods.                                                    */
 ZMQ_EXPORT int zmq_ctx_set_ext (void *context_,
@@ -703,6 +720,11 @@ ZMQ_EXPORT int zmq_ctx_get_ext (void *context_,
 ZMQ_EXPORT int zmq_join (void *s, const char *group);
 ZMQ_EXPORT int zmq_leave (void *s, const char *group);
 ZMQ_EXPORT uint32_t zmq_connect_peer (void *s_, const char *addr_);
+ZMQ_EXPORT int zmq_sendmmsg (
+  void *s_, zmq_msg_t *msgs_, const int *msg_flags_, size_t count_, int flags_);
+ZMQ_EXPORT int
+zmq_recvmmsg (void *s_, zmq_msg_t *msgs_, size_t count_, int flags_);
+ZMQ_EXPORT int zmq_flush (void *s_);
 
 /*  DRAFT Msg methods.                                                        */
 ZMQ_EXPORT int zmq_msg_set_routing_id (zmq_msg_t *msg, uint32_t routing_id);
@@ -711,6 +733,8 @@ ZMQ_EXPORT int zmq_msg_set_group (zmq_msg_t *msg, const char *group);
 ZMQ_EXPORT const char *zmq_msg_group (zmq_msg_t *msg);
 ZMQ_EXPORT int
 zmq_msg_init_buffer (zmq_msg_t *msg_, const void *buf_, size_t size_);
+ZMQ_EXPORT int zmq_msg_pool_open (void);
+ZMQ_EXPORT int zmq_msg_pool_close (void);
 
 /*  DRAFT Msg property names.                                                 */
 #define ZMQ_MSG_PROPERTY_ROUTING_ID "Routing-Id"
@@ -762,12 +786,14 @@ ZMQ_EXPORT int zmq_socket_get_peer_state (void *socket,
 
 /*  DRAFT Socket monitoring events                                            */
 #define ZMQ_EVENT_PIPES_STATS 0x10000
+#define ZMQ_EVENT_PIPES_LATENCY 0x20000
 
 #define ZMQ_CURRENT_EVENT_VERSION 1
 #define ZMQ_CURRENT_EVENT_VERSION_DRAFT 2
 
 #define ZMQ_EVENT_ALL_V1 ZMQ_EVENT_ALL
-#define ZMQ_EVENT_ALL_V2 ZMQ_EVENT_ALL_V1 | ZMQ_EVENT_PIPES_STATS
+#define ZMQ_EVENT_ALL_V2                                                       \
+    ZMQ_EVENT_ALL_V1 | ZMQ_EVENT_PIPES_STATS | ZMQ_EVENT_PIPES_LATENCY
 
 ZMQ_EXPORT int zmq_socket_monitor_versioned (
   void *s_, const char *addr_, uint64_t events_, int event_version_, int type_);
@@ -786,6 +812,9 @@ ZMQ_EXPORT int zmq_ppoll (zmq_pollitem_t *items_,
                           const void *sigmask_);
 #endif
 
+/*  DRAFT Utility functions.                                                  */
+ZMQ_EXPORT uint64_t zmq_clock_ns (void);
+
 #endif // ZMQ_BUILD_DRAFT_API
 
 #ifdef ZMQ_HAVE_NORM
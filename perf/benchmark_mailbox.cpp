@@ -0,0 +1,203 @@
+/*
+    Copyright (c) 2007-2016 Contributors as noted in the AUTHORS file
+
+    This file is part of libzmq, the ZeroMQ core engine in C++.
+
+    libzmq is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License (LGPL) as published
+    by the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    As a special exception, the Contributors give you permission to link
+    this library with independent modules to produce an executable,
+    regardless of the license terms of these independent modules, and to
+    copy and distribute the resulting executable under terms of your choice,
+    provided that you also meet, for each linked independent module, the
+    terms and conditions of the license of that module. An independent
+    module is a module which is not derived from or based on this library.
+    If you modify this library, you must extend this exception to your
+    version of the library.
+
+    libzmq is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#if __cplusplus >= 201103L
+
+#include "precompiled.hpp"
+
+#include "command.hpp"
+#include "config.hpp"
+#include "mpsc_queue.hpp"
+#include "mutex.hpp"
+#include "signaler.hpp"
+#include "ypipe.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+const std::size_t commands_per_producer = 500000;
+const std::size_t producer_counts[] = {1, 2, 4, 8};
+const std::size_t samples = 5;
+
+//  Both mailboxes are copied here rather than taken from mailbox_t, which
+//  is built with one or the other depending on ZMQ_USE_MPSC_MAILBOX.
+
+//  The default mailbox: a single-writer ypipe with the sending side
+//  serialised by a mutex.
+class locked_mailbox_t
+{
+  public:
+    locked_mailbox_t () : _active (false)
+    {
+        const bool ok = _cpipe.check_read ();
+        zmq_assert (!ok);
+    }
+
+    ~locked_mailbox_t ()
+    {
+        _sync.lock ();
+        _sync.unlock ();
+    }
+
+    void send (const zmq::command_t &cmd_)
+    {
+        _sync.lock ();
+        _cpipe.write (cmd_, false);
+        const bool ok = _cpipe.flush ();
+        _sync.unlock ();
+        if (!ok)
+            _signaler.send ();
+    }
+
+    int recv (zmq::command_t *cmd_, int timeout_)
+    {
+        if (_active) {
+            if (_cpipe.read (cmd_))
+                return 0;
+            _active = false;
+        }
+        if (_signaler.wait (timeout_) == -1)
+            return -1;
+        if (_signaler.recv_failable () == -1)
+            return -1;
+        _active = true;
+        const bool ok = _cpipe.read (cmd_);
+        zmq_assert (ok);
+        return 0;
+    }
+
+  private:
+    zmq::ypipe_t<zmq::command_t, zmq::command_pipe_granularity> _cpipe;
+    zmq::signaler_t _signaler;
+    zmq::mutex_t _sync;
+    bool _active;
+};
+
+//  The mailbox built with ZMQ_USE_MPSC_MAILBOX: a lock-free queue that
+//  senders write to concurrently.
+class mpsc_mailbox_t
+{
+  public:
+    mpsc_mailbox_t () : _active (false) {}
+
+    void send (const zmq::command_t &cmd_)
+    {
+        if (!_queue.write (cmd_))
+            _signaler.send ();
+    }
+
+    int recv (zmq::command_t *cmd_, int timeout_)
+    {
+        if (_active) {
+            if (_queue.read (cmd_))
+                return 0;
+            _active = false;
+        }
+        if (_signaler.wait (timeout_) == -1)
+            return -1;
+        if (_signaler.recv_failable () == -1)
+            return -1;
+        _active = true;
+        const bool ok = _queue.read (cmd_);
+        zmq_assert (ok);
+        return 0;
+    }
+
+  private:
+    zmq::mpsc_queue_t<zmq::command_t> _queue;
+    zmq::signaler_t _signaler;
+    bool _active;
+};
+
+template <class T> double benchmark_mailbox (std::size_t producers_)
+{
+    using namespace std::chrono;
+    T mailbox;
+    const std::size_t total = producers_ * commands_per_producer;
+
+    std::vector<std::thread> threads;
+    const auto start = steady_clock::now ();
+    for (std::size_t i = 0; i < producers_; ++i)
+        threads.emplace_back ([&mailbox] () {
+            zmq::command_t cmd;
+            cmd.destination = NULL;
+            cmd.type = zmq::command_t::activate_read;
+            for (std::size_t j = 0; j < commands_per_producer; ++j)
+                mailbox.send (cmd);
+        });
+
+    zmq::command_t cmd;
+    for (std::size_t received = 0; received < total;) {
+        if (mailbox.recv (&cmd, -1) == 0)
+            ++received;
+    }
+    const auto end = steady_clock::now ();
+
+    for (auto &thread : threads)
+        thread.join ();
+
+    return static_cast<double> (total)
+           / duration_cast<duration<double> > (end - start).count ();
+}
+
+template <class T> void benchmark (const char *name_)
+{
+    std::printf ("[%s]\n", name_);
+    for (const auto producers : producer_counts) {
+        double best = 0;
+        for (std::size_t run = 0; run < samples; ++run) {
+            const double rate = benchmark_mailbox<T> (producers);
+            if (rate > best)
+                best = rate;
+        }
+        std::printf ("producers = %llu, throughput = %.0lf commands/s\n",
+                     static_cast<unsigned long long> (producers), best);
+    }
+}
+
+int main ()
+{
+    std::printf ("commands per producer = %llu, samples = %llu\n",
+                 static_cast<unsigned long long> (commands_per_producer),
+                 static_cast<unsigned long long> (samples));
+    benchmark<locked_mailbox_t> ("mutex + ypipe");
+    benchmark<mpsc_mailbox_t> ("mpsc_queue");
+}
+
+#else
+
+int main ()
+{
+}
+
+#endif
@@ -31,15 +31,18 @@
 
 #include "radix_tree.hpp"
 #include "trie.hpp"
+#include "mtrie.hpp"
+#include "generic_mtrie_impl.hpp"
 
 #include <chrono>
 #include <cstddef>
 #include <cstdio>
+#include <cstdlib>
 #include <random>
 #include <ratio>
 #include <vector>
 
-const std::size_t nkeys = 10000;
+std::size_t nkeys = 10000;
 const std::size_t nqueries = 1000000;
 const std::size_t warmup_runs = 10;
 const std::size_t samples = 10;
@@ -47,6 +50,33 @@ const std::size_t key_length = 20;
 const char *chars = "abcdefghijklmnopqrstuvwxyz0123456789";
 const int chars_len = 36;
 
+// The multi-trie used by XPUB matches a topic against the pipes subscribed
+// to its prefixes rather than checking it, so adapt it to the interface of
+// the subscription tries.
+class mtrie_adapter_t
+{
+  public:
+    bool add (const unsigned char *key_, std::size_t key_size_)
+    {
+        return _mtrie.add (key_, key_size_, pipe ());
+    }
+
+    bool check (const unsigned char *key_, std::size_t key_size_)
+    {
+        bool found = false;
+        _mtrie.match (key_, key_size_, on_match, &found);
+        return found;
+    }
+
+  private:
+    // The pipe is only compared, never dereferenced.
+    zmq::pipe_t *pipe () { return reinterpret_cast<zmq::pipe_t *> (this); }
+
+    static void on_match (zmq::pipe_t *, bool *found_) { *found_ = true; }
+
+    zmq::mtrie_t _mtrie;
+};
+
 template <class T>
 void benchmark_lookup (T &subscriptions_,
                        std::vector<unsigned char *> &queries_)
@@ -54,17 +84,19 @@ void benchmark_lookup (T &subscriptions_,
     using namespace std::chrono;
     std::vector<duration<long, std::nano> > samples_vec;
     samples_vec.reserve (samples);
+    // Consuming the results keeps the lookups from being optimized away.
+    std::size_t matches = 0;
 
     for (std::size_t run = 0; run < warmup_runs; ++run) {
         for (auto &query : queries_)
-            subscriptions_.check (query, key_length);
+            matches += subscriptions_.check (query, key_length);
     }
 
     for (std::size_t run = 0; run < samples; ++run) {
         duration<long, std::nano> interval (0);
         for (auto &query : queries_) {
             auto start = steady_clock::now ();
-            subscriptions_.check (query, key_length);
+            matches += subscriptions_.check (query, key_length);
             auto end = steady_clock::now ();
             interval += end - start;
         }
@@ -74,12 +106,20 @@ void benchmark_lookup (T &subscriptions_,
     std::size_t sum = 0;
     for (const auto &sample : samples_vec)
         sum += sample.count ();
-    std::printf ("Average lookup time = %.1lf ns\n",
-                 static_cast<double> (sum) / samples);
+    std::printf ("Average lookup time = %.1lf ns (%llu matches)\n",
+                 static_cast<double> (sum) / samples,
+                 static_cast<unsigned long long> (matches));
 }
 
-int main ()
+int main (int argc, char *argv[])
 {
+    if (argc == 2)
+        nkeys = std::strtoul (argv[1], NULL, 10);
+    if (argc > 2 || nkeys == 0) {
+        std::printf ("usage: benchmark_radix_tree [<key-count>]\n");
+        return 1;
+    }
+
     // Generate input set.
     std::minstd_rand rng (123456789);
     std::vector<unsigned char *> input_set;
@@ -96,14 +136,16 @@ int main ()
     for (std::size_t i = 0; i < nqueries; ++i)
         queries.push_back (input_set[rng () % nkeys]);
 
-    // Initialize both data structures.
+    // Initialize the data structures.
     //
     // Keeping initialization out of the benchmarking function helps
     // heaptrack detect peak memory consumption of the radix tree.
     zmq::trie_t trie;
+    mtrie_adapter_t mtrie;
     zmq::radix_tree_t radix_tree;
     for (auto &key : input_set) {
         trie.add (key, key_length);
+        mtrie.add (key, key_length);
         radix_tree.add (key, key_length);
     }
 
@@ -115,6 +157,9 @@ int main ()
     std::puts ("[trie]");
     benchmark_lookup (trie, queries);
 
+    std::puts ("[mtrie]");
+    benchmark_lookup (mtrie, queries);
+
     std::puts ("[radix_tree]");
     benchmark_lookup (radix_tree, queries);
 
@@ -0,0 +1,186 @@
+/*
+    Copyright (c) 2018 Contributors as noted in the AUTHORS file
+
+    This file is part of libzmq, the ZeroMQ core engine in C++.
+
+    libzmq is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License (LGPL) as published
+    by the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    As a special exception, the Contributors give you permission to link
+    this library with independent modules to produce an executable,
+    regardless of the license terms of these independent modules, and to
+    copy and distribute the resulting executable under terms of your choice,
+    provided that you also meet, for each linked independent module, the
+    terms and conditions of the license of that module. An independent
+    module is a module which is not derived from or based on this library.
+    If you modify this library, you must extend this exception to your
+    version of the library.
+
+    libzmq is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#if __cplusplus >= 201103L
+
+#include "blob.hpp"
+#include "routing_table.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <vector>
+
+std::size_t npeers = 50000;
+const std::size_t nqueries = 1000000;
+const std::size_t warmup_runs = 10;
+const std::size_t samples = 10;
+const std::size_t id_length = 5;
+
+// What a routing socket stores per peer.
+struct out_pipe_t
+{
+    void *pipe;
+    bool active;
+};
+
+// The ordered map the routing sockets used to keep their peers in.
+class map_adapter_t
+{
+  public:
+    void add (const zmq::blob_t &id_)
+    {
+        const out_pipe_t out_pipe = {this, true};
+        _map.emplace (zmq::blob_t (id_.data (), id_.size ()), out_pipe);
+    }
+
+    out_pipe_t *find (const zmq::blob_t &id_)
+    {
+        const auto it = _map.find (id_);
+        return it == _map.end () ? NULL : &it->second;
+    }
+
+  private:
+    std::map<zmq::blob_t, out_pipe_t> _map;
+};
+
+class table_adapter_t
+{
+  public:
+    void add (const zmq::blob_t &id_)
+    {
+        const out_pipe_t out_pipe = {this, true};
+        _table.insert (id_, out_pipe);
+    }
+
+    out_pipe_t *find (const zmq::blob_t &id_) { return _table.find (id_); }
+
+  private:
+    zmq::routing_table_t<out_pipe_t> _table;
+};
+
+// Looks up the peer the way ROUTER does on send, from the routing id
+// frame referenced by a temporary blob.
+template <class T>
+void benchmark_lookup (T &peers_, std::vector<unsigned char *> &queries_)
+{
+    using namespace std::chrono;
+    std::vector<duration<long, std::nano> > samples_vec;
+    samples_vec.reserve (samples);
+    // Consuming the results keeps the lookups from being optimized away.
+    std::size_t found = 0;
+
+    for (std::size_t run = 0; run < warmup_runs; ++run) {
+        for (auto &query : queries_)
+            found += peers_.find (zmq::blob_t (query, id_length,
+                                               zmq::reference_tag_t ()))
+                     != NULL;
+    }
+
+    for (std::size_t run = 0; run < samples; ++run) {
+        const auto start = steady_clock::now ();
+        for (auto &query : queries_)
+            found += peers_.find (zmq::blob_t (query, id_length,
+                                               zmq::reference_tag_t ()))
+                     != NULL;
+        const auto end = steady_clock::now ();
+        samples_vec.push_back ((end - start) / queries_.size ());
+    }
+
+    std::size_t sum = 0;
+    for (const auto &sample : samples_vec)
+        sum += sample.count ();
+    std::printf ("Average lookup time = %.1lf ns (%llu found)\n",
+                 static_cast<double> (sum) / samples,
+                 static_cast<unsigned long long> (found));
+}
+
+int main (int argc, char *argv[])
+{
+    if (argc == 2)
+        npeers = std::strtoul (argv[1], NULL, 10);
+    if (argc > 2 || npeers == 0) {
+        std::printf ("usage: benchmark_routing_table [<peer-count>]\n");
+        return 1;
+    }
+
+    // Generate routing ids the way ROUTER does, a zero byte followed by
+    // a 32-bit integer starting at a random value.
+    std::minstd_rand rng (123456789);
+    std::vector<unsigned char *> ids;
+    std::vector<unsigned char *> queries;
+    ids.reserve (npeers);
+    queries.reserve (nqueries);
+
+    const std::uint32_t first = static_cast<std::uint32_t> (rng ());
+    for (std::size_t i = 0; i < npeers; ++i) {
+        unsigned char *id = new unsigned char[id_length];
+        const std::uint32_t n = first + static_cast<std::uint32_t> (i);
+        id[0] = 0;
+        id[1] = static_cast<unsigned char> (n >> 24);
+        id[2] = static_cast<unsigned char> (n >> 16);
+        id[3] = static_cast<unsigned char> (n >> 8);
+        id[4] = static_cast<unsigned char> (n);
+        ids.push_back (id);
+    }
+    for (std::size_t i = 0; i < nqueries; ++i)
+        queries.push_back (ids[rng () % npeers]);
+
+    map_adapter_t map;
+    table_adapter_t table;
+    for (auto &id : ids) {
+        const zmq::blob_t blob (id, id_length, zmq::reference_tag_t ());
+        map.add (blob);
+        table.add (blob);
+    }
+
+    std::printf ("peers = %llu, queries = %llu, id size = %llu\n",
+                 static_cast<unsigned long long> (npeers),
+                 static_cast<unsigned long long> (nqueries),
+                 static_cast<unsigned long long> (id_length));
+    std::puts ("[std::map]");
+    benchmark_lookup (map, queries);
+
+    std::puts ("[routing_table]");
+    benchmark_lookup (table, queries);
+
+    for (auto &id : ids)
+        delete[] id;
+}
+
+#else
+
+int main ()
+{
+}
+
+#endif
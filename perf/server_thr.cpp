@@ -0,0 +1,225 @@
+/*
+    Copyright (c) 2007-2012 iMatix Corporation
+    Copyright (c) 2009-2011 250bpm s.r.o.
+    Copyright (c) 2007-2011 Other contributors as noted in the AUTHORS file
+
+    This file is part of libzmq, the ZeroMQ core engine in C++.
+
+    libzmq is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License (LGPL) as published
+    by the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    As a special exception, the Contributors give you permission to link
+    this library with independent modules to produce an executable,
+    regardless of the license terms of these independent modules, and to
+    copy and distribute the resulting executable under terms of your choice,
+    provided that you also meet, for each linked independent module, the
+    terms and conditions of the license of that module. An independent
+    module is a module which is not derived from or based on this library.
+    If you modify this library, you must extend this exception to your
+    version of the library.
+
+    libzmq is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../include/zmq.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined ZMQ_SERVER && defined ZMQ_CLIENT
+
+//  Sends messages from a SERVER socket to many CLIENT sockets in turn,
+//  addressing each by its routing id, which is the lookup SERVER does on
+//  every send.
+
+int main (int argc, char *argv[])
+{
+    int client_count;
+    int message_count;
+    void *ctx;
+    void *server;
+    void **clients;
+    uint32_t *routing_ids;
+    int hwm = 0;
+    int rc;
+    int i;
+    zmq_msg_t msg;
+    void *watch;
+    unsigned long elapsed;
+    unsigned long throughput;
+    int received;
+
+    if (argc != 3) {
+        printf ("usage: server_thr <client-count> <message-count>\n");
+        return 1;
+    }
+    client_count = atoi (argv[1]);
+    message_count = atoi (argv[2]);
+    if (client_count <= 0 || message_count <= 0) {
+        printf ("client and message counts must be positive\n");
+        return 1;
+    }
+
+    ctx = zmq_ctx_new ();
+    if (!ctx) {
+        printf ("error in zmq_ctx_new: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+    rc = zmq_ctx_set (ctx, ZMQ_MAX_SOCKETS, client_count + 1);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_set: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    server = zmq_socket (ctx, ZMQ_SERVER);
+    if (!server) {
+        printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+    rc = zmq_setsockopt (server, ZMQ_SNDHWM, &hwm, sizeof hwm);
+    if (rc != 0) {
+        printf ("error in zmq_setsockopt: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+    rc = zmq_bind (server, "inproc://server_thr");
+    if (rc != 0) {
+        printf ("error in zmq_bind: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    //  Each client says hello so that the server learns its routing id.
+    clients = (void **) malloc (client_count * sizeof (void *));
+    routing_ids = (uint32_t *) malloc (client_count * sizeof (uint32_t));
+    if (!clients || !routing_ids) {
+        printf ("error in malloc\n");
+        return -1;
+    }
+    for (i = 0; i != client_count; i++) {
+        clients[i] = zmq_socket (ctx, ZMQ_CLIENT);
+        if (!clients[i]) {
+            printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+        rc = zmq_setsockopt (clients[i], ZMQ_RCVHWM, &hwm, sizeof hwm);
+        if (rc != 0) {
+            printf ("error in zmq_setsockopt: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+        rc = zmq_connect (clients[i], "inproc://server_thr");
+        if (rc != 0) {
+            printf ("error in zmq_connect: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+        rc = zmq_send (clients[i], "", 0, 0);
+        if (rc < 0) {
+            printf ("error in zmq_send: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+    }
+
+    rc = zmq_msg_init (&msg);
+    if (rc != 0) {
+        printf ("error in zmq_msg_init: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+    for (i = 0; i != client_count; i++) {
+        rc = zmq_msg_recv (&msg, server, 0);
+        if (rc < 0) {
+            printf ("error in zmq_msg_recv: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+        routing_ids[i] = zmq_msg_routing_id (&msg);
+    }
+
+    printf ("client count: %d\n", client_count);
+    printf ("message count: %d\n", message_count);
+
+    watch = zmq_stopwatch_start ();
+
+    for (i = 0; i != message_count; i++) {
+        rc = zmq_msg_init_size (&msg, 1);
+        if (rc != 0) {
+            printf ("error in zmq_msg_init_size: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+        rc = zmq_msg_set_routing_id (&msg, routing_ids[i % client_count]);
+        if (rc != 0) {
+            printf ("error in zmq_msg_set_routing_id: %s\n",
+                    zmq_strerror (errno));
+            return -1;
+        }
+        rc = zmq_msg_send (&msg, server, 0);
+        if (rc < 0) {
+            printf ("error in zmq_msg_send: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+    }
+
+    elapsed = zmq_stopwatch_stop (watch);
+    if (elapsed == 0)
+        elapsed = 1;
+
+    //  Check that every message made it to its client.
+    received = 0;
+    for (i = 0; i != client_count; i++)
+        while (zmq_msg_recv (&msg, clients[i], ZMQ_DONTWAIT) >= 0)
+            received++;
+    if (received != message_count) {
+        printf ("%d messages received, %d expected\n", received,
+                message_count);
+        return -1;
+    }
+
+    throughput = (unsigned long) ((double) message_count / (double) elapsed
+                                  * 1000000);
+
+    printf ("mean throughput: %d [msg/s]\n", (int) throughput);
+
+    rc = zmq_msg_close (&msg);
+    if (rc != 0) {
+        printf ("error in zmq_msg_close: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    for (i = 0; i != client_count; i++) {
+        rc = zmq_close (clients[i]);
+        if (rc != 0) {
+            printf ("error in zmq_close: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+    }
+    rc = zmq_close (server);
+    if (rc != 0) {
+        printf ("error in zmq_close: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    rc = zmq_ctx_term (ctx);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_term: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    free (routing_ids);
+    free (clients);
+
+    return 0;
+}
+
+#else
+
+int main ()
+{
+    printf ("server_thr requires the draft API\n");
+    return 1;
+}
+
+#endif
@@ -37,7 +37,14 @@
 #include "ipc_address.hpp"
 #include "tipc_address.hpp"
 #include "ws_address.hpp"
+
+#if defined ZMQ_HAVE_NORM
 #include "norm_address.hpp"
+#endif
+
+#if defined ZMQ_HAVE_TLS
+#include "tls_address.hpp"
+#endif
 
 #if defined ZMQ_HAVE_VMCI
 #include "vmci_address.hpp"
@@ -73,6 +80,12 @@ zmq::address_t::~address_t ()
     }
 #endif
 
+#ifdef ZMQ_HAVE_TLS
+    else if (protocol == protocol_name::tls) {
+        LIBZMQ_DELETE (resolved.tcp_addr);
+    }
+#endif
+
 #if defined ZMQ_HAVE_IPC
     else if (protocol == protocol_name::ipc) {
         LIBZMQ_DELETE (resolved.ipc_addr);
@@ -109,6 +122,13 @@ int zmq::address_t::to_string (std::string &addr_) const
     if (protocol == protocol_name::wss && resolved.ws_addr)
         return resolved.ws_addr->to_string (addr_);
 #endif
+#ifdef ZMQ_HAVE_TLS
+    if (protocol == protocol_name::tls && resolved.tcp_addr) {
+        const tls_address_t tls_addr (resolved.tcp_addr->addr (),
+                                      resolved.tcp_addr->addrlen ());
+        return tls_addr.to_string (addr_);
+    }
+#endif
 #if defined ZMQ_HAVE_IPC
     if (protocol == protocol_name::ipc && resolved.ipc_addr)
         return resolved.ipc_addr->to_string (addr_);
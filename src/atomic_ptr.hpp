@@ -220,6 +220,31 @@ template <typename T> class atomic_ptr_t
 #endif
     }
 
+    //  Atomically set the pointer with release semantics.
+    void store (T *val_) ZMQ_NOEXCEPT
+    {
+#if defined ZMQ_ATOMIC_PTR_CXX11
+        _ptr.store (val_, std::memory_order_release);
+#else
+        xchg (val_);
+#endif
+    }
+
+    //  Atomically read the pointer with acquire semantics.
+    T *load () ZMQ_NOEXCEPT
+    {
+#if defined ZMQ_ATOMIC_PTR_CXX11
+        return _ptr.load (std::memory_order_acquire);
+#else
+        return (T *) atomic_cas ((void **) &_ptr, NULL, NULL
+#if defined ZMQ_ATOMIC_PTR_MUTEX
+                                 ,
+                                 _sync
+#endif
+        );
+#endif
+    }
+
   private:
 #if defined ZMQ_ATOMIC_PTR_CXX11
     std::atomic<T *> _ptr;
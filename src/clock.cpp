@@ -33,9 +33,15 @@
 #include "config.hpp"
 #include "err.hpp"
 #include "mutex.hpp"
+#include "atomic_ptr.hpp"
 
 #include <stddef.h>
 
+#if defined ZMQ_HAVE_LINUX
+#include <stdio.h>
+#include <string.h>
+#endif
+
 #if defined _MSC_VER
 #if defined _WIN32_WCE
 #include <cmnintrin.h>
@@ -47,6 +53,10 @@
 #endif
 #endif
 
+#if (defined __GNUC__ && (defined __i386__ || defined __x86_64__))
+#include <cpuid.h>
+#endif
+
 #if !defined ZMQ_HAVE_WINDOWS
 #include <sys/time.h>
 #endif
@@ -126,23 +136,184 @@ static f_compatible_get_tick_count64 my_get_tick_count64 =
   init_compatible_get_tick_count64 ();
 #endif
 
-#ifndef ZMQ_HAVE_WINDOWS
 const uint64_t usecs_per_msec = 1000;
 const uint64_t nsecs_per_usec = 1000;
-#endif
+const uint64_t nsecs_per_msec = 1000000;
 const uint64_t usecs_per_sec = 1000000;
+const uint64_t nsecs_per_sec = 1000000000;
+
+//  Conversion of timestamp counter ticks to nanoseconds, computed as
+//  base_ns + (tsc - base_tsc) * mult / 2^tsc_shift.
+struct tsc_calibration_t
+{
+    uint64_t base_tsc;
+    uint64_t base_ns;
+    uint64_t mult;
+
+    //  How far behind base_tsc the counter of another core may be. A
+    //  counter further behind has been reset.
+    uint64_t max_skew;
+};
+
+static const int tsc_shift = 24;
+static const uint64_t tsc_mask = (static_cast<uint64_t> (1) << tsc_shift) - 1;
+
+//  Set once the timestamp counter has been calibrated.
+static zmq::atomic_ptr_t<tsc_calibration_t> tsc_calibration;
+
+//  Cleared if the timestamp counter cannot be used to measure time.
+static zmq::atomic_value_t tsc_usable (1);
+
+//  First sample of the calibration, guarded by the mutex.
+static zmq::mutex_t tsc_calibration_mutex;
+static uint64_t tsc_sample_tsc = 0;
+static uint64_t tsc_sample_ns = 0;
+
+//  Returns true if the timestamp counter ticks at a constant rate, also
+//  across frequency changes and sleep states.
+static bool tsc_invariant ()
+{
+#if (defined __GNUC__ && (defined __i386__ || defined __x86_64__))
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid (0x80000007, &eax, &ebx, &ecx, &edx))
+        return false;
+    return (edx & (1 << 8)) != 0;
+#elif (defined _MSC_VER && (defined _M_IX86 || defined _M_X64))
+    int info[4];
+    __cpuid (info, 0x80000000);
+    if (static_cast<unsigned int> (info[0]) < 0x80000007)
+        return false;
+    __cpuid (info, 0x80000007);
+    return (info[3] & (1 << 8)) != 0;
+#else
+    return false;
+#endif
+}
+
+//  Returns false if the kernel does not keep time with the timestamp
+//  counter itself. It switches to another clocksource once it finds the
+//  counter unreliable, e.g. unsynchronised across sockets or stopped in
+//  deep sleep states, even if the CPU claims it is invariant.
+static bool tsc_trusted_by_kernel ()
+{
+#if defined ZMQ_HAVE_LINUX
+    FILE *const file =
+      fopen ("/sys/devices/system/clocksource/clocksource0/"
+             "current_clocksource",
+             "r");
+    if (!file)
+        return false;
+    char name[16] = "";
+    const bool ok = fgets (name, sizeof name, file) != NULL
+                    && strncmp (name, "tsc\n", 4) == 0;
+    fclose (file);
+    return ok;
+#else
+    return true;
+#endif
+}
 
 zmq::clock_t::clock_t () :
     _last_tsc (rdtsc ()),
 #ifdef ZMQ_HAVE_WINDOWS
     _last_time (static_cast<uint64_t> ((*my_get_tick_count64) ()))
 #else
-    _last_time (now_us () / usecs_per_msec)
+    _last_time (now_ns () / nsecs_per_msec)
 #endif
 {
 }
 
 uint64_t zmq::clock_t::now_us ()
+{
+    return system_ns () / nsecs_per_usec;
+}
+
+uint64_t zmq::clock_t::now_ns ()
+{
+    const tsc_calibration_t *calibration = tsc_calibration.load ();
+    if (unlikely (calibration == NULL)) {
+        if (tsc_usable.load ())
+            calibrate_tsc ();
+        calibration = tsc_calibration.load ();
+        if (calibration == NULL)
+            return system_ns ();
+    }
+
+    //  The counters of different cores may be slightly apart. Never go
+    //  back before the calibration point. A counter that is further
+    //  behind has been reset, e.g. on resume from suspend, and would stop
+    //  the clock until it caught up; use the system time from now on.
+    const uint64_t tsc = rdtsc ();
+    if (unlikely (tsc + calibration->max_skew < calibration->base_tsc)) {
+        tsc_usable.store (0);
+        tsc_calibration.store (NULL);
+        return system_ns ();
+    }
+    const uint64_t ticks =
+      tsc > calibration->base_tsc ? tsc - calibration->base_tsc : 0;
+    return calibration->base_ns + (ticks >> tsc_shift) * calibration->mult
+           + (((ticks & tsc_mask) * calibration->mult) >> tsc_shift);
+}
+
+void zmq::clock_t::calibrate_tsc ()
+{
+    //  Whoever finds the calibration in progress keeps using the system
+    //  time rather than waiting.
+    if (!tsc_calibration_mutex.try_lock ())
+        return;
+
+    //  Another thread may have completed it meanwhile.
+    if (tsc_calibration.load () != NULL || !tsc_usable.load ()) {
+        tsc_calibration_mutex.unlock ();
+        return;
+    }
+
+    //  Take the counter on both sides of reading the system time, and keep
+    //  the quickest of a few reads, so that the sample is not skewed by the
+    //  time it took to read the latter.
+    uint64_t tsc = 0;
+    uint64_t now = 0;
+    uint64_t best = 0;
+    for (int i = 0; i != 3; i++) {
+        const uint64_t tsc_before = rdtsc ();
+        const uint64_t ns = system_ns ();
+        const uint64_t tsc_after = rdtsc ();
+        if (i == 0 || tsc_after - tsc_before < best) {
+            best = tsc_after - tsc_before;
+            tsc = tsc_before + best / 2;
+            now = ns;
+        }
+    }
+
+    if (tsc_sample_ns == 0) {
+        if (tsc_invariant () && tsc_trusted_by_kernel ()) {
+            tsc_sample_tsc = tsc;
+            tsc_sample_ns = now;
+        } else
+            tsc_usable.store (0);
+    } else if (tsc <= tsc_sample_tsc) {
+        //  Migrated to a core whose counter is behind; start over.
+        tsc_sample_tsc = tsc;
+        tsc_sample_ns = now;
+    } else if (now - tsc_sample_ns
+               >= tsc_calibration_period * usecs_per_msec * nsecs_per_usec) {
+        //  The clock is anchored at the system time just read, so that
+        //  it continues from the values returned before calibration.
+        static tsc_calibration_t calibration;
+        calibration.base_tsc = tsc;
+        calibration.base_ns = now;
+        calibration.mult = static_cast<uint64_t> (
+          static_cast<double> (now - tsc_sample_ns)
+          * static_cast<double> (1 << tsc_shift)
+          / static_cast<double> (tsc - tsc_sample_tsc));
+        calibration.max_skew = (nsecs_per_msec << tsc_shift) / calibration.mult;
+        tsc_calibration.store (&calibration);
+    }
+
+    tsc_calibration_mutex.unlock ();
+}
+
+uint64_t zmq::clock_t::system_ns ()
 {
 #if defined ZMQ_HAVE_WINDOWS
 
@@ -157,11 +328,13 @@ uint64_t zmq::clock_t::now_us ()
     LARGE_INTEGER tick;
     QueryPerformanceCounter (&tick);
 
-    //  Convert the tick number into the number of seconds
+    //  Convert the tick number into the number of nanoseconds
     //  since the system was started.
-    const double ticks_div =
-      static_cast<double> (ticks_per_second.QuadPart) / usecs_per_sec;
-    return static_cast<uint64_t> (tick.QuadPart / ticks_div);
+    const uint64_t frequency =
+      static_cast<uint64_t> (ticks_per_second.QuadPart);
+    const uint64_t ticks = static_cast<uint64_t> (tick.QuadPart);
+    return ticks / frequency * nsecs_per_sec
+           + ticks % frequency * nsecs_per_sec / frequency;
 
 #elif defined HAVE_CLOCK_GETTIME                                               \
   && (defined CLOCK_MONOTONIC || defined ZMQ_HAVE_VXWORKS)
@@ -184,29 +357,35 @@ uint64_t zmq::clock_t::now_us ()
         struct timeval tv;
         int rc = gettimeofday (&tv, NULL);
         errno_assert (rc == 0);
-        return tv.tv_sec * usecs_per_sec + tv.tv_usec;
+        return (tv.tv_sec * usecs_per_sec + tv.tv_usec) * nsecs_per_usec;
 #endif
     }
-    return tv.tv_sec * usecs_per_sec + tv.tv_nsec / nsecs_per_usec;
+    return tv.tv_sec * nsecs_per_sec + tv.tv_nsec;
 
 #elif defined HAVE_GETHRTIME
 
-    return gethrtime () / nsecs_per_usec;
+    return gethrtime ();
 
 #else
 
-    LIBZMQ_UNUSED (nsecs_per_usec);
     //  Use POSIX gettimeofday function to get precise time.
     struct timeval tv;
     int rc = gettimeofday (&tv, NULL);
     errno_assert (rc == 0);
-    return tv.tv_sec * usecs_per_sec + tv.tv_usec;
+    return (tv.tv_sec * usecs_per_sec + tv.tv_usec) * nsecs_per_usec;
 
 #endif
 }
 
 uint64_t zmq::clock_t::now_ms ()
 {
+#ifndef ZMQ_HAVE_WINDOWS
+    //  Once the timestamp counter is calibrated, converting it costs no
+    //  more than checking whether the cached time below is still current.
+    if (likely (tsc_calibration.load () != NULL))
+        return now_ns () / nsecs_per_msec;
+#endif
+
     const uint64_t tsc = rdtsc ();
 
     //  If TSC is not supported, get precise time and chop off the microseconds.
@@ -218,7 +397,7 @@ uint64_t zmq::clock_t::now_ms ()
         // to its 32 bit limitation.
         return static_cast<uint64_t> ((*my_get_tick_count64) ());
 #else
-        return now_us () / usecs_per_msec;
+        return now_ns () / nsecs_per_msec;
 #endif
     }
 
@@ -232,7 +411,8 @@ uint64_t zmq::clock_t::now_ms ()
 #ifdef ZMQ_HAVE_WINDOWS
     _last_time = static_cast<uint64_t> ((*my_get_tick_count64) ());
 #else
-    _last_time = now_us () / usecs_per_msec;
+    //  Reading the precise time also calibrates the timestamp counter.
+    _last_time = now_ns () / nsecs_per_msec;
 #endif
     return _last_time;
 }
@@ -275,7 +455,6 @@ uint64_t zmq::clock_t::rdtsc ()
 #else
     clock_gettime (CLOCK_MONOTONIC, &ts);
 #endif
-    return static_cast<uint64_t> (ts.tv_sec) * nsecs_per_usec * usecs_per_sec
-           + ts.tv_nsec;
+    return static_cast<uint64_t> (ts.tv_sec) * nsecs_per_sec + ts.tv_nsec;
 #endif
 }
@@ -62,11 +62,24 @@ class clock_t
     //  High precision timestamp.
     static uint64_t now_us ();
 
+    //  High precision monotonic timestamp in nanoseconds. Where the CPU has
+    //  an invariant timestamp counter, it is read and converted using a
+    //  calibration against the system clock, which avoids the cost of
+    //  a clock_gettime call.
+    static uint64_t now_ns ();
+
     //  Low precision timestamp. In tight loops generating it can be
-    //  10 to 100 times faster than the high precision timestamp.
+    //  10 to 100 times faster than the high precision timestamp. Uses
+    //  now_ns, and thus the calibrated timestamp counter, where possible.
     uint64_t now_ms ();
 
   private:
+    //  Monotonic system time in nanoseconds.
+    static uint64_t system_ns ();
+
+    //  Measures the timestamp counter against the system time.
+    static void calibrate_tsc ();
+
     //  TSC timestamp of when last time measurement was made.
     uint64_t _last_tsc;
 
@@ -39,6 +39,7 @@ namespace zmq
 {
 class object_t;
 class own_t;
+class crypto_job_t;
 struct i_engine;
 class pipe_t;
 class socket_base_t;
@@ -73,6 +74,7 @@ struct command_t
         conn_failed,
         pipe_peer_stats,
         pipe_stats_publish,
+        crypto_job_done,
         done
     } type;
 
@@ -186,12 +188,15 @@ struct command_t
         {
         } reaped;
 
-        //  Send application-side pipe count and ask to send monitor event
+        //  Send application-side pipe count and ask to send monitor event.
+        //  Latency summaries of both directions are collated in latency,
+        //  if the pipe records them.
         struct
         {
             uint64_t queue_count;
             zmq::own_t *socket_base;
             endpoint_uri_pair_t *endpoint_pair;
+            uint64_t *latency;
         } pipe_peer_stats;
 
         //  Collate application thread and I/O thread pipe counts and endpoints
@@ -201,8 +206,16 @@ struct command_t
             uint64_t outbound_queue_count;
             uint64_t inbound_queue_count;
             endpoint_uri_pair_t *endpoint_pair;
+            uint64_t *latency;
         } pipe_stats_publish;
 
+        //  Sent by a crypto pool thread to the object that submitted the
+        //  job once it has run. The submitter used inc_seqnum beforehand.
+        struct
+        {
+            zmq::crypto_job_t *job;
+        } crypto_job_done;
+
         //  Sent by reaper thread to the term thread when all the sockets
         //  are successfully deallocated.
         struct
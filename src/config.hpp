@@ -63,6 +63,69 @@ enum
     //  latency and fairness.
     proxy_burst_size = 1000,
 
+    //  Maximal number of idle decoder buffers each I/O thread keeps for
+    //  reuse by zero-copy receive.
+    decoder_buffer_pool_size = 16,
+
+    //  Number of distinct buffer sizes the decoder buffers of an I/O thread
+    //  are pooled by. Sockets with different ZMQ_IN_BATCH_SIZE values need
+    //  buffers of different sizes.
+    decoder_buffer_pool_sizes = 4,
+
+    //  Size of the page-backed regions I/O threads carve decoder buffers
+    //  from when ZMQ_IO_THREAD_NUMA_LOCAL or ZMQ_IO_THREAD_HUGEPAGES is
+    //  set. One huge page on most platforms.
+    decoder_buffer_region_size = 2 * 1024 * 1024,
+
+    //  Maximal number of pieces of encoded data written to a stream
+    //  socket in a single system call.
+    out_gather_max_chunks = 64,
+
+    //  Message bodies of at least this size are written straight from
+    //  the message rather than copied into the output batch. Must be
+    //  larger than max_vsm_size.
+    out_gather_min_ref = 1024,
+
+    //  How often, in milliseconds, the socket of a closed connection is
+    //  checked for the completion of its outstanding zero-copy sends.
+    zerocopy_drain_interval = 10,
+
+    //  How long, in milliseconds, closed connections are given to finish
+    //  their zero-copy sends once the context terminates, regardless of
+    //  ZMQ_LINGER. The data still queued after that is discarded.
+    zerocopy_term_timeout = 1000,
+
+    //  Maximal number of datagrams the UDP engine handles in a single
+    //  system call. Matches the kernel limit for sendmmsg/recvmmsg.
+    max_udp_batch_size = 1024,
+
+    //  Limits for a single UDP segmentation offload send: the kernel
+    //  accepts at most 64 segments and one IP datagram worth of payload.
+    max_udp_gso_segments = 64,
+    max_udp_gso_size = 65507,
+
+    //  Size of a receive buffer able to hold a coalesced UDP datagram.
+    max_udp_gro_size = 65535,
+
+    //  Maximal number of coalesced UDP datagrams received in a single
+    //  system call. Each needs a buffer of max_udp_gro_size bytes and
+    //  carries up to max_udp_gso_segments datagrams.
+    max_udp_gro_batch_size = 4,
+
+    //  Largest block of long message content, including its header, that
+    //  is served from the message pool. Must be a power of two of at least
+    //  128 bytes.
+    msg_pool_max_block = 16384,
+
+    //  Amount of memory, in bytes, each thread may keep cached per size
+    //  class of the message pool. Blocks beyond that are shared with other
+    //  threads.
+    msg_pool_thread_cache = 65536,
+
+    //  Longest topic, i.e. first message part, whose matching pipes an XPUB
+    //  socket caches with ZMQ_XPUB_MATCH_CACHE.
+    xpub_match_cache_max_topic = 256,
+
     //  Maximal delay to process command in API thread (in CPU ticks).
     //  3,000,000 ticks equals to 1 - 2 milliseconds on current CPUs.
     //  Note that delay is only applied when there is continuous stream of
@@ -76,6 +139,11 @@ enum
     //  possible latencies.
     clock_precision = 1000000,
 
+    //  Minimal time, in milliseconds, over which the CPU's timestamp counter
+    //  is measured against the system clock before clock_t::now_ns starts
+    //  converting it to nanoseconds. Until then, the system clock is used.
+    tsc_calibration_period = 50,
+
     //  On some OSes the signaler has to be emulated using a TCP
     //  connection. In such cases following port is used.
     //  If 0, it lets the OS choose a free port without requiring use of a
@@ -0,0 +1,119 @@
+/*
+    Copyright (c) 2007-2016 Contributors as noted in the AUTHORS file
+
+    This file is part of libzmq, the ZeroMQ core engine in C++.
+
+    libzmq is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License (LGPL) as published
+    by the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    As a special exception, the Contributors give you permission to link
+    this library with independent modules to produce an executable,
+    regardless of the license terms of these independent modules, and to
+    copy and distribute the resulting executable under terms of your choice,
+    provided that you also meet, for each linked independent module, the
+    terms and conditions of the license of that module. An independent
+    module is a module which is not derived from or based on this library.
+    If you modify this library, you must extend this exception to your
+    version of the library.
+
+    libzmq is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "precompiled.hpp"
+
+#include <new>
+
+#include "macros.hpp"
+#include "crypto_pool.hpp"
+#include "command.hpp"
+#include "ctx.hpp"
+#include "err.hpp"
+#include "object.hpp"
+
+zmq::crypto_pool_t::crypto_pool_t (ctx_t *ctx_, int thread_count_) :
+    _ctx (ctx_), _stopping (false)
+{
+    zmq_assert (thread_count_ > 0);
+    for (int i = 0; i != thread_count_; i++) {
+        thread_t *thread = new (std::nothrow) thread_t;
+        alloc_assert (thread);
+        _threads.push_back (thread);
+    }
+}
+
+zmq::crypto_pool_t::~crypto_pool_t ()
+{
+    {
+        scoped_lock_t locker (_sync);
+        zmq_assert (_queue.empty ());
+        _stopping = true;
+        _cond.broadcast ();
+    }
+
+    for (std::vector<thread_t *>::size_type i = 0; i != _threads.size ();
+         i++) {
+        if (_threads[i]->get_started ())
+            _threads[i]->stop ();
+        LIBZMQ_DELETE (_threads[i]);
+    }
+}
+
+void zmq::crypto_pool_t::start ()
+{
+    for (std::vector<thread_t *>::size_type i = 0; i != _threads.size (); i++)
+        _ctx->start_thread (*_threads[i], worker_routine, this, "Crypto");
+}
+
+void zmq::crypto_pool_t::submit (object_t *destination_, crypto_job_t *job_)
+{
+    const pending_t pending = {destination_, job_};
+
+    scoped_lock_t locker (_sync);
+    _queue.push_back (pending);
+
+    //  There is no way to wake a single waiter, but the pool is small and
+    //  the waiters that find the queue empty go back to sleep.
+    _cond.broadcast ();
+}
+
+void zmq::crypto_pool_t::worker_routine (void *arg_)
+{
+    static_cast<crypto_pool_t *> (arg_)->loop ();
+}
+
+void zmq::crypto_pool_t::loop ()
+{
+    _sync.lock ();
+    while (true) {
+        while (_queue.empty () && !_stopping) {
+            const int rc = _cond.wait (&_sync, -1);
+            errno_assert (rc == 0);
+        }
+        if (_queue.empty ())
+            break;
+
+        const pending_t pending = _queue.front ();
+        _queue.pop_front ();
+        _sync.unlock ();
+
+        pending.job->execute ();
+
+        command_t cmd;
+        cmd.destination = pending.destination;
+        cmd.type = command_t::crypto_job_done;
+        cmd.args.crypto_job_done.job = pending.job;
+        _ctx->send_command (pending.destination->get_tid (), cmd);
+
+        _sync.lock ();
+    }
+    _sync.unlock ();
+}
@@ -0,0 +1,106 @@
+/*
+    Copyright (c) 2007-2016 Contributors as noted in the AUTHORS file
+
+    This file is part of libzmq, the ZeroMQ core engine in C++.
+
+    libzmq is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License (LGPL) as published
+    by the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    As a special exception, the Contributors give you permission to link
+    this library with independent modules to produce an executable,
+    regardless of the license terms of these independent modules, and to
+    copy and distribute the resulting executable under terms of your choice,
+    provided that you also meet, for each linked independent module, the
+    terms and conditions of the license of that module. An independent
+    module is a module which is not derived from or based on this library.
+    If you modify this library, you must extend this exception to your
+    version of the library.
+
+    libzmq is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __ZMQ_CRYPTO_POOL_HPP_INCLUDED__
+#define __ZMQ_CRYPTO_POOL_HPP_INCLUDED__
+
+#include <deque>
+#include <vector>
+
+#include "condition_variable.hpp"
+#include "macros.hpp"
+#include "mutex.hpp"
+#include "stdint.hpp"
+#include "thread.hpp"
+
+namespace zmq
+{
+class ctx_t;
+class object_t;
+
+//  Unit of work run on a crypto pool thread. While it executes, a job must
+//  only touch its own state; it is handed back to the object that submitted
+//  it, on that object's thread, once it is done.
+
+class crypto_job_t
+{
+  public:
+    crypto_job_t () ZMQ_DEFAULT;
+    virtual ~crypto_job_t () ZMQ_DEFAULT;
+
+    virtual void execute () = 0;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (crypto_job_t)
+};
+
+//  Threads that run expensive cryptographic operations, e.g. the public key
+//  operations of a CURVE handshake, off the I/O threads. Jobs are returned
+//  to the submitting object in a crypto_job_done command.
+
+class crypto_pool_t
+{
+  public:
+    crypto_pool_t (ctx_t *ctx_, int thread_count_);
+
+    //  Waits for the threads to finish. No jobs may be outstanding.
+    ~crypto_pool_t ();
+
+    void start ();
+
+    //  Runs the job on one of the pool's threads and then sends it to
+    //  the destination. The caller must have incremented the destination's
+    //  sequence number, which keeps it alive until the job comes back.
+    void submit (object_t *destination_, crypto_job_t *job_);
+
+  private:
+    static void worker_routine (void *arg_);
+    void loop ();
+
+    ctx_t *const _ctx;
+
+    std::vector<thread_t *> _threads;
+
+    struct pending_t
+    {
+        object_t *destination;
+        crypto_job_t *job;
+    };
+
+    //  Jobs waiting for a thread, protected by _sync.
+    std::deque<pending_t> _queue;
+    bool _stopping;
+    mutex_t _sync;
+    condition_variable_t _cond;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (crypto_pool_t)
+};
+}
+
+#endif
@@ -43,9 +43,11 @@
 #include "socket_base.hpp"
 #include "io_thread.hpp"
 #include "reaper.hpp"
+#include "crypto_pool.hpp"
 #include "pipe.hpp"
 #include "err.hpp"
 #include "msg.hpp"
+#include "page_allocator.hpp"
 #include "random.hpp"
 
 #ifdef ZMQ_HAVE_VMCI
@@ -78,9 +80,11 @@ zmq::ctx_t::ctx_t () :
     _starting (true),
     _terminating (false),
     _reaper (NULL),
+    _crypto_pool (NULL),
     _max_sockets (clipped_maxsocket (ZMQ_MAX_SOCKETS_DFLT)),
     _max_msgsz (INT_MAX),
     _io_thread_count (ZMQ_IO_THREADS_DFLT),
+    _crypto_thread_count (0),
     _blocky (true),
     _ipv6 (false),
     _zero_copy (true)
@@ -127,6 +131,9 @@ zmq::ctx_t::~ctx_t ()
         LIBZMQ_DELETE (_io_threads[i]);
     }
 
+    //  All sessions are gone, so no crypto jobs are outstanding.
+    LIBZMQ_DELETE (_crypto_pool);
+
     //  Deallocate the reaper thread object.
     LIBZMQ_DELETE (_reaper);
 
@@ -279,6 +286,14 @@ int zmq::ctx_t::set (int option_, const void *optval_, size_t optvallen_)
             }
             break;
 
+        case ZMQ_CRYPTO_THREADS:
+            if (is_int && value >= 0) {
+                scoped_lock_t locker (_opt_sync);
+                _crypto_thread_count = value;
+                return 0;
+            }
+            break;
+
         case ZMQ_IPV6:
             if (is_int && value >= 0) {
                 scoped_lock_t locker (_opt_sync);
@@ -347,6 +362,13 @@ int zmq::ctx_t::get (int option_, void *optval_, const size_t *optvallen_)
             }
             break;
 
+        case ZMQ_CRYPTO_THREADS:
+            if (is_int) {
+                *value = _crypto_thread_count;
+                return 0;
+            }
+            break;
+
         case ZMQ_IPV6:
             if (is_int) {
                 *value = _ipv6;
@@ -382,6 +404,24 @@ int zmq::ctx_t::get (int option_, void *optval_, const size_t *optvallen_)
             }
             break;
 
+        case ZMQ_DECODER_BUFFER_HITS:
+        case ZMQ_DECODER_BUFFER_MISSES:
+            if (is_int) {
+                scoped_lock_t locker (_slot_sync);
+                uint32_t total = 0;
+                for (io_threads_t::size_type i = 0; i != _io_threads.size ();
+                     i++) {
+                    const decoder_buffer_pool_t *const pool =
+                      _io_threads[i]->get_decoder_buffer_pool ();
+                    total += option_ == ZMQ_DECODER_BUFFER_HITS
+                               ? pool->hits ()
+                               : pool->misses ();
+                }
+                *value = static_cast<int> (total);
+                return 0;
+            }
+            break;
+
         default: {
             return thread_ctx_t::get (option_, optval_, optvallen_);
         }
@@ -411,6 +451,7 @@ bool zmq::ctx_t::start ()
     const int term_and_reaper_threads_count = 2;
     const int mazmq = _max_sockets;
     const int ios = _io_thread_count;
+    const int crypto_threads = _crypto_thread_count;
     _opt_sync.unlock ();
     const int slot_count = mazmq + ios + term_and_reaper_threads_count;
     try {
@@ -456,6 +497,17 @@ bool zmq::ctx_t::start ()
         io_thread->start ();
     }
 
+    //  The crypto pool needs no slots; jobs are returned through the
+    //  mailboxes of the objects that submitted them.
+    if (crypto_threads > 0) {
+        _crypto_pool = new (std::nothrow) crypto_pool_t (this, crypto_threads);
+        if (!_crypto_pool) {
+            errno = ENOMEM;
+            goto fail_cleanup_reaper;
+        }
+        _crypto_pool->start ();
+    }
+
     //  In the unused part of the slot array, create a list of empty slots.
     for (int32_t i = static_cast<int32_t> (_slots.size ()) - 1;
          i >= static_cast<int32_t> (ios) + term_and_reaper_threads_count; i--) {
@@ -539,9 +591,18 @@ zmq::object_t *zmq::ctx_t::get_reaper () const
     return _reaper;
 }
 
+zmq::crypto_pool_t *zmq::ctx_t::get_crypto_pool () const
+{
+    return _crypto_pool;
+}
+
 zmq::thread_ctx_t::thread_ctx_t () :
     _thread_priority (ZMQ_THREAD_PRIORITY_DFLT),
-    _thread_sched_policy (ZMQ_THREAD_SCHED_POLICY_DFLT)
+    _thread_sched_policy (ZMQ_THREAD_SCHED_POLICY_DFLT),
+    _io_uring (true),
+    _io_thread_numa_local (false),
+    _io_thread_hugepages (false),
+    _io_thread_spin (0)
 {
 }
 
@@ -604,6 +665,38 @@ int zmq::thread_ctx_t::set (int option_, const void *optval_, size_t optvallen_)
             }
             break;
 
+        case ZMQ_IO_URING:
+            if (is_int && value >= 0) {
+                scoped_lock_t locker (_opt_sync);
+                _io_uring = (value != 0);
+                return 0;
+            }
+            break;
+
+        case ZMQ_IO_THREAD_NUMA_LOCAL:
+            if (is_int && value >= 0) {
+                scoped_lock_t locker (_opt_sync);
+                _io_thread_numa_local = (value != 0);
+                return 0;
+            }
+            break;
+
+        case ZMQ_IO_THREAD_HUGEPAGES:
+            if (is_int && value >= 0) {
+                scoped_lock_t locker (_opt_sync);
+                _io_thread_hugepages = (value != 0);
+                return 0;
+            }
+            break;
+
+        case ZMQ_IO_THREAD_SPIN:
+            if (is_int && value >= 0) {
+                scoped_lock_t locker (_opt_sync);
+                _io_thread_spin = value;
+                return 0;
+            }
+            break;
+
         case ZMQ_THREAD_NAME_PREFIX:
             // start_thread() allows max 16 chars for thread name
             if (is_int) {
@@ -641,6 +734,38 @@ int zmq::thread_ctx_t::get (int option_,
             }
             break;
 
+        case ZMQ_IO_URING:
+            if (is_int) {
+                scoped_lock_t locker (_opt_sync);
+                *value = _io_uring;
+                return 0;
+            }
+            break;
+
+        case ZMQ_IO_THREAD_NUMA_LOCAL:
+            if (is_int) {
+                scoped_lock_t locker (_opt_sync);
+                *value = _io_thread_numa_local;
+                return 0;
+            }
+            break;
+
+        case ZMQ_IO_THREAD_HUGEPAGES:
+            if (is_int) {
+                scoped_lock_t locker (_opt_sync);
+                *value = _io_thread_hugepages;
+                return 0;
+            }
+            break;
+
+        case ZMQ_IO_THREAD_SPIN:
+            if (is_int) {
+                scoped_lock_t locker (_opt_sync);
+                *value = _io_thread_spin;
+                return 0;
+            }
+            break;
+
         case ZMQ_THREAD_NAME_PREFIX:
             if (is_int) {
                 scoped_lock_t locker (_opt_sync);
@@ -659,6 +784,22 @@ int zmq::thread_ctx_t::get (int option_,
     return -1;
 }
 
+bool zmq::thread_ctx_t::io_uring_enabled () const
+{
+    return _io_uring;
+}
+
+int zmq::thread_ctx_t::io_thread_page_flags () const
+{
+    return (_io_thread_numa_local ? page_numa_local : 0)
+           | (_io_thread_hugepages ? page_huge : 0);
+}
+
+int zmq::thread_ctx_t::io_thread_spin () const
+{
+    return _io_thread_spin;
+}
+
 void zmq::ctx_t::send_command (uint32_t tid_, const command_t &command_)
 {
     _slots[tid_]->send (command_);
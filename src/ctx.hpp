@@ -50,6 +50,7 @@ class object_t;
 class io_thread_t;
 class socket_base_t;
 class reaper_t;
+class crypto_pool_t;
 class pipe_t;
 
 //  Information associated with inproc endpoint. Note that endpoint options
@@ -75,6 +76,16 @@ class thread_ctx_t
     int set (int option_, const void *optval_, size_t optvallen_);
     int get (int option_, void *optval_, const size_t *optvallen_);
 
+    //  Whether I/O thread pollers may use io_uring where available.
+    bool io_uring_enabled () const;
+
+    //  Placement flags (see page_allocator.hpp) for the decoder buffers
+    //  of I/O threads.
+    int io_thread_page_flags () const;
+
+    //  Microseconds I/O threads poll for events before blocking.
+    int io_thread_spin () const;
+
   protected:
     //  Synchronisation of access to context options.
     mutex_t _opt_sync;
@@ -85,6 +96,10 @@ class thread_ctx_t
     int _thread_sched_policy;
     std::set<int> _thread_affinity_cpus;
     std::string _thread_name_prefix;
+    bool _io_uring;
+    bool _io_thread_numa_local;
+    bool _io_thread_hugepages;
+    int _io_thread_spin;
 };
 
 //  Context object encapsulates all the global state associated with
@@ -134,6 +149,9 @@ class ctx_t ZMQ_FINAL : public thread_ctx_t
     //  Returns reaper thread object.
     zmq::object_t *get_reaper () const;
 
+    //  Returns the crypto pool, or NULL if ZMQ_CRYPTO_THREADS is zero.
+    zmq::crypto_pool_t *get_crypto_pool () const;
+
     //  Management of inproc endpoints.
     int register_endpoint (const char *addr_, const endpoint_t &endpoint_);
     int unregister_endpoint (const std::string &addr_,
@@ -203,6 +221,9 @@ class ctx_t ZMQ_FINAL : public thread_ctx_t
     typedef std::vector<zmq::io_thread_t *> io_threads_t;
     io_threads_t _io_threads;
 
+    //  Threads that take CURVE handshake crypto off the I/O threads.
+    zmq::crypto_pool_t *_crypto_pool;
+
     //  Array of pointers to mailboxes for both application and I/O threads.
     std::vector<i_mailbox *> _slots;
 
@@ -233,6 +254,9 @@ class ctx_t ZMQ_FINAL : public thread_ctx_t
     //  Number of I/O threads to launch.
     int _io_thread_count;
 
+    //  Number of crypto pool threads to launch.
+    int _crypto_thread_count;
+
     //  Does context wait (possibly forever) on termination?
     bool _blocky;
 
@@ -55,10 +55,9 @@ namespace zmq
 struct curve_client_tools_t
 {
     static int produce_hello (void *data_,
-                              const uint8_t *server_key_,
                               const uint64_t cn_nonce_,
                               const uint8_t *cn_public_,
-                              const uint8_t *cn_secret_)
+                              const uint8_t *hello_precom_)
     {
         uint8_t hello_nonce[crypto_box_NONCEBYTES];
         std::vector<uint8_t, secure_allocator_t<uint8_t> > hello_plaintext (
@@ -70,9 +69,9 @@ struct curve_client_tools_t
         put_uint64 (hello_nonce + 16, cn_nonce_);
 
         //  Create Box [64 * %x0](C'->S)
-        const int rc =
-          crypto_box (hello_box, &hello_plaintext[0], hello_plaintext.size (),
-                      hello_nonce, server_key_, cn_secret_);
+        const int rc = crypto_box_afternm (hello_box, &hello_plaintext[0],
+                                           hello_plaintext.size (),
+                                           hello_nonce, hello_precom_);
         if (rc == -1)
             return -1;
 
@@ -95,7 +94,7 @@ struct curve_client_tools_t
 
     static int process_welcome (const uint8_t *msg_data_,
                                 size_t msg_size_,
-                                const uint8_t *server_key_,
+                                const uint8_t *hello_precom_,
                                 const uint8_t *cn_secret_,
                                 uint8_t *cn_server_,
                                 uint8_t *cn_cookie_,
@@ -118,9 +117,9 @@ struct curve_client_tools_t
         memcpy (welcome_nonce, "WELCOME-", 8);
         memcpy (welcome_nonce + 8, msg_data_ + 8, 16);
 
-        int rc = crypto_box_open (&welcome_plaintext[0], welcome_box,
-                                  sizeof welcome_box, welcome_nonce,
-                                  server_key_, cn_secret_);
+        int rc = crypto_box_open_afternm (&welcome_plaintext[0], welcome_box,
+                                          sizeof welcome_box, welcome_nonce,
+                                          hello_precom_);
         if (rc != 0) {
             errno = EPROTO;
             return -1;
@@ -144,9 +143,9 @@ struct curve_client_tools_t
                                  const uint8_t *public_key_,
                                  const uint8_t *secret_key_,
                                  const uint8_t *cn_public_,
-                                 const uint8_t *cn_secret_,
                                  const uint8_t *cn_server_,
                                  const uint8_t *cn_cookie_,
+                                 const uint8_t *cn_precom_,
                                  const uint8_t *metadata_plaintext_,
                                  const size_t metadata_length_)
     {
@@ -203,9 +202,9 @@ struct curve_client_tools_t
         memcpy (initiate_nonce, "CurveZMQINITIATE", 16);
         put_uint64 (initiate_nonce + 16, cn_nonce_);
 
-        rc = crypto_box (&initiate_box[0], &initiate_plaintext[0],
-                         crypto_box_ZEROBYTES + 128 + metadata_length_,
-                         initiate_nonce, cn_server_, cn_secret_);
+        rc = crypto_box_afternm (&initiate_box[0], &initiate_plaintext[0],
+                                 crypto_box_ZEROBYTES + 128 + metadata_length_,
+                                 initiate_nonce, cn_precom_);
 
         if (rc == -1)
             return -1;
@@ -261,20 +260,28 @@ struct curve_client_tools_t
         memset (cn_public, 0, crypto_box_PUBLICKEYBYTES);
         rc = crypto_box_keypair (cn_public, cn_secret);
         zmq_assert (rc == 0);
+
+        //  HELLO and WELCOME are both boxed between C' and S, so the
+        //  shared key is computed once here rather than once per box.
+        rc = crypto_box_beforenm (hello_precom, server_key, cn_secret);
+        zmq_assert (rc == 0);
     }
 
     int produce_hello (void *data_, const uint64_t cn_nonce_) const
     {
-        return produce_hello (data_, server_key, cn_nonce_, cn_public,
-                              cn_secret);
+        return produce_hello (data_, cn_nonce_, cn_public, hello_precom);
     }
 
     int process_welcome (const uint8_t *msg_data_,
                          size_t msg_size_,
                          uint8_t *cn_precom_)
     {
-        return process_welcome (msg_data_, msg_size_, server_key, cn_secret,
-                                cn_server, cn_cookie, cn_precom_);
+        const int rc =
+          process_welcome (msg_data_, msg_size_, hello_precom, cn_secret,
+                           cn_server, cn_cookie, cn_precom);
+        if (rc == 0)
+            memcpy (cn_precom_, cn_precom, crypto_box_BEFORENMBYTES);
+        return rc;
     }
 
     int produce_initiate (void *data_,
@@ -284,8 +291,8 @@ struct curve_client_tools_t
                           const size_t metadata_length_) const
     {
         return produce_initiate (data_, size_, cn_nonce_, server_key,
-                                 public_key, secret_key, cn_public, cn_secret,
-                                 cn_server, cn_cookie, metadata_plaintext_,
+                                 public_key, secret_key, cn_public, cn_server,
+                                 cn_cookie, cn_precom, metadata_plaintext_,
                                  metadata_length_);
     }
 
@@ -310,6 +317,12 @@ struct curve_client_tools_t
     //  Cookie received from server
     uint8_t cn_cookie[16 + 80];
 
+    //  Precomputed key for boxes between C' and S
+    uint8_t hello_precom[crypto_box_BEFORENMBYTES];
+
+    //  Precomputed key for boxes between C' and S'
+    uint8_t cn_precom[crypto_box_BEFORENMBYTES];
+
   private:
     template <size_t N>
     static bool is_handshake_command (const uint8_t *msg_data_,
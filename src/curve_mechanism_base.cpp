@@ -151,19 +151,34 @@ int zmq::curve_encoding_t::encode (msg_t *msg_)
                                : zmq::msg_t::sub_cmd_name_size;
     }
 
+    //  The plaintext is assembled directly in the message that will carry
+    //  the box and encrypted in place, so the payload is copied only once.
 #ifdef ZMQ_HAVE_CRYPTO_BOX_EASY_FNS
     const size_t mlen = flags_len + sub_cancel_len + msg_->size ();
-    std::vector<uint8_t> message_plaintext (mlen);
+    msg_t msg_box;
+    int rc =
+      msg_box.init_size (message_header_len + crypto_box_MACBYTES + mlen);
+    zmq_assert (rc == 0);
+
+    uint8_t *const message = static_cast<uint8_t *> (msg_box.data ());
+    uint8_t *const message_box = message + message_header_len;
+    uint8_t *const message_plaintext = message_box + crypto_box_MACBYTES;
 #else
     const size_t mlen =
       crypto_box_ZEROBYTES + flags_len + sub_cancel_len + msg_->size ();
-    std::vector<uint8_t> message_plaintext_with_zerobytes (mlen);
-    uint8_t *const message_plaintext =
-      &message_plaintext_with_zerobytes[crypto_box_ZEROBYTES];
+    msg_t msg_box;
+    int rc = msg_box.init_size (message_header_len + mlen
+                                - crypto_box_BOXZEROBYTES);
+    zmq_assert (rc == 0);
 
-    std::fill (message_plaintext_with_zerobytes.begin (),
-               message_plaintext_with_zerobytes.begin () + crypto_box_ZEROBYTES,
-               0);
+    //  The zero padding the box starts with overlaps the header, which is
+    //  written after boxing.
+    uint8_t *const message = static_cast<uint8_t *> (msg_box.data ());
+    uint8_t *const message_box =
+      message + message_header_len - crypto_box_BOXZEROBYTES;
+    uint8_t *const message_plaintext = message_box + crypto_box_ZEROBYTES;
+
+    memset (message_box, 0, crypto_box_ZEROBYTES);
 #endif
 
     const uint8_t flags = msg_->flags () & flag_mask;
@@ -191,43 +206,21 @@ int zmq::curve_encoding_t::encode (msg_t *msg_)
                 msg_->size ());
 
 #ifdef ZMQ_HAVE_CRYPTO_BOX_EASY_FNS
-    msg_t msg_box;
-    int rc =
-      msg_box.init_size (message_header_len + mlen + crypto_box_MACBYTES);
-    zmq_assert (rc == 0);
-
-    rc = crypto_box_easy_afternm (
-      static_cast<uint8_t *> (msg_box.data ()) + message_header_len,
-      &message_plaintext[0], mlen, message_nonce, _cn_precom);
-    zmq_assert (rc == 0);
-
-    msg_->move (msg_box);
-
-    uint8_t *const message = static_cast<uint8_t *> (msg_->data ());
+    rc = crypto_box_easy_afternm (message_box, message_plaintext, mlen,
+                                  message_nonce, _cn_precom);
 #else
-    std::vector<uint8_t> message_box (mlen);
-
-    int rc =
-      crypto_box_afternm (&message_box[0], &message_plaintext_with_zerobytes[0],
-                          mlen, message_nonce, _cn_precom);
-    zmq_assert (rc == 0);
-
-    rc = msg_->close ();
-    zmq_assert (rc == 0);
-
-    rc = msg_->init_size (16 + mlen - crypto_box_BOXZEROBYTES);
-    zmq_assert (rc == 0);
-
-    uint8_t *const message = static_cast<uint8_t *> (msg_->data ());
-
-    memcpy (message + message_header_len, &message_box[crypto_box_BOXZEROBYTES],
-            mlen - crypto_box_BOXZEROBYTES);
+    rc = crypto_box_afternm (message_box, message_box, mlen, message_nonce,
+                             _cn_precom);
 #endif
+    zmq_assert (rc == 0);
 
     memcpy (message, message_command, message_command_len);
     memcpy (message + message_command_len, message_nonce + nonce_prefix_len,
             sizeof (nonce_t));
 
+    rc = msg_->move (msg_box);
+    zmq_assert (rc == 0);
+
     return 0;
 }
 
@@ -245,6 +238,8 @@ int zmq::curve_encoding_t::decode (msg_t *msg_, int *error_event_code_)
     memcpy (message_nonce + nonce_prefix_len, message + message_command_len,
             sizeof (nonce_t));
 
+    //  The box is opened in place; the plaintext is then moved to the front
+    //  of the message, which is shrunk to fit.
 #ifdef ZMQ_HAVE_CRYPTO_BOX_EASY_FNS
     const size_t clen = msg_->size () - message_header_len;
 
@@ -253,52 +248,38 @@ int zmq::curve_encoding_t::decode (msg_t *msg_, int *error_event_code_)
     rc = crypto_box_open_easy_afternm (message_plaintext,
                                        message + message_header_len, clen,
                                        message_nonce, _cn_precom);
+
+    const size_t plaintext_size = clen - flags_len - crypto_box_MACBYTES;
 #else
     const size_t clen =
       crypto_box_BOXZEROBYTES + msg_->size () - message_header_len;
 
-    std::vector<uint8_t> message_plaintext_with_zerobytes (clen);
-    std::vector<uint8_t> message_box (clen);
-
-    std::fill (message_box.begin (),
-               message_box.begin () + crypto_box_BOXZEROBYTES, 0);
-    memcpy (&message_box[crypto_box_BOXZEROBYTES], message + message_header_len,
-            msg_->size () - message_header_len);
+    //  The zero padding the box must start with overlaps the header, which
+    //  is no longer needed once the nonce has been extracted.
+    uint8_t *const message_box =
+      message + message_header_len - crypto_box_BOXZEROBYTES;
+    memset (message_box, 0, crypto_box_BOXZEROBYTES);
 
-    rc = crypto_box_open_afternm (&message_plaintext_with_zerobytes[0],
-                                  &message_box[0], clen, message_nonce,
-                                  _cn_precom);
+    rc = crypto_box_open_afternm (message_box, message_box, clen,
+                                  message_nonce, _cn_precom);
 
     const uint8_t *const message_plaintext =
-      &message_plaintext_with_zerobytes[crypto_box_ZEROBYTES];
+      message_box + crypto_box_ZEROBYTES;
+
+    const size_t plaintext_size = clen - flags_len - crypto_box_ZEROBYTES;
 #endif
 
     if (rc == 0) {
         const uint8_t flags = message_plaintext[0];
 
-#ifdef ZMQ_HAVE_CRYPTO_BOX_EASY_FNS
-        const size_t plaintext_size = clen - flags_len - crypto_box_MACBYTES;
-
+        // this is copying the data to insecure memory, so there is no point in
+        // using secure_allocator_t for message_plaintext
         if (plaintext_size > 0) {
             memmove (msg_->data (), &message_plaintext[flags_len],
                      plaintext_size);
         }
 
         msg_->shrink (plaintext_size);
-#else
-        rc = msg_->close ();
-        zmq_assert (rc == 0);
-
-        rc = msg_->init_size (clen - flags_len - crypto_box_ZEROBYTES);
-        zmq_assert (rc == 0);
-
-        // this is copying the data to insecure memory, so there is no point in
-        // using secure_allocator_t for message_plaintext
-        if (msg_->size () > 0) {
-            memcpy (msg_->data (), &message_plaintext[flags_len],
-                    msg_->size ());
-        }
-#endif
 
         msg_->set_flags (flags & flag_mask);
     } else {
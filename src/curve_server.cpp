@@ -38,6 +38,158 @@
 #include "curve_server.hpp"
 #include "wire.hpp"
 #include "secure_allocator.hpp"
+#include "crypto_pool.hpp"
+
+//  The handshake steps that use the server's long-term or short-term secret
+//  key. Their public key operations may run on a crypto pool thread, so a
+//  job carries copies of everything it needs.
+
+class zmq::curve_server_t::job_t : public crypto_job_t
+{
+  public:
+    //  Completes the handshake step on the mechanism's thread.
+    virtual int done (curve_server_t *server_) = 0;
+};
+
+class zmq::curve_server_t::hello_job_t ZMQ_FINAL : public job_t
+{
+  public:
+    hello_job_t (const uint8_t *secret_key_,
+                 const uint8_t *cn_client_,
+                 const uint8_t *hello_) :
+        secret_key (crypto_box_SECRETKEYBYTES),
+        cn_secret (crypto_box_SECRETKEYBYTES),
+        welcome_precom (crypto_box_BEFORENMBYTES),
+        rc (-1)
+    {
+        memcpy (&secret_key[0], secret_key_, crypto_box_SECRETKEYBYTES);
+        memcpy (cn_client, cn_client_, crypto_box_PUBLICKEYBYTES);
+
+        memcpy (hello_nonce, "CurveZMQHELLO---", 16);
+        memcpy (hello_nonce + 16, hello_ + 112, 8);
+
+        memset (hello_box, 0, crypto_box_BOXZEROBYTES);
+        memcpy (hello_box + crypto_box_BOXZEROBYTES, hello_ + 120, 80);
+
+        //  Secret part of the short-term key pair
+        randombytes (&cn_secret[0], crypto_box_SECRETKEYBYTES);
+    }
+
+    void execute ()
+    {
+        //  Generate short-term key pair
+        int result = crypto_scalarmult_base (cn_public, &cn_secret[0]);
+        zmq_assert (result == 0);
+
+        //  C' and s are used both to open HELLO and to box WELCOME
+        result = crypto_box_beforenm (&welcome_precom[0], cn_client,
+                                      &secret_key[0]);
+        zmq_assert (result == 0);
+
+        std::vector<uint8_t, secure_allocator_t<uint8_t> > hello_plaintext (
+          crypto_box_ZEROBYTES + 64);
+
+        //  Open Box [64 * %x0](C'->S)
+        rc = crypto_box_open_afternm (&hello_plaintext[0], hello_box,
+                                      sizeof hello_box, hello_nonce,
+                                      &welcome_precom[0]);
+    }
+
+    int done (curve_server_t *server_) { return server_->hello_done (this); }
+
+    std::vector<uint8_t, secure_allocator_t<uint8_t> > secret_key;
+    uint8_t cn_client[crypto_box_PUBLICKEYBYTES];
+    uint8_t hello_nonce[crypto_box_NONCEBYTES];
+    uint8_t hello_box[crypto_box_BOXZEROBYTES + 80];
+
+    uint8_t cn_public[crypto_box_PUBLICKEYBYTES];
+    std::vector<uint8_t, secure_allocator_t<uint8_t> > cn_secret;
+    std::vector<uint8_t, secure_allocator_t<uint8_t> > welcome_precom;
+    int rc;
+};
+
+class zmq::curve_server_t::initiate_job_t ZMQ_FINAL : public job_t
+{
+  public:
+    initiate_job_t (const uint8_t *cn_client_,
+                    const uint8_t *cn_secret_,
+                    const uint8_t *initiate_,
+                    size_t size_) :
+        cn_secret (crypto_box_SECRETKEYBYTES),
+        clen ((size_ - 113) + crypto_box_BOXZEROBYTES),
+        initiate_box (crypto_box_BOXZEROBYTES + clen),
+        precom (crypto_box_BEFORENMBYTES),
+        initiate_plaintext (crypto_box_ZEROBYTES + clen),
+        vouch_plaintext (crypto_box_ZEROBYTES + 64),
+        initiate_rc (-1),
+        vouch_rc (-1)
+    {
+        memcpy (cn_client, cn_client_, crypto_box_PUBLICKEYBYTES);
+        memcpy (&cn_secret[0], cn_secret_, crypto_box_SECRETKEYBYTES);
+
+        std::fill (initiate_box.begin (),
+                   initiate_box.begin () + crypto_box_BOXZEROBYTES, 0);
+        memcpy (&initiate_box[crypto_box_BOXZEROBYTES], initiate_ + 113,
+                clen - crypto_box_BOXZEROBYTES);
+
+        memcpy (initiate_nonce, "CurveZMQINITIATE", 16);
+        memcpy (initiate_nonce + 16, initiate_ + 105, 8);
+    }
+
+    void execute ()
+    {
+        //  C' and s' are used both to open INITIATE and for the messages
+        int result =
+          crypto_box_beforenm (&precom[0], cn_client, &cn_secret[0]);
+        zmq_assert (result == 0);
+
+        //  Open Box [C + vouch + metadata](C'->S')
+        initiate_rc =
+          crypto_box_open_afternm (&initiate_plaintext[0], &initiate_box[0],
+                                   clen, initiate_nonce, &precom[0]);
+        if (initiate_rc != 0)
+            return;
+
+        uint8_t vouch_nonce[crypto_box_NONCEBYTES];
+        uint8_t vouch_box[crypto_box_BOXZEROBYTES + 80];
+
+        //  Open Box Box [C',S](C->S')
+        memset (vouch_box, 0, crypto_box_BOXZEROBYTES);
+        memcpy (vouch_box + crypto_box_BOXZEROBYTES,
+                &initiate_plaintext[crypto_box_ZEROBYTES + 48], 80);
+
+        memset (vouch_nonce, 0, crypto_box_NONCEBYTES);
+        memcpy (vouch_nonce, "VOUCH---", 8);
+        memcpy (vouch_nonce + 8,
+                &initiate_plaintext[crypto_box_ZEROBYTES + 32], 16);
+
+        vouch_rc = crypto_box_open (&vouch_plaintext[0], vouch_box,
+                                    sizeof vouch_box, vouch_nonce,
+                                    client_key (), &cn_secret[0]);
+    }
+
+    int done (curve_server_t *server_)
+    {
+        return server_->initiate_done (this);
+    }
+
+    const uint8_t *client_key () const
+    {
+        return &initiate_plaintext[crypto_box_ZEROBYTES];
+    }
+
+    uint8_t cn_client[crypto_box_PUBLICKEYBYTES];
+    std::vector<uint8_t, secure_allocator_t<uint8_t> > cn_secret;
+    const size_t clen;
+    uint8_t initiate_nonce[crypto_box_NONCEBYTES];
+    std::vector<uint8_t> initiate_box;
+
+    std::vector<uint8_t, secure_allocator_t<uint8_t> > precom;
+    std::vector<uint8_t, secure_allocator_t<uint8_t> > initiate_plaintext;
+    std::vector<uint8_t, secure_allocator_t<uint8_t> > vouch_plaintext;
+    int initiate_rc;
+    int vouch_rc;
+};
 
 zmq::curve_server_t::curve_server_t (session_base_t *session_,
                                      const std::string &peer_address_,
@@ -50,17 +202,16 @@ zmq::curve_server_t::curve_server_t (session_base_t *session_,
                             options_,
                             "CurveZMQMESSAGES",
                             "CurveZMQMESSAGEC",
-                            downgrade_sub_)
+                            downgrade_sub_),
+    _pending_job (NULL)
 {
-    int rc;
     //  Fetch our secret key from socket options
     memcpy (_secret_key, options_.curve_secret_key, crypto_box_SECRETKEYBYTES);
 
-    //  Generate short-term key pair
+    //  The short-term key pair is generated when HELLO arrives
     memset (_cn_secret, 0, crypto_box_SECRETKEYBYTES);
     memset (_cn_public, 0, crypto_box_PUBLICKEYBYTES);
-    rc = crypto_box_keypair (_cn_public, _cn_secret);
-    zmq_assert (rc == 0);
+    memset (_welcome_precom, 0, crypto_box_BEFORENMBYTES);
 }
 
 zmq::curve_server_t::~curve_server_t ()
@@ -106,6 +257,11 @@ int zmq::curve_server_t::process_handshake_command (msg_t *msg_)
         case waiting_for_initiate:
             rc = process_initiate (msg_);
             break;
+        case waiting_for_crypto:
+            //  Leave the command with the engine until the job is done.
+            errno = EAGAIN;
+            rc = -1;
+            break;
         default:
             // TODO I think this is not a case reachable with a misbehaving
             // client. It is not an "invalid handshake command", but would be
@@ -129,6 +285,30 @@ int zmq::curve_server_t::process_handshake_command (msg_t *msg_)
     return rc;
 }
 
+int zmq::curve_server_t::crypto_job_done (crypto_job_t *job_)
+{
+    if (job_ != _pending_job)
+        return 0;
+
+    zmq_assert (state == waiting_for_crypto);
+    _pending_job = NULL;
+    return static_cast<job_t *> (job_)->done (this);
+}
+
+int zmq::curve_server_t::run_job (job_t *job_)
+{
+    if (session->offload_crypto_job (job_)) {
+        _pending_job = job_;
+        state = waiting_for_crypto;
+        return 0;
+    }
+
+    job_->execute ();
+    const int rc = job_->done (this);
+    delete job_;
+    return rc;
+}
+
 int zmq::curve_server_t::encode (msg_t *msg_)
 {
     zmq_assert (state == ready);
@@ -180,22 +360,17 @@ int zmq::curve_server_t::process_hello (msg_t *msg_)
     //  Save client's short-term public key (C')
     memcpy (_cn_client, hello + 80, 32);
 
-    uint8_t hello_nonce[crypto_box_NONCEBYTES];
-    std::vector<uint8_t, secure_allocator_t<uint8_t> > hello_plaintext (
-      crypto_box_ZEROBYTES + 64);
-    uint8_t hello_box[crypto_box_BOXZEROBYTES + 80];
-
-    memcpy (hello_nonce, "CurveZMQHELLO---", 16);
-    memcpy (hello_nonce + 16, hello + 112, 8);
     set_peer_nonce (get_uint64 (hello + 112));
 
-    memset (hello_box, 0, crypto_box_BOXZEROBYTES);
-    memcpy (hello_box + crypto_box_BOXZEROBYTES, hello + 120, 80);
+    hello_job_t *const job =
+      new (std::nothrow) hello_job_t (_secret_key, _cn_client, hello);
+    alloc_assert (job);
+    return run_job (job);
+}
 
-    //  Open Box [64 * %x0](C'->S)
-    rc = crypto_box_open (&hello_plaintext[0], hello_box, sizeof hello_box,
-                          hello_nonce, _cn_client, _secret_key);
-    if (rc != 0) {
+int zmq::curve_server_t::hello_done (hello_job_t *job_)
+{
+    if (job_->rc != 0) {
         // CURVE I: cannot open client HELLO -- wrong server key?
         session->get_socket ()->event_handshake_failed_protocol (
           session->get_endpoint (), ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC);
@@ -203,8 +378,13 @@ int zmq::curve_server_t::process_hello (msg_t *msg_)
         return -1;
     }
 
+    memcpy (_cn_public, job_->cn_public, crypto_box_PUBLICKEYBYTES);
+    memcpy (_cn_secret, &job_->cn_secret[0], crypto_box_SECRETKEYBYTES);
+    memcpy (_welcome_precom, &job_->welcome_precom[0],
+            crypto_box_BEFORENMBYTES);
+
     state = sending_welcome;
-    return rc;
+    return 0;
 }
 
 int zmq::curve_server_t::produce_welcome (msg_t *msg_)
@@ -256,9 +436,10 @@ int zmq::curve_server_t::produce_welcome (msg_t *msg_)
     memcpy (&welcome_plaintext[crypto_box_ZEROBYTES + 48],
             cookie_ciphertext + crypto_secretbox_BOXZEROBYTES, 80);
 
-    rc = crypto_box (welcome_ciphertext, &welcome_plaintext[0],
-                     welcome_plaintext.size (), welcome_nonce, _cn_client,
-                     _secret_key);
+    rc = crypto_box_afternm (welcome_ciphertext, &welcome_plaintext[0],
+                             welcome_plaintext.size (), welcome_nonce,
+                             _welcome_precom);
+    memset (_welcome_precom, 0, crypto_box_BEFORENMBYTES);
 
     //  TODO I think we should change this back to zmq_assert (rc == 0);
     //  as it was before https://github.com/zeromq/libzmq/pull/1832
@@ -339,28 +520,17 @@ int zmq::curve_server_t::process_initiate (msg_t *msg_)
         return -1;
     }
 
-    const size_t clen = (size - 113) + crypto_box_BOXZEROBYTES;
-
-    uint8_t initiate_nonce[crypto_box_NONCEBYTES];
-    std::vector<uint8_t, secure_allocator_t<uint8_t> > initiate_plaintext (
-      crypto_box_ZEROBYTES + clen);
-    std::vector<uint8_t> initiate_box (crypto_box_BOXZEROBYTES + clen);
-
-    //  Open Box [C + vouch + metadata](C'->S')
-    std::fill (initiate_box.begin (),
-               initiate_box.begin () + crypto_box_BOXZEROBYTES, 0);
-    memcpy (&initiate_box[crypto_box_BOXZEROBYTES], initiate + 113,
-            clen - crypto_box_BOXZEROBYTES);
-
-    memcpy (initiate_nonce, "CurveZMQINITIATE", 16);
-    memcpy (initiate_nonce + 16, initiate + 105, 8);
     set_peer_nonce (get_uint64 (initiate + 105));
 
-    const uint8_t *client_key = &initiate_plaintext[crypto_box_ZEROBYTES];
+    initiate_job_t *const job = new (std::nothrow)
+      initiate_job_t (_cn_client, _cn_secret, initiate, size);
+    alloc_assert (job);
+    return run_job (job);
+}
 
-    rc = crypto_box_open (&initiate_plaintext[0], &initiate_box[0], clen,
-                          initiate_nonce, _cn_client, _cn_secret);
-    if (rc != 0) {
+int zmq::curve_server_t::initiate_done (initiate_job_t *job_)
+{
+    if (job_->initiate_rc != 0) {
         // CURVE I: cannot open client INITIATE
         session->get_socket ()->event_handshake_failed_protocol (
           session->get_endpoint (), ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC);
@@ -368,24 +538,7 @@ int zmq::curve_server_t::process_initiate (msg_t *msg_)
         return -1;
     }
 
-    uint8_t vouch_nonce[crypto_box_NONCEBYTES];
-    std::vector<uint8_t, secure_allocator_t<uint8_t> > vouch_plaintext (
-      crypto_box_ZEROBYTES + 64);
-    uint8_t vouch_box[crypto_box_BOXZEROBYTES + 80];
-
-    //  Open Box Box [C',S](C->S') and check contents
-    memset (vouch_box, 0, crypto_box_BOXZEROBYTES);
-    memcpy (vouch_box + crypto_box_BOXZEROBYTES,
-            &initiate_plaintext[crypto_box_ZEROBYTES + 48], 80);
-
-    memset (vouch_nonce, 0, crypto_box_NONCEBYTES);
-    memcpy (vouch_nonce, "VOUCH---", 8);
-    memcpy (vouch_nonce + 8, &initiate_plaintext[crypto_box_ZEROBYTES + 32],
-            16);
-
-    rc = crypto_box_open (&vouch_plaintext[0], vouch_box, sizeof vouch_box,
-                          vouch_nonce, client_key, _cn_secret);
-    if (rc != 0) {
+    if (job_->vouch_rc != 0) {
         // CURVE I: cannot open client INITIATE vouch
         session->get_socket ()->event_handshake_failed_protocol (
           session->get_endpoint (), ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC);
@@ -393,6 +546,13 @@ int zmq::curve_server_t::process_initiate (msg_t *msg_)
         return -1;
     }
 
+    const std::vector<uint8_t, secure_allocator_t<uint8_t> >
+      &initiate_plaintext = job_->initiate_plaintext;
+    const std::vector<uint8_t, secure_allocator_t<uint8_t> > &vouch_plaintext =
+      job_->vouch_plaintext;
+    const uint8_t *const client_key = job_->client_key ();
+    const size_t clen = job_->clen;
+
     //  What we decrypted must be the client's short-term public key
     if (memcmp (&vouch_plaintext[crypto_box_ZEROBYTES], _cn_client, 32)) {
         // TODO this case is very hard to test, as it would require a modified
@@ -405,16 +565,15 @@ int zmq::curve_server_t::process_initiate (msg_t *msg_)
         return -1;
     }
 
-    //  Precompute connection secret from client key
-    rc = crypto_box_beforenm (get_writable_precom_buffer (), _cn_client,
-                              _cn_secret);
-    zmq_assert (rc == 0);
+    //  Connection secret, precomputed from the client's short-term key
+    memcpy (get_writable_precom_buffer (), &job_->precom[0],
+            crypto_box_BEFORENMBYTES);
 
     //  Given this is a backward-incompatible change, it's behind a socket
     //  option disabled by default.
     if (zap_required () || !options.zap_enforce_domain) {
         //  Use ZAP protocol (RFC 27) to authenticate the user.
-        rc = session->zap_connect ();
+        const int rc = session->zap_connect ();
         if (rc == 0) {
             send_zap_request (client_key);
             state = waiting_for_zap_reply;
@@ -57,8 +57,13 @@ class curve_server_t ZMQ_FINAL : public zap_client_common_handshake_t,
     int process_handshake_command (msg_t *msg_);
     int encode (msg_t *msg_);
     int decode (msg_t *msg_);
+    int crypto_job_done (crypto_job_t *job_);
 
   private:
+    class job_t;
+    class hello_job_t;
+    class initiate_job_t;
+
     //  Our secret key (s)
     uint8_t _secret_key[crypto_box_SECRETKEYBYTES];
 
@@ -74,9 +79,21 @@ class curve_server_t ZMQ_FINAL : public zap_client_common_handshake_t,
     //  Key used to produce cookie
     uint8_t _cookie_key[crypto_secretbox_KEYBYTES];
 
+    //  Precomputed key for the WELCOME box, from C' and s
+    uint8_t _welcome_precom[crypto_box_BEFORENMBYTES];
+
+    //  Job submitted to the crypto pool, if we are waiting for one
+    job_t *_pending_job;
+
+    //  Runs the public key operations of a handshake step on the crypto
+    //  pool if there is one, otherwise right away.
+    int run_job (job_t *job_);
+
     int process_hello (msg_t *msg_);
+    int hello_done (hello_job_t *job_);
     int produce_welcome (msg_t *msg_);
     int process_initiate (msg_t *msg_);
+    int initiate_done (initiate_job_t *job_);
     int produce_ready (msg_t *msg_);
     int produce_error (msg_t *msg_) const;
 
@@ -63,6 +63,15 @@ class decoder_base_t : public i_decoder
         _buf = _allocator.allocate ();
     }
 
+    decoder_base_t (const size_t buf_size_, decoder_buffer_pool_t *pool_) :
+        _next (NULL),
+        _read_pos (NULL),
+        _to_read (0),
+        _allocator (buf_size_, pool_)
+    {
+        _buf = _allocator.allocate ();
+    }
+
     ~decoder_base_t () ZMQ_OVERRIDE { _allocator.deallocate (); }
 
     //  Returns a buffer to be filled with binary data.
@@ -30,25 +30,194 @@
 #include "precompiled.hpp"
 #include "decoder_allocators.hpp"
 
+#include "config.hpp"
 #include "msg.hpp"
+#include "page_allocator.hpp"
+
+zmq::decoder_buffer_pool_t::decoder_buffer_pool_t (int page_flags_) :
+    _page_flags (page_flags_),
+    _carved (0),
+    _region_pos (NULL),
+    _region_left (0),
+    _refs (1)
+{
+}
+
+zmq::decoder_buffer_pool_t::~decoder_buffer_pool_t ()
+{
+    release_idle ();
+    for (std::vector<void *>::size_type i = 0; i != _regions.size (); i++)
+        page_free (_regions[i], decoder_buffer_region_size);
+}
+
+void zmq::decoder_buffer_pool_t::close ()
+{
+    //  Buffers still in use are freed rather than cached once the
+    //  pool is gone.
+    release_idle ();
+    if (!_refs.sub (1))
+        delete this;
+}
+
+unsigned char *
+zmq::decoder_buffer_pool_t::allocate (decoder_buffer_pool_t *pool_,
+                                      std::size_t size_)
+{
+    bucket_t *bucket = pool_ ? pool_->find_bucket (size_) : NULL;
+    if (pool_ && !bucket) {
+        pool_->_misses.add (1);
+        pool_ = NULL;
+    }
+
+    buffer_t *buffer = NULL;
+    if (pool_) {
+        pool_->_refs.add (1);
+        buffer = take (*bucket);
+        if (buffer) {
+            pool_->_hits.add (1);
+            return reinterpret_cast<unsigned char *> (buffer + 1);
+        }
+        pool_->_misses.add (1);
+        buffer = pool_->carve (*bucket);
+        if (buffer)
+            return reinterpret_cast<unsigned char *> (buffer + 1);
+    }
+
+    buffer = static_cast<buffer_t *> (std::malloc (sizeof (buffer_t) + size_));
+    alloc_assert (buffer);
+    buffer->pool = pool_;
+    buffer->bucket = bucket;
+    buffer->carved = false;
+    return reinterpret_cast<unsigned char *> (buffer + 1);
+}
+
+void zmq::decoder_buffer_pool_t::release (unsigned char *buf_)
+{
+    buffer_t *const buffer = reinterpret_cast<buffer_t *> (buf_) - 1;
+    decoder_buffer_pool_t *const pool = buffer->pool;
+    if (!pool) {
+        std::free (buffer);
+        return;
+    }
+
+    //  Carved buffers count towards the bound but cannot be freed.
+    bucket_t &bucket = *buffer->bucket;
+    if (bucket.idle.add (1) < decoder_buffer_pool_size || buffer->carved) {
+        buffer_t *top;
+        do {
+            top = bucket.returned.load ();
+            buffer->next = top;
+        } while (bucket.returned.cas (top, buffer) != top);
+    } else {
+        bucket.idle.sub (1);
+        std::free (buffer);
+    }
+
+    if (!pool->_refs.sub (1))
+        delete pool;
+}
+
+zmq::decoder_buffer_pool_t::bucket_t *
+zmq::decoder_buffer_pool_t::find_bucket (std::size_t size_)
+{
+    //  Only the owner assigns sizes to buckets, so no synchronisation is
+    //  needed. Buckets are never given up, which bounds the pooled memory.
+    for (int i = 0; i != decoder_buffer_pool_sizes; i++) {
+        if (!_buckets[i].size)
+            _buckets[i].size = size_;
+        if (_buckets[i].size == size_)
+            return &_buckets[i];
+    }
+    return NULL;
+}
+
+zmq::decoder_buffer_pool_t::buffer_t *
+zmq::decoder_buffer_pool_t::take (bucket_t &bucket_)
+{
+    if (!bucket_.cached)
+        bucket_.cached = bucket_.returned.xchg (NULL);
+    buffer_t *const buffer = bucket_.cached;
+    if (buffer) {
+        bucket_.cached = buffer->next;
+        bucket_.idle.sub (1);
+    }
+    return buffer;
+}
+
+zmq::decoder_buffer_pool_t::buffer_t *
+zmq::decoder_buffer_pool_t::carve (bucket_t &bucket_)
+{
+    //  Carved buffers cannot be freed, so only as many are carved as one
+    //  size keeps idle; beyond that the heap is used.
+    if (!_page_flags || _carved == decoder_buffer_pool_size)
+        return NULL;
+
+    //  Keep buffers cache line aligned so that neighbours do not share one.
+    const std::size_t needed =
+      (sizeof (buffer_t) + bucket_.size + ZMQ_CACHELINE_SIZE - 1)
+      & ~static_cast<std::size_t> (ZMQ_CACHELINE_SIZE - 1);
+    if (needed > decoder_buffer_region_size)
+        return NULL;
+
+    if (needed > _region_left) {
+        void *const region = page_alloc (decoder_buffer_region_size, _page_flags);
+        if (!region)
+            return NULL;
+        _regions.push_back (region);
+        _region_pos = static_cast<unsigned char *> (region);
+        _region_left = decoder_buffer_region_size;
+    }
+
+    buffer_t *const buffer = reinterpret_cast<buffer_t *> (_region_pos);
+    _region_pos += needed;
+    _region_left -= needed;
+    buffer->pool = this;
+    buffer->bucket = &bucket_;
+    buffer->carved = true;
+    _carved++;
+    return buffer;
+}
+
+void zmq::decoder_buffer_pool_t::release_idle ()
+{
+    for (int i = 0; i != decoder_buffer_pool_sizes; i++) {
+        release_list (_buckets[i].cached);
+        _buckets[i].cached = NULL;
+        release_list (_buckets[i].returned.xchg (NULL));
+    }
+}
+
+void zmq::decoder_buffer_pool_t::release_list (buffer_t *buffer_)
+{
+    while (buffer_) {
+        buffer_t *const next = buffer_->next;
+        if (!buffer_->carved)
+            std::free (buffer_);
+        buffer_ = next;
+    }
+}
 
 zmq::shared_message_memory_allocator::shared_message_memory_allocator (
-  std::size_t bufsize_) :
+  std::size_t bufsize_, decoder_buffer_pool_t *pool_) :
     _buf (NULL),
     _buf_size (0),
     _max_size (bufsize_),
     _msg_content (NULL),
-    _max_counters ((_max_size + msg_t::max_vsm_size - 1) / msg_t::max_vsm_size)
+    _max_counters ((_max_size + msg_t::max_vsm_size - 1) / msg_t::max_vsm_size),
+    _pool (pool_)
 {
 }
 
 zmq::shared_message_memory_allocator::shared_message_memory_allocator (
-  std::size_t bufsize_, std::size_t max_messages_) :
+  std::size_t bufsize_,
+  std::size_t max_messages_,
+  decoder_buffer_pool_t *pool_) :
     _buf (NULL),
     _buf_size (0),
     _max_size (bufsize_),
     _msg_content (NULL),
-    _max_counters (max_messages_)
+    _max_counters (max_messages_),
+    _pool (pool_)
 {
 }
 
@@ -81,8 +250,7 @@ unsigned char *zmq::shared_message_memory_allocator::allocate ()
           _max_size + sizeof (zmq::atomic_counter_t)
           + _max_counters * sizeof (zmq::msg_t::content_t);
 
-        _buf = static_cast<unsigned char *> (std::malloc (allocationsize));
-        alloc_assert (_buf);
+        _buf = decoder_buffer_pool_t::allocate (_pool, allocationsize);
 
         new (_buf) atomic_counter_t (1);
     } else {
@@ -103,7 +271,7 @@ void zmq::shared_message_memory_allocator::deallocate ()
     zmq::atomic_counter_t *c = reinterpret_cast<zmq::atomic_counter_t *> (_buf);
     if (_buf && !c->sub (1)) {
         c->~atomic_counter_t ();
-        std::free (_buf);
+        decoder_buffer_pool_t::release (_buf);
     }
     clear ();
 }
@@ -135,7 +303,7 @@ void zmq::shared_message_memory_allocator::call_dec_ref (void *, void *hint_)
 
     if (!c->sub (1)) {
         c->~atomic_counter_t ();
-        std::free (buf);
+        decoder_buffer_pool_t::release (buf);
         buf = NULL;
     }
 }
@@ -32,13 +32,117 @@
 
 #include <cstddef>
 #include <cstdlib>
+#include <vector>
 
 #include "atomic_counter.hpp"
+#include "atomic_ptr.hpp"
 #include "msg.hpp"
 #include "err.hpp"
+#include "config.hpp"
 
 namespace zmq
 {
+//  Recycles the buffers of shared_message_memory_allocator. Each I/O thread
+//  owns a pool; buffers can be released to it from any thread, e.g. when the
+//  application closes the last message referencing a buffer, and they are
+//  reused by the I/O thread's decoders. Buffers are pooled by size, for the
+//  first decoder_buffer_pool_sizes sizes allocated; further sizes come from
+//  the heap and are freed on release. The number of idle buffers kept is
+//  bounded by decoder_buffer_pool_size per size.
+//
+//  If page flags are given, up to decoder_buffer_pool_size buffers in total
+//  are instead carved by the owner from regions of
+//  decoder_buffer_region_size bytes placed accordingly. Such buffers are
+//  always kept for reuse and the regions are unmapped with the pool.
+class decoder_buffer_pool_t
+{
+  public:
+    explicit decoder_buffer_pool_t (int page_flags_ = 0);
+
+    //  Called by the owner instead of deleting the pool. The pool is
+    //  deallocated once the last buffer allocated from it is released.
+    void close ();
+
+    //  Allocates a buffer of size_ bytes. If pool_ is not NULL, the buffer
+    //  is taken from and later released to that pool; this must be called
+    //  from the thread owning the pool.
+    static unsigned char *allocate (decoder_buffer_pool_t *pool_,
+                                    std::size_t size_);
+
+    //  Releases a buffer returned by allocate. Safe to call from any thread.
+    static void release (unsigned char *buf_);
+
+    //  Number of allocations served from the pool and from the heap.
+    uint32_t hits () const { return _hits.get (); }
+    uint32_t misses () const { return _misses.get (); }
+
+  private:
+    struct buffer_t;
+
+    //  The buffers of one size.
+    struct bucket_t
+    {
+        bucket_t () : size (0), cached (NULL) {}
+
+        //  Size of the buffers, or zero if the bucket is not used yet.
+        std::size_t size;
+
+        //  Idle buffers taken over by the owner.
+        buffer_t *cached;
+
+        //  Idle buffers released by any thread.
+        atomic_ptr_t<buffer_t> returned;
+
+        //  Number of idle buffers, whether cached or returned.
+        atomic_counter_t idle;
+    };
+
+    struct buffer_t
+    {
+        decoder_buffer_pool_t *pool;
+        bucket_t *bucket;
+        buffer_t *next;
+        bool carved;
+    };
+
+    ~decoder_buffer_pool_t ();
+
+    //  Returns the bucket for buffers of size_ bytes, or NULL if all the
+    //  buckets hold other sizes.
+    bucket_t *find_bucket (std::size_t size_);
+
+    //  Takes an idle buffer, or returns NULL.
+    static buffer_t *take (bucket_t &bucket_);
+
+    //  Carves a new buffer from the regions, or returns NULL.
+    buffer_t *carve (bucket_t &bucket_);
+
+    //  Releases the idle buffers of all buckets.
+    void release_idle ();
+
+    static void release_list (buffer_t *buffer_);
+
+    const int _page_flags;
+
+    bucket_t _buckets[decoder_buffer_pool_sizes];
+
+    //  Number of buffers carved so far.
+    int _carved;
+
+    //  Regions buffers are carved from, and the unused part of the last one.
+    std::vector<void *> _regions;
+    unsigned char *_region_pos;
+    std::size_t _region_left;
+
+    //  One reference held by the owner and one per buffer in use.
+    atomic_counter_t _refs;
+
+    atomic_counter_t _hits;
+    atomic_counter_t _misses;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (decoder_buffer_pool_t)
+};
+
 // Static buffer policy.
 class c_single_allocator
 {
@@ -80,11 +184,13 @@ class c_single_allocator
 class shared_message_memory_allocator
 {
   public:
-    explicit shared_message_memory_allocator (std::size_t bufsize_);
+    explicit shared_message_memory_allocator (
+      std::size_t bufsize_, decoder_buffer_pool_t *pool_ = NULL);
 
     // Create an allocator for a maximum number of messages
     shared_message_memory_allocator (std::size_t bufsize_,
-                                     std::size_t max_messages_);
+                                     std::size_t max_messages_,
+                                     decoder_buffer_pool_t *pool_ = NULL);
 
     ~shared_message_memory_allocator ();
 
@@ -127,6 +233,7 @@ class shared_message_memory_allocator
     const std::size_t _max_size;
     zmq::msg_t::content_t *_msg_content;
     std::size_t _max_counters;
+    decoder_buffer_pool_t *const _pool;
 };
 }
 
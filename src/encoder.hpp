@@ -126,6 +126,30 @@ template <typename T> class encoder_base_t : public i_encoder
         return pos;
     }
 
+    size_t encode_chunk (unsigned char **data_) ZMQ_FINAL
+    {
+        if (in_progress () == NULL)
+            return 0;
+
+        while (!_to_write) {
+            if (_new_msg_flag) {
+                int rc = _in_progress->close ();
+                errno_assert (rc == 0);
+                rc = _in_progress->init ();
+                errno_assert (rc == 0);
+                _in_progress = NULL;
+                return 0;
+            }
+            (static_cast<T *> (this)->*_next) ();
+        }
+
+        const size_t size = _to_write;
+        *data_ = _write_pos;
+        _write_pos += size;
+        _to_write = 0;
+        return size;
+    }
+
     void load_msg (msg_t *msg_) ZMQ_FINAL
     {
         zmq_assert (in_progress () == NULL);
@@ -44,6 +44,7 @@
 #include "macros.hpp"
 #include "err.hpp"
 #include "config.hpp"
+#include "clock.hpp"
 #include "i_poll_events.hpp"
 
 #ifdef ZMQ_HAVE_WINDOWS
@@ -52,7 +53,7 @@ const zmq::epoll_t::epoll_fd_t zmq::epoll_t::epoll_retired_fd =
 #endif
 
 zmq::epoll_t::epoll_t (const zmq::thread_ctx_t &ctx_) :
-    worker_poller_base_t (ctx_)
+    worker_poller_base_t (ctx_), _spin (ctx_.io_thread_spin ())
 {
 #ifdef ZMQ_IOTHREAD_POLLER_USE_EPOLL_CLOEXEC
     //  Setting this option result in sane behaviour when exec() functions
@@ -180,13 +181,31 @@ void zmq::epoll_t::loop ()
             continue;
         }
 
-        //  Wait for events.
-        const int n = epoll_wait (_epoll_fd, &ev_buf[0], max_io_events,
-                                  timeout ? timeout : -1);
+        //  Wait for events. If configured, poll without blocking for a while
+        //  first, so that events arriving soon are handled without the
+        //  latency of putting the thread to sleep and waking it up.
+        int n = 0;
+        int wait_timeout = timeout ? timeout : -1;
+        if (_spin > 0) {
+            const uint64_t spin =
+              timeout ? std::min (static_cast<uint64_t> (_spin),
+                                  static_cast<uint64_t> (timeout) * 1000)
+                      : _spin;
+            const uint64_t spin_end = clock_t::now_ns () + spin * 1000;
+            do {
+                n = epoll_wait (_epoll_fd, &ev_buf[0], max_io_events, 0);
+            } while (n == 0 && clock_t::now_ns () < spin_end);
+            if (timeout)
+                wait_timeout = timeout - static_cast<int> (spin / 1000);
+        }
+        if (n == 0 && wait_timeout != 0)
+            n = epoll_wait (_epoll_fd, &ev_buf[0], max_io_events,
+                            wait_timeout);
         if (n == -1) {
             errno_assert (errno == EINTR);
             continue;
         }
+        update_clock ();
 
         for (int i = 0; i < n; i++) {
             const poll_entry_t *const pe =
@@ -103,6 +103,9 @@ class epoll_t ZMQ_FINAL : public worker_poller_base_t
     typedef std::vector<poll_entry_t *> retired_t;
     retired_t _retired;
 
+    //  Microseconds to poll without blocking before waiting for events.
+    const int _spin;
+
     ZMQ_NON_COPYABLE_NOR_MOVABLE (epoll_t)
 };
 
@@ -50,6 +50,12 @@ struct i_encoder
     //  Function returns 0 when a new message is required.
     virtual size_t encode (unsigned char **data_, size_t size_) = 0;
 
+    //  Returns the next piece of encoded data in data_ without copying it.
+    //  Message bodies point into the message, other pieces into the
+    //  encoder, and are valid until the encoder is called again.
+    //  Function returns 0 when a new message is required.
+    virtual size_t encode_chunk (unsigned char **data_) = 0;
+
     //  Load a new message into encoder.
     virtual void load_msg (msg_t *msg_) = 0;
 };
@@ -36,6 +36,7 @@
 namespace zmq
 {
 class io_thread_t;
+class crypto_job_t;
 
 //  Abstract interface to be implemented by various engines.
 
@@ -75,6 +76,10 @@ struct i_engine
 
     virtual void zap_msg_available () = 0;
 
+    //  Called by the session when a job the engine's mechanism offloaded
+    //  to the crypto pool has run. The session deletes the job afterwards.
+    virtual void crypto_job_done (zmq::crypto_job_t *job_) = 0;
+
     virtual const endpoint_uri_pair_t &get_endpoint () const = 0;
 };
 }
@@ -45,6 +45,10 @@ class i_mailbox
     virtual void send (const command_t &cmd_) = 0;
     virtual int recv (command_t *cmd_, int timeout_) = 0;
 
+    //  Check whether commands are waiting, without blocking or taking any
+    //  lock. Only a hint: a command may arrive right after it returned.
+    virtual bool check_read () = 0;
+
 
 #ifdef HAVE_FORK
     // close the file descriptors in the signaller. This is used in a forked
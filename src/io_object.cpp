@@ -58,6 +58,7 @@ void zmq::io_object_t::unplug ()
     //  Forget about old poller in preparation to be migrated
     //  to a different I/O thread.
     _poller = NULL;
+    _timers.clear ();
 }
 
 zmq::io_object_t::handle_t zmq::io_object_t::add_fd (fd_t fd_)
@@ -92,12 +93,29 @@ void zmq::io_object_t::reset_pollout (handle_t handle_)
 
 void zmq::io_object_t::add_timer (int timeout_, int id_)
 {
-    _poller->add_timer (timeout_, this, id_);
+    const timer_entry_t timer = {id_,
+                                 _poller->add_timer (timeout_, this, id_)};
+    for (std::vector<timer_entry_t>::iterator it = _timers.begin (),
+                                              end = _timers.end ();
+         it != end; ++it)
+        if (!_poller->timer_pending (it->handle)) {
+            *it = timer;
+            return;
+        }
+    _timers.push_back (timer);
 }
 
 void zmq::io_object_t::cancel_timer (int id_)
 {
-    _poller->cancel_timer (this, id_);
+    for (std::vector<timer_entry_t>::iterator it = _timers.begin (),
+                                              end = _timers.end ();
+         it != end; ++it)
+        if (it->id == id_ && _poller->timer_pending (it->handle)) {
+            _poller->cancel_timer (it->handle);
+            *it = _timers.back ();
+            _timers.pop_back ();
+            return;
+        }
 }
 
 void zmq::io_object_t::in_event ()
@@ -31,6 +31,7 @@
 #define __ZMQ_IO_OBJECT_HPP_INCLUDED__
 
 #include <stddef.h>
+#include <vector>
 
 #include "stdint.hpp"
 #include "poller.hpp"
@@ -76,6 +77,15 @@ class io_object_t : public i_poll_events
   private:
     poller_t *_poller;
 
+    //  Timers of this object, to cancel them by ID. Entries of timers that
+    //  expired are reused.
+    struct timer_entry_t
+    {
+        int id;
+        poller_t::timer_handle_t handle;
+    };
+    std::vector<timer_entry_t> _timers;
+
     ZMQ_NON_COPYABLE_NOR_MOVABLE (io_object_t)
 };
 }
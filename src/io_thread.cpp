@@ -35,14 +35,25 @@
 #include "io_thread.hpp"
 #include "err.hpp"
 #include "ctx.hpp"
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+#include "zerocopy_drainer.hpp"
+#endif
 
 zmq::io_thread_t::io_thread_t (ctx_t *ctx_, uint32_t tid_) :
     object_t (ctx_, tid_),
     _mailbox_handle (static_cast<poller_t::handle_t> (NULL))
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+    ,
+    _stopping (false)
+#endif
 {
     _poller = new (std::nothrow) poller_t (*ctx_);
     alloc_assert (_poller);
 
+    _decoder_buffer_pool = new (std::nothrow)
+      decoder_buffer_pool_t (ctx_->io_thread_page_flags ());
+    alloc_assert (_decoder_buffer_pool);
+
     if (_mailbox.get_fd () != retired_fd) {
         _mailbox_handle = _poller->add_fd (_mailbox.get_fd (), this);
         _poller->set_pollin (_mailbox_handle);
@@ -52,6 +63,9 @@ zmq::io_thread_t::io_thread_t (ctx_t *ctx_, uint32_t tid_) :
 zmq::io_thread_t::~io_thread_t ()
 {
     LIBZMQ_DELETE (_poller);
+
+    //  Messages received by this thread may still reference its buffers.
+    _decoder_buffer_pool->close ();
 }
 
 void zmq::io_thread_t::start ()
@@ -78,6 +92,25 @@ int zmq::io_thread_t::get_load () const
     return _poller->get_load ();
 }
 
+zmq::decoder_buffer_pool_t *zmq::io_thread_t::get_decoder_buffer_pool () const
+{
+    return _decoder_buffer_pool;
+}
+
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+void zmq::io_thread_t::add_zerocopy_drainer (zerocopy_drainer_t *drainer_)
+{
+    _zerocopy_drainers.insert (drainer_);
+    if (_stopping)
+        drainer_->stop ();
+}
+
+void zmq::io_thread_t::rm_zerocopy_drainer (zerocopy_drainer_t *drainer_)
+{
+    _zerocopy_drainers.erase (drainer_);
+}
+#endif
+
 void zmq::io_thread_t::in_event ()
 {
     //  TODO: Do we want to limit number of commands I/O thread can
@@ -117,5 +150,16 @@ void zmq::io_thread_t::process_stop ()
 {
     zmq_assert (_mailbox_handle);
     _poller->rm_fd (_mailbox_handle);
+
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+    //  The poller keeps running while drainers are left, which must not
+    //  wait for their sends indefinitely.
+    _stopping = true;
+    for (zerocopy_drainers_t::iterator it = _zerocopy_drainers.begin (),
+                                       end = _zerocopy_drainers.end ();
+         it != end; ++it)
+        (*it)->stop ();
+#endif
+
     _poller->stop ();
 }
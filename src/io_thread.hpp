@@ -35,10 +35,18 @@
 #include "poller.hpp"
 #include "i_poll_events.hpp"
 #include "mailbox.hpp"
+#include "decoder_allocators.hpp"
+
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+#include <set>
+#endif
 
 namespace zmq
 {
 class ctx_t;
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+class zerocopy_drainer_t;
+#endif
 
 //  Generic part of the I/O thread. Polling-mechanism-specific features
 //  are implemented in separate "polling objects".
@@ -75,6 +83,16 @@ class io_thread_t ZMQ_FINAL : public object_t, public i_poll_events
     //  Returns load experienced by the I/O thread.
     int get_load () const;
 
+    //  Returns the pool recycling buffers of decoders in this thread.
+    decoder_buffer_pool_t *get_decoder_buffer_pool () const;
+
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+    //  Drainers of closed connections register here, so that they are
+    //  stopped along with the thread instead of keeping it alive.
+    void add_zerocopy_drainer (zerocopy_drainer_t *drainer_);
+    void rm_zerocopy_drainer (zerocopy_drainer_t *drainer_);
+#endif
+
   private:
     //  I/O thread accesses incoming commands via this mailbox.
     mailbox_t _mailbox;
@@ -85,6 +103,17 @@ class io_thread_t ZMQ_FINAL : public object_t, public i_poll_events
     //  I/O multiplexing is performed using a poller object.
     poller_t *_poller;
 
+    //  Recycles decoder buffers released by the application threads.
+    decoder_buffer_pool_t *_decoder_buffer_pool;
+
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+    typedef std::set<zerocopy_drainer_t *> zerocopy_drainers_t;
+    zerocopy_drainers_t _zerocopy_drainers;
+
+    //  True once the thread was asked to stop.
+    bool _stopping;
+#endif
+
     ZMQ_NON_COPYABLE_NOR_MOVABLE (io_thread_t)
 };
 }
@@ -0,0 +1,530 @@
+/*
+    Copyright (c) 2007-2016 Contributors as noted in the AUTHORS file
+
+    This file is part of libzmq, the ZeroMQ core engine in C++.
+
+    libzmq is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License (LGPL) as published
+    by the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    As a special exception, the Contributors give you permission to link
+    this library with independent modules to produce an executable,
+    regardless of the license terms of these independent modules, and to
+    copy and distribute the resulting executable under terms of your choice,
+    provided that you also meet, for each linked independent module, the
+    terms and conditions of the license of that module. An independent
+    module is a module which is not derived from or based on this library.
+    If you modify this library, you must extend this exception to your
+    version of the library.
+
+    libzmq is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "precompiled.hpp"
+#if defined ZMQ_IOTHREAD_POLLER_USE_IO_URING
+#include "io_uring.hpp"
+
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <poll.h>
+#include <endian.h>
+#if __BYTE_ORDER == __BIG_ENDIAN
+#include <linux/swab.h>
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <new>
+
+#include "macros.hpp"
+#include "err.hpp"
+#include "config.hpp"
+#include "i_poll_events.hpp"
+
+//  Tag set on the user data of POLL_REMOVE requests so that their
+//  completions can be told apart from those of the POLL_ADD requests.
+//  Entries are allocated with new, hence the lowest bit is always clear.
+static const uint64_t cancel_tag = 1;
+
+zmq::io_uring_t::io_uring_t (const zmq::thread_ctx_t &ctx_) :
+    worker_poller_base_t (ctx_),
+    _ring_fd (retired_fd),
+    _rings (MAP_FAILED),
+    _rings_size (0),
+    _sqes (static_cast<io_uring_sqe *> (MAP_FAILED)),
+    _sqes_size (0),
+    _sq_head (NULL),
+    _sq_tail (NULL),
+    _sq_array (NULL),
+    _sq_mask (0),
+    _sq_entries (0),
+    _sq_tail_local (0),
+    _cq_head (NULL),
+    _cq_tail (NULL),
+    _cq_mask (0),
+    _cqes (NULL),
+    _epoll_fd (retired_fd)
+{
+    if (ctx_.io_uring_enabled () && setup_ring ())
+        return;
+
+    _epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+    errno_assert (_epoll_fd != retired_fd);
+}
+
+zmq::io_uring_t::~io_uring_t ()
+{
+    //  Wait till the worker thread exits.
+    stop_worker ();
+
+    //  Closing the ring cancels any requests still in flight.
+    if (_ring_fd != retired_fd) {
+        if (_sqes != MAP_FAILED)
+            munmap (_sqes, _sqes_size);
+        if (_rings != MAP_FAILED)
+            munmap (_rings, _rings_size);
+        close (_ring_fd);
+    }
+    if (_epoll_fd != retired_fd)
+        close (_epoll_fd);
+
+    for (retired_t::iterator it = _retired.begin (), end = _retired.end ();
+         it != end; ++it) {
+        LIBZMQ_DELETE (*it);
+    }
+}
+
+bool zmq::io_uring_t::setup_ring ()
+{
+    io_uring_params params;
+    memset (&params, 0, sizeof params);
+
+    //  Every fd has at most one poll and one cancellation in flight, so
+    //  give the completion queue room to spare. Overflowing completions
+    //  are not lost (IORING_FEAT_NODROP), just slower to deliver.
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = max_io_events * 16;
+
+    const long fd = syscall (__NR_io_uring_setup,
+                             static_cast<unsigned> (max_io_events), &params);
+    if (fd < 0)
+        return false;
+    _ring_fd = static_cast<fd_t> (fd);
+
+    //  Timed waits need IORING_ENTER_EXT_ARG (Linux 5.11), which implies
+    //  the single mapping of both rings and no dropping of completions.
+    const unsigned required_features =
+      IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+    if ((params.features & required_features) != required_features) {
+        close (_ring_fd);
+        _ring_fd = retired_fd;
+        return false;
+    }
+
+    _rings_size =
+      std::max (params.sq_off.array + params.sq_entries * sizeof (unsigned),
+                params.cq_off.cqes + params.cq_entries * sizeof (io_uring_cqe));
+    _rings = mmap (NULL, _rings_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_SQ_RING);
+    errno_assert (_rings != MAP_FAILED);
+
+    _sqes_size = params.sq_entries * sizeof (io_uring_sqe);
+    _sqes = static_cast<io_uring_sqe *> (
+      mmap (NULL, _sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+            _ring_fd, IORING_OFF_SQES));
+    errno_assert (_sqes != MAP_FAILED);
+
+    unsigned char *const rings = static_cast<unsigned char *> (_rings);
+    _sq_head = reinterpret_cast<unsigned *> (rings + params.sq_off.head);
+    _sq_tail = reinterpret_cast<unsigned *> (rings + params.sq_off.tail);
+    _sq_array = reinterpret_cast<unsigned *> (rings + params.sq_off.array);
+    _sq_mask = *reinterpret_cast<unsigned *> (rings + params.sq_off.ring_mask);
+    _sq_entries = params.sq_entries;
+    _sq_tail_local = *_sq_tail;
+
+    _cq_head = reinterpret_cast<unsigned *> (rings + params.cq_off.head);
+    _cq_tail = reinterpret_cast<unsigned *> (rings + params.cq_off.tail);
+    _cq_mask = *reinterpret_cast<unsigned *> (rings + params.cq_off.ring_mask);
+    _cqes = reinterpret_cast<io_uring_cqe *> (rings + params.cq_off.cqes);
+
+    return true;
+}
+
+zmq::io_uring_t::handle_t zmq::io_uring_t::add_fd (fd_t fd_,
+                                                    i_poll_events *events_)
+{
+    check_thread ();
+    poll_entry_t *pe = new (std::nothrow) poll_entry_t;
+    alloc_assert (pe);
+
+    pe->fd = fd_;
+    pe->events_wanted = 0;
+    pe->events_armed = 0;
+    pe->cancelling = false;
+    pe->pending = false;
+    pe->events = events_;
+
+    if (_ring_fd == retired_fd) {
+        epoll_event ev;
+        memset (&ev, 0, sizeof ev);
+        ev.data.ptr = pe;
+        const int rc = epoll_ctl (_epoll_fd, EPOLL_CTL_ADD, fd_, &ev);
+        errno_assert (rc != -1);
+    }
+
+    //  Increase the load metric of the thread.
+    adjust_load (1);
+
+    return pe;
+}
+
+void zmq::io_uring_t::rm_fd (handle_t handle_)
+{
+    check_thread ();
+    poll_entry_t *pe = static_cast<poll_entry_t *> (handle_);
+
+    if (_ring_fd == retired_fd) {
+        epoll_event ev;
+        memset (&ev, 0, sizeof ev);
+        const int rc = epoll_ctl (_epoll_fd, EPOLL_CTL_DEL, pe->fd, &ev);
+        errno_assert (rc != -1);
+    } else if (pe->events_armed && !pe->cancelling) {
+        //  The entry must stay alive until the kernel reports the
+        //  cancelled request as complete. The cancellation is issued
+        //  with the other pending updates.
+        schedule (pe);
+    }
+    pe->fd = retired_fd;
+    _retired.push_back (pe);
+
+    //  Decrease the load metric of the thread.
+    adjust_load (-1);
+}
+
+void zmq::io_uring_t::set_pollin (handle_t handle_)
+{
+    check_thread ();
+    poll_entry_t *pe = static_cast<poll_entry_t *> (handle_);
+    update (pe, pe->events_wanted | POLLIN);
+}
+
+void zmq::io_uring_t::reset_pollin (handle_t handle_)
+{
+    check_thread ();
+    poll_entry_t *pe = static_cast<poll_entry_t *> (handle_);
+    update (pe, pe->events_wanted & ~static_cast<uint32_t> (POLLIN));
+}
+
+void zmq::io_uring_t::set_pollout (handle_t handle_)
+{
+    check_thread ();
+    poll_entry_t *pe = static_cast<poll_entry_t *> (handle_);
+    update (pe, pe->events_wanted | POLLOUT);
+}
+
+void zmq::io_uring_t::reset_pollout (handle_t handle_)
+{
+    check_thread ();
+    poll_entry_t *pe = static_cast<poll_entry_t *> (handle_);
+    update (pe, pe->events_wanted & ~static_cast<uint32_t> (POLLOUT));
+}
+
+void zmq::io_uring_t::stop ()
+{
+    check_thread ();
+}
+
+int zmq::io_uring_t::max_fds ()
+{
+    return -1;
+}
+
+void zmq::io_uring_t::update (poll_entry_t *pe_, uint32_t events_)
+{
+    if (pe_->events_wanted == events_)
+        return;
+    pe_->events_wanted = events_;
+
+    if (_ring_fd == retired_fd) {
+        epoll_event ev;
+        memset (&ev, 0, sizeof ev);
+        ev.events = (events_ & POLLIN ? EPOLLIN : 0)
+                    | (events_ & POLLOUT ? EPOLLOUT : 0);
+        ev.data.ptr = pe_;
+        const int rc = epoll_ctl (_epoll_fd, EPOLL_CTL_MOD, pe_->fd, &ev);
+        errno_assert (rc != -1);
+        return;
+    }
+
+    //  The registration is brought up to date just before the next wait,
+    //  so toggling events back and forth within a single iteration of the
+    //  event loop costs nothing.
+    schedule (pe_);
+}
+
+void zmq::io_uring_t::schedule (poll_entry_t *pe_)
+{
+    if (!pe_->pending) {
+        pe_->pending = true;
+        _pending.push_back (pe_);
+    }
+}
+
+void zmq::io_uring_t::flush_pending ()
+{
+    pending_t::iterator it = _pending.begin ();
+    for (const pending_t::iterator end = _pending.end (); it != end; ++it) {
+        poll_entry_t *const pe = *it;
+
+        if (pe->fd == retired_fd || pe->events_armed) {
+            //  A request for a superset of the wanted events is left in
+            //  flight; the events not wanted are filtered on completion.
+            //  Otherwise the request is cancelled and its completion
+            //  re-queues the entry. Retired entries only need their
+            //  request cancelled.
+            if (!pe->events_armed || pe->cancelling
+                || (pe->fd != retired_fd
+                    && (pe->events_wanted & ~pe->events_armed) == 0)) {
+                pe->pending = false;
+                continue;
+            }
+            io_uring_sqe *sqe = get_sqe ();
+            if (!sqe)
+                break;
+            pe->pending = false;
+            sqe->opcode = IORING_OP_POLL_REMOVE;
+            sqe->fd = -1;
+            sqe->addr = reinterpret_cast<uintptr_t> (pe);
+            sqe->user_data = reinterpret_cast<uintptr_t> (pe) | cancel_tag;
+            pe->cancelling = true;
+            continue;
+        }
+
+        if (!pe->events_wanted) {
+            pe->pending = false;
+            continue;
+        }
+        io_uring_sqe *sqe = get_sqe ();
+        if (!sqe)
+            break;
+        pe->pending = false;
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = pe->fd;
+#if __BYTE_ORDER == __BIG_ENDIAN
+        sqe->poll32_events = __swahw32 (pe->events_wanted);
+#else
+        sqe->poll32_events = pe->events_wanted;
+#endif
+        sqe->user_data = reinterpret_cast<uintptr_t> (pe);
+        pe->events_armed = pe->events_wanted;
+    }
+
+    //  Updates that did not fit into the ring stay queued for the next
+    //  iteration of the event loop.
+    _pending.erase (_pending.begin (), it);
+}
+
+io_uring_sqe *zmq::io_uring_t::get_sqe ()
+{
+    while (_sq_tail_local - __atomic_load_n (_sq_head, __ATOMIC_ACQUIRE)
+           == _sq_entries) {
+        //  The kernel refuses new submissions with EBUSY or EAGAIN until
+        //  the completions it holds are reaped, which only happens in
+        //  wait. Any error is reported again by the submission there.
+        const int rc = enter (false, -1);
+        if (rc == -1 && errno != EINTR)
+            return NULL;
+    }
+
+    const unsigned index = _sq_tail_local & _sq_mask;
+    io_uring_sqe *sqe = &_sqes[index];
+    memset (sqe, 0, sizeof (io_uring_sqe));
+    _sq_array[index] = index;
+    _sq_tail_local++;
+    return sqe;
+}
+
+int zmq::io_uring_t::enter (bool wait_, int timeout_)
+{
+    //  Publish the queued entries to the kernel.
+    __atomic_store_n (_sq_tail, _sq_tail_local, __ATOMIC_RELEASE);
+    const unsigned to_submit =
+      _sq_tail_local - __atomic_load_n (_sq_head, __ATOMIC_ACQUIRE);
+
+    __kernel_timespec ts;
+    io_uring_getevents_arg arg;
+    memset (&arg, 0, sizeof arg);
+    if (wait_ && timeout_ > 0) {
+        ts.tv_sec = timeout_ / 1000;
+        ts.tv_nsec = (timeout_ % 1000) * 1000000;
+        arg.ts = reinterpret_cast<uintptr_t> (&ts);
+    }
+
+    const long rc = syscall (
+      __NR_io_uring_enter, _ring_fd, to_submit, wait_ ? 1u : 0u,
+      IORING_ENTER_EXT_ARG | (wait_ ? IORING_ENTER_GETEVENTS : 0u), &arg,
+      sizeof arg);
+    return static_cast<int> (rc);
+}
+
+void zmq::io_uring_t::complete (uint64_t user_data_, int res_)
+{
+    //  Completions of cancellation requests carry no information; the
+    //  cancelled request completes on its own.
+    if (user_data_ & cancel_tag)
+        return;
+
+    poll_entry_t *const pe =
+      reinterpret_cast<poll_entry_t *> (static_cast<uintptr_t> (user_data_));
+    pe->events_armed = 0;
+    pe->cancelling = false;
+    if (pe->fd == retired_fd)
+        return;
+
+    //  The request is one-shot, so re-arm it with the current set of
+    //  wanted events, if any.
+    schedule (pe);
+    if (res_ < 0)
+        return;
+
+    const uint32_t revents = static_cast<uint32_t> (res_);
+    if (revents & (POLLERR | POLLHUP))
+        pe->events->in_event ();
+    if (pe->fd == retired_fd)
+        return;
+    if (revents & pe->events_wanted & POLLOUT)
+        pe->events->out_event ();
+    if (pe->fd == retired_fd)
+        return;
+    if (revents & pe->events_wanted & POLLIN)
+        pe->events->in_event ();
+}
+
+void zmq::io_uring_t::destroy_retired ()
+{
+    //  Entries with a request still in flight are kept until the
+    //  completion arrives.
+    retired_t::iterator keep = _retired.begin ();
+    for (retired_t::iterator it = _retired.begin (), end = _retired.end ();
+         it != end; ++it) {
+        if ((*it)->events_armed || (*it)->pending)
+            *keep++ = *it;
+        else
+            LIBZMQ_DELETE (*it);
+    }
+    _retired.erase (keep, _retired.end ());
+}
+
+void zmq::io_uring_t::loop ()
+{
+    if (_ring_fd == retired_fd) {
+        epoll_loop ();
+        return;
+    }
+
+    while (true) {
+        //  Execute any due timers.
+        const int timeout = static_cast<int> (execute_timers ());
+
+        //  Without event sources, the loop only runs to fire the remaining
+        //  timers. The wait below then sleeps until the next one is due.
+        if (get_load () == 0 && timeout == 0)
+            break;
+
+        //  Submit the registration changes and wait for events in a
+        //  single system call.
+        wait (timeout);
+
+        //  Destroy retired event sources.
+        destroy_retired ();
+    }
+
+    //  Requests still in flight hold references to the polled files, and
+    //  the kernel releases those asynchronously once the ring is closed.
+    //  Wait for the cancellations here, so that e.g. a listening socket is
+    //  really closed by the time the poller is gone.
+    flush_pending ();
+    destroy_retired ();
+    while (!_retired.empty ()) {
+        wait (0);
+        destroy_retired ();
+    }
+}
+
+void zmq::io_uring_t::wait (int timeout_)
+{
+    flush_pending ();
+    const int rc = enter (true, timeout_);
+    if (rc == -1)
+        errno_assert (errno == EINTR || errno == ETIME || errno == EBUSY
+                      || errno == EAGAIN);
+    update_clock ();
+
+    //  Reap the completions available in the ring.
+    unsigned head = *_cq_head;
+    const unsigned tail = __atomic_load_n (_cq_tail, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+        const io_uring_cqe *const cqe = &_cqes[head & _cq_mask];
+        const uint64_t user_data = cqe->user_data;
+        const int res = cqe->res;
+        __atomic_store_n (_cq_head, head + 1, __ATOMIC_RELEASE);
+        complete (user_data, res);
+    }
+}
+
+void zmq::io_uring_t::epoll_loop ()
+{
+    epoll_event ev_buf[max_io_events];
+
+    while (true) {
+        //  Execute any due timers.
+        const int timeout = static_cast<int> (execute_timers ());
+
+        //  Without event sources, epoll_wait just sleeps until the next
+        //  timer is due.
+        if (get_load () == 0 && timeout == 0)
+            break;
+
+        //  Wait for events.
+        const int n = epoll_wait (_epoll_fd, &ev_buf[0], max_io_events,
+                                  timeout ? timeout : -1);
+        if (n == -1) {
+            errno_assert (errno == EINTR);
+            continue;
+        }
+        update_clock ();
+
+        for (int i = 0; i < n; i++) {
+            const poll_entry_t *const pe =
+              static_cast<const poll_entry_t *> (ev_buf[i].data.ptr);
+
+            if (pe->fd == retired_fd)
+                continue;
+            if (ev_buf[i].events & (EPOLLERR | EPOLLHUP))
+                pe->events->in_event ();
+            if (pe->fd == retired_fd)
+                continue;
+            if (ev_buf[i].events & EPOLLOUT)
+                pe->events->out_event ();
+            if (pe->fd == retired_fd)
+                continue;
+            if (ev_buf[i].events & EPOLLIN)
+                pe->events->in_event ();
+        }
+
+        //  Destroy retired event sources.
+        destroy_retired ();
+    }
+}
+
+#endif
@@ -0,0 +1,185 @@
+/*
+    Copyright (c) 2007-2016 Contributors as noted in the AUTHORS file
+
+    This file is part of libzmq, the ZeroMQ core engine in C++.
+
+    libzmq is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License (LGPL) as published
+    by the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    As a special exception, the Contributors give you permission to link
+    this library with independent modules to produce an executable,
+    regardless of the license terms of these independent modules, and to
+    copy and distribute the resulting executable under terms of your choice,
+    provided that you also meet, for each linked independent module, the
+    terms and conditions of the license of that module. An independent
+    module is a module which is not derived from or based on this library.
+    If you modify this library, you must extend this exception to your
+    version of the library.
+
+    libzmq is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __ZMQ_IO_URING_HPP_INCLUDED__
+#define __ZMQ_IO_URING_HPP_INCLUDED__
+
+//  poller.hpp decides which polling mechanism to use.
+#include "poller.hpp"
+#if defined ZMQ_IOTHREAD_POLLER_USE_IO_URING
+
+#include <vector>
+
+#include <linux/io_uring.h>
+
+#include "ctx.hpp"
+#include "fd.hpp"
+#include "thread.hpp"
+#include "poller_base.hpp"
+
+namespace zmq
+{
+struct i_poll_events;
+
+//  This class implements socket polling mechanism using the Linux-specific
+//  io_uring interface. Readiness is requested by one-shot POLL_ADD requests
+//  that are queued in the submission ring and handed over to the kernel
+//  together with the wait for completions, so changing the set of polled
+//  events does not cost a system call of its own the way epoll_ctl does.
+//  Completions are reaped in batches straight from the shared ring.
+//
+//  Only the wait for readiness goes through the ring. Engines still read
+//  from and write to their sockets with ordinary system calls once they
+//  are notified.
+//
+//  If the kernel lacks the required io_uring features, or io_uring was
+//  disabled using the ZMQ_IO_URING context option, the poller falls back
+//  to epoll.
+
+class io_uring_t ZMQ_FINAL : public worker_poller_base_t
+{
+  public:
+    typedef void *handle_t;
+
+    io_uring_t (const thread_ctx_t &ctx_);
+    ~io_uring_t () ZMQ_OVERRIDE;
+
+    //  "poller" concept.
+    handle_t add_fd (fd_t fd_, zmq::i_poll_events *events_);
+    void rm_fd (handle_t handle_);
+    void set_pollin (handle_t handle_);
+    void reset_pollin (handle_t handle_);
+    void set_pollout (handle_t handle_);
+    void reset_pollout (handle_t handle_);
+    void stop ();
+
+    static int max_fds ();
+
+  private:
+    struct poll_entry_t
+    {
+        fd_t fd;
+
+        //  Events the owner of the fd is interested in (POLLIN/POLLOUT).
+        uint32_t events_wanted;
+
+        //  Events the in-flight POLL_ADD request was submitted for, or zero
+        //  if there is no request in flight.
+        uint32_t events_armed;
+
+        //  True if a POLL_REMOVE was issued for the in-flight request.
+        bool cancelling;
+
+        //  True if the entry is queued on the list of pending updates.
+        bool pending;
+
+        zmq::i_poll_events *events;
+    };
+
+    //  Main event loop.
+    void loop () ZMQ_OVERRIDE;
+    void epoll_loop ();
+
+    //  Sets up the rings. Returns false if io_uring is not usable.
+    bool setup_ring ();
+
+    //  Changes the set of events wanted for the entry.
+    void update (poll_entry_t *pe_, uint32_t events_);
+
+    //  Queues the entry for (re)submission at the next loop iteration.
+    void schedule (poll_entry_t *pe_);
+
+    //  Turns queued updates into submission queue entries.
+    void flush_pending ();
+
+    //  Returns a free submission queue entry, submitting the queued ones
+    //  to the kernel first if the ring is full. Returns NULL if the kernel
+    //  does not accept the submission at the moment.
+    io_uring_sqe *get_sqe ();
+
+    //  Submits queued entries and, if wait_ is true, waits for at least one
+    //  completion, or for timeout_ milliseconds if it is positive.
+    int enter (bool wait_, int timeout_);
+
+    //  Submits the queued requests, waits for completions for at most
+    //  timeout_ milliseconds (forever if zero) and dispatches them.
+    void wait (int timeout_);
+
+    //  Dispatches a single completion to the owning entry.
+    void complete (uint64_t user_data_, int res_);
+
+    //  Destroys retired entries the kernel no longer refers to.
+    void destroy_retired ();
+
+    //  io_uring file descriptor or retired_fd when using epoll.
+    fd_t _ring_fd;
+
+    //  The rings are shared with the kernel by a single mapping, with the
+    //  submission queue entries mapped separately.
+    void *_rings;
+    size_t _rings_size;
+    io_uring_sqe *_sqes;
+    size_t _sqes_size;
+
+    unsigned *_sq_head;
+    unsigned *_sq_tail;
+    unsigned *_sq_array;
+    unsigned _sq_mask;
+    unsigned _sq_entries;
+
+    //  Tail of the submission queue including the entries that were not
+    //  yet published to the kernel.
+    unsigned _sq_tail_local;
+
+    unsigned *_cq_head;
+    unsigned *_cq_tail;
+    unsigned _cq_mask;
+    io_uring_cqe *_cqes;
+
+    //  Fallback epoll file descriptor.
+    fd_t _epoll_fd;
+
+    //  Entries whose registration has to be updated.
+    typedef std::vector<poll_entry_t *> pending_t;
+    pending_t _pending;
+
+    //  List of retired event sources.
+    typedef std::vector<poll_entry_t *> retired_t;
+    retired_t _retired;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (io_uring_t)
+};
+
+typedef io_uring_t poller_t;
+}
+
+#endif
+
+#endif
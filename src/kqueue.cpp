@@ -200,6 +200,7 @@ void zmq::kqueue_t::loop ()
             errno_assert (errno == EINTR);
             continue;
         }
+        update_clock ();
 
         for (int i = 0; i < n; i++) {
             poll_entry_t *pe = (poll_entry_t *) ev_buf[i].udata;
@@ -0,0 +1,78 @@
+/*
+    Copyright (c) 2007-2016 Contributors as noted in the AUTHORS file
+
+    This file is part of libzmq, the ZeroMQ core engine in C++.
+
+    libzmq is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License (LGPL) as published
+    by the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    As a special exception, the Contributors give you permission to link
+    this library with independent modules to produce an executable,
+    regardless of the license terms of these independent modules, and to
+    copy and distribute the resulting executable under terms of your choice,
+    provided that you also meet, for each linked independent module, the
+    terms and conditions of the license of that module. An independent
+    module is a module which is not derived from or based on this library.
+    If you modify this library, you must extend this exception to your
+    version of the library.
+
+    libzmq is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "precompiled.hpp"
+#include "latency_histogram.hpp"
+
+#include <string.h>
+
+zmq::latency_histogram_t::latency_histogram_t () : _count (0), _max (0)
+{
+    memset (_counts, 0, sizeof _counts);
+}
+
+void zmq::latency_histogram_t::summarize (uint64_t *values_) const
+{
+    values_[0] = _count;
+    values_[1] = percentile (50000);
+    values_[2] = percentile (90000);
+    values_[3] = percentile (99000);
+    values_[4] = percentile (99900);
+    values_[5] = _max;
+}
+
+uint64_t zmq::latency_histogram_t::upper_bound (unsigned int index_)
+{
+    if (index_ < 2 * sub_buckets)
+        return index_;
+    const unsigned int shift = index_ / sub_buckets - 1;
+    const uint64_t lower = static_cast<uint64_t> (sub_buckets
+                                                  + index_ % sub_buckets)
+                           << shift;
+    return lower + ((static_cast<uint64_t> (1) << shift) - 1);
+}
+
+uint64_t zmq::latency_histogram_t::percentile (uint64_t millipercent_) const
+{
+    if (_count == 0)
+        return 0;
+
+    //  Rank of the latency sought, rounded up.
+    const uint64_t rank = (_count * millipercent_ + 99999) / 100000;
+    uint64_t seen = 0;
+    for (unsigned int i = 0; i != buckets; i++) {
+        seen += _counts[i];
+        if (seen >= rank) {
+            const uint64_t bound = upper_bound (i);
+            return bound < _max ? bound : _max;
+        }
+    }
+    return _max;
+}
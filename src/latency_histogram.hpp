@@ -0,0 +1,112 @@
+/*
+    Copyright (c) 2007-2016 Contributors as noted in the AUTHORS file
+
+    This file is part of libzmq, the ZeroMQ core engine in C++.
+
+    libzmq is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License (LGPL) as published
+    by the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    As a special exception, the Contributors give you permission to link
+    this library with independent modules to produce an executable,
+    regardless of the license terms of these independent modules, and to
+    copy and distribute the resulting executable under terms of your choice,
+    provided that you also meet, for each linked independent module, the
+    terms and conditions of the license of that module. An independent
+    module is a module which is not derived from or based on this library.
+    If you modify this library, you must extend this exception to your
+    version of the library.
+
+    libzmq is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __ZMQ_LATENCY_HISTOGRAM_HPP_INCLUDED__
+#define __ZMQ_LATENCY_HISTOGRAM_HPP_INCLUDED__
+
+#include "macros.hpp"
+#include "stdint.hpp"
+
+namespace zmq
+{
+//  Histogram of latencies in nanoseconds. As in HdrHistogram, the buckets
+//  double in width from one power of two to the next, and each power of two
+//  is split in a few buckets of equal width, so that any value is kept with
+//  the same relative precision at the cost of a fixed amount of memory.
+//  Must only be used by a single thread.
+
+class latency_histogram_t
+{
+  public:
+    latency_histogram_t ();
+
+    //  Adds a latency to the histogram.
+    void record (uint64_t value_)
+    {
+        _counts[index (value_)]++;
+        _count++;
+        if (value_ > _max)
+            _max = value_;
+    }
+
+    //  Number of values in the summary written by summarize.
+    enum
+    {
+        summary_size = 6
+    };
+
+    //  Writes the number of latencies recorded, the median, the 90th, 99th
+    //  and 99.9th percentiles and the maximum to values_. The percentiles
+    //  are rounded up to the upper bound of their bucket.
+    void summarize (uint64_t *values_) const;
+
+  private:
+    enum
+    {
+        //  Each power of two is split in 2^sub_bucket_bits buckets, i.e.
+        //  values are kept with a precision of 12.5%.
+        sub_bucket_bits = 3,
+        sub_buckets = 1 << sub_bucket_bits,
+        buckets = (64 - sub_bucket_bits + 1) * sub_buckets
+    };
+
+    static unsigned int index (uint64_t value_)
+    {
+        if (value_ < sub_buckets)
+            return static_cast<unsigned int> (value_);
+#if defined __GNUC__
+        const unsigned int msb = 63 - __builtin_clzll (value_);
+#else
+        unsigned int msb = 0;
+        for (uint64_t v = value_; v >>= 1;)
+            msb++;
+#endif
+        const unsigned int shift = msb - sub_bucket_bits;
+        return (shift + 1) * sub_buckets
+               + static_cast<unsigned int> ((value_ >> shift)
+                                            & (sub_buckets - 1));
+    }
+
+    //  Returns the largest value falling into the given bucket.
+    static uint64_t upper_bound (unsigned int index_);
+
+    //  Returns the value below which the given fraction of the recorded
+    //  latencies falls, expressed in thousandths of a percent.
+    uint64_t percentile (uint64_t millipercent_) const;
+
+    uint64_t _counts[buckets];
+    uint64_t _count;
+    uint64_t _max;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (latency_histogram_t)
+};
+}
+
+#endif
@@ -31,24 +31,30 @@
 #include "mailbox.hpp"
 #include "err.hpp"
 
-zmq::mailbox_t::mailbox_t ()
+zmq::mailbox_t::mailbox_t () : _active (false)
 {
     //  Get the pipe into passive state. That way, if the users starts by
     //  polling on the associated file descriptor it will get woken up when
-    //  new command is posted.
+    //  new command is posted. The lock-free queue starts that way.
+#ifndef ZMQ_USE_MPSC_MAILBOX
     const bool ok = _cpipe.check_read ();
     zmq_assert (!ok);
-    _active = false;
+#endif
 }
 
 zmq::mailbox_t::~mailbox_t ()
 {
+#ifdef ZMQ_USE_MPSC_MAILBOX
+    //  Other threads might still be in our send() method. The queue
+    //  waits for their commands to be linked in before disappearing.
+#else
     //  TODO: Retrieve and deallocate commands inside the _cpipe.
 
     // Work around problem that other threads might still be in our
     // send() method, by waiting on the mutex before disappearing.
     _sync.lock ();
     _sync.unlock ();
+#endif
 }
 
 zmq::fd_t zmq::mailbox_t::get_fd () const
@@ -58,19 +64,25 @@ zmq::fd_t zmq::mailbox_t::get_fd () const
 
 void zmq::mailbox_t::send (const command_t &cmd_)
 {
+#ifdef ZMQ_USE_MPSC_MAILBOX
+    //  If the queue was empty, the reader is asleep and has to be woken up.
+    if (!_queue.write (cmd_))
+        _signaler.send ();
+#else
     _sync.lock ();
     _cpipe.write (cmd_, false);
     const bool ok = _cpipe.flush ();
     _sync.unlock ();
     if (!ok)
         _signaler.send ();
+#endif
 }
 
 int zmq::mailbox_t::recv (command_t *cmd_, int timeout_)
 {
     //  Try to get the command straight away.
     if (_active) {
-        if (_cpipe.read (cmd_))
+        if (read (cmd_))
             return 0;
 
         //  If there are no more commands available, switch into passive state.
@@ -95,11 +107,31 @@ int zmq::mailbox_t::recv (command_t *cmd_, int timeout_)
     _active = true;
 
     //  Get a command.
-    const bool ok = _cpipe.read (cmd_);
+    const bool ok = read (cmd_);
     zmq_assert (ok);
     return 0;
 }
 
+bool zmq::mailbox_t::check_read ()
+{
+#ifdef ZMQ_USE_MPSC_MAILBOX
+    return _queue.check_read ();
+#else
+    //  ypipe_t::check_read would put the pipe to sleep when it is empty,
+    //  behind the back of the active state.
+    return _cpipe.peek_read ();
+#endif
+}
+
+bool zmq::mailbox_t::read (command_t *cmd_)
+{
+#ifdef ZMQ_USE_MPSC_MAILBOX
+    return _queue.read (cmd_);
+#else
+    return _cpipe.read (cmd_);
+#endif
+}
+
 bool zmq::mailbox_t::valid () const
 {
     return _signaler.valid ();
@@ -36,8 +36,12 @@
 #include "fd.hpp"
 #include "config.hpp"
 #include "command.hpp"
+#ifdef ZMQ_USE_MPSC_MAILBOX
+#include "mpsc_queue.hpp"
+#else
 #include "ypipe.hpp"
 #include "mutex.hpp"
+#endif
 #include "i_mailbox.hpp"
 
 namespace zmq
@@ -51,6 +55,7 @@ class mailbox_t ZMQ_FINAL : public i_mailbox
     fd_t get_fd () const;
     void send (const command_t &cmd_);
     int recv (command_t *cmd_, int timeout_);
+    bool check_read ();
 
     bool valid () const;
 
@@ -62,18 +67,30 @@ class mailbox_t ZMQ_FINAL : public i_mailbox
 #endif
 
   private:
+    //  Reads a command from the underlying queue or pipe.
+    bool read (command_t *cmd_);
+
+#ifdef ZMQ_USE_MPSC_MAILBOX
+    //  The queue to store actual commands. There's only one thread
+    //  receiving from the mailbox, but there is arbitrary number of threads
+    //  sending, so the queue is safe for concurrent writers.
+    mpsc_queue_t<command_t> _queue;
+#else
     //  The pipe to store actual commands.
     typedef ypipe_t<command_t, command_pipe_granularity> cpipe_t;
     cpipe_t _cpipe;
+#endif
 
     //  Signaler to pass signals from writer thread to reader thread.
     signaler_t _signaler;
 
+#ifndef ZMQ_USE_MPSC_MAILBOX
     //  There's only one thread receiving from the mailbox, but there
     //  is arbitrary number of threads sending. Given that ypipe requires
     //  synchronised access on both of its endpoints, we have to synchronise
     //  the sending side.
     mutex_t _sync;
+#endif
 
     //  True if the underlying pipe is active, ie. when we are allowed to
     //  read commands from it.
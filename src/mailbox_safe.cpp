@@ -79,6 +79,7 @@ void zmq::mailbox_safe_t::send (const command_t &cmd_)
     _sync->lock ();
     _cpipe.write (cmd_, false);
     const bool ok = _cpipe.flush ();
+    _pending.add (1);
 
     if (!ok) {
         _cond_var.broadcast ();
@@ -96,8 +97,10 @@ void zmq::mailbox_safe_t::send (const command_t &cmd_)
 int zmq::mailbox_safe_t::recv (command_t *cmd_, int timeout_)
 {
     //  Try to get the command straight away.
-    if (_cpipe.read (cmd_))
+    if (_cpipe.read (cmd_)) {
+        _pending.sub (1);
         return 0;
+    }
 
     //  If the timeout is zero, it will be quicker to release the lock, giving other a chance to send a command
     //  and immediately relock it.
@@ -121,5 +124,11 @@ int zmq::mailbox_safe_t::recv (command_t *cmd_, int timeout_)
         return -1;
     }
 
+    _pending.sub (1);
     return 0;
 }
+
+bool zmq::mailbox_safe_t::check_read ()
+{
+    return _pending.get () != 0;
+}
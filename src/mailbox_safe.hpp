@@ -37,6 +37,7 @@
 #include "fd.hpp"
 #include "config.hpp"
 #include "command.hpp"
+#include "atomic_counter.hpp"
 #include "ypipe.hpp"
 #include "mutex.hpp"
 #include "i_mailbox.hpp"
@@ -52,6 +53,7 @@ class mailbox_safe_t ZMQ_FINAL : public i_mailbox
 
     void send (const command_t &cmd_);
     int recv (command_t *cmd_, int timeout_);
+    bool check_read ();
 
     // Add signaler to mailbox which will be called when a message is ready
     void add_signaler (signaler_t *signaler_);
@@ -73,6 +75,10 @@ class mailbox_safe_t ZMQ_FINAL : public i_mailbox
     typedef ypipe_t<command_t, command_pipe_granularity> cpipe_t;
     cpipe_t _cpipe;
 
+    //  Number of commands written but not read yet, so that check_read
+    //  does not need the lock.
+    atomic_counter_t _pending;
+
     //  Condition variable to pass signals from writer thread to reader thread.
     condition_variable_t _cond_var;
 
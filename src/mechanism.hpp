@@ -39,6 +39,7 @@ namespace zmq
 {
 class msg_t;
 class session_base_t;
+class crypto_job_t;
 
 //  Abstract class representing security mechanism.
 //  Different mechanism extends this class.
@@ -70,6 +71,10 @@ class mechanism_t
     //  Notifies mechanism about availability of ZAP message.
     virtual int zap_msg_available () { return 0; }
 
+    //  Notifies mechanism that a job it offloaded to the crypto pool has
+    //  run. Jobs submitted by other mechanisms must be ignored.
+    virtual int crypto_job_done (crypto_job_t *) { return 0; }
+
     //  Returns the status of this mechanism.
     virtual status_t status () const = 0;
 
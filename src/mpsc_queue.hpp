@@ -0,0 +1,205 @@
+/*
+    Copyright (c) 2007-2016 Contributors as noted in the AUTHORS file
+
+    This file is part of libzmq, the ZeroMQ core engine in C++.
+
+    libzmq is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License (LGPL) as published
+    by the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    As a special exception, the Contributors give you permission to link
+    this library with independent modules to produce an executable,
+    regardless of the license terms of these independent modules, and to
+    copy and distribute the resulting executable under terms of your choice,
+    provided that you also meet, for each linked independent module, the
+    terms and conditions of the license of that module. An independent
+    module is a module which is not derived from or based on this library.
+    If you modify this library, you must extend this exception to your
+    version of the library.
+
+    libzmq is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __ZMQ_MPSC_QUEUE_HPP_INCLUDED__
+#define __ZMQ_MPSC_QUEUE_HPP_INCLUDED__
+
+#include <new>
+
+#include "atomic_ptr.hpp"
+#include "err.hpp"
+#include "macros.hpp"
+
+#ifdef ZMQ_HAVE_WINDOWS
+#include "windows.hpp"
+#else
+#include <sched.h>
+#endif
+
+namespace zmq
+{
+//  Lock-free multi-producer, single-consumer queue.
+//  Any number of threads can write to the queue concurrently, without
+//  taking a lock. Only a single thread can read from the queue at any
+//  specific moment.
+//
+//  Items are kept in a singly linked list of nodes. A writer claims its
+//  place in the list with a single atomic exchange of the head pointer
+//  and links the previous node to its own afterwards. The reader owns the
+//  tail of the list.
+//
+//  Like ypipe_t, the queue tells the writer when the reader has to be
+//  woken up: a reader that finds the queue empty swaps the head for the
+//  'asleep' sentinel, and the writer that swaps the sentinel out again
+//  is the one to wake it.
+
+template <typename T> class mpsc_queue_t
+{
+  public:
+    //  Initialises the queue with the reader asleep.
+    mpsc_queue_t ()
+    {
+        _tail = new (std::nothrow) node_t;
+        alloc_assert (_tail);
+        _head.set (&_asleep);
+    }
+
+    ~mpsc_queue_t ()
+    {
+        //  Writers that already claimed a place in the list may still be
+        //  about to link their node. Wait for the chain to be complete
+        //  before releasing it.
+        node_t *const last = _head.load ();
+        node_t *node = _tail;
+        while (last != &_asleep && node != last) {
+            node_t *next;
+            while ((next = node->next.load ()) == NULL)
+                relax ();
+            delete node;
+            node = next;
+        }
+        delete node;
+        release_all (_free.xchg (NULL));
+    }
+
+    //  Write an item to the queue. Returns false if the reader is asleep
+    //  and has to be woken up. Safe to call from any number of threads
+    //  concurrently.
+    bool write (const T &value_)
+    {
+        //  Reuse a node released by the reader if there is one. The whole
+        //  list is taken at once to avoid ABA problems; the remaining nodes
+        //  are put back unless the reader has released more meanwhile.
+        node_t *node = _free.xchg (NULL);
+        if (node) {
+            node_t *const rest = node->next.load ();
+            if (rest && _free.cas (NULL, rest) != NULL)
+                release_all (rest);
+            node->next.set (NULL);
+        } else {
+            node = new (std::nothrow) node_t;
+            alloc_assert (node);
+        }
+        node->value = value_;
+
+        node_t *const prev = _head.xchg (node);
+
+        //  If the reader went asleep, the list continues from its tail.
+        //  The reader doesn't touch the tail until our node is linked in.
+        if (prev == &_asleep) {
+            _tail->next.store (node);
+            return false;
+        }
+        prev->next.store (node);
+        return true;
+    }
+
+    //  Check whether there is an item to read, without changing the state
+    //  of the queue. Only to be called by the reader.
+    bool check_read ()
+    {
+        node_t *const head = _head.load ();
+        return head != _tail && head != &_asleep;
+    }
+
+    //  Read an item from the queue. Returns false if there is no item
+    //  available, in which case the reader is considered asleep until
+    //  a writer reports otherwise.
+    bool read (T *value_)
+    {
+        node_t *next = _tail->next.load ();
+        if (!next) {
+            //  If the head still points to our tail, the queue is truly
+            //  empty and we can go asleep, unless we already are.
+            node_t *const head = _head.cas (_tail, &_asleep);
+            if (head == _tail || head == &_asleep)
+                return false;
+
+            //  A writer has claimed a place in the list but hasn't linked
+            //  its node yet. This window is a couple of instructions long.
+            while ((next = _tail->next.load ()) == NULL)
+                relax ();
+        }
+
+        *value_ = next->value;
+
+        //  Keep the released node for the writers.
+        node_t *top;
+        do {
+            top = _free.load ();
+            _tail->next.set (top);
+        } while (_free.cas (top, _tail) != top);
+        _tail = next;
+        return true;
+    }
+
+  private:
+    struct node_t
+    {
+        T value;
+        atomic_ptr_t<node_t> next;
+    };
+
+    static void release_all (node_t *node_)
+    {
+        while (node_) {
+            node_t *const next = node_->next.load ();
+            delete node_;
+            node_ = next;
+        }
+    }
+
+    static void relax ()
+    {
+#ifdef ZMQ_HAVE_WINDOWS
+        SwitchToThread ();
+#else
+        sched_yield ();
+#endif
+    }
+
+    //  Most recently written node, or the 'asleep' sentinel if the reader
+    //  has found the queue empty. Shared among writers.
+    atomic_ptr_t<node_t> _head;
+
+    //  Node preceding the oldest unread item. Owned by the reader.
+    node_t *_tail;
+
+    //  The sentinel. Never contains an item.
+    node_t _asleep;
+
+    //  Nodes released by the reader are kept here so that the writers
+    //  don't have to hit the allocator for every item.
+    atomic_ptr_t<node_t> _free;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (mpsc_queue_t)
+};
+}
+
+#endif
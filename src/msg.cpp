@@ -39,6 +39,7 @@
 #include "stdint.hpp"
 #include "likely.hpp"
 #include "metadata.hpp"
+#include "msg_pool.hpp"
 #include "err.hpp"
 
 //  Check whether the sizes of public representation of the message (zmq_msg_t)
@@ -104,9 +105,10 @@ int zmq::msg_t::init_size (size_t size_)
         _u.lmsg.group.type = group_type_short;
         _u.lmsg.routing_id = 0;
         _u.lmsg.content = NULL;
+        unsigned char size_class = 0;
         if (sizeof (content_t) + size_ > size_)
-            _u.lmsg.content =
-              static_cast<content_t *> (malloc (sizeof (content_t) + size_));
+            _u.lmsg.content = static_cast<content_t *> (
+              msg_pool_alloc (sizeof (content_t) + size_, &size_class));
         if (unlikely (!_u.lmsg.content)) {
             errno = ENOMEM;
             return -1;
@@ -117,6 +119,7 @@ int zmq::msg_t::init_size (size_t size_)
         _u.lmsg.content->ffn = NULL;
         _u.lmsg.content->hint = NULL;
         new (&_u.lmsg.content->refcnt) zmq::atomic_counter_t ();
+        _u.lmsg.content->size_class = size_class;
     }
     return 0;
 }
@@ -199,6 +202,7 @@ int zmq::msg_t::init_data (void *data_,
         _u.lmsg.content->ffn = ffn_;
         _u.lmsg.content->hint = hint_;
         new (&_u.lmsg.content->refcnt) zmq::atomic_counter_t ();
+        _u.lmsg.content->size_class = 0;
     }
     return 0;
 }
@@ -286,7 +290,7 @@ int zmq::msg_t::close ()
             if (_u.lmsg.content->ffn)
                 _u.lmsg.content->ffn (_u.lmsg.content->data,
                                       _u.lmsg.content->hint);
-            free (_u.lmsg.content);
+            msg_pool_free (_u.lmsg.content, _u.lmsg.content->size_class);
         }
     }
 
@@ -634,7 +638,7 @@ bool zmq::msg_t::rm_refs (int refs_)
 
         if (_u.lmsg.content->ffn)
             _u.lmsg.content->ffn (_u.lmsg.content->data, _u.lmsg.content->hint);
-        free (_u.lmsg.content);
+        msg_pool_free (_u.lmsg.content, _u.lmsg.content->size_class);
 
         return false;
     }
@@ -74,6 +74,8 @@ class msg_t
         msg_free_fn *ffn;
         void *hint;
         zmq::atomic_counter_t refcnt;
+        //  Message pool size class the content was allocated from.
+        unsigned char size_class;
     };
 
     //  Message flags.
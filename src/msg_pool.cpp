@@ -0,0 +1,284 @@
+/*
+    Copyright (c) 2007-2016 Contributors as noted in the AUTHORS file
+
+    This file is part of libzmq, the ZeroMQ core engine in C++.
+
+    libzmq is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License (LGPL) as published
+    by the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    As a special exception, the Contributors give you permission to link
+    this library with independent modules to produce an executable,
+    regardless of the license terms of these independent modules, and to
+    copy and distribute the resulting executable under terms of your choice,
+    provided that you also meet, for each linked independent module, the
+    terms and conditions of the license of that module. An independent
+    module is a module which is not derived from or based on this library.
+    If you modify this library, you must extend this exception to your
+    version of the library.
+
+    libzmq is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "precompiled.hpp"
+#include "msg_pool.hpp"
+#include "atomic_counter.hpp"
+#include "config.hpp"
+#include "err.hpp"
+#include "mutex.hpp"
+
+#include <stdlib.h>
+
+//  Per-thread caches require thread-local storage with destructors.
+#if (defined __cplusplus && __cplusplus >= 201103L)                            \
+  || (defined _MSC_VER && _MSC_VER >= 1900)
+#define ZMQ_MSG_POOL_THREAD_CACHE
+#endif
+
+namespace
+{
+//  Number of users of the pool. Changed under users_sync only, so that
+//  an unbalanced close cannot take the count below zero.
+zmq::atomic_counter_t users;
+zmq::mutex_t users_sync;
+}
+
+#ifdef ZMQ_MSG_POOL_THREAD_CACHE
+
+namespace
+{
+template <size_t N> struct log2_t
+{
+    enum
+    {
+        value = 1 + log2_t<N / 2>::value
+    };
+};
+
+template <> struct log2_t<1>
+{
+    enum
+    {
+        value = 0
+    };
+};
+
+//  The smallest size class holds blocks of 128 bytes, the largest
+//  msg_pool_max_block bytes.
+const int min_block_log2 = 7;
+const int size_classes =
+  1 + 4 * (log2_t<zmq::msg_pool_max_block>::value - min_block_log2);
+
+//  Released blocks are chained through their first bytes.
+struct free_block_t
+{
+    free_block_t *next;
+};
+
+struct block_list_t
+{
+    free_block_t *head;
+    size_t count;
+};
+
+//  Size class of a block of size_ bytes, counting from zero.
+int size_class (size_t size_)
+{
+    if (size_ <= (1u << min_block_log2))
+        return 0;
+    const size_t last = size_ - 1;
+    int log2 = min_block_log2;
+    while (last >> (log2 + 1))
+        ++log2;
+    const int quarter = static_cast<int> (last >> (log2 - 2)) - 4;
+    return (log2 - min_block_log2) * 4 + quarter + 1;
+}
+
+size_t class_size (int class_)
+{
+    if (class_ == 0)
+        return 1u << min_block_log2;
+    const int log2 = min_block_log2 + (class_ - 1) / 4;
+    return static_cast<size_t> (4 + (class_ - 1) % 4 + 1) << (log2 - 2);
+}
+
+//  Number of blocks a thread keeps cached per size class.
+size_t cache_limit (int class_)
+{
+    const size_t limit = zmq::msg_pool_thread_cache / class_size (class_);
+    return limit < 4 ? 4 : limit;
+}
+
+void release_list (free_block_t *block_)
+{
+    while (block_) {
+        free_block_t *const next = block_->next;
+        free (block_);
+        block_ = next;
+    }
+}
+
+//  Blocks handed over between threads, per size class.
+struct shared_list_t
+{
+    zmq::mutex_t sync;
+    block_list_t blocks;
+};
+shared_list_t shared[size_classes];
+
+//  Moves count_ blocks from the front of from_ to the front of to_.
+void move_blocks (block_list_t &from_, block_list_t &to_, size_t count_)
+{
+    for (size_t i = 0; i != count_ && from_.head; ++i) {
+        free_block_t *const block = from_.head;
+        from_.head = block->next;
+        from_.count--;
+        block->next = to_.head;
+        to_.head = block;
+        to_.count++;
+    }
+}
+
+struct thread_cache_t
+{
+    thread_cache_t ()
+    {
+        for (int i = 0; i != size_classes; ++i) {
+            blocks[i].head = NULL;
+            blocks[i].count = 0;
+        }
+    }
+
+    ~thread_cache_t ()
+    {
+        //  Let other threads have the blocks of an exiting thread.
+        for (int i = 0; i != size_classes; ++i) {
+            if (users.get () != 0) {
+                zmq::scoped_lock_t locker (shared[i].sync);
+                move_blocks (blocks[i], shared[i].blocks, blocks[i].count);
+            }
+            release_list (blocks[i].head);
+        }
+    }
+
+    block_list_t blocks[size_classes];
+};
+
+thread_local thread_cache_t thread_cache;
+}
+
+void *zmq::msg_pool_alloc (size_t size_, unsigned char *size_class_)
+{
+    if (size_ > msg_pool_max_block || users.get () == 0) {
+        *size_class_ = 0;
+        return malloc (size_);
+    }
+
+    const int c = size_class (size_);
+    block_list_t &cache = thread_cache.blocks[c];
+
+    //  Take half a cache worth of blocks released by other threads.
+    if (!cache.head) {
+        scoped_lock_t locker (shared[c].sync);
+        move_blocks (shared[c].blocks, cache, cache_limit (c) / 2);
+    }
+
+    *size_class_ = static_cast<unsigned char> (c + 1);
+    free_block_t *const block = cache.head;
+    if (!block)
+        return malloc (class_size (c));
+    cache.head = block->next;
+    cache.count--;
+    return block;
+}
+
+void zmq::msg_pool_free (void *block_, unsigned char size_class_)
+{
+    if (size_class_ == 0 || users.get () == 0) {
+        free (block_);
+        return;
+    }
+
+    const int c = size_class_ - 1;
+    block_list_t &cache = thread_cache.blocks[c];
+    free_block_t *const block = static_cast<free_block_t *> (block_);
+    block->next = cache.head;
+    cache.head = block;
+    cache.count++;
+
+    //  Hand half of the cache over to other threads. The shared list is
+    //  bounded as well, blocks beyond that go back to the heap.
+    const size_t limit = cache_limit (c);
+    if (cache.count > limit) {
+        block_list_t excess = {NULL, 0};
+        move_blocks (cache, excess, limit / 2);
+        {
+            scoped_lock_t locker (shared[c].sync);
+            if (shared[c].blocks.count < limit * 8)
+                move_blocks (excess, shared[c].blocks, excess.count);
+        }
+        release_list (excess.head);
+    }
+}
+
+//  Nobody uses the pool anymore, return the shared blocks to the heap.
+//  Blocks cached by threads are released as the threads exit.
+static void release_shared ()
+{
+    for (int i = 0; i != size_classes; ++i) {
+        block_list_t blocks;
+        {
+            zmq::scoped_lock_t locker (shared[i].sync);
+            blocks = shared[i].blocks;
+            shared[i].blocks.head = NULL;
+            shared[i].blocks.count = 0;
+        }
+        release_list (blocks.head);
+    }
+}
+
+#else
+
+void *zmq::msg_pool_alloc (size_t size_, unsigned char *size_class_)
+{
+    *size_class_ = 0;
+    return malloc (size_);
+}
+
+void zmq::msg_pool_free (void *block_, unsigned char size_class_)
+{
+    LIBZMQ_UNUSED (size_class_);
+    free (block_);
+}
+
+static void release_shared ()
+{
+}
+
+#endif
+
+void zmq::msg_pool_open ()
+{
+    scoped_lock_t locker (users_sync);
+    users.add (1);
+}
+
+int zmq::msg_pool_close ()
+{
+    scoped_lock_t locker (users_sync);
+    if (users.get () == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!users.sub (1))
+        release_shared ();
+    return 0;
+}
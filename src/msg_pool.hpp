@@ -0,0 +1,61 @@
+/*
+    Copyright (c) 2007-2016 Contributors as noted in the AUTHORS file
+
+    This file is part of libzmq, the ZeroMQ core engine in C++.
+
+    libzmq is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License (LGPL) as published
+    by the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    As a special exception, the Contributors give you permission to link
+    this library with independent modules to produce an executable,
+    regardless of the license terms of these independent modules, and to
+    copy and distribute the resulting executable under terms of your choice,
+    provided that you also meet, for each linked independent module, the
+    terms and conditions of the license of that module. An independent
+    module is a module which is not derived from or based on this library.
+    If you modify this library, you must extend this exception to your
+    version of the library.
+
+    libzmq is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __ZMQ_MSG_POOL_HPP_INCLUDED__
+#define __ZMQ_MSG_POOL_HPP_INCLUDED__
+
+#include <stddef.h>
+
+namespace zmq
+{
+//  Cache of the memory blocks backing the content of long messages.
+//  Blocks are grouped in size classes, four per power of two. Each thread
+//  keeps released blocks of its own, so that a message allocated in one
+//  thread and released in another takes no lock on either side; threads
+//  exchange blocks with a shared, locked list in batches only.
+
+//  Allocates a block of at least size_ bytes. The size class the block
+//  has to be released to is stored in size_class_, zero meaning the block
+//  was not taken from the pool.
+void *msg_pool_alloc (size_t size_, unsigned char *size_class_);
+
+//  Releases a block allocated by msg_pool_alloc.
+void msg_pool_free (void *block_, unsigned char size_class_);
+
+//  Start and stop using the pool. msg_t has no context to hang the pool
+//  off, so it is process-wide and refcounted, so that each user can enable
+//  it independently. While nobody uses the pool, blocks are allocated and
+//  released with malloc and free directly. msg_pool_close fails with
+//  EINVAL if it is not matched by a prior msg_pool_open.
+void msg_pool_open ();
+int msg_pool_close ();
+}
+
+#endif
@@ -48,6 +48,7 @@ class norm_engine_t ZMQ_FINAL : public io_object_t, public i_engine
     void restart_output () ZMQ_FINAL;
 
     void zap_msg_available () ZMQ_FINAL {}
+    void crypto_job_done (crypto_job_t *) ZMQ_FINAL {}
 
     const endpoint_uri_pair_t &get_endpoint () const ZMQ_FINAL;
 
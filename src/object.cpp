@@ -109,14 +109,16 @@ void zmq::object_t::process_command (const command_t &cmd_)
         case command_t::pipe_peer_stats:
             process_pipe_peer_stats (cmd_.args.pipe_peer_stats.queue_count,
                                      cmd_.args.pipe_peer_stats.socket_base,
-                                     cmd_.args.pipe_peer_stats.endpoint_pair);
+                                     cmd_.args.pipe_peer_stats.endpoint_pair,
+                                     cmd_.args.pipe_peer_stats.latency);
             break;
 
         case command_t::pipe_stats_publish:
             process_pipe_stats_publish (
               cmd_.args.pipe_stats_publish.outbound_queue_count,
               cmd_.args.pipe_stats_publish.inbound_queue_count,
-              cmd_.args.pipe_stats_publish.endpoint_pair);
+              cmd_.args.pipe_stats_publish.endpoint_pair,
+              cmd_.args.pipe_stats_publish.latency);
             break;
 
         case command_t::pipe_term:
@@ -164,6 +166,11 @@ void zmq::object_t::process_command (const command_t &cmd_)
             process_conn_failed ();
             break;
 
+        case command_t::crypto_job_done:
+            process_crypto_job_done (cmd_.args.crypto_job_done.job);
+            process_seqnum ();
+            break;
+
         case command_t::done:
         default:
             zmq_assert (false);
@@ -312,7 +319,8 @@ void zmq::object_t::send_hiccup (pipe_t *destination_, void *pipe_)
 void zmq::object_t::send_pipe_peer_stats (pipe_t *destination_,
                                           uint64_t queue_count_,
                                           own_t *socket_base_,
-                                          endpoint_uri_pair_t *endpoint_pair_)
+                                          endpoint_uri_pair_t *endpoint_pair_,
+                                          uint64_t *latency_)
 {
     command_t cmd;
     cmd.destination = destination_;
@@ -320,6 +328,7 @@ void zmq::object_t::send_pipe_peer_stats (pipe_t *destination_,
     cmd.args.pipe_peer_stats.queue_count = queue_count_;
     cmd.args.pipe_peer_stats.socket_base = socket_base_;
     cmd.args.pipe_peer_stats.endpoint_pair = endpoint_pair_;
+    cmd.args.pipe_peer_stats.latency = latency_;
     send_command (cmd);
 }
 
@@ -327,7 +336,8 @@ void zmq::object_t::send_pipe_stats_publish (
   own_t *destination_,
   uint64_t outbound_queue_count_,
   uint64_t inbound_queue_count_,
-  endpoint_uri_pair_t *endpoint_pair_)
+  endpoint_uri_pair_t *endpoint_pair_,
+  uint64_t *latency_)
 {
     command_t cmd;
     cmd.destination = destination_;
@@ -335,6 +345,7 @@ void zmq::object_t::send_pipe_stats_publish (
     cmd.args.pipe_stats_publish.outbound_queue_count = outbound_queue_count_;
     cmd.args.pipe_stats_publish.inbound_queue_count = inbound_queue_count_;
     cmd.args.pipe_stats_publish.endpoint_pair = endpoint_pair_;
+    cmd.args.pipe_stats_publish.latency = latency_;
     send_command (cmd);
 }
 
@@ -477,14 +488,16 @@ void zmq::object_t::process_hiccup (void *)
 
 void zmq::object_t::process_pipe_peer_stats (uint64_t,
                                              own_t *,
-                                             endpoint_uri_pair_t *)
+                                             endpoint_uri_pair_t *,
+                                             uint64_t *)
 {
     zmq_assert (false);
 }
 
 void zmq::object_t::process_pipe_stats_publish (uint64_t,
                                                 uint64_t,
-                                                endpoint_uri_pair_t *)
+                                                endpoint_uri_pair_t *,
+                                                uint64_t *)
 {
     zmq_assert (false);
 }
@@ -544,6 +557,11 @@ void zmq::object_t::process_conn_failed ()
     zmq_assert (false);
 }
 
+void zmq::object_t::process_crypto_job_done (crypto_job_t *)
+{
+    zmq_assert (false);
+}
+
 void zmq::object_t::send_command (const command_t &cmd_)
 {
     _ctx->send_command (cmd_.destination->get_tid (), cmd_);
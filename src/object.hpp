@@ -48,6 +48,7 @@ class socket_base_t;
 class session_base_t;
 class io_thread_t;
 class own_t;
+class crypto_job_t;
 
 //  Base class for all objects that participate in inter-thread
 //  communication.
@@ -102,11 +103,13 @@ class object_t
     void send_pipe_peer_stats (zmq::pipe_t *destination_,
                                uint64_t queue_count_,
                                zmq::own_t *socket_base,
-                               endpoint_uri_pair_t *endpoint_pair_);
+                               endpoint_uri_pair_t *endpoint_pair_,
+                               uint64_t *latency_);
     void send_pipe_stats_publish (zmq::own_t *destination_,
                                   uint64_t outbound_queue_count_,
                                   uint64_t inbound_queue_count_,
-                                  endpoint_uri_pair_t *endpoint_pair_);
+                                  endpoint_uri_pair_t *endpoint_pair_,
+                                  uint64_t *latency_);
     void send_pipe_term (zmq::pipe_t *destination_);
     void send_pipe_term_ack (zmq::pipe_t *destination_);
     void send_pipe_hwm (zmq::pipe_t *destination_, int inhwm_, int outhwm_);
@@ -132,11 +135,13 @@ class object_t
     virtual void process_hiccup (void *pipe_);
     virtual void process_pipe_peer_stats (uint64_t queue_count_,
                                           zmq::own_t *socket_base_,
-                                          endpoint_uri_pair_t *endpoint_pair_);
+                                          endpoint_uri_pair_t *endpoint_pair_,
+                                          uint64_t *latency_);
     virtual void
     process_pipe_stats_publish (uint64_t outbound_queue_count_,
                                 uint64_t inbound_queue_count_,
-                                endpoint_uri_pair_t *endpoint_pair_);
+                                endpoint_uri_pair_t *endpoint_pair_,
+                                uint64_t *latency_);
     virtual void process_pipe_term ();
     virtual void process_pipe_term_ack ();
     virtual void process_pipe_hwm (int inhwm_, int outhwm_);
@@ -147,6 +152,7 @@ class object_t
     virtual void process_reap (zmq::socket_base_t *socket_);
     virtual void process_reaped ();
     virtual void process_conn_failed ();
+    virtual void process_crypto_job_done (zmq::crypto_job_t *job_);
 
 
     //  Special handler called after a command that requires a seqnum
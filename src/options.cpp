@@ -33,6 +33,7 @@
 #include <set>
 
 #include "options.hpp"
+#include "config.hpp"
 #include "err.hpp"
 #include "macros.hpp"
 
@@ -251,13 +252,21 @@ zmq::options_t::options_t () :
     router_notify (0),
     monitor_event_version (1),
     wss_trust_system (false),
+    wss_ktls (false),
     hello_msg (),
     can_send_hello_msg (false),
     disconnect_msg (),
     can_recv_disconnect_msg (false),
     hiccup_msg (),
     can_recv_hiccup_msg (false),
-    busy_poll (0)
+    busy_poll (0),
+    udp_batch_size (1),
+    udp_offload (false),
+    tcp_zerocopy_threshold (0),
+    recv_spin (0),
+    flush_msgs (0),
+    flush_bytes (0),
+    latency_stats (false)
 {
     memset (curve_public_key, 0, CURVE_KEYSIZE);
     memset (curve_secret_key, 0, CURVE_KEYSIZE);
@@ -844,6 +853,49 @@ int zmq::options_t::setsockopt (int option_,
                 return 0;
             }
             break;
+
+        case ZMQ_UDP_BATCH_SIZE:
+            if (is_int && value > 0 && value <= max_udp_batch_size) {
+                udp_batch_size = value;
+                return 0;
+            }
+            break;
+
+        case ZMQ_UDP_OFFLOAD:
+            return do_setsockopt_int_as_bool_relaxed (optval_, optvallen_,
+                                                      &udp_offload);
+
+        case ZMQ_TCP_ZEROCOPY_THRESHOLD:
+            if (is_int && value >= 0) {
+                tcp_zerocopy_threshold = value;
+                return 0;
+            }
+            break;
+
+        case ZMQ_RECV_SPIN:
+            if (is_int && value >= 0) {
+                recv_spin = value;
+                return 0;
+            }
+            break;
+
+        case ZMQ_FLUSH_MSGS:
+            if (is_int && value >= 0) {
+                flush_msgs = value;
+                return 0;
+            }
+            break;
+
+        case ZMQ_FLUSH_BYTES:
+            if (is_int && value >= 0) {
+                flush_bytes = value;
+                return 0;
+            }
+            break;
+
+        case ZMQ_LATENCY_STATS:
+            return do_setsockopt_int_as_bool_relaxed (optval_, optvallen_,
+                                                      &latency_stats);
 #ifdef ZMQ_HAVE_WSS
         case ZMQ_WSS_KEY_PEM:
             // TODO: check if valid certificate
@@ -863,6 +915,9 @@ int zmq::options_t::setsockopt (int option_,
         case ZMQ_WSS_TRUST_SYSTEM:
             return do_setsockopt_int_as_bool_strict (optval_, optvallen_,
                                                      &wss_trust_system);
+        case ZMQ_WSS_KTLS:
+            return do_setsockopt_int_as_bool_strict (optval_, optvallen_,
+                                                     &wss_ktls);
 #endif
 
         case ZMQ_HELLO_MSG:
@@ -1382,6 +1437,64 @@ int zmq::options_t::getsockopt (int option_,
                 *value = busy_poll;
             }
             break;
+
+        case ZMQ_UDP_BATCH_SIZE:
+            if (is_int) {
+                *value = udp_batch_size;
+                return 0;
+            }
+            break;
+
+        case ZMQ_UDP_OFFLOAD:
+            if (is_int) {
+                *value = udp_offload;
+                return 0;
+            }
+            break;
+
+        case ZMQ_TCP_ZEROCOPY_THRESHOLD:
+            if (is_int) {
+                *value = tcp_zerocopy_threshold;
+                return 0;
+            }
+            break;
+
+        case ZMQ_RECV_SPIN:
+            if (is_int) {
+                *value = recv_spin;
+                return 0;
+            }
+            break;
+
+        case ZMQ_FLUSH_MSGS:
+            if (is_int) {
+                *value = flush_msgs;
+                return 0;
+            }
+            break;
+
+        case ZMQ_FLUSH_BYTES:
+            if (is_int) {
+                *value = flush_bytes;
+                return 0;
+            }
+            break;
+
+        case ZMQ_LATENCY_STATS:
+            if (is_int) {
+                *value = latency_stats;
+                return 0;
+            }
+            break;
+
+#ifdef ZMQ_HAVE_WSS
+        case ZMQ_WSS_KTLS:
+            if (is_int) {
+                *value = wss_ktls;
+                return 0;
+            }
+            break;
+#endif
 #endif
 
 
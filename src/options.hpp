@@ -310,6 +310,10 @@ struct options_t
     std::string wss_hostname;
     bool wss_trust_system;
 
+    //  If true, WSS connections hand the record encryption to the kernel
+    //  once the TLS handshake is done, where supported.
+    bool wss_ktls;
+
     //  Hello msg
     std::vector<unsigned char> hello_msg;
     bool can_send_hello_msg;
@@ -324,6 +328,31 @@ struct options_t
 
     //  This option removes several delays caused by scheduling, interrupts and context switching.
     int busy_poll;
+
+    //  Maximum number of datagrams sent or received by the UDP engine
+    //  in a single system call.
+    int udp_batch_size;
+
+    //  If true, the UDP engine uses segmentation offload (UDP_SEGMENT and
+    //  UDP_GRO) for batched sends and receives where available.
+    bool udp_offload;
+
+    //  Minimal size of a message part sent with MSG_ZEROCOPY over TCP.
+    //  Zero disables zero-copy transmission.
+    int tcp_zerocopy_threshold;
+
+    //  Microseconds a blocking receive polls for a message before it
+    //  waits for one.
+    int recv_spin;
+
+    //  Number of messages and bytes after which the pipes are flushed,
+    //  if the flushes are to be deferred. Zero for no limit.
+    int flush_msgs;
+    int flush_bytes;
+
+    //  If true, the pipes of new connections record how long the messages
+    //  spend in them, and report it when the pipes' stats are queried.
+    bool latency_stats;
 };
 
 inline bool get_effective_conflate_option (const options_t &options)
@@ -0,0 +1,120 @@
+/*
+    Copyright (c) 2007-2016 Contributors as noted in the AUTHORS file
+
+    This file is part of libzmq, the ZeroMQ core engine in C++.
+
+    libzmq is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License (LGPL) as published
+    by the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    As a special exception, the Contributors give you permission to link
+    this library with independent modules to produce an executable,
+    regardless of the license terms of these independent modules, and to
+    copy and distribute the resulting executable under terms of your choice,
+    provided that you also meet, for each linked independent module, the
+    terms and conditions of the license of that module. An independent
+    module is a module which is not derived from or based on this library.
+    If you modify this library, you must extend this exception to your
+    version of the library.
+
+    libzmq is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "precompiled.hpp"
+#include "page_allocator.hpp"
+#include "macros.hpp"
+#include "err.hpp"
+
+#if defined ZMQ_HAVE_WINDOWS
+#include "windows.hpp"
+#else
+#include <sys/types.h>
+#include <sys/mman.h>
+#if defined ZMQ_HAVE_MBIND
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#include <unistd.h>
+#endif
+
+#if !defined MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+
+#if defined ZMQ_HAVE_MBIND
+//  Prefers the NUMA node of the CPU the calling thread runs on. The policy
+//  applies to pages faulted in afterwards, so this must run before the
+//  memory is first touched.
+static void bind_to_local_node (void *ptr_, size_t size_)
+{
+    unsigned int cpu;
+    unsigned int node;
+    if (syscall (SYS_getcpu, &cpu, &node, NULL) != 0)
+        return;
+
+    const size_t bits = sizeof (unsigned long) * 8;
+    unsigned long mask[16] = {0};
+    if (node >= sizeof mask * 8)
+        return;
+    mask[node / bits] = 1UL << (node % bits);
+
+    //  Failure is not fatal, the memory is merely placed by the default
+    //  policy instead.
+    syscall (SYS_mbind, ptr_, size_, MPOL_PREFERRED, mask,
+             sizeof mask * 8 + 1, 0);
+}
+#endif
+
+void *zmq::page_alloc (size_t size_, int flags_)
+{
+#if defined ZMQ_HAVE_WINDOWS
+    //  Large pages need SeLockMemoryPrivilege and NUMA placement follows
+    //  first touch, so plain committed pages are used.
+    LIBZMQ_UNUSED (flags_);
+    return VirtualAlloc (NULL, size_, MEM_COMMIT | MEM_RESERVE,
+                         PAGE_READWRITE);
+#else
+    void *ptr = MAP_FAILED;
+#if defined ZMQ_HAVE_MAP_HUGETLB
+    //  Only succeeds if huge pages have been reserved by the administrator.
+    if (flags_ & page_huge)
+        ptr = mmap (NULL, size_, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+    if (ptr == MAP_FAILED) {
+        ptr = mmap (NULL, size_, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr == MAP_FAILED)
+            return NULL;
+#if defined MADV_HUGEPAGE
+        if (flags_ & page_huge)
+            madvise (ptr, size_, MADV_HUGEPAGE);
+#endif
+    }
+#if defined ZMQ_HAVE_MBIND
+    if (flags_ & page_numa_local)
+        bind_to_local_node (ptr, size_);
+#endif
+    return ptr;
+#endif
+}
+
+void zmq::page_free (void *ptr_, size_t size_)
+{
+#if defined ZMQ_HAVE_WINDOWS
+    LIBZMQ_UNUSED (size_);
+    const BOOL rc = VirtualFree (ptr_, 0, MEM_RELEASE);
+    win_assert (rc != 0);
+#else
+    const int rc = munmap (ptr_, size_);
+    errno_assert (rc == 0);
+#endif
+}
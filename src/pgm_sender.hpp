@@ -60,6 +60,7 @@ class pgm_sender_t ZMQ_FINAL : public io_object_t, public i_engine
     bool restart_input ();
     void restart_output ();
     void zap_msg_available () {}
+    void crypto_job_done (crypto_job_t *) {}
     const endpoint_uri_pair_t &get_endpoint () const;
 
     //  i_poll_events interface implementation.
@@ -30,6 +30,7 @@
 #include "precompiled.hpp"
 #include <new>
 #include <stddef.h>
+#include <algorithm>
 
 #include "macros.hpp"
 #include "pipe.hpp"
@@ -41,7 +42,8 @@
 int zmq::pipepair (object_t *parents_[2],
                    pipe_t *pipes_[2],
                    const int hwms_[2],
-                   const bool conflate_[2])
+                   const bool conflate_[2],
+                   const bool latency_[2])
 {
     //   Creates two pipe objects. These objects are connected by two ypipes,
     //   each to pass messages in one direction.
@@ -49,25 +51,37 @@ int zmq::pipepair (object_t *parents_[2],
     typedef ypipe_t<msg_t, message_pipe_granularity> upipe_normal_t;
     typedef ypipe_conflate_t<msg_t> upipe_conflate_t;
 
+    latency_histogram_t *latency1 = NULL;
     pipe_t::upipe_t *upipe1;
     if (conflate_[0])
         upipe1 = new (std::nothrow) upipe_conflate_t ();
-    else
+    else if (latency_[0]) {
+        latency1 = new (std::nothrow) latency_histogram_t ();
+        alloc_assert (latency1);
+        upipe1 = new (std::nothrow) pipe_t::upipe_stamped_t ();
+    } else
         upipe1 = new (std::nothrow) upipe_normal_t ();
     alloc_assert (upipe1);
 
+    latency_histogram_t *latency2 = NULL;
     pipe_t::upipe_t *upipe2;
     if (conflate_[1])
         upipe2 = new (std::nothrow) upipe_conflate_t ();
-    else
+    else if (latency_[1]) {
+        latency2 = new (std::nothrow) latency_histogram_t ();
+        alloc_assert (latency2);
+        upipe2 = new (std::nothrow) pipe_t::upipe_stamped_t ();
+    } else
         upipe2 = new (std::nothrow) upipe_normal_t ();
     alloc_assert (upipe2);
 
-    pipes_[0] = new (std::nothrow)
-      pipe_t (parents_[0], upipe1, upipe2, hwms_[1], hwms_[0], conflate_[0]);
+    pipes_[0] = new (std::nothrow) pipe_t (parents_[0], upipe1, upipe2,
+                                           hwms_[1], hwms_[0], conflate_[0],
+                                           latency1);
     alloc_assert (pipes_[0]);
-    pipes_[1] = new (std::nothrow)
-      pipe_t (parents_[1], upipe2, upipe1, hwms_[0], hwms_[1], conflate_[1]);
+    pipes_[1] = new (std::nothrow) pipe_t (parents_[1], upipe2, upipe1,
+                                           hwms_[0], hwms_[1], conflate_[1],
+                                           latency2);
     alloc_assert (pipes_[1]);
 
     pipes_[0]->set_peer (pipes_[1]);
@@ -104,10 +118,12 @@ zmq::pipe_t::pipe_t (object_t *parent_,
                      upipe_t *outpipe_,
                      int inhwm_,
                      int outhwm_,
-                     bool conflate_) :
+                     bool conflate_,
+                     latency_histogram_t *latency_) :
     object_t (parent_),
     _in_pipe (inpipe_),
     _out_pipe (outpipe_),
+    _latency (latency_),
     _in_active (true),
     _out_active (true),
     _hwm (outhwm_),
@@ -119,6 +135,8 @@ zmq::pipe_t::pipe_t (object_t *parent_,
     _peers_msgs_read (0),
     _peer (NULL),
     _sink (NULL),
+    _flush_batch (NULL),
+    _flush_pending (false),
     _state (active),
     _delay (true),
     _server_socket_routing_id (0),
@@ -129,7 +147,10 @@ zmq::pipe_t::pipe_t (object_t *parent_,
 
 zmq::pipe_t::~pipe_t ()
 {
+    if (_flush_pending)
+        _flush_batch->remove (this);
     _disconnect_msg.close ();
+    LIBZMQ_DELETE (_latency);
 }
 
 void zmq::pipe_t::set_peer (pipe_t *peer_)
@@ -146,6 +167,11 @@ void zmq::pipe_t::set_event_sink (i_pipe_events *sink_)
     _sink = sink_;
 }
 
+void zmq::pipe_t::set_flush_batch (flush_batch_t *flush_batch_)
+{
+    _flush_batch = flush_batch_;
+}
+
 void zmq::pipe_t::set_server_socket_routing_id (
   uint32_t server_socket_routing_id_)
 {
@@ -222,8 +248,16 @@ bool zmq::pipe_t::read (msg_t *msg_)
         return false;
     }
 
-    if (!(msg_->flags () & msg_t::more) && !msg_->is_routing_id ())
+    if (!(msg_->flags () & msg_t::more) && !msg_->is_routing_id ()) {
         _msgs_read++;
+        if (_latency) {
+            //  Counters of different cores may be slightly apart.
+            const uint64_t stamp =
+              static_cast<upipe_stamped_t *> (_in_pipe)->stamp ();
+            const uint64_t now = clock_t::now_ns ();
+            _latency->record (now > stamp ? now - stamp : 0);
+        }
+    }
 
     if (_lwm > 0 && _msgs_read % _lwm == 0)
         send_activate_write (_peer, _msgs_read);
@@ -275,6 +309,23 @@ void zmq::pipe_t::rollback () const
 
 void zmq::pipe_t::flush ()
 {
+    if (_flush_batch && _flush_batch->active ()) {
+        if (!_flush_pending) {
+            _flush_pending = true;
+            _flush_batch->add (this);
+        }
+        return;
+    }
+    flush_now ();
+}
+
+void zmq::pipe_t::flush_now ()
+{
+    if (_flush_pending) {
+        _flush_pending = false;
+        _flush_batch->remove (this);
+    }
+
     //  The peer does not exist anymore at this point.
     if (_state == term_ack_sent)
         return;
@@ -467,7 +518,7 @@ void zmq::pipe_t::terminate (bool delay_)
         msg_t msg;
         msg.init_delimiter ();
         _out_pipe->write (msg, false);
-        flush ();
+        flush_now ();
     }
 }
 
@@ -523,18 +574,26 @@ void zmq::pipe_t::hiccup ()
     //  responsible for deallocating it.
 
     //  Create new inpipe.
-    _in_pipe =
-      _conflate
-        ? static_cast<upipe_t *> (new (std::nothrow) ypipe_conflate_t<msg_t> ())
-        : new (std::nothrow) ypipe_t<msg_t, message_pipe_granularity> ();
-
-    alloc_assert (_in_pipe);
+    _in_pipe = new_in_pipe ();
     _in_active = true;
 
     //  Notify the peer about the hiccup.
     send_hiccup (_peer, _in_pipe);
 }
 
+zmq::pipe_t::upipe_t *zmq::pipe_t::new_in_pipe () const
+{
+    upipe_t *pipe;
+    if (_conflate)
+        pipe = new (std::nothrow) ypipe_conflate_t<msg_t> ();
+    else if (_latency)
+        pipe = new (std::nothrow) upipe_stamped_t ();
+    else
+        pipe = new (std::nothrow) ypipe_t<msg_t, message_pipe_granularity> ();
+    alloc_assert (pipe);
+    return pipe;
+}
+
 void zmq::pipe_t::set_hwms (int inhwm_, int outhwm_)
 {
     int in = inhwm_ + std::max (_in_hwm_boost, 0);
@@ -583,16 +642,30 @@ void zmq::pipe_t::send_stats_to_peer (own_t *socket_base_)
 {
     endpoint_uri_pair_t *ep =
       new (std::nothrow) endpoint_uri_pair_t (_endpoint_pair);
+
+    //  The latency of the inbound messages goes into the second half, the
+    //  peer fills in that of the outbound messages it read.
+    uint64_t *latency = NULL;
+    if (_latency) {
+        latency = new (std::nothrow)
+          uint64_t[2 * latency_histogram_t::summary_size] ();
+        alloc_assert (latency);
+        _latency->summarize (latency + latency_histogram_t::summary_size);
+    }
     send_pipe_peer_stats (_peer, _msgs_written - _peers_msgs_read, socket_base_,
-                          ep);
+                          ep, latency);
 }
 
 void zmq::pipe_t::process_pipe_peer_stats (uint64_t queue_count_,
                                            own_t *socket_base_,
-                                           endpoint_uri_pair_t *endpoint_pair_)
+                                           endpoint_uri_pair_t *endpoint_pair_,
+                                           uint64_t *latency_)
 {
+    if (latency_ && _latency)
+        _latency->summarize (latency_);
     send_pipe_stats_publish (socket_base_, queue_count_,
-                             _msgs_written - _peers_msgs_read, endpoint_pair_);
+                             _msgs_written - _peers_msgs_read, endpoint_pair_,
+                             latency_);
 }
 
 void zmq::pipe_t::send_disconnect_msg ()
@@ -627,3 +700,38 @@ void zmq::pipe_t::send_hiccup_msg (const std::vector<unsigned char> &hiccup_)
         flush ();
     }
 }
+
+zmq::flush_batch_t::flush_batch_t () : _active (false)
+{
+}
+
+void zmq::flush_batch_t::begin ()
+{
+    _active = true;
+}
+
+void zmq::flush_batch_t::end ()
+{
+    _active = false;
+    while (!_pending.empty ())
+        _pending.back ()->flush_now ();
+}
+
+void zmq::flush_batch_t::pause ()
+{
+    _active = false;
+}
+
+void zmq::flush_batch_t::add (pipe_t *pipe_)
+{
+    _pending.push_back (pipe_);
+}
+
+void zmq::flush_batch_t::remove (pipe_t *pipe_)
+{
+    const std::vector<pipe_t *>::iterator it =
+      std::find (_pending.begin (), _pending.end (), pipe_);
+    zmq_assert (it != _pending.end ());
+    *it = _pending.back ();
+    _pending.pop_back ();
+}
@@ -31,6 +31,8 @@
 #define __ZMQ_PIPE_HPP_INCLUDED__
 
 #include "ypipe_base.hpp"
+#include "ypipe_stamped.hpp"
+#include "latency_histogram.hpp"
 #include "config.hpp"
 #include "object.hpp"
 #include "stdint.hpp"
@@ -40,10 +42,43 @@
 #include "endpoint.hpp"
 #include "msg.hpp"
 
+#include <vector>
+
 namespace zmq
 {
 class pipe_t;
 
+//  While active, defers the flushes of the pipes using it, so that the
+//  readers of a batch of messages are woken up once rather than once per
+//  message. Must only be used by the thread writing to the pipes.
+class flush_batch_t
+{
+  public:
+    flush_batch_t ();
+
+    //  Starts deferring flushes.
+    void begin ();
+
+    //  Stops deferring flushes and flushes the pipes written in between.
+    void end ();
+
+    //  Stops deferring flushes, leaving those deferred so far to end ().
+    void pause ();
+
+    bool active () const { return _active; }
+
+    void add (pipe_t *pipe_);
+    void remove (pipe_t *pipe_);
+
+  private:
+    bool _active;
+
+    //  Pipes with deferred flushes.
+    std::vector<pipe_t *> _pending;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (flush_batch_t)
+};
+
 //  Create a pipepair for bi-directional transfer of messages.
 //  First HWM is for messages passed from first pipe to the second pipe.
 //  Second HWM is for messages passed from second pipe to the first pipe.
@@ -52,10 +87,13 @@ class pipe_t;
 //  terminates straight away.
 //  If conflate is true, only the most recently arrived message could be
 //  read (older messages are discarded)
+//  If latency is true, the pipe records how long the messages it reads
+//  spent in transit. Ignored for conflating pipes.
 int pipepair (zmq::object_t *parents_[2],
               zmq::pipe_t *pipes_[2],
               const int hwms_[2],
-              const bool conflate_[2]);
+              const bool conflate_[2],
+              const bool latency_[2]);
 
 struct i_pipe_events
 {
@@ -80,12 +118,19 @@ class pipe_t ZMQ_FINAL : public object_t,
     friend int pipepair (zmq::object_t *parents_[2],
                          zmq::pipe_t *pipes_[2],
                          const int hwms_[2],
-                         const bool conflate_[2]);
+                         const bool conflate_[2],
+                         const bool latency_[2]);
+
+    //  The batch flushes the pipes it deferred.
+    friend class flush_batch_t;
 
   public:
     //  Specifies the object to send events to.
     void set_event_sink (i_pipe_events *sink_);
 
+    //  Specifies the batch that may defer flushes of this pipe.
+    void set_flush_batch (flush_batch_t *flush_batch_);
+
     //  Pipe endpoint can store an routing ID to be used by its clients.
     void set_server_socket_routing_id (uint32_t server_socket_routing_id_);
     uint32_t get_server_socket_routing_id () const;
@@ -113,7 +158,8 @@ class pipe_t ZMQ_FINAL : public object_t,
     //  Remove unfinished parts of the outbound message from the pipe.
     void rollback () const;
 
-    //  Flush the messages downstream.
+    //  Flush the messages downstream, unless the flush batch of the pipe
+    //  is active.
     void flush ();
 
     //  Temporarily disconnects the inbound message stream and drops
@@ -163,7 +209,8 @@ class pipe_t ZMQ_FINAL : public object_t,
     void
     process_pipe_peer_stats (uint64_t queue_count_,
                              own_t *socket_base_,
-                             endpoint_uri_pair_t *endpoint_pair_) ZMQ_OVERRIDE;
+                             endpoint_uri_pair_t *endpoint_pair_,
+                             uint64_t *latency_) ZMQ_OVERRIDE;
     void process_pipe_term () ZMQ_OVERRIDE;
     void process_pipe_term_ack () ZMQ_OVERRIDE;
     void process_pipe_hwm (int inhwm_, int outhwm_) ZMQ_OVERRIDE;
@@ -178,7 +225,8 @@ class pipe_t ZMQ_FINAL : public object_t,
             upipe_t *outpipe_,
             int inhwm_,
             int outhwm_,
-            bool conflate_);
+            bool conflate_,
+            latency_histogram_t *latency_);
 
     //  Pipepair uses this function to let us know about
     //  the peer pipe object.
@@ -187,10 +235,20 @@ class pipe_t ZMQ_FINAL : public object_t,
     //  Destructor is private. Pipe objects destroy themselves.
     ~pipe_t () ZMQ_OVERRIDE;
 
+    //  Type of the underlying pipe recording the latency of messages.
+    typedef ypipe_stamped_t<msg_t, message_pipe_granularity> upipe_stamped_t;
+
+    //  Creates the underlying pipe for messages flowing towards this end.
+    upipe_t *new_in_pipe () const;
+
     //  Underlying pipes for both directions.
     upipe_t *_in_pipe;
     upipe_t *_out_pipe;
 
+    //  Time the messages read from the pipe spent in transit, if the
+    //  inbound pipe records it.
+    latency_histogram_t *_latency;
+
     //  Can the pipe be read from / written to?
     bool _in_active;
     bool _out_active;
@@ -219,6 +277,13 @@ class pipe_t ZMQ_FINAL : public object_t,
     //  Sink to send events to.
     i_pipe_events *_sink;
 
+    //  Batch deferring our flushes, if any, and whether it holds one.
+    flush_batch_t *_flush_batch;
+    bool _flush_pending;
+
+    //  Flushes the messages downstream regardless of the flush batch.
+    void flush_now ();
+
     //  States of the pipe endpoint:
     //  active: common state before any termination begins,
     //  delimiter_received: delimiter was read from pipe before
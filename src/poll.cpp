@@ -158,6 +158,7 @@ void zmq::poll_t::loop ()
             errno_assert (errno == EINTR);
             continue;
         }
+        update_clock ();
 
         //  If there are no events (i.e. it's a timeout) there's no point
         //  in checking the pollset.
@@ -32,6 +32,10 @@
 #include "i_poll_events.hpp"
 #include "err.hpp"
 
+zmq::poller_base_t::poller_base_t () : _now (_clock.now_ms ())
+{
+}
+
 zmq::poller_base_t::~poller_base_t ()
 {
     //  Make sure there is no more load on the shutdown.
@@ -51,31 +55,34 @@ void zmq::poller_base_t::adjust_load (int amount_)
         _load.sub (-amount_);
 }
 
-void zmq::poller_base_t::add_timer (int timeout_, i_poll_events *sink_, int id_)
+zmq::poller_base_t::timer_handle_t
+zmq::poller_base_t::add_timer (int timeout_, i_poll_events *sink_, int id_)
+{
+    const timer_info_t info = {sink_, id_};
+    return _timers.add (_now, timeout_ > 0 ? timeout_ : 0, info);
+}
+
+void zmq::poller_base_t::cancel_timer (timer_handle_t handle_)
+{
+    //  Cancelling an expired or cancelled timer does nothing. As described
+    //  in issue #3645, `timer_event ()` call from `execute_timers ()` might
+    //  call `cancel_timer ()` on an already cancelled timer.
+    _timers.cancel (handle_);
+}
+
+bool zmq::poller_base_t::timer_pending (timer_handle_t handle_) const
 {
-    uint64_t expiration = _clock.now_ms () + timeout_;
-    timer_info_t info = {sink_, id_};
-    _timers.insert (timers_t::value_type (expiration, info));
+    return _timers.pending (handle_);
 }
 
-void zmq::poller_base_t::cancel_timer (i_poll_events *sink_, int id_)
+uint64_t zmq::poller_base_t::now_ms () const
 {
-    //  Complexity of this operation is O(n). We assume it is rarely used.
-    for (timers_t::iterator it = _timers.begin (), end = _timers.end ();
-         it != end; ++it)
-        if (it->second.sink == sink_ && it->second.id == id_) {
-            _timers.erase (it);
-            return;
-        }
-
-    //  We should generally never get here. Calling 'cancel_timer ()' on
-    //  an already expired or canceled timer (or even worse - on a timer which
-    //  never existed, supplying bad sink_ and/or id_ values) does not make any
-    //  sense.
-    //  But in some edge cases this might happen. As described in issue #3645
-    //  `timer_event ()` call from `execute_timers ()` might call `cancel_timer ()`
-    //  on already canceled (deleted) timer.
-    //  As soon as that is resolved an 'assert (false)' should be put here.
+    return _now;
+}
+
+void zmq::poller_base_t::update_clock ()
+{
+    _now = _clock.now_ms ();
 }
 
 uint64_t zmq::poller_base_t::execute_timers ()
@@ -85,37 +92,23 @@ uint64_t zmq::poller_base_t::execute_timers ()
         return 0;
 
     //  Get the current time.
-    const uint64_t current = _clock.now_ms ();
+    update_clock ();
+    const uint64_t current = _now;
 
     //  Execute the timers that are already due.
-    uint64_t res = 0;
-    timer_info_t timer_temp;
-    timers_t::iterator it;
-
-    do {
-        it = _timers.begin ();
-
-        //  If we have to wait to execute the item, same will be true for
-        //  all the following items because multimap is sorted. Thus we can
-        //  stop checking the subsequent timers.
-        if (it->first > current) {
-            res = it->first - current;
-            break;
-        }
-
-        //  Save and remove the timer because timer_event() call might delete
-        //  exactly this timer and then the iterator will be invalid.
-        timer_temp = it->second;
-        _timers.erase (it);
-
-        //  Trigger the timer.
-        timer_temp.sink->timer_event (timer_temp.id);
-
-    } while (!_timers.empty ());
+    timers_t::handle_t handle;
+    timer_info_t info;
+    while (_timers.pop (current, &handle, &info)) {
+        //  Release the timer before triggering it, so that the handle is
+        //  stale should timer_event() try to cancel it.
+        _timers.cancel (handle);
+        info.sink->timer_event (info.id);
+    }
 
     //  Return the time to wait for the next timer (at least 1ms), or 0, if
     //  there are no more timers.
-    return res;
+    const int64_t res = _timers.timeout (current);
+    return res > 0 ? static_cast<uint64_t> (res) : 0;
 }
 
 zmq::worker_poller_base_t::worker_poller_base_t (const thread_ctx_t &ctx_) :
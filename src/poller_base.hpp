@@ -30,11 +30,10 @@
 #ifndef __ZMQ_POLLER_BASE_HPP_INCLUDED__
 #define __ZMQ_POLLER_BASE_HPP_INCLUDED__
 
-#include <map>
-
 #include "clock.hpp"
 #include "atomic_counter.hpp"
 #include "ctx.hpp"
+#include "timer_wheel.hpp"
 
 namespace zmq
 {
@@ -44,8 +43,8 @@ struct i_poll_events;
 // convention, this is done via a typedef.
 //
 // At the time of writing, the following implementations of the poller_t
-// concept exist: zmq::devpoll_t, zmq::epoll_t, zmq::kqueue_t, zmq::poll_t,
-// zmq::pollset_t, zmq::select_t
+// concept exist: zmq::devpoll_t, zmq::epoll_t, zmq::io_uring_t, zmq::kqueue_t,
+// zmq::poll_t, zmq::pollset_t, zmq::select_t
 //
 // An implementation of the poller_t concept must provide the following public
 // methods:
@@ -54,11 +53,19 @@ struct i_poll_events;
 //
 //   Add a timeout to expire in timeout_ milliseconds. After the
 //   expiration, timer_event on sink_ object will be called with
-//   argument set to id_.
-// void add_timer(int timeout_, zmq::i_poll_events *sink_, int id_);
+//   argument set to id_. Returns a handle to cancel the timer with.
+// timer_handle_t add_timer(int timeout_, zmq::i_poll_events *sink_, int id_);
+//
+//   Cancel the timer with the given handle. Does nothing if the timer
+//   has expired or was cancelled already.
+// void cancel_timer(timer_handle_t handle_);
 //
-//   Cancel the timer created by sink_ object with ID equal to id_.
-// void cancel_timer(zmq::i_poll_events *sink_, int id_);
+//   Returns whether the timer with the given handle is still to expire.
+// bool timer_pending(timer_handle_t handle_) const;
+//
+//   Returns the time in milliseconds the poller was last woken up at.
+//   Timeouts passed to add_timer are relative to this time.
+// uint64_t now_ms() const;
 //
 //   Adds a fd to the poller. Initially, no events are activated. These must
 //   be activated by the set_* methods using the returned handle_.
@@ -122,18 +129,31 @@ struct i_poll_events;
 class poller_base_t
 {
   public:
-    poller_base_t () ZMQ_DEFAULT;
+    poller_base_t ();
     virtual ~poller_base_t ();
 
+    typedef uint64_t timer_handle_t;
+
     // Methods from the poller concept.
     int get_load () const;
-    void add_timer (int timeout_, zmq::i_poll_events *sink_, int id_);
-    void cancel_timer (zmq::i_poll_events *sink_, int id_);
+    timer_handle_t
+    add_timer (int timeout_, zmq::i_poll_events *sink_, int id_);
+    void cancel_timer (timer_handle_t handle_);
+    bool timer_pending (timer_handle_t handle_) const;
+
+    //  Returns the time in milliseconds as of the last update_clock.
+    //  Timeouts set from event handlers can use it instead of reading
+    //  the clock anew for each of them.
+    uint64_t now_ms () const;
 
   protected:
     //  Called by individual poller implementations to manage the load.
     void adjust_load (int amount_);
 
+    //  Refreshes the time returned by now_ms. Called by individual poller
+    //  implementations once they are woken up, before handling the events.
+    void update_clock ();
+
     //  Executes any timers that are due. Returns number of milliseconds
     //  to wait to match the next timer or 0 meaning "no timers".
     uint64_t execute_timers ();
@@ -142,13 +162,16 @@ class poller_base_t
     //  Clock instance private to this I/O thread.
     clock_t _clock;
 
-    //  List of active timers.
+    //  Time of the last update_clock call, in milliseconds.
+    uint64_t _now;
+
+    //  Active timers.
     struct timer_info_t
     {
         zmq::i_poll_events *sink;
         int id;
     };
-    typedef std::multimap<uint64_t, timer_info_t> timers_t;
+    typedef timer_wheel_t<timer_info_t> timers_t;
     timers_t _timers;
 
     //  Load of the poller. Currently the number of file descriptors
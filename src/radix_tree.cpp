@@ -37,6 +37,20 @@
 #include <iterator>
 #include <vector>
 
+#if defined __AVX2__
+#define ZMQ_RADIX_TREE_AVX2
+#define ZMQ_RADIX_TREE_SSE2
+#include <immintrin.h>
+#elif defined __SSE2__ || defined _M_X64                                       \
+  || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#define ZMQ_RADIX_TREE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined ZMQ_RADIX_TREE_SSE2 && defined _MSC_VER
+#include <intrin.h>
+#endif
+
 node_t::node_t (unsigned char *data_) : _data (data_)
 {
 }
@@ -109,6 +123,69 @@ void node_t::set_first_byte_at (size_t index_, unsigned char byte_)
     first_bytes ()[index_] = byte_;
 }
 
+#if defined ZMQ_RADIX_TREE_SSE2
+static size_t lowest_bit (unsigned int mask_)
+{
+#if defined _MSC_VER
+    unsigned long index;
+    _BitScanForward (&index, mask_);
+    return index;
+#else
+    return __builtin_ctz (mask_);
+#endif
+}
+#endif
+
+size_t node_t::edge_index (unsigned char byte_)
+{
+    const unsigned char *const bytes = first_bytes ();
+    const size_t count = edgecount ();
+    size_t i = 0;
+
+    // The first bytes are distinct, so the first byte equal to byte_ is the
+    // only one. Nodes with many children, typically those near the root,
+    // are scanned a vector of first bytes at a time, the last vector
+    // overlapping the previous one rather than reading past the end.
+#if defined ZMQ_RADIX_TREE_AVX2
+    if (count >= 32) {
+        const __m256i needle = _mm256_set1_epi8 (static_cast<char> (byte_));
+        for (;; i += 32) {
+            if (i + 32 > count)
+                i = count - 32;
+            const __m256i block = _mm256_loadu_si256 (
+              reinterpret_cast<const __m256i *> (bytes + i));
+            const unsigned int mask = static_cast<unsigned int> (
+              _mm256_movemask_epi8 (_mm256_cmpeq_epi8 (block, needle)));
+            if (mask)
+                return i + lowest_bit (mask);
+            if (i + 32 == count)
+                return count;
+        }
+    }
+#endif
+#if defined ZMQ_RADIX_TREE_SSE2
+    if (count >= 16) {
+        const __m128i needle = _mm_set1_epi8 (static_cast<char> (byte_));
+        for (;; i += 16) {
+            if (i + 16 > count)
+                i = count - 16;
+            const __m128i block =
+              _mm_loadu_si128 (reinterpret_cast<const __m128i *> (bytes + i));
+            const unsigned int mask = static_cast<unsigned int> (
+              _mm_movemask_epi8 (_mm_cmpeq_epi8 (block, needle)));
+            if (mask)
+                return i + lowest_bit (mask);
+            if (i + 16 == count)
+                return count;
+        }
+    }
+#endif
+    for (; i < count; ++i)
+        if (bytes[i] == byte_)
+            return i;
+    return count;
+}
+
 unsigned char *node_t::node_pointers ()
 {
     return prefix () + prefix_length () + edgecount ();
@@ -153,25 +230,41 @@ bool node_t::operator!= (node_t other_) const
     return !(*this == other_);
 }
 
-void node_t::resize (size_t prefix_length_, size_t edgecount_)
+static size_t node_size (size_t prefix_length_, size_t edgecount_)
+{
+    return 3 * sizeof (uint32_t) + prefix_length_
+           + edgecount_ * (1 + sizeof (void *));
+}
+
+size_t node_t::size ()
 {
-    const size_t node_size = 3 * sizeof (uint32_t) + prefix_length_
-                             + edgecount_ * (1 + sizeof (void *));
-    unsigned char *new_data =
-      static_cast<unsigned char *> (realloc (_data, node_size));
-    zmq_assert (new_data);
-    _data = new_data;
+    return node_size (prefix_length (), edgecount ());
+}
+
+void node_t::resize (node_arena_t &arena_,
+                     size_t prefix_length_,
+                     size_t edgecount_)
+{
+    // Like realloc, keep the contents up to the smaller of both sizes.
+    const size_t old_size = size ();
+    const size_t new_size = node_size (prefix_length_, edgecount_);
+    if (!node_arena_t::same_block (old_size, new_size)) {
+        unsigned char *new_data = arena_.allocate (new_size);
+        memcpy (new_data, _data, old_size < new_size ? old_size : new_size);
+        arena_.deallocate (_data, old_size);
+        _data = new_data;
+    }
     set_prefix_length (static_cast<uint32_t> (prefix_length_));
     set_edgecount (static_cast<uint32_t> (edgecount_));
 }
 
-node_t make_node (size_t refcount_, size_t prefix_length_, size_t edgecount_)
+node_t make_node (node_arena_t &arena_,
+                  size_t refcount_,
+                  size_t prefix_length_,
+                  size_t edgecount_)
 {
-    const size_t node_size = 3 * sizeof (uint32_t) + prefix_length_
-                             + edgecount_ * (1 + sizeof (void *));
-
-    unsigned char *data = static_cast<unsigned char *> (malloc (node_size));
-    zmq_assert (data);
+    unsigned char *data =
+      arena_.allocate (node_size (prefix_length_, edgecount_));
 
     node_t node (data);
     node.set_refcount (static_cast<uint32_t> (refcount_));
@@ -182,15 +275,83 @@ node_t make_node (size_t refcount_, size_t prefix_length_, size_t edgecount_)
 
 // ----------------------------------------------------------------------
 
-zmq::radix_tree_t::radix_tree_t () : _root (make_node (0, 0, 0)), _size (0)
+node_arena_t::node_arena_t () : _chunk_pos (NULL), _chunk_left (0)
+{
+    memset (_free_blocks, 0, sizeof _free_blocks);
+}
+
+node_arena_t::~node_arena_t ()
+{
+    for (size_t i = 0, count = _chunks.size (); i < count; ++i)
+        free (_chunks[i]);
+}
+
+bool node_arena_t::same_block (size_t size1_, size_t size2_)
+{
+    if (size1_ > max_block_size || size2_ > max_block_size)
+        return false;
+    return (size1_ - 1) / block_align == (size2_ - 1) / block_align;
+}
+
+unsigned char *node_arena_t::allocate (size_t size_)
+{
+    unsigned char *data;
+    if (size_ > max_block_size) {
+        data = static_cast<unsigned char *> (malloc (size_));
+        alloc_assert (data);
+        return data;
+    }
+
+    // Released blocks hold the link to the next free block of their size.
+    const size_t index = (size_ - 1) / block_align;
+    data = _free_blocks[index];
+    if (data) {
+        memcpy (&_free_blocks[index], data, sizeof (data));
+        return data;
+    }
+
+    // The remainder of a chunk too small for the block is left unused.
+    const size_t block_size = (index + 1) * block_align;
+    if (_chunk_left < block_size) {
+        _chunk_pos = static_cast<unsigned char *> (malloc (chunk_size));
+        alloc_assert (_chunk_pos);
+        _chunks.push_back (_chunk_pos);
+        _chunk_left = chunk_size;
+    }
+    data = _chunk_pos;
+    _chunk_pos += block_size;
+    _chunk_left -= block_size;
+    return data;
+}
+
+void node_arena_t::deallocate (unsigned char *data_, size_t size_)
+{
+    if (size_ > max_block_size) {
+        free (data_);
+        return;
+    }
+    const size_t index = (size_ - 1) / block_align;
+    memcpy (data_, &_free_blocks[index], sizeof (data_));
+    _free_blocks[index] = data_;
+}
+
+// ----------------------------------------------------------------------
+
+zmq::radix_tree_t::radix_tree_t () :
+    _root (make_node (_arena, 0, 0, 0)), _size (0)
 {
 }
 
-static void free_nodes (node_t node_)
+void zmq::radix_tree_t::free_node (node_t node_)
+{
+    _arena.deallocate (node_._data, node_.size ());
+}
+
+void zmq::radix_tree_t::free_nodes (node_t node_)
 {
     for (size_t i = 0, count = node_.edgecount (); i < count; ++i)
         free_nodes (node_.node_at (i));
-    free (node_._data);
+    free_node (node_);
 }
 
 zmq::radix_tree_t::~radix_tree_t ()
@@ -260,19 +421,12 @@ match_result_t zmq::radix_tree_t::match (const unsigned char *key_,
 
         // We need to match the rest of the key. Check if there's an
         // outgoing edge from this node.
-        node_t next_node = current_node;
-        for (size_t i = 0, edgecount = current_node.edgecount (); i < edgecount;
-             ++i) {
-            if (current_node.first_byte_at (i) == key_[key_byte_index]) {
-                parent_edge_index = edge_index;
-                edge_index = i;
-                next_node = current_node.node_at (i);
-                break;
-            }
-        }
-
-        if (next_node == current_node)
+        const size_t i = current_node.edge_index (key_[key_byte_index]);
+        if (i == current_node.edgecount ())
             break; // No outgoing edge.
+        parent_edge_index = edge_index;
+        edge_index = i;
+        const node_t next_node = current_node.node_at (i);
         grandparent_node = parent_node;
         parent_node = current_node;
         current_node = next_node;
@@ -298,11 +452,12 @@ bool zmq::radix_tree_t::add (const unsigned char *key_, size_t key_size_)
             // The mismatch is at one of the outgoing edges, so we
             // create an edge from the current node to a new leaf node
             // that has the rest of the key as the prefix.
-            node_t key_node = make_node (1, key_size_ - key_bytes_matched, 0);
+            node_t key_node =
+              make_node (_arena, 1, key_size_ - key_bytes_matched, 0);
             key_node.set_prefix (key_ + key_bytes_matched);
 
             // Reallocate for one more edge.
-            current_node.resize (current_node.prefix_length (),
+            current_node.resize (_arena, current_node.prefix_length (),
                                  current_node.edgecount () + 1);
 
             // Make room for the new edge. We need to shift the chunk
@@ -336,9 +491,10 @@ bool zmq::radix_tree_t::add (const unsigned char *key_, size_t key_size_)
         // One node will have the rest of the characters from the key,
         // and the other node will have the rest of the characters
         // from the current node's prefix.
-        node_t key_node = make_node (1, key_size_ - key_bytes_matched, 0);
+        node_t key_node =
+          make_node (_arena, 1, key_size_ - key_bytes_matched, 0);
         node_t split_node =
-          make_node (current_node.refcount (),
+          make_node (_arena, current_node.refcount (),
                      current_node.prefix_length () - prefix_bytes_matched,
                      current_node.edgecount ());
 
@@ -354,7 +510,7 @@ bool zmq::radix_tree_t::add (const unsigned char *key_, size_t key_size_)
         // the matched characters and 2 outgoing edges to the above
         // nodes. Set the refcount to 0 since this node doesn't hold a
         // key.
-        current_node.resize (prefix_bytes_matched, 2);
+        current_node.resize (_arena, prefix_bytes_matched, 2);
         current_node.set_refcount (0);
 
         // Add links to the new nodes. We don't need to copy the
@@ -376,7 +532,7 @@ bool zmq::radix_tree_t::add (const unsigned char *key_, size_t key_size_)
         // the current node's prefix and the outgoing edges from the
         // current node.
         node_t split_node =
-          make_node (current_node.refcount (),
+          make_node (_arena, current_node.refcount (),
                      current_node.prefix_length () - prefix_bytes_matched,
                      current_node.edgecount ());
         split_node.set_prefix (current_node.prefix () + prefix_bytes_matched);
@@ -385,7 +541,7 @@ bool zmq::radix_tree_t::add (const unsigned char *key_, size_t key_size_)
 
         // Resize the current node to hold only the matched characters
         // from its prefix and one edge to the new node.
-        current_node.resize (prefix_bytes_matched, 1);
+        current_node.resize (_arena, prefix_bytes_matched, 1);
 
         // Add an edge to the split node and set the refcount to 1
         // since this key wasn't inserted earlier. We don't need to
@@ -446,7 +602,7 @@ bool zmq::radix_tree_t::rm (const unsigned char *key_, size_t key_size_)
         // keep the old prefix length since resize() will overwrite
         // it.
         const uint32_t old_prefix_length = current_node.prefix_length ();
-        current_node.resize (old_prefix_length + child.prefix_length (),
+        current_node.resize (_arena, old_prefix_length + child.prefix_length (),
                              child.edgecount ());
 
         // Append the child node's prefix to the current node.
@@ -458,7 +614,7 @@ bool zmq::radix_tree_t::rm (const unsigned char *key_, size_t key_size_)
         current_node.set_node_pointers (child.node_pointers ());
         current_node.set_refcount (child.refcount ());
 
-        free (child._data);
+        free_node (child);
         parent_node.set_node_at (edge_index, current_node);
         return true;
     }
@@ -475,7 +631,8 @@ bool zmq::radix_tree_t::rm (const unsigned char *key_, size_t key_size_)
         // keep the old prefix length since resize() will overwrite
         // it.
         const uint32_t old_prefix_length = parent_node.prefix_length ();
-        parent_node.resize (old_prefix_length + other_child.prefix_length (),
+        parent_node.resize (_arena,
+                            old_prefix_length + other_child.prefix_length (),
                             other_child.edgecount ());
 
         // Append the child node's prefix to the current node.
@@ -487,8 +644,8 @@ bool zmq::radix_tree_t::rm (const unsigned char *key_, size_t key_size_)
         parent_node.set_node_pointers (other_child.node_pointers ());
         parent_node.set_refcount (other_child.refcount ());
 
-        free (current_node._data);
-        free (other_child._data);
+        free_node (current_node);
+        free_node (other_child);
         grandparent_node.set_node_at (parent_edge_index, parent_node);
         return true;
     }
@@ -514,11 +671,11 @@ bool zmq::radix_tree_t::rm (const unsigned char *key_, size_t key_size_)
 
     // Shrink the parent node to the new size, which "deletes" the
     // last pointer in the chunk of node pointers.
-    parent_node.resize (parent_node.prefix_length (),
+    parent_node.resize (_arena, parent_node.prefix_length (),
                         parent_node.edgecount () - 1);
 
     // Nothing points to this node now, so we can reclaim it.
-    free (current_node._data);
+    free_node (current_node);
 
     if (parent_node.prefix_length () == 0)
         _root._data = parent_node._data;
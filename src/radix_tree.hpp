@@ -31,9 +31,44 @@
 #define RADIX_TREE_HPP
 
 #include <stddef.h>
+#include <vector>
 
+#include "macros.hpp"
 #include "stdint.hpp"
 
+// Allocator for the nodes of a tree. Nodes are carved out of large chunks,
+// rounded up to a multiple of 8 bytes, and kept on a free list per size
+// once released, so that the nodes of a tree are packed together rather
+// than scattered across the heap, each with malloc's overhead. The rare
+// nodes larger than max_block_size are allocated with malloc.
+class node_arena_t
+{
+  public:
+    node_arena_t ();
+    ~node_arena_t ();
+
+    unsigned char *allocate (size_t size_);
+    void deallocate (unsigned char *data_, size_t size_);
+
+    // Whether a block allocated for size1_ bytes can hold size2_ bytes.
+    static bool same_block (size_t size1_, size_t size2_);
+
+  private:
+    enum
+    {
+        block_align = 8,
+        max_block_size = 512,
+        chunk_size = 64 * 1024
+    };
+
+    unsigned char *_free_blocks[max_block_size / block_align];
+    std::vector<unsigned char *> _chunks;
+    unsigned char *_chunk_pos;
+    size_t _chunk_left;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (node_arena_t)
+};
+
 // Wrapper type for a node's data layout.
 //
 // There are 3 32-bit unsigned integers that act as a header. These
@@ -73,6 +108,8 @@ struct node_t
     unsigned char *prefix ();
     unsigned char *first_bytes ();
     unsigned char first_byte_at (size_t index_);
+    // Index of the edge whose first byte is byte_, or edgecount ().
+    size_t edge_index (unsigned char byte_);
     unsigned char *node_pointers ();
     node_t node_at (size_t index_);
     void set_refcount (uint32_t value_);
@@ -84,12 +121,17 @@ struct node_t
     void set_node_pointers (const unsigned char *pointers_);
     void set_node_at (size_t index_, node_t node_);
     void set_edge_at (size_t index_, unsigned char first_byte_, node_t node_);
-    void resize (size_t prefix_length_, size_t edgecount_);
+    size_t size ();
+    void
+    resize (node_arena_t &arena_, size_t prefix_length_, size_t edgecount_);
 
     unsigned char *_data;
 };
 
-node_t make_node (size_t refcount_, size_t prefix_length_, size_t edgecount_);
+node_t make_node (node_arena_t &arena_,
+                  size_t refcount_,
+                  size_t prefix_length_,
+                  size_t edgecount_);
 
 struct match_result_t
 {
@@ -139,8 +181,14 @@ class radix_tree_t
     match_result_t
     match (const unsigned char *key_, size_t key_size_, bool is_lookup_) const;
 
+    void free_node (node_t node_);
+    void free_nodes (node_t node_);
+
+    node_arena_t _arena;
     node_t _root;
     size_t _size;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (radix_tree_t)
 };
 }
 
@@ -34,7 +34,9 @@
 #include "raw_decoder.hpp"
 #include "err.hpp"
 
-zmq::raw_decoder_t::raw_decoder_t (size_t bufsize_) : _allocator (bufsize_, 1)
+zmq::raw_decoder_t::raw_decoder_t (size_t bufsize_,
+                                   decoder_buffer_pool_t *pool_) :
+    _allocator (bufsize_, 1, pool_)
 {
     const int rc = _in_progress.init ();
     errno_assert (rc == 0);
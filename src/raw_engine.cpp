@@ -81,7 +81,8 @@ void zmq::raw_engine_t::plug_internal ()
     _encoder = new (std::nothrow) raw_encoder_t (_options.out_batch_size);
     alloc_assert (_encoder);
 
-    _decoder = new (std::nothrow) raw_decoder_t (_options.in_batch_size);
+    _decoder = new (std::nothrow)
+      raw_decoder_t (_options.in_batch_size, _decoder_buffer_pool);
     alloc_assert (_decoder);
 
     _next_msg = &raw_engine_t::pull_msg_from_session;
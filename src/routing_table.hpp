@@ -0,0 +1,256 @@
+/*
+    Copyright (c) 2007-2016 Contributors as noted in the AUTHORS file
+
+    This file is part of libzmq, the ZeroMQ core engine in C++.
+
+    libzmq is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License (LGPL) as published
+    by the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    As a special exception, the Contributors give you permission to link
+    this library with independent modules to produce an executable,
+    regardless of the license terms of these independent modules, and to
+    copy and distribute the resulting executable under terms of your choice,
+    provided that you also meet, for each linked independent module, the
+    terms and conditions of the license of that module. An independent
+    module is a module which is not derived from or based on this library.
+    If you modify this library, you must extend this exception to your
+    version of the library.
+
+    libzmq is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __ZMQ_ROUTING_TABLE_HPP_INCLUDED__
+#define __ZMQ_ROUTING_TABLE_HPP_INCLUDED__
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "blob.hpp"
+#include "err.hpp"
+#include "macros.hpp"
+#include "random.hpp"
+#include "stdint.hpp"
+
+namespace zmq
+{
+//  Hash table mapping routing ids to values of type T, used by the
+//  routing sockets to find the pipe of a peer on every send.
+//
+//  Collisions are resolved by linear probing, and an erased entry is
+//  filled by shifting back the rest of its cluster, so lookups never
+//  have to skip over tombstones. Ids of up to inline_id_size bytes,
+//  which include the ids ROUTER generates itself, are stored in the
+//  slot; longer ids are allocated. The hash is seeded per table so
+//  that peers choosing their own routing ids cannot force collisions.
+//
+//  T is copied around when the table is resized and must be cheap to
+//  copy. Inserting or erasing invalidates pointers to the values.
+
+template <typename T> class routing_table_t
+{
+  public:
+    routing_table_t () : _seed (generate_random ()), _count (0) {}
+
+    ~routing_table_t ()
+    {
+        for (size_t i = 0, n = _slots.size (); i != n; ++i)
+            if (_slots[i].hash)
+                release_id (_slots[i]);
+    }
+
+    size_t size () const { return _count; }
+
+    bool empty () const { return _count == 0; }
+
+    //  Number of slots; iterate over them with at () to visit the values.
+    size_t slots () const { return _slots.size (); }
+
+    //  Returns the value stored in the slot, or NULL if it is free.
+    T *at (size_t slot_)
+    {
+        return _slots[slot_].hash ? &_slots[slot_].value : NULL;
+    }
+
+    //  Returns the value stored for the id, or NULL if there is none.
+    T *find (const blob_t &id_)
+    {
+        const size_t slot = lookup (id_, hash (id_));
+        return slot == npos ? NULL : &_slots[slot].value;
+    }
+
+    const T *find (const blob_t &id_) const
+    {
+        const size_t slot = lookup (id_, hash (id_));
+        return slot == npos ? NULL : &_slots[slot].value;
+    }
+
+    //  Stores a copy of the id and the value. Returns false, leaving the
+    //  table unchanged, if the id is already present.
+    bool insert (const blob_t &id_, const T &value_)
+    {
+        const uint32_t h = hash (id_);
+        if (lookup (id_, h) != npos)
+            return false;
+        if ((_count + 1) * 4 > _slots.size () * 3)
+            rehash (_slots.empty () ? min_slots : _slots.size () * 2);
+
+        slot_t &slot = _slots[free_slot (h)];
+        slot.hash = h;
+        slot.size = static_cast<uint32_t> (id_.size ());
+        zmq_assert (slot.size == id_.size ());
+        unsigned char *data = slot.id.bytes;
+        if (id_.size () > inline_id_size) {
+            data = static_cast<unsigned char *> (malloc (id_.size ()));
+            alloc_assert (data);
+            slot.id.ptr = data;
+        }
+        memcpy (data, id_.data (), id_.size ());
+        slot.value = value_;
+        ++_count;
+        return true;
+    }
+
+    //  Removes the id, storing its value into value_ if that is not NULL.
+    //  Returns false if the id is not present.
+    bool erase (const blob_t &id_, T *value_ = NULL)
+    {
+        size_t hole = lookup (id_, hash (id_));
+        if (hole == npos)
+            return false;
+        if (value_)
+            *value_ = _slots[hole].value;
+        release_id (_slots[hole]);
+        --_count;
+
+        //  Move back any entry of the cluster following the hole whose
+        //  home slot does not lie between the hole and the entry itself.
+        const size_t mask = _slots.size () - 1;
+        for (size_t slot = (hole + 1) & mask; _slots[slot].hash;
+             slot = (slot + 1) & mask) {
+            const size_t home = _slots[slot].hash & mask;
+            if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+                _slots[hole] = _slots[slot];
+                hole = slot;
+            }
+        }
+        _slots[hole].hash = 0;
+
+        if (_slots.size () > min_slots && _count * 8 < _slots.size ())
+            rehash (_slots.size () / 2);
+        return true;
+    }
+
+    //  Removes all the entries.
+    void clear ()
+    {
+        for (size_t i = 0, n = _slots.size (); i != n; ++i)
+            if (_slots[i].hash)
+                release_id (_slots[i]);
+        _slots.clear ();
+        _count = 0;
+    }
+
+  private:
+    enum
+    {
+        inline_id_size = 16,
+        min_slots = 16
+    };
+
+    static const size_t npos = static_cast<size_t> (-1);
+
+    struct slot_t
+    {
+        //  Hash of the id, never 0 for an entry; 0 marks a free slot.
+        uint32_t hash;
+        uint32_t size;
+        union
+        {
+            unsigned char bytes[inline_id_size];
+            unsigned char *ptr;
+        } id;
+        T value;
+    };
+
+    static const unsigned char *id_data (const slot_t &slot_)
+    {
+        return slot_.size > inline_id_size ? slot_.id.ptr : slot_.id.bytes;
+    }
+
+    static void release_id (slot_t &slot_)
+    {
+        if (slot_.size > inline_id_size)
+            free (slot_.id.ptr);
+    }
+
+    //  Seeded FNV-1a followed by the murmur3 finalizer, so that the low
+    //  bits used to pick the home slot depend on every byte of the id.
+    uint32_t hash (const blob_t &id_) const
+    {
+        uint32_t h = 2166136261u ^ _seed;
+        const unsigned char *data = id_.data ();
+        for (size_t i = 0, n = id_.size (); i != n; ++i) {
+            h ^= data[i];
+            h *= 16777619u;
+        }
+        h ^= h >> 16;
+        h *= 0x85ebca6bu;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35u;
+        h ^= h >> 16;
+        return h ? h : 1;
+    }
+
+    size_t lookup (const blob_t &id_, uint32_t hash_) const
+    {
+        if (_count == 0)
+            return npos;
+        const size_t mask = _slots.size () - 1;
+        for (size_t slot = hash_ & mask; _slots[slot].hash;
+             slot = (slot + 1) & mask) {
+            const slot_t &s = _slots[slot];
+            if (s.hash == hash_ && s.size == id_.size ()
+                && memcmp (id_data (s), id_.data (), s.size) == 0)
+                return slot;
+        }
+        return npos;
+    }
+
+    size_t free_slot (uint32_t hash_) const
+    {
+        const size_t mask = _slots.size () - 1;
+        size_t slot = hash_ & mask;
+        while (_slots[slot].hash)
+            slot = (slot + 1) & mask;
+        return slot;
+    }
+
+    //  Moves the entries into a table of the given size, a power of two.
+    //  The ids are owned by the entries, so they are moved along as is.
+    void rehash (size_t slots_)
+    {
+        std::vector<slot_t> old (slots_);
+        old.swap (_slots);
+        for (size_t i = 0, n = old.size (); i != n; ++i)
+            if (old[i].hash)
+                _slots[free_slot (old[i].hash)] = old[i];
+    }
+
+    const uint32_t _seed;
+    size_t _count;
+    std::vector<slot_t> _slots;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (routing_table_t)
+};
+}
+
+#endif
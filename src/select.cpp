@@ -441,6 +441,7 @@ void zmq::select_t::select_family_entry (family_entry_t &family_entry_,
         return;
     }
 #endif
+    update_clock ();
 
     trigger_events (fd_entries, local_fds_set, rc);
 
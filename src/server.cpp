@@ -38,7 +38,8 @@
 
 zmq::server_t::server_t (class ctx_t *parent_, uint32_t tid_, int sid_) :
     socket_base_t (parent_, tid_, sid_, true),
-    _next_routing_id (generate_random ())
+    _peers (0),
+    _first_generation (1 + generate_random () % max_generation)
 {
     options.type = ZMQ_SERVER;
     options.can_send_hello_msg = true;
@@ -47,7 +48,7 @@ zmq::server_t::server_t (class ctx_t *parent_, uint32_t tid_, int sid_) :
 
 zmq::server_t::~server_t ()
 {
-    zmq_assert (_out_pipes.empty ());
+    zmq_assert (_peers == 0);
 }
 
 void zmq::server_t::xattach_pipe (pipe_t *pipe_,
@@ -59,26 +60,47 @@ void zmq::server_t::xattach_pipe (pipe_t *pipe_,
 
     zmq_assert (pipe_);
 
-    uint32_t routing_id = _next_routing_id++;
-    if (!routing_id)
-        routing_id = _next_routing_id++; //  Never use Routing ID zero
+    uint32_t index;
+    if (_free_slots.size () > min_free_slots
+        || (_out_pipes.size () == max_slots && !_free_slots.empty ())) {
+        index = _free_slots.front ();
+        _free_slots.pop_front ();
+        outpipe_t &slot = _out_pipes[index];
+        slot.generation =
+          slot.generation == max_generation ? 1 : slot.generation + 1;
+    } else if (_out_pipes.size () < max_slots) {
+        index = static_cast<uint32_t> (_out_pipes.size ());
+        const outpipe_t slot = {NULL, false, _first_generation};
+        _out_pipes.push_back (slot);
+    } else {
+        //  Every routing ID is taken, refuse the peer.
+        pipe_->terminate (false);
+        return;
+    }
 
-    pipe_->set_server_socket_routing_id (routing_id);
     //  Add the record into output pipes lookup table
-    outpipe_t outpipe = {pipe_, true};
-    const bool ok =
-      _out_pipes.ZMQ_MAP_INSERT_OR_EMPLACE (routing_id, outpipe).second;
-    zmq_assert (ok);
+    outpipe_t &slot = _out_pipes[index];
+    slot.pipe = pipe_;
+    slot.active = true;
+    ++_peers;
+    pipe_->set_server_socket_routing_id ((slot.generation << slot_index_bits)
+                                         | index);
 
     _fq.attach (pipe_);
 }
 
 void zmq::server_t::xpipe_terminated (pipe_t *pipe_)
 {
-    const out_pipes_t::iterator it =
-      _out_pipes.find (pipe_->get_server_socket_routing_id ());
-    zmq_assert (it != _out_pipes.end ());
-    _out_pipes.erase (it);
+    const uint32_t routing_id = pipe_->get_server_socket_routing_id ();
+    //  The pipe of a refused peer was never attached.
+    if (!routing_id)
+        return;
+
+    outpipe_t *const slot = lookup_out_pipe (routing_id);
+    zmq_assert (slot && slot->pipe == pipe_);
+    slot->pipe = NULL;
+    --_peers;
+    _free_slots.push_back (routing_id & (max_slots - 1));
     _fq.pipe_terminated (pipe_);
 }
 
@@ -89,15 +111,22 @@ void zmq::server_t::xread_activated (pipe_t *pipe_)
 
 void zmq::server_t::xwrite_activated (pipe_t *pipe_)
 {
-    const out_pipes_t::iterator end = _out_pipes.end ();
-    out_pipes_t::iterator it;
-    for (it = _out_pipes.begin (); it != end; ++it)
-        if (it->second.pipe == pipe_)
-            break;
-
-    zmq_assert (it != _out_pipes.end ());
-    zmq_assert (!it->second.active);
-    it->second.active = true;
+    outpipe_t *const slot =
+      lookup_out_pipe (pipe_->get_server_socket_routing_id ());
+    zmq_assert (slot && slot->pipe == pipe_);
+    zmq_assert (!slot->active);
+    slot->active = true;
+}
+
+zmq::server_t::outpipe_t *zmq::server_t::lookup_out_pipe (uint32_t routing_id_)
+{
+    const uint32_t index = routing_id_ & (max_slots - 1);
+    if (index >= _out_pipes.size ())
+        return NULL;
+    outpipe_t &slot = _out_pipes[index];
+    if (!slot.pipe || slot.generation != routing_id_ >> slot_index_bits)
+        return NULL;
+    return &slot;
 }
 
 int zmq::server_t::xsend (msg_t *msg_)
@@ -108,12 +137,11 @@ int zmq::server_t::xsend (msg_t *msg_)
         return -1;
     }
     //  Find the pipe associated with the routing stored in the message.
-    const uint32_t routing_id = msg_->get_routing_id ();
-    out_pipes_t::iterator it = _out_pipes.find (routing_id);
+    outpipe_t *const slot = lookup_out_pipe (msg_->get_routing_id ());
 
-    if (it != _out_pipes.end ()) {
-        if (!it->second.pipe->check_write ()) {
-            it->second.active = false;
+    if (slot) {
+        if (!slot->pipe->check_write ()) {
+            slot->active = false;
             errno = EAGAIN;
             return -1;
         }
@@ -126,13 +154,13 @@ int zmq::server_t::xsend (msg_t *msg_)
     int rc = msg_->reset_routing_id ();
     errno_assert (rc == 0);
 
-    const bool ok = it->second.pipe->write (msg_);
+    const bool ok = slot->pipe->write (msg_);
     if (unlikely (!ok)) {
         // Message failed to send - we must close it ourselves.
         rc = msg_->close ();
         errno_assert (rc == 0);
     } else
-        it->second.pipe->flush ();
+        slot->pipe->flush ();
 
     //  Detach the message from the data buffer.
     rc = msg_->init ();
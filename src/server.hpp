@@ -30,7 +30,8 @@
 #ifndef __ZMQ_SERVER_HPP_INCLUDED__
 #define __ZMQ_SERVER_HPP_INCLUDED__
 
-#include <map>
+#include <deque>
+#include <vector>
 
 #include "socket_base.hpp"
 #include "session_base.hpp"
@@ -67,19 +68,40 @@ class server_t : public socket_base_t
     //  Fair queueing object for inbound pipes.
     fq_t _fq;
 
+    //  Outbound pipes are kept in a slot map. A routing ID holds the
+    //  index of the peer's slot in its low bits and the generation of
+    //  the slot in its high bits. The generation is bumped every time
+    //  the slot is reused, so that stale routing IDs do not match the
+    //  new peer, and is never zero, so neither is a routing ID.
+    enum
+    {
+        slot_index_bits = 20,
+        max_slots = 1 << slot_index_bits,
+        max_generation = (1 << (32 - slot_index_bits)) - 1,
+        //  Free slots are reused oldest first, and only once there are
+        //  more than this many, so that a routing ID comes back only
+        //  after many other peers came and went.
+        min_free_slots = 1024
+    };
+
     struct outpipe_t
     {
         zmq::pipe_t *pipe;
         bool active;
+        uint32_t generation;
     };
 
-    //  Outbound pipes indexed by the peer IDs.
-    typedef std::map<uint32_t, outpipe_t> out_pipes_t;
-    out_pipes_t _out_pipes;
+    //  Returns the slot of the connected peer with the given routing ID,
+    //  or NULL if there is none.
+    outpipe_t *lookup_out_pipe (uint32_t routing_id_);
+
+    std::vector<outpipe_t> _out_pipes;
+    std::deque<uint32_t> _free_slots;
+    size_t _peers;
 
-    //  Routing IDs are generated. It's a simple increment and wrap-over
-    //  algorithm. This value is the next ID to use (if not used already).
-    uint32_t _next_routing_id;
+    //  Generation of newly created slots, so that routing IDs differ
+    //  between sockets.
+    const uint32_t _first_generation;
 
     ZMQ_NON_COPYABLE_NOR_MOVABLE (server_t)
 };
@@ -47,6 +47,7 @@
 #include "udp_engine.hpp"
 
 #include "ctx.hpp"
+#include "crypto_pool.hpp"
 #include "req.hpp"
 #include "radio.hpp"
 #include "dish.hpp"
@@ -345,6 +346,26 @@ zmq::socket_base_t *zmq::session_base_t::get_socket () const
     return _socket;
 }
 
+bool zmq::session_base_t::offload_crypto_job (crypto_job_t *job_)
+{
+    crypto_pool_t *const pool = get_ctx ()->get_crypto_pool ();
+    if (!pool)
+        return false;
+
+    //  The session must not go away before the job comes back.
+    inc_seqnum ();
+    pool->submit (this, job_);
+    return true;
+}
+
+void zmq::session_base_t::process_crypto_job_done (crypto_job_t *job_)
+{
+    //  The engine that submitted the job may have been replaced or be gone.
+    if (_engine)
+        _engine->crypto_job_done (job_);
+    delete job_;
+}
+
 void zmq::session_base_t::process_plug ()
 {
     if (_active)
@@ -376,7 +397,8 @@ int zmq::session_base_t::zap_connect ()
     pipe_t *new_pipes[2] = {NULL, NULL};
     int hwms[2] = {0, 0};
     bool conflates[2] = {false, false};
-    int rc = pipepair (parents, new_pipes, hwms, conflates);
+    bool latencies[2] = {false, false};
+    int rc = pipepair (parents, new_pipes, hwms, conflates, latencies);
     errno_assert (rc == 0);
 
     //  Attach local end of the pipe to this socket object.
@@ -430,7 +452,8 @@ void zmq::session_base_t::engine_ready ()
         int hwms[2] = {conflate ? -1 : options.rcvhwm,
                        conflate ? -1 : options.sndhwm};
         bool conflates[2] = {conflate, conflate};
-        const int rc = pipepair (parents, pipes, hwms, conflates);
+        bool latencies[2] = {options.latency_stats, options.latency_stats};
+        const int rc = pipepair (parents, pipes, hwms, conflates, latencies);
         errno_assert (rc == 0);
 
         //  Plug the local end of the pipe.
@@ -634,10 +657,16 @@ void zmq::session_base_t::start_connecting (bool wait_)
                                            options.socks_proxy_password);
             }
         } else {
-            connecter = new (std::nothrow)
-              tcp_connecter_t (io_thread, this, options, _addr, wait_);
+            connecter = new (std::nothrow) tcp_connecter_t (
+              io_thread, this, options, _addr, wait_, false, std::string ());
         }
     }
+#if defined ZMQ_HAVE_TLS
+    else if (_addr->protocol == protocol_name::tls) {
+        connecter = new (std::nothrow) tcp_connecter_t (
+          io_thread, this, options, _addr, wait_, true, _wss_hostname);
+    }
+#endif
 #if defined ZMQ_HAVE_IPC
     else if (_addr->protocol == protocol_name::ipc) {
         connecter = new (std::nothrow)
@@ -93,6 +93,11 @@ class session_base_t : public own_t, public io_object_t, public i_pipe_events
     //  The function takes ownership of the message.
     int write_zap_msg (msg_t *msg_);
 
+    //  Hands the job to the context's crypto pool; it is passed back to
+    //  the engine through crypto_job_done once it has run. Returns false,
+    //  leaving the job with the caller, if the context has no crypto pool.
+    bool offload_crypto_job (crypto_job_t *job_);
+
     socket_base_t *get_socket () const;
     const endpoint_uri_pair_t &get_endpoint () const;
 
@@ -114,6 +119,7 @@ class session_base_t : public own_t, public io_object_t, public i_pipe_events
     void process_attach (zmq::i_engine *engine_) ZMQ_FINAL;
     void process_term (int linger_) ZMQ_FINAL;
     void process_conn_failed () ZMQ_OVERRIDE;
+    void process_crypto_job_done (crypto_job_t *job_) ZMQ_FINAL;
 
     //  i_poll_events handlers.
     void timer_event (int id_) ZMQ_FINAL;
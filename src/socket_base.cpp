@@ -250,6 +250,8 @@ zmq::socket_base_t::socket_base_t (ctx_t *parent_,
     _handle (static_cast<poller_t::handle_t> (NULL)),
     _last_tsc (0),
     _ticks (0),
+    _deferred_msgs (0),
+    _deferred_bytes (0),
     _rcvmore (false),
     _monitor_socket (NULL),
     _monitor_events (0),
@@ -355,6 +357,9 @@ int zmq::socket_base_t::check_protocol (const std::string &protocol_) const
 #ifdef ZMQ_HAVE_WSS
         && protocol_ != protocol_name::wss
 #endif
+#ifdef ZMQ_HAVE_TLS
+        && protocol_ != protocol_name::tls
+#endif
 #if defined ZMQ_HAVE_OPENPGM
         //  pgm/epgm transports only available if 0MQ is compiled with OpenPGM.
         && protocol_ != protocol_name::pgm
@@ -394,6 +399,14 @@ int zmq::socket_base_t::check_protocol (const std::string &protocol_) const
     }
 #endif
 
+#ifdef ZMQ_HAVE_TLS
+    //  The TLS transport carries ZMTP only.
+    if (protocol_ == protocol_name::tls && options.raw_socket) {
+        errno = ENOCOMPATPROTO;
+        return -1;
+    }
+#endif
+
     if (protocol_ == protocol_name::udp
         && (options.type != ZMQ_DISH && options.type != ZMQ_RADIO
             && options.type != ZMQ_DGRAM)) {
@@ -411,6 +424,7 @@ void zmq::socket_base_t::attach_pipe (pipe_t *pipe_,
 {
     //  First, register the pipe so that we can terminate it later on.
     pipe_->set_event_sink (this);
+    pipe_->set_flush_batch (&_flush_batch);
     _pipes.push_back (pipe_);
 
     //  Let the derived socket type know about new pipe.
@@ -477,6 +491,9 @@ int zmq::socket_base_t::getsockopt (int option_,
     }
 
     if (option_ == ZMQ_EVENTS) {
+        //  The caller is likely to wait for the socket next.
+        flush_deferred ();
+
         const int rc = process_commands (0, false);
         if (rc != 0 && (errno == EINTR || errno == ETERM)) {
             return -1;
@@ -617,7 +634,8 @@ int zmq::socket_base_t::bind (const char *endpoint_uri_)
 
         int hwms[2] = {options.sndhwm, options.rcvhwm};
         bool conflates[2] = {false, false};
-        rc = pipepair (parents, new_pipes, hwms, conflates);
+        bool latencies[2] = {options.latency_stats, options.latency_stats};
+        rc = pipepair (parents, new_pipes, hwms, conflates, latencies);
         errno_assert (rc == 0);
 
         //  Attach local end of the pipe to the socket object.
@@ -646,9 +664,15 @@ int zmq::socket_base_t::bind (const char *endpoint_uri_)
         return -1;
     }
 
+#ifdef ZMQ_HAVE_TLS
+    if (protocol == protocol_name::tcp || protocol == protocol_name::tls) {
+        tcp_listener_t *listener = new (std::nothrow) tcp_listener_t (
+          io_thread, this, options, protocol == protocol_name::tls);
+#else
     if (protocol == protocol_name::tcp) {
         tcp_listener_t *listener =
-          new (std::nothrow) tcp_listener_t (io_thread, this, options);
+          new (std::nothrow) tcp_listener_t (io_thread, this, options, false);
+#endif
         alloc_assert (listener);
         rc = listener->set_local_address (address.c_str ());
         if (rc != 0) {
@@ -821,7 +845,11 @@ int zmq::socket_base_t::connect_internal (const char *endpoint_uri_)
 
         int hwms[2] = {conflate ? -1 : sndhwm, conflate ? -1 : rcvhwm};
         bool conflates[2] = {conflate, conflate};
-        rc = pipepair (parents, new_pipes, hwms, conflates);
+        const bool latency =
+          options.latency_stats
+          || (peer.socket != NULL && peer.options.latency_stats);
+        bool latencies[2] = {latency, latency};
+        rc = pipepair (parents, new_pipes, hwms, conflates, latencies);
         if (!conflate) {
             new_pipes[0]->set_hwms_boost (peer.options.sndhwm,
                                           peer.options.rcvhwm);
@@ -916,7 +944,11 @@ int zmq::socket_base_t::connect_internal (const char *endpoint_uri_)
     alloc_assert (paddr);
 
     //  Resolve address (if needed by the protocol)
+#ifdef ZMQ_HAVE_TLS
+    if (protocol == protocol_name::tcp || protocol == protocol_name::tls) {
+#else
     if (protocol == protocol_name::tcp) {
+#endif
         //  Do some basic sanity checks on tcp:// address syntax
         //  - hostname starts with digit or letter, with embedded '-' or '.'
         //  - IPv6 address may contain hex chars and colons.
@@ -1095,7 +1127,8 @@ int zmq::socket_base_t::connect_internal (const char *endpoint_uri_)
         int hwms[2] = {conflate ? -1 : options.sndhwm,
                        conflate ? -1 : options.rcvhwm};
         bool conflates[2] = {conflate, conflate};
-        rc = pipepair (parents, new_pipes, hwms, conflates);
+        bool latencies[2] = {options.latency_stats, options.latency_stats};
+        rc = pipepair (parents, new_pipes, hwms, conflates, latencies);
         errno_assert (rc == 0);
 
         //  Attach local end of the pipe to the socket object.
@@ -1225,7 +1258,11 @@ int zmq::socket_base_t::term_endpoint (const char *endpoint_uri_)
 int zmq::socket_base_t::send (msg_t *msg_, int flags_)
 {
     scoped_optional_lock_t sync_lock (_thread_safe ? &_sync : NULL);
+    return send_internal (msg_, flags_);
+}
 
+int zmq::socket_base_t::send_internal (msg_t *msg_, int flags_)
+{
     //  Check whether the context hasn't been shut down yet.
     if (unlikely (_ctx_terminated)) {
         errno = ETERM;
@@ -1253,11 +1290,23 @@ int zmq::socket_base_t::send (msg_t *msg_, int flags_)
 
     msg_->reset_metadata ();
 
-    //  Try to send the message using method in each socket class
+    //  Try to send the message using method in each socket class, leaving
+    //  the pipes unflushed if asked to.
+    const bool defer = defer_flushes ();
+    const size_t size = msg_->size ();
+    if (defer)
+        _flush_batch.begin ();
     rc = xsend (msg_);
+    if (defer)
+        _flush_batch.pause ();
     if (rc == 0) {
+        if (defer)
+            deferred_write (size, (flags_ & ZMQ_SNDMORE) != 0);
         return 0;
     }
+
+    //  Let the readers drain the pipes before giving up or waiting for them.
+    flush_deferred ();
     //  Special case for ZMQ_PUSH: -2 means pipe is dead while a
     //  multi-part send is in progress and can't be recovered, so drop
     //  silently when in blocking mode to keep backward compatibility.
@@ -1310,10 +1359,153 @@ int zmq::socket_base_t::send (msg_t *msg_, int flags_)
     return 0;
 }
 
+int zmq::socket_base_t::send_batch (msg_t *msgs_,
+                                    const int *msg_flags_,
+                                    size_t count_,
+                                    int flags_)
+{
+    scoped_optional_lock_t sync_lock (_thread_safe ? &_sync : NULL);
+
+    //  Check whether the context hasn't been shut down yet.
+    if (unlikely (_ctx_terminated)) {
+        errno = ETERM;
+        return -1;
+    }
+
+    //  Process pending commands, if any.
+    int rc = process_commands (0, true);
+    if (unlikely (rc != 0)) {
+        return -1;
+    }
+
+    //  The readers are woken up once the whole batch is written.
+    _flush_batch.begin ();
+
+    const bool defer = defer_flushes ();
+    size_t sent = 0;
+    for (; sent != count_; ++sent) {
+        msg_t *const msg = &msgs_[sent];
+        if (unlikely (!msg->check ())) {
+            errno = EFAULT;
+            break;
+        }
+
+        //  Message boundaries are given by msg_flags_ or else are those of
+        //  the messages themselves, e.g. as received by recv_batch.
+        //  ZMQ_SNDMORE continues the last one.
+        if (msg_flags_) {
+            if (msg_flags_[sent] & ZMQ_SNDMORE)
+                msg->set_flags (msg_t::more);
+            else
+                msg->reset_flags (msg_t::more);
+        }
+        if (sent == count_ - 1 && (flags_ & ZMQ_SNDMORE))
+            msg->set_flags (msg_t::more);
+        const bool more = (msg->flags () & msg_t::more) != 0;
+
+        msg->reset_metadata ();
+        const size_t size = msg->size ();
+        if (xsend (msg) == 0) {
+            if (defer)
+                deferred_write (size, more);
+            continue;
+        }
+
+        //  The message cannot be sent right now. Let the readers catch up
+        //  and leave waiting, if asked to, to the regular send.
+        _flush_batch.end ();
+        rc = send_internal (msg,
+                            (more ? ZMQ_SNDMORE : 0) | (flags_ & ZMQ_DONTWAIT));
+        if (rc != 0)
+            break;
+        _flush_batch.begin ();
+    }
+
+    if (defer)
+        _flush_batch.pause ();
+    else
+        _flush_batch.end ();
+
+    if (sent == 0 && count_ != 0)
+        return -1;
+    return static_cast<int> (sent);
+}
+
+int zmq::socket_base_t::flush ()
+{
+    scoped_optional_lock_t sync_lock (_thread_safe ? &_sync : NULL);
+
+    //  Check whether the context hasn't been shut down yet.
+    if (unlikely (_ctx_terminated)) {
+        errno = ETERM;
+        return -1;
+    }
+
+    flush_deferred ();
+    return 0;
+}
+
+bool zmq::socket_base_t::defer_flushes () const
+{
+    return options.flush_msgs > 0 || options.flush_bytes > 0;
+}
+
+void zmq::socket_base_t::deferred_write (size_t size_, bool more_)
+{
+    _deferred_bytes += size_;
+    if (!more_)
+        _deferred_msgs++;
+    if ((options.flush_msgs > 0 && _deferred_msgs >= options.flush_msgs)
+        || (options.flush_bytes > 0
+            && _deferred_bytes >= static_cast<size_t> (options.flush_bytes)))
+        flush_deferred ();
+}
+
+void zmq::socket_base_t::flush_deferred ()
+{
+    _flush_batch.end ();
+    _deferred_msgs = 0;
+    _deferred_bytes = 0;
+}
+
+int zmq::socket_base_t::recv_batch (msg_t *msgs_, size_t count_, int flags_)
+{
+    scoped_optional_lock_t sync_lock (_thread_safe ? &_sync : NULL);
+
+    if (count_ == 0)
+        return 0;
+
+    //  Wait for the first message as a regular receive would.
+    if (recv_internal (&msgs_[0], flags_) != 0)
+        return -1;
+
+    //  Then take the messages already available, processing commands at
+    //  the usual rate.
+    size_t received = 1;
+    for (; received != count_; ++received) {
+        msg_t *const msg = &msgs_[received];
+        if (unlikely (!msg->check ()))
+            break;
+        if (++_ticks == inbound_poll_rate) {
+            if (unlikely (process_commands (0, false) != 0))
+                break;
+            _ticks = 0;
+        }
+        if (xrecv (msg) != 0)
+            break;
+        extract_flags (msg);
+    }
+    return static_cast<int> (received);
+}
+
 int zmq::socket_base_t::recv (msg_t *msg_, int flags_)
 {
     scoped_optional_lock_t sync_lock (_thread_safe ? &_sync : NULL);
+    return recv_internal (msg_, flags_);
+}
 
+int zmq::socket_base_t::recv_internal (msg_t *msg_, int flags_)
+{
     //  Check whether the context hasn't been shut down yet.
     if (unlikely (_ctx_terminated)) {
         errno = ETERM;
@@ -1353,6 +1545,10 @@ int zmq::socket_base_t::recv (msg_t *msg_, int flags_)
         return 0;
     }
 
+    //  Waiting for a message, e.g. a reply, to what is still unflushed
+    //  would never end.
+    flush_deferred ();
+
     //  If the message cannot be fetched immediately, there are two scenarios.
     //  For non-blocking recv, commands are processed in case there's an
     //  activate_reader command already waiting in a command pipe.
@@ -1377,6 +1573,55 @@ int zmq::socket_base_t::recv (msg_t *msg_, int flags_)
     int timeout = options.rcvtimeo;
     const uint64_t end = timeout < 0 ? 0 : (_clock.now_ms () + timeout);
 
+    //  If configured, poll for the message for a while before blocking, so
+    //  that a message arriving soon is received without the latency of
+    //  putting the thread to sleep and waking it up.
+    if (options.recv_spin > 0) {
+        const uint64_t spin =
+          timeout > 0 ? std::min (static_cast<uint64_t> (options.recv_spin),
+                                  static_cast<uint64_t> (timeout) * 1000)
+                      : options.recv_spin;
+        const uint64_t spin_end = clock_t::now_ns () + spin * 1000;
+
+        //  The failed xrecv above left all pipes inactive, so any message
+        //  arriving now is announced by a command. Watch the mailbox
+        //  without holding the lock of a thread-safe socket and only do
+        //  the actual work once there is something to process. Callers
+        //  hold the lock exactly once, so unlocking releases it.
+        if (_thread_safe)
+            _sync.unlock ();
+        do {
+            if (!_mailbox->check_read ())
+                continue;
+            if (_thread_safe)
+                _sync.lock ();
+            if (unlikely (process_commands (0, false) != 0)) {
+                return -1;
+            }
+            rc = xrecv (msg_);
+            if (rc == 0) {
+                _ticks = 0;
+                extract_flags (msg_);
+                return 0;
+            }
+            if (unlikely (errno != EAGAIN)) {
+                return -1;
+            }
+            if (_thread_safe)
+                _sync.unlock ();
+        } while (clock_t::now_ns () < spin_end);
+        if (_thread_safe)
+            _sync.lock ();
+
+        if (timeout > 0) {
+            timeout = static_cast<int> (end - _clock.now_ms ());
+            if (timeout <= 0) {
+                errno = EAGAIN;
+                return -1;
+            }
+        }
+    }
+
     //  In blocking scenario, commands are processed over and over again until
     //  we are able to fetch a message.
     bool block = (_ticks != 0);
@@ -1417,6 +1662,9 @@ int zmq::socket_base_t::close ()
     //  Mark the socket as dead
     _tag = 0xdeadbeef;
 
+    //  Hand over whatever was written so far, so that lingering applies.
+    flush_deferred ();
+
 
     //  Transfer the ownership of the socket from this application thread
     //  to the reaper thread which will take care of the rest of shutdown
@@ -1562,10 +1810,16 @@ void zmq::socket_base_t::process_term_endpoint (std::string *endpoint_)
 void zmq::socket_base_t::process_pipe_stats_publish (
   uint64_t outbound_queue_count_,
   uint64_t inbound_queue_count_,
-  endpoint_uri_pair_t *endpoint_pair_)
+  endpoint_uri_pair_t *endpoint_pair_,
+  uint64_t *latency_)
 {
     uint64_t values[2] = {outbound_queue_count_, inbound_queue_count_};
     event (*endpoint_pair_, values, 2, ZMQ_EVENT_PIPES_STATS);
+    if (latency_) {
+        event (*endpoint_pair_, latency_,
+               2 * latency_histogram_t::summary_size, ZMQ_EVENT_PIPES_LATENCY);
+        delete[] latency_;
+    }
     delete endpoint_pair_;
 }
 
@@ -1577,12 +1831,15 @@ void zmq::socket_base_t::process_pipe_stats_publish (
  * The inbound pipe on the I/O thread will then add its own stats and endpoint,
  * and write back a message to the socket object (pipe_stats_publish) which
  * will raise an event with the data.
+ * Pipes recording the latency of messages add a summary of the latency in
+ * each direction along the way, which is raised as a second event.
  */
 int zmq::socket_base_t::query_pipes_stats ()
 {
     {
         scoped_lock_t lock (_monitor_sync);
-        if (!(_monitor_events & ZMQ_EVENT_PIPES_STATS)) {
+        if (!(_monitor_events
+              & (ZMQ_EVENT_PIPES_STATS | ZMQ_EVENT_PIPES_LATENCY))) {
             errno = EINVAL;
             return -1;
         }
@@ -2092,15 +2349,10 @@ int zmq::routing_socket_base_t::xsetsockopt (int option_,
 
 void zmq::routing_socket_base_t::xwrite_activated (pipe_t *pipe_)
 {
-    const out_pipes_t::iterator end = _out_pipes.end ();
-    out_pipes_t::iterator it;
-    for (it = _out_pipes.begin (); it != end; ++it)
-        if (it->second.pipe == pipe_)
-            break;
-
-    zmq_assert (it != end);
-    zmq_assert (!it->second.active);
-    it->second.active = true;
+    out_pipe_t *out_pipe = _out_pipes.find (pipe_->get_routing_id ());
+    zmq_assert (out_pipe && out_pipe->pipe == pipe_);
+    zmq_assert (!out_pipe->active);
+    out_pipe->active = true;
 }
 
 std::string zmq::routing_socket_base_t::extract_connect_routing_id ()
@@ -2120,47 +2372,39 @@ void zmq::routing_socket_base_t::add_out_pipe (blob_t routing_id_,
 {
     //  Add the record into output pipes lookup table
     const out_pipe_t outpipe = {pipe_, true};
-    const bool ok =
-      _out_pipes.ZMQ_MAP_INSERT_OR_EMPLACE (ZMQ_MOVE (routing_id_), outpipe)
-        .second;
+    const bool ok = _out_pipes.insert (routing_id_, outpipe);
     zmq_assert (ok);
 }
 
 bool zmq::routing_socket_base_t::has_out_pipe (const blob_t &routing_id_) const
 {
-    return 0 != _out_pipes.count (routing_id_);
+    return _out_pipes.find (routing_id_) != NULL;
 }
 
 zmq::routing_socket_base_t::out_pipe_t *
 zmq::routing_socket_base_t::lookup_out_pipe (const blob_t &routing_id_)
 {
     // TODO we could probably avoid constructor a temporary blob_t to call this function
-    out_pipes_t::iterator it = _out_pipes.find (routing_id_);
-    return it == _out_pipes.end () ? NULL : &it->second;
+    return _out_pipes.find (routing_id_);
 }
 
 const zmq::routing_socket_base_t::out_pipe_t *
 zmq::routing_socket_base_t::lookup_out_pipe (const blob_t &routing_id_) const
 {
     // TODO we could probably avoid constructor a temporary blob_t to call this function
-    const out_pipes_t::const_iterator it = _out_pipes.find (routing_id_);
-    return it == _out_pipes.end () ? NULL : &it->second;
+    return _out_pipes.find (routing_id_);
 }
 
 void zmq::routing_socket_base_t::erase_out_pipe (const pipe_t *pipe_)
 {
-    const size_t erased = _out_pipes.erase (pipe_->get_routing_id ());
+    const bool erased = _out_pipes.erase (pipe_->get_routing_id ());
     zmq_assert (erased);
 }
 
 zmq::routing_socket_base_t::out_pipe_t
 zmq::routing_socket_base_t::try_erase_out_pipe (const blob_t &routing_id_)
 {
-    const out_pipes_t::iterator it = _out_pipes.find (routing_id_);
     out_pipe_t res = {NULL, false};
-    if (it != _out_pipes.end ()) {
-        res = it->second;
-        _out_pipes.erase (it);
-    }
+    _out_pipes.erase (routing_id_, &res);
     return res;
 }
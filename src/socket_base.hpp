@@ -37,6 +37,7 @@
 #include "own.hpp"
 #include "array.hpp"
 #include "blob.hpp"
+#include "routing_table.hpp"
 #include "stdint.hpp"
 #include "poller.hpp"
 #include "i_poll_events.hpp"
@@ -88,6 +89,18 @@ class socket_base_t : public own_t,
     int term_endpoint (const char *endpoint_uri_);
     int send (zmq::msg_t *msg_, int flags_);
     int recv (zmq::msg_t *msg_, int flags_);
+
+    //  Send or receive up to count_ messages in one go. Return the number
+    //  of messages transferred, or -1 if there was none. If msg_flags_ is
+    //  not NULL, it holds the ZMQ_SNDMORE flag of each message.
+    int send_batch (zmq::msg_t *msgs_,
+                    const int *msg_flags_,
+                    size_t count_,
+                    int flags_);
+    int recv_batch (zmq::msg_t *msgs_, size_t count_, int flags_);
+
+    //  Flushes the messages whose flushes were deferred.
+    int flush ();
     void add_signaler (signaler_t *s_);
     void remove_signaler (signaler_t *s_);
     int close ();
@@ -209,6 +222,12 @@ class socket_base_t : public own_t,
 
     int connect_internal (const char *endpoint_uri_);
 
+    //  The bodies of send and recv, for thread-safe sockets to be called
+    //  with _sync held exactly once: waiting for commands releases it,
+    //  which a nested lock would defeat.
+    int send_internal (msg_t *msg_, int flags_);
+    int recv_internal (msg_t *msg_, int flags_);
+
     // Mutex for synchronize access to the socket in thread safe mode
     mutex_t _sync;
 
@@ -296,7 +315,8 @@ class socket_base_t : public own_t,
     void
     process_pipe_stats_publish (uint64_t outbound_queue_count_,
                                 uint64_t inbound_queue_count_,
-                                endpoint_uri_pair_t *endpoint_pair_) ZMQ_FINAL;
+                                endpoint_uri_pair_t *endpoint_pair_,
+                                uint64_t *latency_) ZMQ_FINAL;
     void process_term (int linger_) ZMQ_FINAL;
     void process_term_endpoint (std::string *endpoint_) ZMQ_FINAL;
 
@@ -312,6 +332,23 @@ class socket_base_t : public own_t,
     typedef array_t<pipe_t, 3> pipes_t;
     pipes_t _pipes;
 
+    //  Defers the flushes of the attached pipes while sending a batch, or
+    //  according to ZMQ_FLUSH_MSGS and ZMQ_FLUSH_BYTES.
+    flush_batch_t _flush_batch;
+
+    //  Messages and bytes written since the deferred flushes were done.
+    int _deferred_msgs;
+    size_t _deferred_bytes;
+
+    //  Whether flushes are deferred beyond a single send.
+    bool defer_flushes () const;
+
+    //  Accounts for a message part written with its flush deferred,
+    //  flushing once ZMQ_FLUSH_MSGS or ZMQ_FLUSH_BYTES is reached.
+    void deferred_write (size_t size_, bool more_);
+
+    void flush_deferred ();
+
     //  Reaper's poller and handle of this socket within it.
     poller_t *_poller;
     poller_t::handle_t _handle;
@@ -383,10 +420,10 @@ class routing_socket_base_t : public socket_base_t
     template <typename Func> bool any_of_out_pipes (Func func_)
     {
         bool res = false;
-        for (out_pipes_t::iterator it = _out_pipes.begin (),
-                                   end = _out_pipes.end ();
-             it != end && !res; ++it) {
-            res |= func_ (*it->second.pipe);
+        for (size_t i = 0, n = _out_pipes.slots (); i != n && !res; ++i) {
+            const out_pipe_t *out_pipe = _out_pipes.at (i);
+            if (out_pipe)
+                res |= func_ (*out_pipe->pipe);
         }
 
         return res;
@@ -394,7 +431,7 @@ class routing_socket_base_t : public socket_base_t
 
   private:
     //  Outbound pipes indexed by the peer IDs.
-    typedef std::map<blob_t, out_pipe_t> out_pipes_t;
+    typedef routing_table_t<out_pipe_t> out_pipes_t;
     out_pipes_t _out_pipes;
 
     // Next assigned name on a zmq_connect() call used by ROUTER and STREAM socket types
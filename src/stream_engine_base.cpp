@@ -108,6 +108,7 @@ zmq::stream_engine_base_t::stream_engine_base_t (
     _inpos (NULL),
     _insize (0),
     _decoder (NULL),
+    _decoder_buffer_pool (NULL),
     _outpos (NULL),
     _outsize (0),
     _encoder (NULL),
@@ -131,6 +132,18 @@ zmq::stream_engine_base_t::stream_engine_base_t (
     _session (NULL),
     _socket (NULL),
     _has_handshake_stage (has_handshake_stage_)
+#if defined ZMQ_HAVE_WRITEV
+    ,
+    _gather (false),
+    _out_iov_pos (0)
+#endif
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+    ,
+    _zerocopy (false),
+    _out_zerocopy (false),
+    _zerocopy_first (0),
+    _io_thread (NULL)
+#endif
 {
     const int rc = _tx_msg.init ();
     errno_assert (rc == 0);
@@ -143,6 +156,22 @@ zmq::stream_engine_base_t::~stream_engine_base_t ()
 {
     zmq_assert (!_plugged);
 
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+    //  The kernel may still be transmitting from the messages of zero-copy
+    //  sends, and reports when it is done only while the socket is open.
+    //  Leave both to a drainer, so that the messages are not reused early.
+    if (!_zerocopy_sends.empty ())
+        process_zerocopy_completions ();
+    if (!_zerocopy_sends.empty () && _s != retired_fd) {
+        zmq_assert (_io_thread);
+        zerocopy_drainer_t *drainer = new (std::nothrow)
+          zerocopy_drainer_t (_io_thread, _s, _zerocopy_sends,
+                              _zerocopy_first, _options.linger.load ());
+        alloc_assert (drainer);
+        _s = retired_fd;
+    }
+#endif
+
     if (_s != retired_fd) {
 #ifdef ZMQ_HAVE_WINDOWS
         const int rc = closesocket (_s);
@@ -160,6 +189,10 @@ zmq::stream_engine_base_t::~stream_engine_base_t ()
         _s = retired_fd;
     }
 
+#if defined ZMQ_HAVE_WRITEV
+    release_out_refs ();
+#endif
+
     const int rc = _tx_msg.close ();
     errno_assert (rc == 0);
 
@@ -191,8 +224,29 @@ void zmq::stream_engine_base_t::plug (io_thread_t *io_thread_,
     //  Connect to I/O threads poller object.
     io_object_t::plug (io_thread_);
     _handle = add_fd (_s);
+    _decoder_buffer_pool = io_thread_->get_decoder_buffer_pool ();
     _io_error = false;
 
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+    if (_options.tcp_zerocopy_threshold > 0 && can_gather_output ())
+        _zerocopy = tcp_zerocopy_enabled (_s);
+    _io_thread = io_thread_;
+#endif
+
+#if defined ZMQ_HAVE_WRITEV
+    //  Zero-copy sends work on the single buffer handed out by encode.
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+    _gather = can_gather_output () && !_zerocopy;
+#else
+    _gather = can_gather_output ();
+#endif
+    if (_gather) {
+        _gather_buf.resize (_options.out_batch_size);
+        _out_iov.reserve (out_gather_max_chunks);
+        _out_refs.reserve (out_gather_max_chunks);
+    }
+#endif
+
     plug_internal ();
 }
 
@@ -239,6 +293,14 @@ void zmq::stream_engine_base_t::terminate ()
 
 void zmq::stream_engine_base_t::in_event ()
 {
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+    //  Zero-copy completions are signalled as socket errors. If input is
+    //  stopped, they are the only reason for us to be called here.
+    if (!_zerocopy_sends.empty () && process_zerocopy_completions ()
+        && _input_stopped)
+        return;
+#endif
+
     // ignore errors
     const bool res = in_event_internal ();
     LIBZMQ_UNUSED (res);
@@ -320,7 +382,8 @@ bool zmq::stream_engine_base_t::in_event_internal ()
         }
         _input_stopped = true;
         reset_pollin (_handle);
-    }
+    } else if (_insize == 0 && has_buffered_input ())
+        return in_event_internal ();
 
     _session->flush ();
     return true;
@@ -330,6 +393,14 @@ void zmq::stream_engine_base_t::out_event ()
 {
     zmq_assert (!_io_error);
 
+#if defined ZMQ_HAVE_WRITEV
+    //  Data put into the write buffer during the handshake goes first.
+    if (_gather && !_outsize) {
+        out_event_gather ();
+        return;
+    }
+#endif
+
     //  If write buffer is empty, try to read new data from the encoder.
     if (!_outsize) {
         //  Even when we stop polling as soon as there is no
@@ -343,6 +414,20 @@ void zmq::stream_engine_base_t::out_event ()
         _outpos = NULL;
         _outsize = _encoder->encode (&_outpos, 0);
 
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+        //  The encoder hands out large message bodies without copying
+        //  them into its buffer; those may be sent without copying, too.
+        _out_zerocopy = false;
+        if (_zerocopy
+            && _outsize >= static_cast<size_t> (_options.tcp_zerocopy_threshold)
+            && !_tx_msg.is_vsm ()) {
+            const unsigned char *data =
+              static_cast<const unsigned char *> (_tx_msg.data ());
+            _out_zerocopy =
+              _outpos >= data && _outpos + _outsize <= data + _tx_msg.size ();
+        }
+#endif
+
         while (_outsize < static_cast<size_t> (_options.out_batch_size)) {
             if ((this->*_next_msg) (&_tx_msg) == -1) {
                 //  ws_engine can cause an engine error and delete it, so
@@ -375,7 +460,12 @@ void zmq::stream_engine_base_t::out_event ()
     //  arbitrarily large. However, we assume that underlying TCP layer has
     //  limited transmission buffer and thus the actual number of bytes
     //  written should be reasonably modest.
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+    const int nbytes = _out_zerocopy ? write_zerocopy (_outpos, _outsize)
+                                     : write (_outpos, _outsize);
+#else
     const int nbytes = write (_outpos, _outsize);
+#endif
 
     //  IO error has occurred. We stop waiting for output events.
     //  The engine is not terminated until we detect input error;
@@ -519,6 +609,24 @@ void zmq::stream_engine_base_t::zap_msg_available ()
         restart_output ();
 }
 
+void zmq::stream_engine_base_t::crypto_job_done (crypto_job_t *job_)
+{
+    //  The job may have been submitted by a previous engine of the session.
+    if (_mechanism == NULL)
+        return;
+
+    const int rc = _mechanism->crypto_job_done (job_);
+    if (rc == -1) {
+        error (protocol_error);
+        return;
+    }
+    if (_input_stopped)
+        if (!restart_input ())
+            return;
+    if (_output_stopped)
+        restart_output ();
+}
+
 const zmq::endpoint_uri_pair_t &zmq::stream_engine_base_t::get_endpoint () const
 {
     return _endpoint_uri_pair;
@@ -785,3 +893,160 @@ int zmq::stream_engine_base_t::write (const void *data_, size_t size_)
 {
     return zmq::tcp_write (_s, data_, size_);
 }
+
+#if defined ZMQ_HAVE_WRITEV
+void zmq::stream_engine_base_t::out_event_gather ()
+{
+    //  If all gathered data has been written, gather new data from the
+    //  encoder.
+    if (_out_iov_pos == _out_iov.size ()) {
+        //  Even when we stop polling as soon as there is no
+        //  data to send, the poller may invoke out_event one
+        //  more time due to 'speculative write' optimisation.
+        if (unlikely (_encoder == NULL)) {
+            zmq_assert (_handshaking);
+            return;
+        }
+
+        _out_iov.clear ();
+        _out_iov_pos = 0;
+        size_t buffered = 0;
+        size_t total = 0;
+
+        //  As with a single buffer, new messages are only pulled while less
+        //  than a batch worth of data is pending; once the session runs out
+        //  of messages it may terminate us, dropping whatever is unwritten.
+        while (_out_iov.size () < out_gather_max_chunks) {
+            unsigned char *chunk;
+            const size_t n = _encoder->encode_chunk (&chunk);
+            if (n == 0) {
+                if (total >= _gather_buf.size ())
+                    break;
+                if ((this->*_next_msg) (&_tx_msg) == -1) {
+                    //  ws_engine can cause an engine error and delete it, so
+                    //  bail out immediately to avoid use-after-free
+                    if (errno == ECONNRESET)
+                        return;
+                    break;
+                }
+                _encoder->load_msg (&_tx_msg);
+                continue;
+            }
+            total += n;
+
+            //  Copy small pieces, appending to the previous piece if it
+            //  was copied as well.
+            if (n < out_gather_min_ref && buffered + n <= _gather_buf.size ()) {
+                unsigned char *const pos = &_gather_buf[buffered];
+                memcpy (pos, chunk, n);
+                buffered += n;
+                if (!_out_iov.empty ()
+                    && static_cast<unsigned char *> (_out_iov.back ().iov_base)
+                           + _out_iov.back ().iov_len
+                         == pos)
+                    _out_iov.back ().iov_len += n;
+                else {
+                    const iovec iov = {pos, n};
+                    _out_iov.push_back (iov);
+                }
+                continue;
+            }
+
+            const iovec iov = {chunk, n};
+            _out_iov.push_back (iov);
+
+            //  Message bodies stay valid while we hold a reference. Other
+            //  data belongs to the encoder and is overwritten once we ask
+            //  for more, so it must be the last piece of the batch.
+            const unsigned char *data =
+              static_cast<const unsigned char *> (_tx_msg.data ());
+            if (_tx_msg.is_vsm () || chunk < data
+                || chunk + n > data + _tx_msg.size ())
+                break;
+            _out_refs.push_back (msg_t ());
+            int rc = _out_refs.back ().init ();
+            errno_assert (rc == 0);
+            rc = _out_refs.back ().copy (_tx_msg);
+            errno_assert (rc == 0);
+        }
+
+        //  If there is no data to send, stop polling for output.
+        if (_out_iov.empty ()) {
+            _output_stopped = true;
+            reset_pollout ();
+            return;
+        }
+    }
+
+    const int nbytes =
+      tcp_writev (_s, &_out_iov[_out_iov_pos],
+                  static_cast<int> (_out_iov.size () - _out_iov_pos));
+
+    //  IO error has occurred. We stop waiting for output events.
+    //  The engine is not terminated until we detect input error;
+    //  this is necessary to prevent losing incoming messages.
+    if (nbytes == -1) {
+        reset_pollout ();
+        return;
+    }
+
+    size_t written = static_cast<size_t> (nbytes);
+    while (written > 0) {
+        iovec &iov = _out_iov[_out_iov_pos];
+        if (written < iov.iov_len) {
+            iov.iov_base = static_cast<unsigned char *> (iov.iov_base) + written;
+            iov.iov_len -= written;
+            break;
+        }
+        written -= iov.iov_len;
+        _out_iov_pos++;
+    }
+
+    if (_out_iov_pos == _out_iov.size ()) {
+        release_out_refs ();
+
+        //  If we are still handshaking and there are no data
+        //  to send, stop polling for output.
+        if (unlikely (_handshaking))
+            reset_pollout ();
+    }
+}
+
+void zmq::stream_engine_base_t::release_out_refs ()
+{
+    for (std::vector<msg_t>::iterator it = _out_refs.begin (),
+                                      end = _out_refs.end ();
+         it != end; ++it) {
+        const int rc = it->close ();
+        errno_assert (rc == 0);
+    }
+    _out_refs.clear ();
+}
+#endif
+
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+int zmq::stream_engine_base_t::write_zerocopy (const void *data_, size_t size_)
+{
+    const int nbytes = zmq::tcp_write_zerocopy (_s, data_, size_);
+    if (nbytes == -1 && errno == ENOBUFS)
+        return write (data_, size_);
+
+    //  Each successful send gets the next value of the kernel's counter.
+    if (nbytes > 0) {
+        _zerocopy_sends.push_back (zerocopy_send_t ());
+        zerocopy_send_t &send = _zerocopy_sends.back ();
+        send.done = false;
+        int rc = send.msg.init ();
+        errno_assert (rc == 0);
+        rc = send.msg.copy (_tx_msg);
+        errno_assert (rc == 0);
+    }
+    return nbytes;
+}
+
+bool zmq::stream_engine_base_t::process_zerocopy_completions ()
+{
+    return release_completed_zerocopy_sends (_s, _zerocopy_sends,
+                                             _zerocopy_first);
+}
+#endif
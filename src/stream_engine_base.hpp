@@ -31,6 +31,10 @@
 #define __ZMQ_STREAM_ENGINE_BASE_HPP_INCLUDED__
 
 #include <stddef.h>
+#if defined ZMQ_HAVE_WRITEV
+#include <vector>
+#include <sys/uio.h>
+#endif
 
 #include "fd.hpp"
 #include "i_engine.hpp"
@@ -42,11 +46,15 @@
 #include "metadata.hpp"
 #include "msg.hpp"
 #include "tcp.hpp"
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+#include "zerocopy_drainer.hpp"
+#endif
 
 namespace zmq
 {
 class io_thread_t;
 class session_base_t;
+class decoder_buffer_pool_t;
 class mechanism_t;
 
 //  This engine handles any socket with SOCK_STREAM semantics,
@@ -69,6 +77,7 @@ class stream_engine_base_t : public io_object_t, public i_engine
     bool restart_input () ZMQ_FINAL;
     void restart_output () ZMQ_FINAL;
     void zap_msg_available () ZMQ_FINAL;
+    void crypto_job_done (crypto_job_t *job_) ZMQ_FINAL;
     const endpoint_uri_pair_t &get_endpoint () const ZMQ_FINAL;
 
     //  i_poll_events interface implementation.
@@ -94,6 +103,7 @@ class stream_engine_base_t : public io_object_t, public i_engine
     int push_one_then_decode_and_push (msg_t *msg_);
 
     void set_handshake_timer ();
+    bool has_handshake_timer () const { return _has_handshake_timer; }
 
     virtual bool handshake () { return true; };
     virtual void plug_internal (){};
@@ -122,6 +132,15 @@ class stream_engine_base_t : public io_object_t, public i_engine
     virtual int read (void *data, size_t size_);
     virtual int write (const void *data_, size_t size_);
 
+    //  Returns true if encoded data may be written to the socket directly
+    //  with tcp_writev or MSG_ZEROCOPY. Engines transforming the data in
+    //  write must not.
+    virtual bool can_gather_output () const { return true; }
+
+    //  Returns true if read holds back data the socket will not signal
+    //  again, e.g. the rest of a decrypted TLS record.
+    virtual bool has_buffered_input () const { return false; }
+
     void reset_pollout () { io_object_t::reset_pollout (_handle); }
     void set_pollout () { io_object_t::set_pollout (_handle); }
     void set_pollin () { io_object_t::set_pollin (_handle); }
@@ -134,6 +153,9 @@ class stream_engine_base_t : public io_object_t, public i_engine
     size_t _insize;
     i_decoder *_decoder;
 
+    //  Recycles the decoder's buffers. Owned by the I/O thread.
+    decoder_buffer_pool_t *_decoder_buffer_pool;
+
     unsigned char *_outpos;
     size_t _outsize;
     i_encoder *_encoder;
@@ -188,6 +210,24 @@ class stream_engine_base_t : public io_object_t, public i_engine
 
     void mechanism_ready ();
 
+#if defined ZMQ_HAVE_WRITEV
+    //  Encodes messages into _out_iov and writes them in a single call.
+    void out_event_gather ();
+
+    //  Releases the messages referenced by _out_iov.
+    void release_out_refs ();
+#endif
+
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+    //  Writes the message data at data_ with MSG_ZEROCOPY and keeps a
+    //  reference to the message until the kernel is done with it.
+    int write_zerocopy (const void *data_, size_t size_);
+
+    //  Releases the messages of completed zero-copy sends. Returns true
+    //  if any completion was found on the socket's error queue.
+    bool process_zerocopy_completions ();
+#endif
+
     //  Underlying socket.
     fd_t _s;
 
@@ -204,6 +244,36 @@ class stream_engine_base_t : public io_object_t, public i_engine
 
     bool _io_error;
 
+#if defined ZMQ_HAVE_WRITEV
+    //  True if output is gathered rather than copied into one buffer.
+    bool _gather;
+
+    //  Gathered output. Small pieces are copied into _gather_buf, large
+    //  message bodies are written straight from the messages, which
+    //  _out_refs keeps alive until they are written.
+    std::vector<unsigned char> _gather_buf;
+    std::vector<iovec> _out_iov;
+    size_t _out_iov_pos;
+    std::vector<msg_t> _out_refs;
+#endif
+
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+    //  True if the socket accepts MSG_ZEROCOPY sends.
+    bool _zerocopy;
+
+    //  True if the data at _outpos is sent with MSG_ZEROCOPY.
+    bool _out_zerocopy;
+
+    //  Messages referenced by zero-copy sends, in the order of the
+    //  kernel's send counter, and the counter value of the first one.
+    zerocopy_sends_t _zerocopy_sends;
+    uint32_t _zerocopy_first;
+
+    //  The thread the engine runs in, which drains the sends still
+    //  outstanding when the engine is destroyed.
+    io_thread_t *_io_thread;
+#endif
+
     //  The session this engine is attached to.
     zmq::session_base_t *_session;
 
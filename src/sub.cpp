@@ -49,6 +49,10 @@ int zmq::sub_t::xsetsockopt (int option_,
                              const void *optval_,
                              size_t optvallen_)
 {
+#ifdef ZMQ_BUILD_DRAFT_API
+    if (option_ == ZMQ_SUB_RADIX_TREE)
+        return xsub_t::xsetsockopt (option_, optval_, optvallen_);
+#endif
     if (option_ != ZMQ_SUBSCRIBE && option_ != ZMQ_UNSUBSCRIBE) {
         errno = EINVAL;
         return -1;
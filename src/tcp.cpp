@@ -46,6 +46,14 @@
 #endif
 #endif
 
+#if defined ZMQ_HAVE_WRITEV
+#include <sys/uio.h>
+#endif
+
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+#include <linux/errqueue.h>
+#endif
+
 #if defined ZMQ_HAVE_OPENVMS
 #include <ioctl.h>
 #endif
@@ -269,6 +277,105 @@ int zmq::tcp_write (fd_t s_, const void *data_, size_t size_)
 #endif
 }
 
+#if defined ZMQ_HAVE_WRITEV
+int zmq::tcp_writev (fd_t s_, const struct iovec *iov_, int count_)
+{
+    const ssize_t nbytes = writev (s_, iov_, count_);
+
+    //  Same as in tcp_write, EAGAIN and EINTR are not errors.
+    if (nbytes == -1
+        && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+        return 0;
+
+    //  Signalise peer failure.
+    if (nbytes == -1) {
+        errno_assert (errno != EACCES && errno != EBADF && errno != EDESTADDRREQ
+                      && errno != EFAULT && errno != EISCONN
+                      && errno != EMSGSIZE && errno != ENOMEM
+                      && errno != ENOTSOCK && errno != EOPNOTSUPP
+                      && errno != EINVAL);
+        return -1;
+    }
+
+    return static_cast<int> (nbytes);
+}
+#endif
+
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+void zmq::tune_tcp_zerocopy (fd_t s_, int threshold_)
+{
+    if (threshold_ > 0) {
+        int on = 1;
+        const int rc = setsockopt (s_, SOL_SOCKET, SO_ZEROCOPY, &on, sizeof on);
+        LIBZMQ_UNUSED (rc);
+    }
+}
+
+bool zmq::tcp_zerocopy_enabled (fd_t s_)
+{
+    int on = 0;
+    socklen_t len = sizeof on;
+    const int rc = getsockopt (s_, SOL_SOCKET, SO_ZEROCOPY, &on, &len);
+    return rc == 0 && on != 0;
+}
+
+int zmq::tcp_write_zerocopy (fd_t s_, const void *data_, size_t size_)
+{
+    const ssize_t nbytes = send (s_, data_, size_, MSG_ZEROCOPY);
+
+    //  Out of pinnable memory, the caller falls back to copying.
+    if (nbytes == -1 && errno == ENOBUFS)
+        return -1;
+
+    if (nbytes == -1
+        && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+        return 0;
+
+    //  Signalise peer failure.
+    if (nbytes == -1) {
+        errno_assert (errno != EACCES && errno != EBADF && errno != EDESTADDRREQ
+                      && errno != EFAULT && errno != EISCONN
+                      && errno != EMSGSIZE && errno != ENOMEM
+                      && errno != ENOTSOCK && errno != EOPNOTSUPP);
+        return -1;
+    }
+
+    return static_cast<int> (nbytes);
+}
+
+int zmq::tcp_read_zerocopy_completion (fd_t s_, uint32_t *lo_, uint32_t *hi_)
+{
+    char control[CMSG_SPACE (sizeof (sock_extended_err) + sizeof (sockaddr_in6))];
+    while (true) {
+        msghdr msg;
+        memset (&msg, 0, sizeof msg);
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof control;
+
+        if (recvmsg (s_, &msg, MSG_ERRQUEUE) == -1)
+            return -1;
+
+        //  Skip anything on the error queue that is not a completion.
+        for (cmsghdr *cmsg = CMSG_FIRSTHDR (&msg); cmsg;
+             cmsg = CMSG_NXTHDR (&msg, cmsg)) {
+            if (!(cmsg->cmsg_level == IPPROTO_IP
+                  && cmsg->cmsg_type == IP_RECVERR)
+                && !(cmsg->cmsg_level == IPPROTO_IPV6
+                     && cmsg->cmsg_type == IPV6_RECVERR))
+                continue;
+            const sock_extended_err *err =
+              reinterpret_cast<const sock_extended_err *> (CMSG_DATA (cmsg));
+            if (err->ee_errno == 0
+                && err->ee_origin == SO_EE_ORIGIN_ZEROCOPY) {
+                *lo_ = err->ee_info;
+                *hi_ = err->ee_data;
+                return 0;
+            }
+        }
+    }
+}
+#endif
+
 int zmq::tcp_read (fd_t s_, void *data_, size_t size_)
 {
 #ifdef ZMQ_HAVE_WINDOWS
@@ -31,6 +31,7 @@
 #define __ZMQ_TCP_HPP_INCLUDED__
 
 #include "fd.hpp"
+#include "stdint.hpp"
 
 namespace zmq
 {
@@ -61,6 +62,32 @@ int tune_tcp_maxrt (fd_t sockfd_, int timeout_);
 //  of error or orderly shutdown by the other peer -1 is returned.
 int tcp_write (fd_t s_, const void *data_, size_t size_);
 
+#if defined ZMQ_HAVE_WRITEV
+//  Same as tcp_write, but writes the data of count_ buffers in one go.
+int tcp_writev (fd_t s_, const struct iovec *iov_, int count_);
+#endif
+
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+//  Enables MSG_ZEROCOPY transmission on the socket if threshold_ is
+//  positive. Failure is not an error, the engine checks whether zero-copy
+//  is available with tcp_zerocopy_enabled.
+void tune_tcp_zerocopy (fd_t s_, int threshold_);
+
+//  Returns true if MSG_ZEROCOPY transmission is enabled on the socket.
+bool tcp_zerocopy_enabled (fd_t s_);
+
+//  Same as tcp_write, but the kernel transmits directly from data_, which
+//  must stay untouched until the send is reported complete. Returns -1
+//  with errno set to ENOBUFS if the kernel was unable to pin the data, in
+//  which case the caller should retry with tcp_write.
+int tcp_write_zerocopy (fd_t s_, const void *data_, size_t size_);
+
+//  Reads a zero-copy completion from the socket's error queue and stores
+//  the range of completed sends in lo_ and hi_. Returns -1 if there are
+//  no completions pending.
+int tcp_read_zerocopy_completion (fd_t s_, uint32_t *lo_, uint32_t *hi_);
+#endif
+
 //  Reads data from the socket (up to 'size' bytes).
 //  Returns the number of bytes actually read or -1 on error.
 //  Zero indicates the peer has closed the connection.
@@ -41,6 +41,11 @@
 #include "tcp_address.hpp"
 #include "session_base.hpp"
 
+#ifdef ZMQ_HAVE_TLS
+#include "tls_engine.hpp"
+#include "tls_address.hpp"
+#endif
+
 #if !defined ZMQ_HAVE_WINDOWS
 #include <unistd.h>
 #include <sys/types.h>
@@ -62,16 +67,49 @@
 #include <TargetConditionals.h>
 #endif
 
+#ifdef ZMQ_HAVE_TLS
+//  Returns the host part of a tls:// address, "[source;]host:port", so that
+//  the server's certificate is checked against the name that was connected
+//  to when ZMQ_WSS_HOSTNAME is not set.
+static std::string endpoint_host (const std::string &address_)
+{
+    const std::string::size_type source = address_.rfind (';');
+    std::string host = source == std::string::npos
+                         ? address_
+                         : address_.substr (source + 1);
+    const std::string::size_type port = host.rfind (':');
+    if (port != std::string::npos)
+        host.erase (port);
+    if (host.size () >= 2 && host[0] == '[' && host[host.size () - 1] == ']')
+        host = host.substr (1, host.size () - 2);
+    return host;
+}
+#endif
+
 zmq::tcp_connecter_t::tcp_connecter_t (class io_thread_t *io_thread_,
                                        class session_base_t *session_,
                                        const options_t &options_,
                                        address_t *addr_,
-                                       bool delayed_start_) :
+                                       bool delayed_start_,
+                                       bool tls_,
+                                       const std::string &tls_hostname_) :
     stream_connecter_base_t (
       io_thread_, session_, options_, addr_, delayed_start_),
-    _connect_timer_started (false)
+    _connect_timer_started (false),
+    _tls (tls_),
+#ifdef ZMQ_HAVE_TLS
+    _hostname (tls_ && tls_hostname_.empty () ? endpoint_host (addr_->address)
+                                              : tls_hostname_)
+#else
+    _hostname (tls_hostname_)
+#endif
 {
+#ifdef ZMQ_HAVE_TLS
+    zmq_assert (_addr->protocol
+                == (_tls ? protocol_name::tls : protocol_name::tcp));
+#else
     zmq_assert (_addr->protocol == protocol_name::tcp);
+#endif
 }
 
 zmq::tcp_connecter_t::~tcp_connecter_t ()
@@ -119,7 +157,14 @@ void zmq::tcp_connecter_t::out_event ()
         return;
     }
 
-    create_engine (fd, get_socket_name<tcp_address_t> (fd, socket_end_local));
+#ifdef ZMQ_HAVE_TLS
+    if (_tls)
+        create_engine (fd,
+                       get_socket_name<tls_address_t> (fd, socket_end_local));
+    else
+#endif
+        create_engine (fd,
+                       get_socket_name<tcp_address_t> (fd, socket_end_local));
 }
 
 void zmq::tcp_connecter_t::timer_event (int id_)
@@ -309,5 +354,39 @@ bool zmq::tcp_connecter_t::tune_socket (const fd_t fd_)
                      fd_, options.tcp_keepalive, options.tcp_keepalive_cnt,
                      options.tcp_keepalive_idle, options.tcp_keepalive_intvl)
                    | tune_tcp_maxrt (fd_, options.tcp_maxrt);
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+    if (!_tls)
+        tune_tcp_zerocopy (fd_, options.tcp_zerocopy_threshold);
+#endif
     return rc == 0;
 }
+
+void zmq::tcp_connecter_t::create_engine (fd_t fd_,
+                                          const std::string &local_address_)
+{
+    if (!_tls) {
+        stream_connecter_base_t::create_engine (fd_, local_address_);
+        return;
+    }
+
+#ifdef ZMQ_HAVE_TLS
+    const endpoint_uri_pair_t endpoint_pair (local_address_, _endpoint,
+                                             endpoint_type_connect);
+
+    //  Create the engine object for this connection.
+    i_engine *engine = new (std::nothrow)
+      tls_engine_t (fd_, options, endpoint_pair, true, NULL, _hostname);
+    alloc_assert (engine);
+
+    //  Attach the engine to the corresponding session object.
+    send_attach (_session, engine);
+
+    //  Shut the connecter down.
+    terminate ();
+
+    _socket->event_connected (endpoint_pair, fd_);
+#else
+    LIBZMQ_UNUSED (_hostname);
+    zmq_assert (false);
+#endif
+}
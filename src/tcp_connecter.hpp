@@ -45,7 +45,9 @@ class tcp_connecter_t ZMQ_FINAL : public stream_connecter_base_t
                      zmq::session_base_t *session_,
                      const options_t &options_,
                      address_t *addr_,
-                     bool delayed_start_);
+                     bool delayed_start_,
+                     bool tls_,
+                     const std::string &tls_hostname_);
     ~tcp_connecter_t ();
 
   private:
@@ -80,9 +82,18 @@ class tcp_connecter_t ZMQ_FINAL : public stream_connecter_base_t
     //  Tunes a connected socket.
     bool tune_socket (fd_t fd_);
 
+    void create_engine (fd_t fd_, const std::string &local_address_);
+
     //  True iff a timer has been started.
     bool _connect_timer_started;
 
+    //  True for the tls:// transport, which runs ZMTP over TLS.
+    const bool _tls;
+
+    //  Name to check the server's certificate against: ZMQ_WSS_HOSTNAME, or
+    //  the host part of the endpoint when that option is not set.
+    const std::string _hostname;
+
     ZMQ_NON_COPYABLE_NOR_MOVABLE (tcp_connecter_t)
 };
 }
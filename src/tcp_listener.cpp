@@ -40,8 +40,14 @@
 #include "ip.hpp"
 #include "tcp.hpp"
 #include "socket_base.hpp"
+#include "session_base.hpp"
 #include "address.hpp"
 
+#ifdef ZMQ_HAVE_TLS
+#include "tls_engine.hpp"
+#include "tls_address.hpp"
+#endif
+
 #ifndef ZMQ_HAVE_WINDOWS
 #include <unistd.h>
 #include <sys/socket.h>
@@ -61,9 +67,22 @@
 
 zmq::tcp_listener_t::tcp_listener_t (io_thread_t *io_thread_,
                                      socket_base_t *socket_,
-                                     const options_t &options_) :
-    stream_listener_base_t (io_thread_, socket_, options_)
+                                     const options_t &options_,
+                                     bool tls_) :
+    stream_listener_base_t (io_thread_, socket_, options_), _tls (tls_)
 {
+#ifdef ZMQ_HAVE_TLS
+    if (_tls)
+        _tls_cred = tls_stream_t::create_server_credentials (options_);
+#endif
+}
+
+zmq::tcp_listener_t::~tcp_listener_t ()
+{
+#ifdef ZMQ_HAVE_TLS
+    if (_tls && _tls_cred)
+        gnutls_certificate_free_credentials (_tls_cred);
+#endif
 }
 
 void zmq::tcp_listener_t::in_event ()
@@ -84,6 +103,10 @@ void zmq::tcp_listener_t::in_event ()
            fd, options.tcp_keepalive, options.tcp_keepalive_cnt,
            options.tcp_keepalive_idle, options.tcp_keepalive_intvl);
     rc = rc | tune_tcp_maxrt (fd, options.tcp_maxrt);
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+    if (!_tls)
+        tune_tcp_zerocopy (fd, options.tcp_zerocopy_threshold);
+#endif
     if (rc != 0) {
         _socket->event_accept_failed (
           make_unconnected_bind_endpoint_pair (_endpoint), zmq_errno ());
@@ -98,9 +121,48 @@ std::string
 zmq::tcp_listener_t::get_socket_name (zmq::fd_t fd_,
                                       socket_end_t socket_end_) const
 {
+#ifdef ZMQ_HAVE_TLS
+    if (_tls)
+        return zmq::get_socket_name<tls_address_t> (fd_, socket_end_);
+#endif
     return zmq::get_socket_name<tcp_address_t> (fd_, socket_end_);
 }
 
+void zmq::tcp_listener_t::create_engine (fd_t fd_)
+{
+    if (!_tls) {
+        stream_listener_base_t::create_engine (fd_);
+        return;
+    }
+
+#ifdef ZMQ_HAVE_TLS
+    const endpoint_uri_pair_t endpoint_pair (
+      get_socket_name (fd_, socket_end_local),
+      get_socket_name (fd_, socket_end_remote), endpoint_type_bind);
+
+    i_engine *engine = new (std::nothrow) tls_engine_t (
+      fd_, options, endpoint_pair, false, _tls_cred, std::string ());
+    alloc_assert (engine);
+
+    //  Choose I/O thread to run connecter in. Given that we are already
+    //  running in an I/O thread, there must be at least one available.
+    io_thread_t *io_thread = choose_io_thread (options.affinity);
+    zmq_assert (io_thread);
+
+    //  Create and launch a session object.
+    session_base_t *session =
+      session_base_t::create (io_thread, false, _socket, options, NULL);
+    errno_assert (session);
+    session->inc_seqnum ();
+    launch_child (session);
+    send_attach (session, engine, false);
+
+    _socket->event_accepted (endpoint_pair, fd_);
+#else
+    zmq_assert (false);
+#endif
+}
+
 int zmq::tcp_listener_t::create_socket (const char *addr_)
 {
     _s = tcp_open_socket (addr_, options, true, true, &_address);
@@ -171,6 +233,14 @@ error:
 
 int zmq::tcp_listener_t::set_local_address (const char *addr_)
 {
+#ifdef ZMQ_HAVE_TLS
+    //  The certificate and key to accept connections with are unusable.
+    if (_tls && !_tls_cred) {
+        errno = EINVAL;
+        return -1;
+    }
+#endif
+
     if (options.use_fd != -1) {
         //  in this case, the addr_ passed is not used and ignored, since the
         //  socket was already created by the application
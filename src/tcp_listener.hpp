@@ -34,6 +34,10 @@
 #include "tcp_address.hpp"
 #include "stream_listener_base.hpp"
 
+#ifdef ZMQ_HAVE_TLS
+#include <gnutls/gnutls.h>
+#endif
+
 namespace zmq
 {
 class tcp_listener_t ZMQ_FINAL : public stream_listener_base_t
@@ -41,13 +45,17 @@ class tcp_listener_t ZMQ_FINAL : public stream_listener_base_t
   public:
     tcp_listener_t (zmq::io_thread_t *io_thread_,
                     zmq::socket_base_t *socket_,
-                    const options_t &options_);
+                    const options_t &options_,
+                    bool tls_);
+
+    ~tcp_listener_t ();
 
     //  Set address to listen on.
     int set_local_address (const char *addr_);
 
   protected:
     std::string get_socket_name (fd_t fd_, socket_end_t socket_end_) const;
+    void create_engine (fd_t fd_);
 
   private:
     //  Handlers for I/O events.
@@ -64,6 +72,12 @@ class tcp_listener_t ZMQ_FINAL : public stream_listener_base_t
     //  Address to listen on.
     tcp_address_t _address;
 
+    //  True for the tls:// transport, which runs ZMTP over TLS.
+    bool _tls;
+#ifdef ZMQ_HAVE_TLS
+    gnutls_certificate_credentials_t _tls_cred;
+#endif
+
     ZMQ_NON_COPYABLE_NOR_MOVABLE (tcp_listener_t)
 };
 }
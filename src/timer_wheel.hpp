@@ -0,0 +1,437 @@
+/*
+    Copyright (c) 2007-2016 Contributors as noted in the AUTHORS file
+
+    This file is part of libzmq, the ZeroMQ core engine in C++.
+
+    libzmq is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License (LGPL) as published
+    by the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    As a special exception, the Contributors give you permission to link
+    this library with independent modules to produce an executable,
+    regardless of the license terms of these independent modules, and to
+    copy and distribute the resulting executable under terms of your choice,
+    provided that you also meet, for each linked independent module, the
+    terms and conditions of the license of that module. An independent
+    module is a module which is not derived from or based on this library.
+    If you modify this library, you must extend this exception to your
+    version of the library.
+
+    libzmq is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __ZMQ_TIMER_WHEEL_HPP_INCLUDED__
+#define __ZMQ_TIMER_WHEEL_HPP_INCLUDED__
+
+#include <vector>
+
+#include "err.hpp"
+#include "macros.hpp"
+#include "stdint.hpp"
+
+#if defined _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace zmq
+{
+//  Hierarchical timing wheel with millisecond ticks, holding timers that
+//  carry a value of type T.
+//
+//  Each of the levels has 64 slots. A slot of level k covers 64^k ticks
+//  and holds the timers due within its span, so a timer is placed in the
+//  lowest level whose 64 slots reach its expiry. When time enters the span
+//  of a higher level slot, its timers are cascaded to the lower levels,
+//  and the timers in a slot of level 0 are due. Timers further away than
+//  the highest level reaches are parked in its last slot and placed again
+//  when it is cascaded. A bitmap of the occupied slots per level lets the
+//  wheel skip idle periods without visiting every tick.
+//
+//  Adding and cancelling are O(1). The timers are stored in a pool, linked
+//  together by index, and recycled once expired or cancelled, so that a
+//  wheel with a steady number of timers does not allocate.
+//
+//  Timers are referred to by handles, which become stale once the timer
+//  is cancelled or released. Handles are never 0.
+
+template <typename T> class timer_wheel_t
+{
+  public:
+    typedef uint64_t handle_t;
+
+    timer_wheel_t () : _now (0), _linked (0), _size (0), _free (npos)
+    {
+        for (int i = 0; i != slot_count; ++i)
+            _heads[i] = _tails[i] = npos;
+        for (int k = 0; k != levels; ++k)
+            _occupied[k] = 0;
+    }
+
+    //  Number of timers, including those popped but not yet released.
+    size_t size () const { return _size; }
+
+    bool empty () const { return _size == 0; }
+
+    //  Adds a timer expiring timeout_ milliseconds after now_.
+    handle_t add (uint64_t now_, uint64_t timeout_, const T &value_)
+    {
+        //  The position of the wheel is arbitrary while it has no timers,
+        //  so catch up with the clock without visiting the ticks.
+        if (_linked == 0 && now_ > _now)
+            _now = now_;
+
+        uint32_t index = _free;
+        if (index == npos) {
+            index = static_cast<uint32_t> (_nodes.size ());
+            zmq_assert (index != npos);
+            node_t node = node_t ();
+            node.generation = 1;
+            _nodes.push_back (node);
+        } else
+            _free = _nodes[index].next;
+
+        node_t &node = _nodes[index];
+        node.expiry = add_saturated (now_, timeout_);
+        node.value = value_;
+        link (index);
+        ++_size;
+        return make_handle (index);
+    }
+
+    //  Returns whether the handle refers to a timer that is still waiting
+    //  to expire, or was popped and is not released yet.
+    bool pending (handle_t handle_) const
+    {
+        return lookup (handle_) != npos;
+    }
+
+    //  Returns the value of the timer, or NULL if the handle is stale.
+    T *get (handle_t handle_)
+    {
+        const uint32_t index = lookup (handle_);
+        return index == npos ? NULL : &_nodes[index].value;
+    }
+
+    //  Drops the timer. Returns false if the handle is stale.
+    bool cancel (handle_t handle_)
+    {
+        const uint32_t index = lookup (handle_);
+        if (index == npos)
+            return false;
+        if (_nodes[index].slot != detached)
+            unlink (index);
+        release_node (index);
+        return true;
+    }
+
+    //  Makes the timer expire timeout_ milliseconds after now_, whether it
+    //  is waiting or was popped. The handle stays valid. Returns false if
+    //  the handle is stale.
+    bool reschedule (handle_t handle_, uint64_t now_, uint64_t timeout_)
+    {
+        const uint32_t index = lookup (handle_);
+        if (index == npos)
+            return false;
+        if (_nodes[index].slot != detached)
+            unlink (index);
+        if (_linked == 0 && now_ > _now)
+            _now = now_;
+        _nodes[index].expiry = add_saturated (now_, timeout_);
+        link (index);
+        return true;
+    }
+
+    //  Finds a timer that expired by now_, moving the wheel forward as
+    //  needed. The timer is taken off the wheel but its handle stays valid
+    //  until it is released with cancel or put back with reschedule.
+    //  Returns false if no timer is due.
+    bool pop (uint64_t now_, handle_t *handle_, T *value_)
+    {
+        while (_heads[due] == npos && _now < now_) {
+            if (_linked == 0) {
+                _now = now_;
+                break;
+            }
+            const uint64_t tick = next_event ();
+            if (tick > now_) {
+                _now = now_;
+                break;
+            }
+            _now = tick;
+            for (int k = levels - 1; k > 0; --k)
+                if ((tick & (span (k) - 1)) == 0)
+                    cascade (k, slot_of (k, tick));
+            splice_to_due (slot_of (0, tick));
+        }
+
+        const uint32_t index = _heads[due];
+        if (index == npos)
+            return false;
+        unlink (index);
+        _nodes[index].slot = detached;
+        *handle_ = make_handle (index);
+        *value_ = _nodes[index].value;
+        return true;
+    }
+
+    //  Returns the number of milliseconds from now_ until the next timer
+    //  expires, 0 if one is due already, or -1 if there are no timers
+    //  waiting.
+    int64_t timeout (uint64_t now_) const
+    {
+        if (_linked == 0)
+            return -1;
+        if (_heads[due] != npos)
+            return 0;
+
+        //  The first occupied slot of each level, in the order time goes
+        //  round the level, holds the earliest timers of that level.
+        uint64_t first = ~uint64_t (0);
+        for (int k = 0; k != levels; ++k) {
+            if (!_occupied[k])
+                continue;
+            const int idx = slot_of (k, _now);
+            uint64_t bits = idx == slots_per_level - 1
+                              ? 0
+                              : _occupied[k] & (~uint64_t (0) << (idx + 1));
+            if (!bits)
+                bits = _occupied[k];
+            const int slot = k * slots_per_level + lowest_bit (bits);
+            for (uint32_t i = _heads[slot]; i != npos; i = _nodes[i].next)
+                if (_nodes[i].expiry < first)
+                    first = _nodes[i].expiry;
+        }
+        return first > now_ ? static_cast<int64_t> (first - now_) : 0;
+    }
+
+  private:
+    enum
+    {
+        slot_bits = 6,
+        slots_per_level = 1 << slot_bits,
+        levels = 6,
+        //  Slot holding the timers that are due.
+        due = levels * slots_per_level,
+        slot_count = due + 1,
+        //  Values of node_t::slot for popped and free timers.
+        detached = -1,
+        unused = -2
+    };
+
+    static const uint32_t npos = 0xffffffff;
+
+    struct node_t
+    {
+        uint64_t expiry;
+        uint32_t prev;
+        uint32_t next;
+        uint32_t generation;
+        int slot;
+        T value;
+    };
+
+    static uint64_t span (int level_)
+    {
+        return uint64_t (1) << (level_ * slot_bits);
+    }
+
+    static int slot_of (int level_, uint64_t tick_)
+    {
+        return static_cast<int> ((tick_ >> (level_ * slot_bits))
+                                 & (slots_per_level - 1));
+    }
+
+    static uint64_t add_saturated (uint64_t now_, uint64_t timeout_)
+    {
+        const uint64_t forever = ~uint64_t (0);
+        return timeout_ > forever - now_ ? forever : now_ + timeout_;
+    }
+
+    static int lowest_bit (uint64_t bits_)
+    {
+#if defined __GNUC__
+        return __builtin_ctzll (bits_);
+#elif defined _MSC_VER && (defined _M_X64 || defined _M_ARM64)
+        unsigned long index;
+        _BitScanForward64 (&index, bits_);
+        return static_cast<int> (index);
+#else
+        int index = 0;
+        while (!(bits_ & 1)) {
+            bits_ >>= 1;
+            ++index;
+        }
+        return index;
+#endif
+    }
+
+    handle_t make_handle (uint32_t index_) const
+    {
+        return (static_cast<uint64_t> (_nodes[index_].generation) << 32)
+               | index_;
+    }
+
+    uint32_t lookup (handle_t handle_) const
+    {
+        const uint32_t index = static_cast<uint32_t> (handle_);
+        if (index >= _nodes.size ()
+            || _nodes[index].generation != handle_ >> 32
+            || _nodes[index].slot == unused)
+            return npos;
+        return index;
+    }
+
+    //  Puts the node in the slot matching its expiry.
+    void link (uint32_t index_)
+    {
+        node_t &node = _nodes[index_];
+        int slot = due;
+        if (node.expiry > _now) {
+            const uint64_t delta = node.expiry - _now;
+            int level = 0;
+            while (level != levels && delta >= span (level + 1))
+                ++level;
+            if (level == levels) {
+                //  Too far away, park it in the slot of the highest level
+                //  that comes round last.
+                level = levels - 1;
+                slot = level * slots_per_level
+                       + ((slot_of (level, _now) + slots_per_level - 1)
+                          & (slots_per_level - 1));
+            } else
+                slot = level * slots_per_level + slot_of (level, node.expiry);
+            _occupied[level] |= uint64_t (1) << (slot % slots_per_level);
+        }
+
+        node.slot = slot;
+        node.next = npos;
+        node.prev = _tails[slot];
+        if (node.prev == npos)
+            _heads[slot] = index_;
+        else
+            _nodes[node.prev].next = index_;
+        _tails[slot] = index_;
+        ++_linked;
+    }
+
+    void unlink (uint32_t index_)
+    {
+        node_t &node = _nodes[index_];
+        const int slot = node.slot;
+        if (node.prev == npos)
+            _heads[slot] = node.next;
+        else
+            _nodes[node.prev].next = node.next;
+        if (node.next == npos)
+            _tails[slot] = node.prev;
+        else
+            _nodes[node.next].prev = node.prev;
+        if (_heads[slot] == npos && slot != due)
+            _occupied[slot / slots_per_level] &=
+              ~(uint64_t (1) << (slot % slots_per_level));
+        --_linked;
+    }
+
+    void release_node (uint32_t index_)
+    {
+        node_t &node = _nodes[index_];
+        node.slot = unused;
+        ++node.generation;
+        if (node.generation == 0)
+            node.generation = 1;
+        node.next = _free;
+        _free = index_;
+        --_size;
+    }
+
+    //  Returns the next tick at which a slot of any level comes due.
+    uint64_t next_event () const
+    {
+        uint64_t res = ~uint64_t (0);
+        for (int k = 0; k != levels; ++k) {
+            if (!_occupied[k])
+                continue;
+            const int shift = k * slot_bits;
+            const int idx = slot_of (k, _now);
+            const uint64_t round = (_now >> shift) & ~uint64_t (
+                                     slots_per_level - 1);
+            uint64_t bits = idx == slots_per_level - 1
+                              ? 0
+                              : _occupied[k] & (~uint64_t (0) << (idx + 1));
+            uint64_t tick;
+            if (bits)
+                tick = (round | lowest_bit (bits)) << shift;
+            else
+                //  The occupied slots belong to the next round.
+                tick = ((round + slots_per_level) | lowest_bit (_occupied[k]))
+                       << shift;
+            if (tick < res)
+                res = tick;
+        }
+        return res;
+    }
+
+    //  Moves the timers of a slot to the lower levels.
+    void cascade (int level_, int idx_)
+    {
+        const int slot = level_ * slots_per_level + idx_;
+        uint32_t index = _heads[slot];
+        if (index == npos)
+            return;
+        _heads[slot] = _tails[slot] = npos;
+        _occupied[level_] &= ~(uint64_t (1) << idx_);
+        while (index != npos) {
+            const uint32_t next = _nodes[index].next;
+            --_linked;
+            link (index);
+            index = next;
+        }
+    }
+
+    //  Appends the timers of a slot of level 0 to the due ones.
+    void splice_to_due (int idx_)
+    {
+        const uint32_t head = _heads[idx_];
+        if (head == npos)
+            return;
+        for (uint32_t i = head; i != npos; i = _nodes[i].next)
+            _nodes[i].slot = due;
+        if (_tails[due] == npos)
+            _heads[due] = head;
+        else {
+            _nodes[_tails[due]].next = head;
+            _nodes[head].prev = _tails[due];
+        }
+        _tails[due] = _tails[idx_];
+        _heads[idx_] = _tails[idx_] = npos;
+        _occupied[0] &= ~(uint64_t (1) << idx_);
+    }
+
+    //  The tick the wheel has advanced to.
+    uint64_t _now;
+
+    //  Number of timers waiting in the slots.
+    size_t _linked;
+
+    //  Number of timers, waiting or popped.
+    size_t _size;
+
+    std::vector<node_t> _nodes;
+    uint32_t _free;
+
+    uint32_t _heads[slot_count];
+    uint32_t _tails[slot_count];
+    uint64_t _occupied[levels];
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (timer_wheel_t)
+};
+}
+
+#endif
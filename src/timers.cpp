@@ -31,8 +31,6 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "timers.hpp"
 #include "err.hpp"
 
-#include <algorithm>
-
 zmq::timers_t::timers_t () : _tag (0xCAFEDADA), _next_timer_id (0)
 {
 }
@@ -48,6 +46,13 @@ bool zmq::timers_t::check_tag () const
     return _tag == 0xCAFEDADA;
 }
 
+zmq::timers_t::wheel_t::handle_t *zmq::timers_t::find_handle (int timer_id_)
+{
+    return _handles.find (
+      blob_t (reinterpret_cast<unsigned char *> (&timer_id_),
+              sizeof timer_id_, reference_tag_t ()));
+}
+
 int zmq::timers_t::add (size_t interval_, timers_timer_fn handler_, void *arg_)
 {
     if (handler_ == NULL) {
@@ -55,58 +60,40 @@ int zmq::timers_t::add (size_t interval_, timers_timer_fn handler_, void *arg_)
         return -1;
     }
 
-    uint64_t when = _clock.now_ms () + interval_;
-    timer_t timer = {++_next_timer_id, interval_, handler_, arg_};
-    _timers.insert (timersmap_t::value_type (when, timer));
-
-    return timer.timer_id;
+    int timer_id = ++_next_timer_id;
+    const timer_t timer = {timer_id, interval_, handler_, arg_};
+    const wheel_t::handle_t handle =
+      _timers.add (_clock.now_ms (), interval_, timer);
+    const bool ok = _handles.insert (
+      blob_t (reinterpret_cast<unsigned char *> (&timer_id), sizeof timer_id,
+              reference_tag_t ()),
+      handle);
+    zmq_assert (ok);
+
+    return timer_id;
 }
 
-struct zmq::timers_t::match_by_id
-{
-    match_by_id (int timer_id_) : _timer_id (timer_id_) {}
-
-    bool operator() (timersmap_t::value_type const &entry_) const
-    {
-        return entry_.second.timer_id == _timer_id;
-    }
-
-  private:
-    int _timer_id;
-};
-
 int zmq::timers_t::cancel (int timer_id_)
 {
-    // check first if timer exists at all
-    if (_timers.end ()
-        == std::find_if (_timers.begin (), _timers.end (),
-                         match_by_id (timer_id_))) {
+    wheel_t::handle_t handle;
+    if (!_handles.erase (
+          blob_t (reinterpret_cast<unsigned char *> (&timer_id_),
+                  sizeof timer_id_, reference_tag_t ()),
+          &handle)) {
         errno = EINVAL;
         return -1;
     }
 
-    // check if timer was already canceled
-    if (_cancelled_timers.count (timer_id_)) {
-        errno = EINVAL;
-        return -1;
-    }
-
-    _cancelled_timers.insert (timer_id_);
-
+    _timers.cancel (handle);
     return 0;
 }
 
 int zmq::timers_t::set_interval (int timer_id_, size_t interval_)
 {
-    const timersmap_t::iterator end = _timers.end ();
-    const timersmap_t::iterator it =
-      std::find_if (_timers.begin (), end, match_by_id (timer_id_));
-    if (it != end) {
-        timer_t timer = it->second;
-        timer.interval = interval_;
-        uint64_t when = _clock.now_ms () + interval_;
-        _timers.erase (it);
-        _timers.insert (timersmap_t::value_type (when, timer));
+    const wheel_t::handle_t *const handle = find_handle (timer_id_);
+    if (handle) {
+        _timers.get (*handle)->interval = interval_;
+        _timers.reschedule (*handle, _clock.now_ms (), interval_);
 
         return 0;
     }
@@ -117,14 +104,10 @@ int zmq::timers_t::set_interval (int timer_id_, size_t interval_)
 
 int zmq::timers_t::reset (int timer_id_)
 {
-    const timersmap_t::iterator end = _timers.end ();
-    const timersmap_t::iterator it =
-      std::find_if (_timers.begin (), end, match_by_id (timer_id_));
-    if (it != end) {
-        timer_t timer = it->second;
-        uint64_t when = _clock.now_ms () + timer.interval;
-        _timers.erase (it);
-        _timers.insert (timersmap_t::value_type (when, timer));
+    const wheel_t::handle_t *const handle = find_handle (timer_id_);
+    if (handle) {
+        _timers.reschedule (*handle, _clock.now_ms (),
+                            _timers.get (*handle)->interval);
 
         return 0;
     }
@@ -135,50 +118,30 @@ int zmq::timers_t::reset (int timer_id_)
 
 long zmq::timers_t::timeout ()
 {
-    const uint64_t now = _clock.now_ms ();
-    long res = -1;
-
-    const timersmap_t::iterator begin = _timers.begin ();
-    const timersmap_t::iterator end = _timers.end ();
-    timersmap_t::iterator it = begin;
-    for (; it != end; ++it) {
-        if (0 == _cancelled_timers.erase (it->second.timer_id)) {
-            //  Live timer, lets return the timeout
-            res = std::max (static_cast<long> (it->first - now), 0l);
-            break;
-        }
-    }
-
-    //  Remove timed-out timers
-    _timers.erase (begin, it);
-
-    return res;
+    return static_cast<long> (_timers.timeout (_clock.now_ms ()));
 }
 
 int zmq::timers_t::execute ()
 {
     const uint64_t now = _clock.now_ms ();
 
-    const timersmap_t::iterator begin = _timers.begin ();
-    const timersmap_t::iterator end = _timers.end ();
-    timersmap_t::iterator it = _timers.begin ();
-    for (; it != end; ++it) {
-        if (0 == _cancelled_timers.erase (it->second.timer_id)) {
-            //  Timer is not cancelled
-
-            //  Map is ordered, if we have to wait for current timer we can stop.
-            if (it->first > now)
-                break;
-
-            const timer_t &timer = it->second;
-
-            timer.handler (timer.timer_id, timer.arg);
+    wheel_t::handle_t handle;
+    timer_t timer;
+    while (_timers.pop (now, &handle, &timer)) {
+        timer.handler (timer.timer_id, timer.arg);
+        _expired.push_back (handle);
+    }
 
-            _timers.insert (
-              timersmap_t::value_type (now + timer.interval, timer));
-        }
+    //  Timers repeat, unless cancelled by a handler. Restarting them only
+    //  now keeps a timer with a zero interval from running forever.
+    for (std::vector<wheel_t::handle_t>::iterator it = _expired.begin (),
+                                                  end = _expired.end ();
+         it != end; ++it) {
+        const timer_t *const expired = _timers.get (*it);
+        if (expired)
+            _timers.reschedule (*it, now, expired->interval);
     }
-    _timers.erase (begin, it);
+    _expired.clear ();
 
     return 0;
 }
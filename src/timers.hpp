@@ -31,10 +31,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define __ZMQ_TIMERS_HPP_INCLUDED__
 
 #include <stddef.h>
-#include <map>
-#include <set>
+#include <vector>
 
 #include "clock.hpp"
+#include "routing_table.hpp"
+#include "timer_wheel.hpp"
 
 namespace zmq
 {
@@ -52,12 +53,10 @@ class timers_t
     int add (size_t interval_, timers_timer_fn handler_, void *arg_);
 
     //  Set the interval of the timer.
-    //  This method is slow, cancelling exsting and adding a new timer yield better performance.
     //  Returns 0 on success and -1 on error.
     int set_interval (int timer_id_, size_t interval_);
 
     //  Reset the timer.
-    //  This method is slow, cancelling exsting and adding a new timer yield better performance.
     //  Returns 0 on success and -1 on error.
     int reset (int timer_id_);
 
@@ -93,13 +92,18 @@ class timers_t
         void *arg;
     } timer_t;
 
-    typedef std::multimap<uint64_t, timer_t> timersmap_t;
-    timersmap_t _timers;
+    typedef timer_wheel_t<timer_t> wheel_t;
+    wheel_t _timers;
 
-    typedef std::set<int> cancelled_timers_t;
-    cancelled_timers_t _cancelled_timers;
+    //  Wheel handles of the timers, indexed by timer ID.
+    typedef routing_table_t<wheel_t::handle_t> handles_t;
+    handles_t _handles;
 
-    struct match_by_id;
+    //  Timers that expired during execute, to restart once all were run.
+    std::vector<wheel_t::handle_t> _expired;
+
+    //  Returns the wheel handle of the timer, or NULL if there is none.
+    wheel_t::handle_t *find_handle (int timer_id_);
 
     ZMQ_NON_COPYABLE_NOR_MOVABLE (timers_t)
 };
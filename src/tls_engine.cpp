@@ -0,0 +1,100 @@
+/*
+    Copyright (c) 2007-2019 Contributors as noted in the AUTHORS file
+
+    This file is part of libzmq, the ZeroMQ core engine in C++.
+
+    libzmq is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License (LGPL) as published
+    by the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    As a special exception, the Contributors give you permission to link
+    this library with independent modules to produce an executable,
+    regardless of the license terms of these independent modules, and to
+    copy and distribute the resulting executable under terms of your choice,
+    provided that you also meet, for each linked independent module, the
+    terms and conditions of the license of that module. An independent
+    module is a module which is not derived from or based on this library.
+    If you modify this library, you must extend this exception to your
+    version of the library.
+
+    libzmq is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "precompiled.hpp"
+#include "tls_engine.hpp"
+
+zmq::tls_engine_t::tls_engine_t (fd_t fd_,
+                                 const options_t &options_,
+                                 const endpoint_uri_pair_t &endpoint_uri_pair_,
+                                 bool client_,
+                                 void *tls_server_cred_,
+                                 const std::string &hostname_) :
+    zmtp_engine_t (fd_, options_, endpoint_uri_pair_),
+    _established (false),
+    _tls (fd_, options_, client_, tls_server_cred_, hostname_)
+{
+}
+
+zmq::tls_engine_t::~tls_engine_t ()
+{
+}
+
+void zmq::tls_engine_t::plug_internal ()
+{
+    //  The handshake timeout covers the TLS handshake and the ZMTP
+    //  handshake following it.
+    set_handshake_timer ();
+    set_pollin ();
+    in_event ();
+}
+
+void zmq::tls_engine_t::out_event ()
+{
+    if (_established)
+        return zmtp_engine_t::out_event ();
+
+    //  The TLS handshake waits for the socket to become writable.
+    handshake ();
+}
+
+bool zmq::tls_engine_t::handshake ()
+{
+    if (_established)
+        return zmtp_engine_t::handshake ();
+
+    const int rc = _tls.handshake ();
+
+    reset_pollout ();
+
+    if (rc == 0) {
+        _established = true;
+
+        //  Start the ZMTP handshake. This processes any input that is
+        //  already there, so we must not touch the engine afterwards.
+        zmtp_engine_t::plug_internal ();
+    } else if (errno == EAGAIN) {
+        if (_tls.handshake_wants_output ())
+            set_pollout ();
+    } else
+        error (zmq::i_engine::connection_error);
+
+    return false;
+}
+
+int zmq::tls_engine_t::read (void *data_, size_t size_)
+{
+    return _tls.read (data_, size_);
+}
+
+int zmq::tls_engine_t::write (const void *data_, size_t size_)
+{
+    return _tls.write (data_, size_);
+}
@@ -0,0 +1,71 @@
+/*
+    Copyright (c) 2007-2019 Contributors as noted in the AUTHORS file
+
+    This file is part of libzmq, the ZeroMQ core engine in C++.
+
+    libzmq is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License (LGPL) as published
+    by the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    As a special exception, the Contributors give you permission to link
+    this library with independent modules to produce an executable,
+    regardless of the license terms of these independent modules, and to
+    copy and distribute the resulting executable under terms of your choice,
+    provided that you also meet, for each linked independent module, the
+    terms and conditions of the license of that module. An independent
+    module is a module which is not derived from or based on this library.
+    If you modify this library, you must extend this exception to your
+    version of the library.
+
+    libzmq is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __ZMQ_TLS_ENGINE_HPP_INCLUDED__
+#define __ZMQ_TLS_ENGINE_HPP_INCLUDED__
+
+#include "zmtp_engine.hpp"
+#include "tls_stream.hpp"
+
+namespace zmq
+{
+//  ZMTP over a TLS session, for the tls:// transport. The ZMTP greeting
+//  starts once the TLS handshake is complete.
+
+class tls_engine_t ZMQ_FINAL : public zmtp_engine_t
+{
+  public:
+    tls_engine_t (fd_t fd_,
+                  const options_t &options_,
+                  const endpoint_uri_pair_t &endpoint_uri_pair_,
+                  bool client_,
+                  void *tls_server_cred_,
+                  const std::string &hostname_);
+    ~tls_engine_t ();
+
+    void out_event ();
+
+  protected:
+    bool handshake ();
+    void plug_internal ();
+    int read (void *data_, size_t size_);
+    int write (const void *data_, size_t size_);
+    bool can_gather_output () const { return false; }
+    bool has_buffered_input () const { return _tls.has_buffered_input (); }
+
+  private:
+    bool _established;
+    tls_stream_t _tls;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (tls_engine_t)
+};
+}
+
+#endif
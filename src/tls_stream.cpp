@@ -0,0 +1,438 @@
+/*
+Copyright (c) 2007-2019 Contributors as noted in the AUTHORS file
+
+This file is part of libzmq, the ZeroMQ core engine in C++.
+
+libzmq is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License (LGPL) as published
+by the Free Software Foundation; either version 3 of the License, or
+(at your option) any later version.
+
+As a special exception, the Contributors give you permission to link
+this library with independent modules to produce an executable,
+regardless of the license terms of these independent modules, and to
+copy and distribute the resulting executable under terms of your choice,
+provided that you also meet, for each linked independent module, the
+terms and conditions of the license of that module. An independent
+module is a module which is not derived from or based on this library.
+If you modify this library, you must extend this exception to your
+version of the library.
+
+libzmq is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "precompiled.hpp"
+#include "tls_stream.hpp"
+#include "err.hpp"
+
+#if defined ZMQ_HAVE_KTLS
+#include "tcp.hpp"
+
+#include <linux/tls.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+#endif
+
+static int verify_certificate_callback (gnutls_session_t session)
+{
+    unsigned int status;
+    const char *hostname;
+
+    // read hostname
+    hostname = (const char *) gnutls_session_get_ptr (session);
+
+    int rc = gnutls_certificate_verify_peers3 (session, hostname, &status);
+    zmq_assert (rc >= 0);
+
+    if (status != 0) {
+        // TODO: somehow log the error
+        // Certificate is not trusted
+        return GNUTLS_E_CERTIFICATE_ERROR;
+    }
+
+    // notify gnutls to continue handshake normally
+    return 0;
+}
+
+//  True if the host name is an IPv4 or IPv6 address rather than a DNS name.
+static bool is_address_literal (const std::string &host_)
+{
+    if (host_.find (':') != std::string::npos)
+        return true;
+    return host_.find_first_not_of ("0123456789.") == std::string::npos;
+}
+
+#if defined ZMQ_HAVE_KTLS
+//  TLS record content types, RFC 8446 section 5.1
+static const unsigned char tls_record_handshake = 22;
+static const unsigned char tls_record_application_data = 23;
+
+//  Handshake message type of TLS 1.3 session tickets, RFC 8446 section 4
+static const unsigned char tls_handshake_new_session_ticket = 4;
+
+//  True if the handshake record holds nothing but complete session tickets.
+static bool only_session_tickets (const unsigned char *data_, size_t size_)
+{
+    while (size_ > 0) {
+        if (size_ < 4 || data_[0] != tls_handshake_new_session_ticket)
+            return false;
+        const size_t length = (static_cast<size_t> (data_[1]) << 16)
+                              | (static_cast<size_t> (data_[2]) << 8)
+                              | data_[3];
+        if (length > size_ - 4)
+            return false;
+        data_ += 4 + length;
+        size_ -= 4 + length;
+    }
+    return true;
+}
+
+//  Fills in the kernel's description of an AEAD record state. TLS 1.2
+//  AES-GCM carries an explicit nonce, which starts at the sequence number;
+//  otherwise the nonce is the part of gnutls' IV that follows the salt.
+template <typename T>
+static bool set_ktls_aead (zmq::fd_t fd_,
+                           int optname_,
+                           T &info_,
+                           bool explicit_nonce_,
+                           const gnutls_datum_t &iv_,
+                           const gnutls_datum_t &key_,
+                           const unsigned char *seq_)
+{
+    const size_t salt_size = sizeof info_.salt;
+    if (key_.size != sizeof info_.key
+        || iv_.size != salt_size + (explicit_nonce_ ? 0 : sizeof info_.iv))
+        return false;
+
+    memcpy (info_.key, key_.data, sizeof info_.key);
+    memcpy (info_.salt, iv_.data, salt_size);
+    if (explicit_nonce_)
+        memcpy (info_.iv, seq_, sizeof info_.iv);
+    else
+        memcpy (info_.iv, iv_.data + salt_size, sizeof info_.iv);
+    memcpy (info_.rec_seq, seq_, sizeof info_.rec_seq);
+
+    return setsockopt (fd_, SOL_TLS, optname_, &info_, sizeof info_) == 0;
+}
+
+//  Hands the current record state of one direction over to the kernel.
+static bool set_ktls_state (gnutls_session_t session_,
+                            zmq::fd_t fd_,
+                            bool read_)
+{
+    gnutls_datum_t mac_key;
+    gnutls_datum_t iv;
+    gnutls_datum_t cipher_key;
+    unsigned char seq[8];
+    if (gnutls_record_get_state (session_, read_ ? 1 : 0, &mac_key, &iv,
+                                 &cipher_key, seq)
+        != GNUTLS_E_SUCCESS)
+        return false;
+
+    const bool tls13 = gnutls_protocol_get_version (session_) == GNUTLS_TLS1_3;
+    const unsigned short version = tls13 ? TLS_1_3_VERSION : TLS_1_2_VERSION;
+    const int optname = read_ ? TLS_RX : TLS_TX;
+
+    switch (gnutls_cipher_get (session_)) {
+        case GNUTLS_CIPHER_AES_128_GCM: {
+            tls12_crypto_info_aes_gcm_128 info;
+            memset (&info, 0, sizeof info);
+            info.info.version = version;
+            info.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+            return set_ktls_aead (fd_, optname, info, !tls13, iv, cipher_key,
+                                  seq);
+        }
+#if defined TLS_CIPHER_AES_GCM_256
+        case GNUTLS_CIPHER_AES_256_GCM: {
+            tls12_crypto_info_aes_gcm_256 info;
+            memset (&info, 0, sizeof info);
+            info.info.version = version;
+            info.info.cipher_type = TLS_CIPHER_AES_GCM_256;
+            return set_ktls_aead (fd_, optname, info, !tls13, iv, cipher_key,
+                                  seq);
+        }
+#endif
+#if defined TLS_CIPHER_CHACHA20_POLY1305
+        case GNUTLS_CIPHER_CHACHA20_POLY1305: {
+            tls12_crypto_info_chacha20_poly1305 info;
+            memset (&info, 0, sizeof info);
+            info.info.version = version;
+            info.info.cipher_type = TLS_CIPHER_CHACHA20_POLY1305;
+            return set_ktls_aead (fd_, optname, info, false, iv, cipher_key,
+                                  seq);
+        }
+#endif
+        default:
+            return false;
+    }
+}
+#endif
+
+zmq::tls_stream_t::tls_stream_t (fd_t fd_,
+                                 const options_t &options_,
+                                 bool client_,
+                                 void *tls_server_cred_,
+                                 const std::string &hostname_) :
+    _fd (fd_),
+    _ktls (options_.wss_ktls),
+    _hostname (hostname_),
+    _tls_client_cred (NULL),
+    _ktls_send (false),
+    _ktls_recv (false)
+{
+    int rc = 0;
+
+    if (client_) {
+        // TODO: move to session_base, to allow changing the socket options between connect calls
+        rc = gnutls_certificate_allocate_credentials (&_tls_client_cred);
+        zmq_assert (rc == 0);
+
+        if (options_.wss_trust_system)
+            gnutls_certificate_set_x509_system_trust (_tls_client_cred);
+
+        if (options_.wss_trust_pem.length () > 0) {
+            gnutls_datum_t trust = {
+              (unsigned char *) options_.wss_trust_pem.c_str (),
+              (unsigned int) options_.wss_trust_pem.length ()};
+            rc = gnutls_certificate_set_x509_trust_mem (
+              _tls_client_cred, &trust, GNUTLS_X509_FMT_PEM);
+            zmq_assert (rc >= 0);
+        }
+
+        gnutls_certificate_set_verify_function (_tls_client_cred,
+                                                verify_certificate_callback);
+
+        rc = gnutls_init (&_tls_session, GNUTLS_CLIENT | GNUTLS_NONBLOCK);
+        zmq_assert (rc == GNUTLS_E_SUCCESS);
+
+        //  Server name indication carries DNS names only, while an address
+        //  is still checked against the certificate below.
+        if (!_hostname.empty () && !is_address_literal (_hostname))
+            gnutls_server_name_set (_tls_session, GNUTLS_NAME_DNS,
+                                    _hostname.c_str (), _hostname.size ());
+
+        gnutls_session_set_ptr (
+          _tls_session,
+          _hostname.empty () ? NULL : const_cast<char *> (_hostname.c_str ()));
+
+        rc = gnutls_credentials_set (_tls_session, GNUTLS_CRD_CERTIFICATE,
+                                     _tls_client_cred);
+        zmq_assert (rc == GNUTLS_E_SUCCESS);
+    } else {
+        zmq_assert (tls_server_cred_);
+
+        rc = gnutls_init (&_tls_session, GNUTLS_SERVER | GNUTLS_NONBLOCK);
+        zmq_assert (rc == GNUTLS_E_SUCCESS);
+
+        rc = gnutls_credentials_set (_tls_session, GNUTLS_CRD_CERTIFICATE,
+                                     tls_server_cred_);
+        zmq_assert (rc == GNUTLS_E_SUCCESS);
+    }
+
+    gnutls_set_default_priority (_tls_session);
+    gnutls_transport_set_int (_tls_session, fd_);
+}
+
+zmq::tls_stream_t::~tls_stream_t ()
+{
+    gnutls_deinit (_tls_session);
+
+    if (_tls_client_cred)
+        gnutls_certificate_free_credentials (_tls_client_cred);
+}
+
+gnutls_certificate_credentials_t
+zmq::tls_stream_t::create_server_credentials (const options_t &options_)
+{
+    gnutls_certificate_credentials_t cred;
+    int rc = gnutls_certificate_allocate_credentials (&cred);
+    zmq_assert (rc == GNUTLS_E_SUCCESS);
+
+    gnutls_datum_t cert = {(unsigned char *) options_.wss_cert_pem.c_str (),
+                           (unsigned int) options_.wss_cert_pem.length ()};
+    gnutls_datum_t key = {(unsigned char *) options_.wss_key_pem.c_str (),
+                          (unsigned int) options_.wss_key_pem.length ()};
+    rc = gnutls_certificate_set_x509_key_mem (cred, &cert, &key,
+                                              GNUTLS_X509_FMT_PEM);
+    if (rc != GNUTLS_E_SUCCESS) {
+        gnutls_certificate_free_credentials (cred);
+        return NULL;
+    }
+
+    return cred;
+}
+
+int zmq::tls_stream_t::handshake ()
+{
+    const int rc = gnutls_handshake (_tls_session);
+
+    if (rc == GNUTLS_E_SUCCESS) {
+#if defined ZMQ_HAVE_KTLS
+        if (_ktls)
+            enable_ktls ();
+#endif
+        return 0;
+    }
+    if (rc == GNUTLS_E_AGAIN || rc == GNUTLS_E_INTERRUPTED
+        || rc == GNUTLS_E_WARNING_ALERT_RECEIVED) {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    errno = EPROTO;
+    return -1;
+}
+
+bool zmq::tls_stream_t::handshake_wants_output () const
+{
+    return gnutls_record_get_direction (_tls_session) == 1;
+}
+
+#if defined ZMQ_HAVE_KTLS
+void zmq::tls_stream_t::enable_ktls ()
+{
+    //  The kernel takes over at the next record; anything gnutls has
+    //  already decrypted would be lost.
+    if (gnutls_record_check_pending (_tls_session) > 0)
+        return;
+
+    if (setsockopt (_fd, SOL_TCP, TCP_ULP, "tls", sizeof "tls") != 0)
+        return;
+
+    //  Either direction may fail on its own, e.g. for a cipher the kernel
+    //  only implements for sending. gnutls keeps handling it then.
+    _ktls_recv = set_ktls_state (_tls_session, _fd, true);
+    _ktls_send = set_ktls_state (_tls_session, _fd, false);
+}
+
+int zmq::tls_stream_t::ktls_read (void *data_, size_t size_)
+{
+    while (true) {
+        iovec iov = {data_, size_};
+        unsigned char control[CMSG_SPACE (sizeof (unsigned char))];
+        msghdr msg;
+        memset (&msg, 0, sizeof msg);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof control;
+
+        const ssize_t rc = recvmsg (_fd, &msg, 0);
+        if (rc == -1) {
+            if (errno == EWOULDBLOCK)
+                errno = EAGAIN;
+            return -1;
+        }
+        if (rc == 0) {
+            errno = EPIPE;
+            return -1;
+        }
+
+        //  The kernel returns records that are not application data one at
+        //  a time, tagged with their type. TLS 1.3 session tickets are of
+        //  no use to us. Any other post-handshake message, e.g. a KeyUpdate,
+        //  changes the record state, which the kernel cannot follow, so
+        //  the connection fails rather than misreading the records after
+        //  it. An alert ends the connection.
+        const cmsghdr *cmsg = CMSG_FIRSTHDR (&msg);
+        if (cmsg && cmsg->cmsg_level == SOL_TLS
+            && cmsg->cmsg_type == TLS_GET_RECORD_TYPE) {
+            const unsigned char type = *CMSG_DATA (cmsg);
+            if (type == tls_record_handshake) {
+                if (only_session_tickets (static_cast<unsigned char *> (data_),
+                                          static_cast<size_t> (rc)))
+                    continue;
+                errno = EPROTO;
+                return -1;
+            }
+            if (type != tls_record_application_data) {
+                errno = EPIPE;
+                return -1;
+            }
+        }
+
+        // TODO: change return type to ssize_t (signed)
+        return static_cast<int> (rc);
+    }
+}
+#endif
+
+int zmq::tls_stream_t::read (void *data_, size_t size_)
+{
+#if defined ZMQ_HAVE_KTLS
+    if (_ktls_recv)
+        return ktls_read (data_, size_);
+#endif
+
+    ssize_t rc = gnutls_record_recv (_tls_session, data_, size_);
+
+    if (rc == GNUTLS_E_REHANDSHAKE) {
+        gnutls_alert_send (_tls_session, GNUTLS_AL_WARNING,
+                           GNUTLS_A_NO_RENEGOTIATION);
+        return 0;
+    }
+
+    if (rc == GNUTLS_E_INTERRUPTED) {
+        errno = EINTR;
+        return -1;
+    }
+
+    if (rc == GNUTLS_E_AGAIN) {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    if (rc == 0) {
+        errno = EPIPE;
+        return -1;
+    }
+
+    if (rc < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    // TODO: change return type to ssize_t (signed)
+    return rc;
+}
+
+bool zmq::tls_stream_t::has_buffered_input () const
+{
+    //  The kernel keeps kTLS records in the socket buffer.
+    return !_ktls_recv && gnutls_record_check_pending (_tls_session) > 0;
+}
+
+int zmq::tls_stream_t::write (const void *data_, size_t size_)
+{
+#if defined ZMQ_HAVE_KTLS
+    if (_ktls_send)
+        return tcp_write (_fd, data_, size_);
+#endif
+
+    ssize_t rc = gnutls_record_send (_tls_session, data_, size_);
+
+    if (rc == GNUTLS_E_INTERRUPTED || rc == GNUTLS_E_AGAIN) {
+        return 0;
+    }
+
+    if (rc < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    // TODO: change return type to ssize_t (signed)
+    return rc;
+}
@@ -0,0 +1,107 @@
+/*
+    Copyright (c) 2007-2019 Contributors as noted in the AUTHORS file
+
+    This file is part of libzmq, the ZeroMQ core engine in C++.
+
+    libzmq is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License (LGPL) as published
+    by the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    As a special exception, the Contributors give you permission to link
+    this library with independent modules to produce an executable,
+    regardless of the license terms of these independent modules, and to
+    copy and distribute the resulting executable under terms of your choice,
+    provided that you also meet, for each linked independent module, the
+    terms and conditions of the license of that module. An independent
+    module is a module which is not derived from or based on this library.
+    If you modify this library, you must extend this exception to your
+    version of the library.
+
+    libzmq is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __ZMQ_TLS_STREAM_HPP_INCLUDED__
+#define __ZMQ_TLS_STREAM_HPP_INCLUDED__
+
+#include <string>
+#include <gnutls/gnutls.h>
+
+#include "fd.hpp"
+#include "macros.hpp"
+#include "options.hpp"
+
+namespace zmq
+{
+//  A GnuTLS session over a connected TCP socket. It is what the WSS and
+//  TLS engines have in common: the handshake, the certificate checks and
+//  the record I/O, which may be handed to the kernel (ZMQ_WSS_KTLS).
+
+class tls_stream_t
+{
+  public:
+    //  Clients pass the hostname to check the server's certificate
+    //  against, servers the credentials created by the listener.
+    tls_stream_t (fd_t fd_,
+                  const options_t &options_,
+                  bool client_,
+                  void *tls_server_cred_,
+                  const std::string &hostname_);
+    ~tls_stream_t ();
+
+    //  Loads the certificate and key set with ZMQ_WSS_CERT_PEM and
+    //  ZMQ_WSS_KEY_PEM, for a listener to pass to its connections.
+    //  Returns NULL if they are missing or invalid.
+    static gnutls_certificate_credentials_t
+    create_server_credentials (const options_t &options_);
+
+    //  Advances the TLS handshake. Returns 0 once it is complete, or -1
+    //  with errno set to EAGAIN while it is in progress and to EPROTO if
+    //  it failed.
+    int handshake ();
+
+    //  True if the handshake in progress waits for the socket to become
+    //  writable.
+    bool handshake_wants_output () const;
+
+    //  Same semantics as tcp_read and tcp_write.
+    int read (void *data_, size_t size_);
+    int write (const void *data_, size_t size_);
+
+    //  True if read has decrypted data left over from a TLS record.
+    bool has_buffered_input () const;
+
+  private:
+#if defined ZMQ_HAVE_KTLS
+    //  Moves the record encryption of the session into the kernel, for
+    //  each direction where both the kernel and the cipher allow it.
+    void enable_ktls ();
+    int ktls_read (void *data_, size_t size_);
+#endif
+
+    const fd_t _fd;
+    const bool _ktls;
+
+    //  The certificate check runs after the connecter that passed the
+    //  name in is gone, so keep a copy.
+    const std::string _hostname;
+
+    gnutls_certificate_credentials_t _tls_client_cred;
+    gnutls_session_t _tls_session;
+
+    //  True for the directions whose records the kernel handles.
+    bool _ktls_send;
+    bool _ktls_recv;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (tls_stream_t)
+};
+}
+
+#endif
@@ -49,6 +49,7 @@
 /* clang-format off */
 
 #include "tweetnacl.h"
+#include "stdint.hpp"
 
 #define FOR(i,n) for (i = 0;i < n;++i)
 #define sv static void
@@ -66,11 +67,9 @@ static const gf
   Y = {0x6658, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666},
   I = {0xa0b0, 0x4a0e, 0x1b27, 0xc4ee, 0xe478, 0xad2f, 0x1806, 0x2f43, 0xd7a7, 0x3dfb, 0x0099, 0x2b4d, 0xdf0b, 0x4fc1, 0x2480, 0x2b83};
 
-static u32 L32(u32 x,int c) { return (x << c) | ((x&0xffffffff) >> (32 - c)); }
-
-static u32 ld32(const u8 *x)
+static uint32_t ld32(const u8 *x)
 {
-  u32 u = x[3];
+  uint32_t u = x[3];
   u = (u<<8)|x[2];
   u = (u<<8)|x[1];
   return (u<<8)|x[0];
@@ -83,7 +82,7 @@ static u64 dl64(const u8 *x)
   return u;
 }
 
-sv st32(u8 *x,u32 u)
+sv st32(u8 *x,uint32_t u)
 {
   int i;
   FOR(i,4) { x[i] = u; u >>= 8; }
@@ -112,38 +111,49 @@ int crypto_verify_32(const u8 *x,const u8 *y)
   return vn(x,y,32);
 }
 
-sv core(u8 *out,const u8 *in,const u8 *k,const u8 *c,int h)
+/*
+    The rounds are written out on 32-bit words rather than shuffled through a
+    temporary block, which is several times faster on every compiler we tried.
+*/
+#define R32(x,c) (((x) << (c)) | ((x) >> (32 - (c))))
+#define QR(x,a,b,c,d) \
+  x[b] ^= R32(x[a] + x[d], 7); \
+  x[c] ^= R32(x[b] + x[a], 9); \
+  x[d] ^= R32(x[c] + x[b],13); \
+  x[a] ^= R32(x[d] + x[c],18);
+
+sv rounds(uint32_t *x)
 {
-  u32 w[16],x[16],y[16],t[4];
-  int i,j,m;
+  int i;
+  for (i = 0;i < 20;i += 2) {
+    QR(x, 0, 4, 8,12) QR(x, 5, 9,13, 1) QR(x,10,14, 2, 6) QR(x,15, 3, 7,11)
+    QR(x, 0, 1, 2, 3) QR(x, 5, 6, 7, 4) QR(x,10,11, 8, 9) QR(x,15,12,13,14)
+  }
+}
+
+#undef QR
 
+sv setup(uint32_t *x,const u8 *in,const u8 *k,const u8 *c)
+{
+  int i;
   FOR(i,4) {
     x[5*i] = ld32(c+4*i);
     x[1+i] = ld32(k+4*i);
     x[6+i] = ld32(in+4*i);
     x[11+i] = ld32(k+16+4*i);
   }
+}
 
-  FOR(i,16) y[i] = x[i];
+sv core(u8 *out,const u8 *in,const u8 *k,const u8 *c,int h)
+{
+  uint32_t x[16],y[16];
+  int i;
 
-  FOR(i,20) {
-    FOR(j,4) {
-      FOR(m,4) t[m] = x[(5*j+4*m)%16];
-      t[1] ^= L32(t[0]+t[3], 7);
-      t[2] ^= L32(t[1]+t[0], 9);
-      t[3] ^= L32(t[2]+t[1],13);
-      t[0] ^= L32(t[3]+t[2],18);
-      FOR(m,4) w[4*j+(j+m)%4] = t[m];
-    }
-    FOR(m,16) x[m] = w[m];
-  }
+  setup(y,in,k,c);
+  FOR(i,16) x[i] = y[i];
+  rounds(x);
 
   if (h) {
-    FOR(i,16) x[i] += y[i];
-    FOR(i,4) {
-      x[5*i] -= ld32(c+4*i);
-      x[6+i] -= ld32(in+4*i);
-    }
     FOR(i,4) {
       st32(out+4*i,x[5*i]);
       st32(out+16+4*i,x[6+i]);
@@ -169,25 +179,33 @@ static const u8 sigma[16] = "expand 32-byte k";
 int crypto_stream_salsa20_xor(u8 *c,const u8 *m,u64 b,const u8 *n,const u8 *k)
 {
   u8 z[16],x[64];
-  u32 u,i;
+  uint32_t y[16],w[16];
+  u64 ctr = 0;
+  u32 i;
   if (!b) return 0;
   FOR(i,16) z[i] = 0;
   FOR(i,8) z[i] = n[i];
+  setup(y,z,k,sigma);
   while (b >= 64) {
-    crypto_core_salsa20(x,z,k,sigma);
-    FOR(i,64) c[i] = (m?m[i]:0) ^ x[i];
-    u = 1;
-    for (i = 8;i < 16;++i) {
-      u += (u32) z[i];
-      z[i] = u;
-      u >>= 8;
-    }
+    y[8] = (uint32_t) ctr;
+    y[9] = (uint32_t) (ctr >> 32);
+    FOR(i,16) w[i] = y[i];
+    rounds(w);
+    if (m)
+      FOR(i,16) st32(c + 4 * i,ld32(m + 4 * i) ^ (w[i] + y[i]));
+    else
+      FOR(i,16) st32(c + 4 * i,w[i] + y[i]);
+    ++ctr;
     b -= 64;
     c += 64;
     if (m) m += 64;
   }
   if (b) {
-    crypto_core_salsa20(x,z,k,sigma);
+    y[8] = (uint32_t) ctr;
+    y[9] = (uint32_t) (ctr >> 32);
+    FOR(i,16) w[i] = y[i];
+    rounds(w);
+    FOR(i,16) st32(x + 4 * i,w[i] + y[i]);
     FOR(i,b) c[i] = (m?m[i]:0) ^ x[i];
   }
   return 0;
@@ -212,70 +230,96 @@ int crypto_stream_xor(u8 *c,const u8 *m,u64 d,const u8 *n,const u8 *k)
   return crypto_stream_salsa20_xor(c,m,d,n+16,s);
 }
 
-sv add1305(u32 *h,const u32 *c)
-{
-  u32 j,u = 0;
-  FOR(j,17) {
-    u += h[j] + c[j];
-    h[j] = u & 255;
-    u >>= 8;
-  }
-}
-
-static const u32 minusp[17] = {
-  5, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 252
-} ;
-
+/*
+    Poly1305 on five 26-bit limbs with 64-bit products, as in poly1305-donna,
+    instead of the reference version's seventeen 8-bit limbs.
+*/
 int crypto_onetimeauth(u8 *out,const u8 *m,u64 n,const u8 *k)
 {
-  u32 s,i,j,u,x[17],r[17],h[17],c[17],g[17];
-
-  FOR(j,17) r[j]=h[j]=0;
-  FOR(j,16) r[j]=k[j];
-  r[3]&=15;
-  r[4]&=252;
-  r[7]&=15;
-  r[8]&=252;
-  r[11]&=15;
-  r[12]&=252;
-  r[15]&=15;
+  const uint32_t mask = 0x3ffffff;
+  uint32_t r0,r1,r2,r3,r4,s1,s2,s3,s4,h0,h1,h2,h3,h4,g0,g1,g2,g3,g4,c,hibit;
+  uint64_t d0,d1,d2,d3,d4,f;
+  u8 t[16];
+  u32 i;
+
+  r0 = ld32(k + 0) & 0x3ffffff;
+  r1 = (ld32(k + 3) >> 2) & 0x3ffff03;
+  r2 = (ld32(k + 6) >> 4) & 0x3ffc0ff;
+  r3 = (ld32(k + 9) >> 6) & 0x3f03fff;
+  r4 = (ld32(k + 12) >> 8) & 0x00fffff;
+  s1 = r1 * 5; s2 = r2 * 5; s3 = r3 * 5; s4 = r4 * 5;
+  h0 = h1 = h2 = h3 = h4 = 0;
 
   while (n > 0) {
-    FOR(j,17) c[j] = 0;
-    for (j = 0;(j < 16) && (j < n);++j) c[j] = m[j];
-    c[j] = 1;
-    m += j; n -= j;
-    add1305(h,c);
-    FOR(i,17) {
-      x[i] = 0;
-      FOR(j,17) x[i] += h[j] * ((j <= i) ? r[i - j] : 320 * r[i + 17 - j]);
+    hibit = 1 << 24;
+    if (n < 16) {
+      FOR(i,16) t[i] = i < n ? m[i] : 0;
+      t[n] = 1;
+      hibit = 0;
+      m = t;
+      n = 16;
     }
-    FOR(i,17) h[i] = x[i];
-    u = 0;
-    FOR(j,16) {
-      u += h[j];
-      h[j] = u & 255;
-      u >>= 8;
-    }
-    u += h[16]; h[16] = u & 3;
-    u = 5 * (u >> 2);
-    FOR(j,16) {
-      u += h[j];
-      h[j] = u & 255;
-      u >>= 8;
-    }
-    u += h[16]; h[16] = u;
+    h0 += ld32(m + 0) & mask;
+    h1 += (ld32(m + 3) >> 2) & mask;
+    h2 += (ld32(m + 6) >> 4) & mask;
+    h3 += (ld32(m + 9) >> 6) & mask;
+    h4 += (ld32(m + 12) >> 8) | hibit;
+
+    d0 = (uint64_t) h0 * r0 + (uint64_t) h1 * s4 + (uint64_t) h2 * s3
+       + (uint64_t) h3 * s2 + (uint64_t) h4 * s1;
+    d1 = (uint64_t) h0 * r1 + (uint64_t) h1 * r0 + (uint64_t) h2 * s4
+       + (uint64_t) h3 * s3 + (uint64_t) h4 * s2;
+    d2 = (uint64_t) h0 * r2 + (uint64_t) h1 * r1 + (uint64_t) h2 * r0
+       + (uint64_t) h3 * s4 + (uint64_t) h4 * s3;
+    d3 = (uint64_t) h0 * r3 + (uint64_t) h1 * r2 + (uint64_t) h2 * r1
+       + (uint64_t) h3 * r0 + (uint64_t) h4 * s4;
+    d4 = (uint64_t) h0 * r4 + (uint64_t) h1 * r3 + (uint64_t) h2 * r2
+       + (uint64_t) h3 * r1 + (uint64_t) h4 * r0;
+
+    c = (uint32_t) (d0 >> 26); h0 = (uint32_t) d0 & mask;
+    d1 += c; c = (uint32_t) (d1 >> 26); h1 = (uint32_t) d1 & mask;
+    d2 += c; c = (uint32_t) (d2 >> 26); h2 = (uint32_t) d2 & mask;
+    d3 += c; c = (uint32_t) (d3 >> 26); h3 = (uint32_t) d3 & mask;
+    d4 += c; c = (uint32_t) (d4 >> 26); h4 = (uint32_t) d4 & mask;
+    h0 += c * 5; c = h0 >> 26; h0 &= mask;
+    h1 += c;
+
+    m += 16;
+    n -= 16;
   }
 
-  FOR(j,17) g[j] = h[j];
-  add1305(h,minusp);
-  s = -(h[16] >> 7);
-  FOR(j,17) h[j] ^= s & (g[j] ^ h[j]);
-
-  FOR(j,16) c[j] = k[j + 16];
-  c[16] = 0;
-  add1305(h,c);
-  FOR(j,16) out[j] = h[j];
+  c = h1 >> 26; h1 &= mask;
+  h2 += c; c = h2 >> 26; h2 &= mask;
+  h3 += c; c = h3 >> 26; h3 &= mask;
+  h4 += c; c = h4 >> 26; h4 &= mask;
+  h0 += c * 5; c = h0 >> 26; h0 &= mask;
+  h1 += c;
+
+  /* Constant time selection of h or h - p. */
+  g0 = h0 + 5; c = g0 >> 26; g0 &= mask;
+  g1 = h1 + c; c = g1 >> 26; g1 &= mask;
+  g2 = h2 + c; c = g2 >> 26; g2 &= mask;
+  g3 = h3 + c; c = g3 >> 26; g3 &= mask;
+  g4 = h4 + c - (1 << 26);
+
+  c = (g4 >> 31) - 1;
+  g0 &= c; g1 &= c; g2 &= c; g3 &= c; g4 &= c;
+  c = ~c;
+  h0 = (h0 & c) | g0;
+  h1 = (h1 & c) | g1;
+  h2 = (h2 & c) | g2;
+  h3 = (h3 & c) | g3;
+  h4 = (h4 & c) | g4;
+
+  h0 = h0 | (h1 << 26);
+  h1 = (h1 >> 6) | (h2 << 20);
+  h2 = (h2 >> 12) | (h3 << 14);
+  h3 = (h3 >> 18) | (h4 << 8);
+
+  f = (uint64_t) h0 + ld32(k + 16); st32(out + 0,(uint32_t) f);
+  f = (uint64_t) h1 + ld32(k + 20) + (f >> 32); st32(out + 4,(uint32_t) f);
+  f = (uint64_t) h2 + ld32(k + 24) + (f >> 32); st32(out + 8,(uint32_t) f);
+  f = (uint64_t) h3 + ld32(k + 28) + (f >> 32); st32(out + 12,(uint32_t) f);
   return 0;
 }
 
@@ -38,10 +38,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef ZMQ_HAVE_VXWORKS
 #include <sockLib.h>
 #endif
+#if defined ZMQ_HAVE_UDP_SEGMENT || defined ZMQ_HAVE_UDP_GRO
+#include <netinet/udp.h>
+#endif
 #endif
 
 #include "udp_address.hpp"
 #include "udp_engine.hpp"
+#include "config.hpp"
 #include "session_base.hpp"
 #include "err.hpp"
 #include "ip.hpp"
@@ -63,7 +67,20 @@ zmq::udp_engine_t::udp_engine_t (const options_t &options_) :
     _address (NULL),
     _options (options_),
     _send_enabled (false),
-    _recv_enabled (false)
+    _recv_enabled (false),
+    _batch_size (1)
+#if defined ZMQ_HAVE_RECVMMSG
+    ,
+    _in_batch_size (1)
+#endif
+#if defined ZMQ_HAVE_SENDMMSG && defined ZMQ_HAVE_UDP_SEGMENT
+    ,
+    _gso (false)
+#endif
+#if defined ZMQ_HAVE_RECVMMSG && defined ZMQ_HAVE_UDP_GRO
+    ,
+    _gro (false)
+#endif
 {
 }
 
@@ -98,6 +115,70 @@ int zmq::udp_engine_t::init (address_t *address_, bool send_, bool recv_)
 
     unblock_socket (_fd);
 
+#if defined ZMQ_HAVE_SENDMMSG || defined ZMQ_HAVE_RECVMMSG
+    _batch_size = _options.udp_batch_size;
+#endif
+
+#if defined ZMQ_HAVE_SENDMMSG
+    if (_send_enabled && _batch_size > 1) {
+        _out_batch.resize (_batch_size * MAX_UDP_MSG);
+        _out_iovs.resize (_batch_size);
+        _out_msgs.resize (_batch_size);
+        _out_raw_addresses.resize (_batch_size);
+        for (int i = 0; i < _batch_size; i++) {
+            _out_iovs[i].iov_base = &_out_batch[i * MAX_UDP_MSG];
+            _out_msgs[i].msg_hdr.msg_iov = &_out_iovs[i];
+            _out_msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+#if defined ZMQ_HAVE_UDP_SEGMENT
+        if (_options.udp_offload) {
+            _gso = true;
+            _out_control.resize (_batch_size
+                                 * CMSG_SPACE (sizeof (uint16_t)));
+            _out_segments.resize (_batch_size);
+            _out_segment_sizes.resize (_batch_size);
+        }
+#endif
+    }
+#endif
+
+#if defined ZMQ_HAVE_RECVMMSG
+    if (_recv_enabled && _batch_size > 1) {
+        size_t slot_size = MAX_UDP_MSG;
+        _in_batch_size = _batch_size;
+#if defined ZMQ_HAVE_UDP_GRO
+        if (_options.udp_offload) {
+            //  Older kernels do not support GRO on UDP sockets, in which
+            //  case we simply receive one datagram per slot.
+            int on = 1;
+            _gro = setsockopt (_fd, IPPROTO_UDP, UDP_GRO,
+                               reinterpret_cast<char *> (&on), sizeof (on))
+                   == 0;
+            if (_gro) {
+                //  Coalesced datagrams need much larger buffers, but few
+                //  of them carry as many datagrams as a full batch.
+                slot_size = max_udp_gro_size;
+                if (_in_batch_size > max_udp_gro_batch_size)
+                    _in_batch_size = max_udp_gro_batch_size;
+                _in_control.resize (_in_batch_size
+                                    * CMSG_SPACE (sizeof (int)));
+            }
+        }
+#endif
+        _in_batch.resize (_in_batch_size * slot_size);
+        _in_iovs.resize (_in_batch_size);
+        _in_msgs.resize (_in_batch_size);
+        _in_addresses.resize (_in_batch_size);
+        for (int i = 0; i < _in_batch_size; i++) {
+            _in_iovs[i].iov_base = &_in_batch[i * slot_size];
+            _in_iovs[i].iov_len = slot_size;
+            _in_msgs[i].msg_hdr.msg_iov = &_in_iovs[i];
+            _in_msgs[i].msg_hdr.msg_iovlen = 1;
+            _in_msgs[i].msg_hdr.msg_name = &_in_addresses[i];
+        }
+    }
+#endif
+
     return 0;
 }
 
@@ -434,82 +515,314 @@ int zmq::udp_engine_t::resolve_raw_address (const char *name_, size_t length_)
     return 0;
 }
 
-void zmq::udp_engine_t::out_event ()
+int zmq::udp_engine_t::pull_datagram (char *buffer_, size_t *size_)
 {
     msg_t group_msg;
     int rc = _session->pull_msg (&group_msg);
     errno_assert (rc == 0 || (rc == -1 && errno == EAGAIN));
+    if (rc != 0)
+        return -1;
 
-    if (rc == 0) {
-        msg_t body_msg;
-        rc = _session->pull_msg (&body_msg);
-        //  If there's a group, there should also be a body
-        errno_assert (rc == 0);
+    msg_t body_msg;
+    rc = _session->pull_msg (&body_msg);
+    //  If there's a group, there should also be a body
+    errno_assert (rc == 0);
 
-        const size_t group_size = group_msg.size ();
-        const size_t body_size = body_msg.size ();
-        size_t size;
+    const size_t group_size = group_msg.size ();
+    const size_t body_size = body_msg.size ();
 
-        if (_options.raw_socket) {
-            rc = resolve_raw_address (static_cast<char *> (group_msg.data ()),
-                                      group_size);
+    //  We discard the message if it does not fit into a datagram buffer
+    const size_t datagram_size =
+      _options.raw_socket ? body_size : group_size + body_size + 1;
+    if (datagram_size > MAX_UDP_MSG) {
+        rc = group_msg.close ();
+        errno_assert (rc == 0);
 
-            //  We discard the message if address is not valid
-            if (rc != 0) {
-                rc = group_msg.close ();
-                errno_assert (rc == 0);
+        rc = body_msg.close ();
+        errno_assert (rc == 0);
 
-                rc = body_msg.close ();
-                errno_assert (rc == 0);
+        errno = EMSGSIZE;
+        return -1;
+    }
 
-                return;
-            }
+    if (_options.raw_socket) {
+        rc = resolve_raw_address (static_cast<char *> (group_msg.data ()),
+                                  group_size);
 
-            size = body_size;
+        //  We discard the message if address is not valid
+        if (rc != 0) {
+            rc = group_msg.close ();
+            errno_assert (rc == 0);
 
-            memcpy (_out_buffer, body_msg.data (), body_size);
-        } else {
-            size = group_size + body_size + 1;
+            rc = body_msg.close ();
+            errno_assert (rc == 0);
 
-            // TODO: check if larger than maximum size
-            _out_buffer[0] = static_cast<unsigned char> (group_size);
-            memcpy (_out_buffer + 1, group_msg.data (), group_size);
-            memcpy (_out_buffer + 1 + group_size, body_msg.data (), body_size);
+            errno = EINVAL;
+            return -1;
         }
 
-        rc = group_msg.close ();
-        errno_assert (rc == 0);
+        memcpy (buffer_, body_msg.data (), body_size);
+    } else {
+        buffer_[0] = static_cast<unsigned char> (group_size);
+        memcpy (buffer_ + 1, group_msg.data (), group_size);
+        memcpy (buffer_ + 1 + group_size, body_msg.data (), body_size);
+    }
 
-        body_msg.close ();
-        errno_assert (rc == 0);
+    *size_ = datagram_size;
+
+    rc = group_msg.close ();
+    errno_assert (rc == 0);
+
+    rc = body_msg.close ();
+    errno_assert (rc == 0);
+
+    return 0;
+}
+
+void zmq::udp_engine_t::out_event ()
+{
+#if defined ZMQ_HAVE_SENDMMSG
+    if (_batch_size > 1) {
+        out_event_batch ();
+        return;
+    }
+#endif
+
+    size_t size;
+    int rc = pull_datagram (_out_buffer, &size);
+    if (rc != 0) {
+        if (errno == EAGAIN)
+            reset_pollout (_handle);
+        return;
+    }
 
 #ifdef ZMQ_HAVE_WINDOWS
-        rc = sendto (_fd, _out_buffer, static_cast<int> (size), 0, _out_address,
-                     _out_address_len);
+    rc = sendto (_fd, _out_buffer, static_cast<int> (size), 0, _out_address,
+                 _out_address_len);
 #elif defined ZMQ_HAVE_VXWORKS
-        rc = sendto (_fd, reinterpret_cast<caddr_t> (_out_buffer), size, 0,
-                     (sockaddr *) _out_address, _out_address_len);
+    rc = sendto (_fd, reinterpret_cast<caddr_t> (_out_buffer), size, 0,
+                 (sockaddr *) _out_address, _out_address_len);
 #else
-        rc = sendto (_fd, _out_buffer, size, 0, _out_address, _out_address_len);
+    rc = sendto (_fd, _out_buffer, size, 0, _out_address, _out_address_len);
 #endif
-        if (rc < 0) {
+    if (rc < 0) {
 #ifdef ZMQ_HAVE_WINDOWS
-            if (WSAGetLastError () != WSAEWOULDBLOCK) {
-                assert_success_or_recoverable (_fd, rc);
-                error (connection_error);
-            }
+        if (WSAGetLastError () != WSAEWOULDBLOCK) {
+            assert_success_or_recoverable (_fd, rc);
+            error (connection_error);
+        }
 #else
-            if (rc != EWOULDBLOCK) {
+        if (errno != EWOULDBLOCK) {
+            assert_success_or_recoverable (_fd, rc);
+            error (connection_error);
+        }
+#endif
+    }
+}
+
+#if defined ZMQ_HAVE_SENDMMSG
+void zmq::udp_engine_t::out_event_batch ()
+{
+#if defined ZMQ_HAVE_UDP_SEGMENT
+    if (_gso) {
+        out_event_gso ();
+        return;
+    }
+#endif
+
+    //  Serialise as many messages as the batch can hold.
+    int count = 0;
+    while (count < _batch_size) {
+        size_t size;
+        if (pull_datagram (&_out_batch[count * MAX_UDP_MSG], &size) != 0) {
+            if (errno == EAGAIN)
+                break;
+            continue;
+        }
+
+        msghdr &hdr = _out_msgs[count].msg_hdr;
+        _out_iovs[count].iov_len = size;
+        if (_options.raw_socket) {
+            _out_raw_addresses[count] = _raw_address;
+            hdr.msg_name = &_out_raw_addresses[count];
+            hdr.msg_namelen = static_cast<socklen_t> (sizeof (sockaddr_in));
+        } else {
+            hdr.msg_name = const_cast<sockaddr *> (_out_address);
+            hdr.msg_namelen = _out_address_len;
+        }
+        count++;
+    }
+
+    if (count == 0) {
+        reset_pollout (_handle);
+        return;
+    }
+
+    for (int sent = 0; sent < count;) {
+        const int rc = sendmmsg (_fd, &_out_msgs[sent],
+                                 static_cast<unsigned int> (count - sent), 0);
+        if (rc < 0) {
+            //  The rest of the batch is dropped, as a single datagram
+            //  would be.
+            if (errno != EWOULDBLOCK) {
                 assert_success_or_recoverable (_fd, rc);
                 error (connection_error);
             }
+            return;
+        }
+        sent += rc;
+    }
+}
 #endif
+
+#if defined ZMQ_HAVE_SENDMMSG && defined ZMQ_HAVE_UDP_SEGMENT
+void zmq::udp_engine_t::out_event_gso ()
+{
+    //  Datagrams are serialised back to back. Each run of equal sized
+    //  datagrams to the same destination is sent as one message which the
+    //  kernel splits into segments; only the last datagram of a run may be
+    //  shorter than the others.
+    int count = 0;
+    int runs = 0;
+    bool run_open = false;
+    size_t offset = 0;
+    while (count < _batch_size) {
+        char *const buffer = &_out_batch[offset];
+        size_t size;
+        if (pull_datagram (buffer, &size) != 0) {
+            if (errno == EAGAIN)
+                break;
+            continue;
         }
-    } else {
+        count++;
+        offset += size;
+
+        if (run_open) {
+            const int last = runs - 1;
+            const bool same_destination =
+              !_options.raw_socket
+              || (_out_raw_addresses[last].sin_addr.s_addr
+                    == _raw_address.sin_addr.s_addr
+                  && _out_raw_addresses[last].sin_port
+                       == _raw_address.sin_port);
+            if (same_destination && size > 0
+                && size <= _out_segment_sizes[last]
+                && _out_segments[last] < max_udp_gso_segments
+                && _out_iovs[last].iov_len + size
+                     <= static_cast<size_t> (max_udp_gso_size)) {
+                _out_iovs[last].iov_len += size;
+                _out_segments[last]++;
+                run_open = size == _out_segment_sizes[last];
+                continue;
+            }
+        }
+
+        msghdr &hdr = _out_msgs[runs].msg_hdr;
+        _out_iovs[runs].iov_base = buffer;
+        _out_iovs[runs].iov_len = size;
+        if (_options.raw_socket) {
+            _out_raw_addresses[runs] = _raw_address;
+            hdr.msg_name = &_out_raw_addresses[runs];
+            hdr.msg_namelen = static_cast<socklen_t> (sizeof (sockaddr_in));
+        } else {
+            hdr.msg_name = const_cast<sockaddr *> (_out_address);
+            hdr.msg_namelen = _out_address_len;
+        }
+        _out_segments[runs] = 1;
+        _out_segment_sizes[runs] = size;
+        runs++;
+        run_open = true;
+    }
+
+    if (count == 0) {
         reset_pollout (_handle);
+        return;
+    }
+
+    //  Only runs of more than one datagram carry the segment size.
+    const size_t control_len = CMSG_SPACE (sizeof (uint16_t));
+    for (int i = 0; i < runs; i++) {
+        msghdr &hdr = _out_msgs[i].msg_hdr;
+        if (_out_segments[i] == 1) {
+            hdr.msg_control = NULL;
+            hdr.msg_controllen = 0;
+            continue;
+        }
+        hdr.msg_control = &_out_control[i * control_len];
+        hdr.msg_controllen = control_len;
+        cmsghdr *cmsg = CMSG_FIRSTHDR (&hdr);
+        cmsg->cmsg_level = IPPROTO_UDP;
+        cmsg->cmsg_type = UDP_SEGMENT;
+        cmsg->cmsg_len = CMSG_LEN (sizeof (uint16_t));
+        const uint16_t segment_size =
+          static_cast<uint16_t> (_out_segment_sizes[i]);
+        memcpy (CMSG_DATA (cmsg), &segment_size, sizeof segment_size);
+    }
+
+    bool refused = false;
+    for (int sent = 0; sent < runs;) {
+        const int rc = sendmmsg (_fd, &_out_msgs[sent],
+                                 static_cast<unsigned int> (runs - sent), 0);
+        if (rc < 0) {
+            //  The kernel rejects segmentation if a segment exceeds the
+            //  path MTU or the device cannot checksum it.
+            if ((errno == EINVAL || errno == EIO)
+                && _out_segments[sent] > 1) {
+                if (!send_segments (_out_msgs[sent].msg_hdr,
+                                    _out_segment_sizes[sent]))
+                    return;
+                refused = true;
+                sent++;
+                continue;
+            }
+            if (errno != EWOULDBLOCK) {
+                assert_success_or_recoverable (_fd, rc);
+                error (connection_error);
+            }
+            return;
+        }
+        sent += rc;
+    }
+
+    //  Stop using segmentation offload, restoring the layout expected
+    //  by out_event_batch.
+    if (refused) {
+        _gso = false;
+        for (int i = 0; i < _batch_size; i++) {
+            _out_iovs[i].iov_base = &_out_batch[i * MAX_UDP_MSG];
+            _out_msgs[i].msg_hdr.msg_control = NULL;
+            _out_msgs[i].msg_hdr.msg_controllen = 0;
+        }
     }
 }
 
+bool zmq::udp_engine_t::send_segments (const msghdr &hdr_,
+                                       size_t segment_size_)
+{
+    const char *data = static_cast<const char *> (hdr_.msg_iov->iov_base);
+    size_t left = hdr_.msg_iov->iov_len;
+    while (left > 0) {
+        const size_t size = left < segment_size_ ? left : segment_size_;
+        const int rc =
+          sendto (_fd, data, size, 0,
+                  static_cast<const sockaddr *> (hdr_.msg_name),
+                  hdr_.msg_namelen);
+        if (rc < 0) {
+            if (errno != EWOULDBLOCK) {
+                assert_success_or_recoverable (_fd, rc);
+                error (connection_error);
+                return false;
+            }
+            //  The rest of the run is dropped.
+            return true;
+        }
+        data += size;
+        left -= size;
+    }
+    return true;
+}
+#endif
+
 const zmq::endpoint_uri_pair_t &zmq::udp_engine_t::get_endpoint () const
 {
     return _empty_endpoint;
@@ -530,6 +843,13 @@ void zmq::udp_engine_t::restart_output ()
 
 void zmq::udp_engine_t::in_event ()
 {
+#if defined ZMQ_HAVE_RECVMMSG
+    if (_batch_size > 1) {
+        in_event_batch ();
+        return;
+    }
+#endif
+
     sockaddr_storage in_address;
     zmq_socklen_t in_addrlen =
       static_cast<zmq_socklen_t> (sizeof (sockaddr_storage));
@@ -545,7 +865,7 @@ void zmq::udp_engine_t::in_event ()
             error (connection_error);
         }
 #else
-        if (nbytes != EWOULDBLOCK) {
+        if (errno != EWOULDBLOCK) {
             assert_success_or_recoverable (_fd, nbytes);
             error (connection_error);
         }
@@ -553,33 +873,106 @@ void zmq::udp_engine_t::in_event ()
         return;
     }
 
+    if (push_datagram (_in_buffer, nbytes, &in_address))
+        _session->flush ();
+}
+
+#if defined ZMQ_HAVE_RECVMMSG
+void zmq::udp_engine_t::in_event_batch ()
+{
+    for (int i = 0; i < _in_batch_size; i++) {
+        _in_msgs[i].msg_hdr.msg_namelen =
+          static_cast<socklen_t> (sizeof (sockaddr_storage));
+#if defined ZMQ_HAVE_UDP_GRO
+        if (_gro) {
+            _in_msgs[i].msg_hdr.msg_control =
+              &_in_control[i * CMSG_SPACE (sizeof (int))];
+            _in_msgs[i].msg_hdr.msg_controllen = CMSG_SPACE (sizeof (int));
+        }
+#endif
+    }
+
+    const int count =
+      recvmmsg (_fd, &_in_msgs[0], static_cast<unsigned int> (_in_batch_size),
+                0, NULL);
+
+    if (count < 0) {
+        if (errno != EWOULDBLOCK) {
+            assert_success_or_recoverable (_fd, count);
+            error (connection_error);
+        }
+        return;
+    }
+
+    //  Datagrams which do not fit into the pipe are dropped, the messages
+    //  pushed so far are flushed in one go.
+    for (int i = 0; i < count; i++) {
+        const char *buffer = static_cast<char *> (_in_iovs[i].iov_base);
+        size_t left = _in_msgs[i].msg_len;
+        size_t segment_size = left;
+#if defined ZMQ_HAVE_UDP_GRO
+        //  A coalesced receive carries the size of its segments, all but
+        //  the last of which have the same size.
+        if (_gro) {
+            msghdr &hdr = _in_msgs[i].msg_hdr;
+            for (cmsghdr *cmsg = CMSG_FIRSTHDR (&hdr); cmsg;
+                 cmsg = CMSG_NXTHDR (&hdr, cmsg)) {
+                if (cmsg->cmsg_level == IPPROTO_UDP
+                    && cmsg->cmsg_type == UDP_GRO) {
+                    int gso_size;
+                    memcpy (&gso_size, CMSG_DATA (cmsg), sizeof gso_size);
+                    if (gso_size > 0)
+                        segment_size = static_cast<size_t> (gso_size);
+                }
+            }
+        }
+#endif
+        do {
+            const size_t size = left < segment_size ? left : segment_size;
+            if (!push_datagram (buffer, static_cast<int> (size),
+                                &_in_addresses[i])) {
+                _session->flush ();
+                return;
+            }
+            buffer += size;
+            left -= size;
+        } while (left > 0);
+    }
+    _session->flush ();
+}
+#endif
+
+bool zmq::udp_engine_t::push_datagram (const char *buffer_,
+                                       int nbytes_,
+                                       const sockaddr_storage *address_)
+{
     int rc;
     int body_size;
     int body_offset;
     msg_t msg;
 
     if (_options.raw_socket) {
-        zmq_assert (in_address.ss_family == AF_INET);
-        sockaddr_to_msg (&msg, reinterpret_cast<sockaddr_in *> (&in_address));
+        zmq_assert (address_->ss_family == AF_INET);
+        sockaddr_to_msg (&msg, reinterpret_cast<const sockaddr_in *> (address_));
 
-        body_size = nbytes;
+        body_size = nbytes_;
         body_offset = 0;
     } else {
         // TODO in out_event, the group size is an *unsigned* char. what is
         // the maximum value?
-        const char *group_buffer = _in_buffer + 1;
-        const int group_size = _in_buffer[0];
+        const char *group_buffer = buffer_ + 1;
+        const int group_size = buffer_[0];
+
+        //  This doesn't fit, just ignore
+        if (nbytes_ - 1 < group_size)
+            return true;
 
         rc = msg.init_size (group_size);
         errno_assert (rc == 0);
         msg.set_flags (msg_t::more);
         memcpy (msg.data (), group_buffer, group_size);
 
-        //  This doesn't fit, just ignore
-        if (nbytes - 1 < group_size)
-            return;
-
-        body_size = nbytes - 1 - group_size;
+        body_size = nbytes_ - 1 - group_size;
         body_offset = 1 + group_size;
     }
     // Push group description to session
@@ -592,14 +985,14 @@ void zmq::udp_engine_t::in_event ()
         errno_assert (rc == 0);
 
         reset_pollin (_handle);
-        return;
+        return false;
     }
 
     rc = msg.close ();
     errno_assert (rc == 0);
     rc = msg.init_size (body_size);
     errno_assert (rc == 0);
-    memcpy (msg.data (), _in_buffer + body_offset, body_size);
+    memcpy (msg.data (), buffer_ + body_offset, body_size);
 
     // Push message body to session
     rc = _session->push_msg (&msg);
@@ -610,12 +1003,12 @@ void zmq::udp_engine_t::in_event ()
 
         _session->reset ();
         reset_pollin (_handle);
-        return;
+        return false;
     }
 
     rc = msg.close ();
     errno_assert (rc == 0);
-    _session->flush ();
+    return true;
 }
 
 bool zmq::udp_engine_t::restart_input ()
@@ -7,6 +7,11 @@
 #include "address.hpp"
 #include "msg.hpp"
 
+#if defined ZMQ_HAVE_SENDMMSG || defined ZMQ_HAVE_RECVMMSG
+#include <vector>
+#include <sys/socket.h>
+#endif
+
 #define MAX_UDP_MSG 8192
 
 namespace zmq
@@ -41,6 +46,7 @@ class udp_engine_t ZMQ_FINAL : public io_object_t, public i_engine
     void restart_output ();
 
     void zap_msg_available (){};
+    void crypto_job_done (crypto_job_t *){};
 
     void in_event ();
     void out_event ();
@@ -48,6 +54,36 @@ class udp_engine_t ZMQ_FINAL : public io_object_t, public i_engine
     const endpoint_uri_pair_t &get_endpoint () const;
 
   private:
+    //  Pulls the next group and body from the session and serialises them
+    //  into buffer_. Returns -1 with errno set to EAGAIN if there are no
+    //  messages to send, or to EINVAL if the message was discarded.
+    int pull_datagram (char *buffer_, size_t *size_);
+
+    //  Pushes the group and body of a received datagram to the session.
+    //  Returns false if the datagram did not fit into the pipe.
+    bool push_datagram (const char *buffer_,
+                        int nbytes_,
+                        const sockaddr_storage *address_);
+
+#if defined ZMQ_HAVE_SENDMMSG
+    //  Sends up to _batch_size datagrams using a single system call.
+    void out_event_batch ();
+#endif
+#if defined ZMQ_HAVE_SENDMMSG && defined ZMQ_HAVE_UDP_SEGMENT
+    //  Like out_event_batch, but coalesces runs of equal sized datagrams
+    //  to the same destination into single segmentation offload sends.
+    void out_event_gso ();
+
+    //  Sends the datagrams of a run one by one, used if the kernel
+    //  refuses to segment it. Returns false if the engine failed.
+    bool send_segments (const msghdr &hdr_, size_t segment_size_);
+#endif
+#if defined ZMQ_HAVE_RECVMMSG
+    //  Receives up to _in_batch_size datagrams, or coalesced runs of
+    //  them, using a single system call.
+    void in_event_batch ();
+#endif
+
     int resolve_raw_address (const char *name_, size_t length_);
     static void sockaddr_to_msg (zmq::msg_t *msg_, const sockaddr_in *addr_);
 
@@ -86,6 +122,38 @@ class udp_engine_t ZMQ_FINAL : public io_object_t, public i_engine
     char _in_buffer[MAX_UDP_MSG];
     bool _send_enabled;
     bool _recv_enabled;
+
+    //  Maximum number of datagrams handled by a single system call.
+    //  Batches are only used if this is larger than one.
+    int _batch_size;
+
+#if defined ZMQ_HAVE_SENDMMSG
+    std::vector<char> _out_batch;
+    std::vector<iovec> _out_iovs;
+    std::vector<mmsghdr> _out_msgs;
+    std::vector<sockaddr_in> _out_raw_addresses;
+#endif
+#if defined ZMQ_HAVE_SENDMMSG && defined ZMQ_HAVE_UDP_SEGMENT
+    //  True if batched sends use UDP_SEGMENT.
+    bool _gso;
+    std::vector<char> _out_control;
+    std::vector<int> _out_segments;
+    std::vector<size_t> _out_segment_sizes;
+#endif
+#if defined ZMQ_HAVE_RECVMMSG
+    //  Number of datagrams received in a single system call, which is
+    //  smaller than _batch_size for coalesced receives.
+    int _in_batch_size;
+    std::vector<char> _in_batch;
+    std::vector<iovec> _in_iovs;
+    std::vector<mmsghdr> _in_msgs;
+    std::vector<sockaddr_storage> _in_addresses;
+#endif
+#if defined ZMQ_HAVE_RECVMMSG && defined ZMQ_HAVE_UDP_GRO
+    //  True if the kernel may hand us coalesced datagrams.
+    bool _gro;
+    std::vector<char> _in_control;
+#endif
 };
 }
 
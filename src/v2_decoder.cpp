@@ -40,8 +40,10 @@
 
 zmq::v2_decoder_t::v2_decoder_t (size_t bufsize_,
                                  int64_t maxmsgsize_,
-                                 bool zero_copy_) :
-    decoder_base_t<v2_decoder_t, shared_message_memory_allocator> (bufsize_),
+                                 bool zero_copy_,
+                                 decoder_buffer_pool_t *pool_) :
+    decoder_base_t<v2_decoder_t, shared_message_memory_allocator> (bufsize_,
+                                                                   pool_),
     _msg_flags (0),
     _zero_copy (zero_copy_),
     _max_msg_size (maxmsgsize_)
@@ -42,7 +42,10 @@ class v2_decoder_t ZMQ_FINAL
     : public decoder_base_t<v2_decoder_t, shared_message_memory_allocator>
 {
   public:
-    v2_decoder_t (size_t bufsize_, int64_t maxmsgsize_, bool zero_copy_);
+    v2_decoder_t (size_t bufsize_,
+                  int64_t maxmsgsize_,
+                  bool zero_copy_,
+                  decoder_buffer_pool_t *pool_ = NULL);
     ~v2_decoder_t ();
 
     //  i_decoder interface.
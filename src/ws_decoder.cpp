@@ -41,8 +41,10 @@
 zmq::ws_decoder_t::ws_decoder_t (size_t bufsize_,
                                  int64_t maxmsgsize_,
                                  bool zero_copy_,
-                                 bool must_mask_) :
-    decoder_base_t<ws_decoder_t, shared_message_memory_allocator> (bufsize_),
+                                 bool must_mask_,
+                                 decoder_buffer_pool_t *pool_) :
+    decoder_base_t<ws_decoder_t, shared_message_memory_allocator> (bufsize_,
+                                                                   pool_),
     _msg_flags (0),
     _zero_copy (zero_copy_),
     _max_msg_size (maxmsgsize_),
@@ -46,7 +46,8 @@ class ws_decoder_t ZMQ_FINAL
     ws_decoder_t (size_t bufsize_,
                   int64_t maxmsgsize_,
                   bool zero_copy_,
-                  bool must_mask_);
+                  bool must_mask_,
+                  decoder_buffer_pool_t *pool_ = NULL);
     ~ws_decoder_t ();
 
     //  i_decoder interface.
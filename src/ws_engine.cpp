@@ -273,7 +273,7 @@ bool zmq::ws_engine_t::handshake ()
 
         _decoder = new (std::nothrow)
           ws_decoder_t (_options.in_batch_size, _options.maxmsgsize,
-                        _options.zero_copy, !_client);
+                        _options.zero_copy, !_client, _decoder_buffer_pool);
         alloc_assert (_decoder);
 
         socket ()->event_handshake_succeeded (_endpoint_uri_pair, 0);
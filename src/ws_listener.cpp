@@ -73,25 +73,15 @@ zmq::ws_listener_t::ws_listener_t (io_thread_t *io_thread_,
     stream_listener_base_t (io_thread_, socket_, options_), _wss (wss_)
 {
 #ifdef ZMQ_HAVE_WSS
-    if (_wss) {
-        int rc = gnutls_certificate_allocate_credentials (&_tls_cred);
-        zmq_assert (rc == GNUTLS_E_SUCCESS);
-
-        gnutls_datum_t cert = {(unsigned char *) options_.wss_cert_pem.c_str (),
-                               (unsigned int) options_.wss_cert_pem.length ()};
-        gnutls_datum_t key = {(unsigned char *) options_.wss_key_pem.c_str (),
-                              (unsigned int) options_.wss_key_pem.length ()};
-        rc = gnutls_certificate_set_x509_key_mem (_tls_cred, &cert, &key,
-                                                  GNUTLS_X509_FMT_PEM);
-        zmq_assert (rc == GNUTLS_E_SUCCESS);
-    }
+    if (_wss)
+        _tls_cred = tls_stream_t::create_server_credentials (options_);
 #endif
 }
 
 zmq::ws_listener_t::~ws_listener_t ()
 {
 #ifdef ZMQ_HAVE_WSS
-    if (_wss)
+    if (_wss && _tls_cred)
         gnutls_certificate_free_credentials (_tls_cred);
 #endif
 }
@@ -206,6 +196,14 @@ error:
 
 int zmq::ws_listener_t::set_local_address (const char *addr_)
 {
+#ifdef ZMQ_HAVE_WSS
+    //  The certificate and key to accept connections with are unusable.
+    if (_wss && !_tls_cred) {
+        errno = EINVAL;
+        return -1;
+    }
+#endif
+
     if (options.use_fd != -1) {
         //  in this case, the addr_ passed is not used and ignored, since the
         //  socket was already created by the application
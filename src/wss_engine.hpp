@@ -30,8 +30,8 @@
 #ifndef __ZMQ_WSS_ENGINE_HPP_INCLUDED__
 #define __ZMQ_WSS_ENGINE_HPP_INCLUDED__
 
-#include <gnutls/gnutls.h>
 #include "ws_engine.hpp"
+#include "tls_stream.hpp"
 
 #define WSS_BUFFER_SIZE 8192
 
@@ -56,13 +56,14 @@ class wss_engine_t : public ws_engine_t
     void plug_internal ();
     int read (void *data, size_t size_);
     int write (const void *data_, size_t size_);
+    bool can_gather_output () const { return false; }
+    bool has_buffered_input () const { return _tls.has_buffered_input (); }
 
   private:
     bool do_handshake ();
 
     bool _established;
-    gnutls_certificate_credentials_t _tls_client_cred;
-    gnutls_session_t _tls_session;
+    tls_stream_t _tls;
 };
 }
 
@@ -35,10 +35,14 @@
 #include "err.hpp"
 #include "msg.hpp"
 #include "macros.hpp"
+#include "config.hpp"
 #include "generic_mtrie_impl.hpp"
 
+#include <algorithm>
+
 zmq::xpub_t::xpub_t (class ctx_t *parent_, uint32_t tid_, int sid_) :
     socket_base_t (parent_, tid_, sid_),
+    _match_cache_size (0),
     _verbose_subs (false),
     _verbose_unsubs (false),
     _more_send (false),
@@ -77,8 +81,10 @@ void zmq::xpub_t::xattach_pipe (pipe_t *pipe_,
 
     //  If subscribe_to_all_ is specified, the caller would like to subscribe
     //  to all data on this pipe, implicitly.
-    if (subscribe_to_all_)
+    if (subscribe_to_all_) {
         _subscriptions.add (NULL, 0, pipe_);
+        clear_match_cache ();
+    }
 
     // if welcome message exists, send a copy of it
     if (_welcome_msg.size () > 0) {
@@ -141,6 +147,7 @@ void zmq::xpub_t::xread_activated (pipe_t *pipe_)
 
                 _pending_pipes.push_back (pipe_);
             } else {
+                clear_match_cache ();
                 if (!subscribe) {
                     const mtrie_t::rm_result rm_result =
                       _subscriptions.rm (data, size, pipe_);
@@ -228,14 +235,30 @@ int zmq::xpub_t::xsetsockopt (int option_,
             _manual = (*static_cast<const int *> (optval_) != 0);
         else if (option_ == ZMQ_ONLY_FIRST_SUBSCRIBE)
             _only_first_subscribe = (*static_cast<const int *> (optval_) != 0);
-    } else if (option_ == ZMQ_SUBSCRIBE && _manual) {
-        if (_last_pipe != NULL)
+    }
+#ifdef ZMQ_BUILD_DRAFT_API
+    else if (option_ == ZMQ_XPUB_MATCH_CACHE) {
+        if (optvallen_ != sizeof (int)
+            || *static_cast<const int *> (optval_) < 0) {
+            errno = EINVAL;
+            return -1;
+        }
+        _match_cache_size = *static_cast<const int *> (optval_);
+        clear_match_cache ();
+    }
+#endif
+    else if (option_ == ZMQ_SUBSCRIBE && _manual) {
+        if (_last_pipe != NULL) {
             _subscriptions.add ((unsigned char *) optval_, optvallen_,
                                 _last_pipe);
+            clear_match_cache ();
+        }
     } else if (option_ == ZMQ_UNSUBSCRIBE && _manual) {
-        if (_last_pipe != NULL)
+        if (_last_pipe != NULL) {
             _subscriptions.rm ((unsigned char *) optval_, optvallen_,
                                _last_pipe);
+            clear_match_cache ();
+        }
     } else if (option_ == ZMQ_XPUB_WELCOME_MSG) {
         _welcome_msg.close ();
 
@@ -285,6 +308,8 @@ void zmq::xpub_t::xpipe_terminated (pipe_t *pipe_)
         _subscriptions.rm (pipe_, send_unsubscription, this, !_verbose_unsubs);
     }
 
+    //  The cached matches may refer to the pipe.
+    clear_match_cache ();
     _dist.pipe_terminated (pipe_);
 }
 
@@ -293,6 +318,57 @@ void zmq::xpub_t::mark_as_matching (pipe_t *pipe_, xpub_t *self_)
     self_->_dist.match (pipe_);
 }
 
+void zmq::xpub_t::collect_matching (pipe_t *pipe_,
+                                    std::vector<pipe_t *> *pipes_)
+{
+    pipes_->push_back (pipe_);
+}
+
+void zmq::xpub_t::clear_match_cache ()
+{
+    _match_cache.clear ();
+    _match_cache_pipes.clear ();
+}
+
+void zmq::xpub_t::match_subscriptions (msg_t *msg_)
+{
+    unsigned char *const data = static_cast<unsigned char *> (msg_->data ());
+    const size_t size = msg_->size ();
+    if (_match_cache_size == 0 || size > xpub_match_cache_max_topic) {
+        _subscriptions.match (data, size, mark_as_matching, this);
+        return;
+    }
+
+    const match_range_t *const cached =
+      _match_cache.find (blob_t (data, size, reference_tag_t ()));
+    if (cached) {
+        for (size_t i = cached->first, end = i + cached->count; i != end; ++i)
+            _dist.match (_match_cache_pipes[i]);
+        return;
+    }
+
+    //  Once the cache is full, the topics cached so far are kept until the
+    //  subscriptions change and others are matched as if it was disabled.
+    if (_match_cache.size () >= _match_cache_size) {
+        _subscriptions.match (data, size, mark_as_matching, this);
+        return;
+    }
+
+    //  A pipe subscribed to several prefixes of the topic is reported once
+    //  for each of them.
+    const size_t first = _match_cache_pipes.size ();
+    _subscriptions.match (data, size, collect_matching, &_match_cache_pipes);
+    const std::vector<pipe_t *>::iterator begin =
+      _match_cache_pipes.begin () + first;
+    std::sort (begin, _match_cache_pipes.end ());
+    _match_cache_pipes.erase (std::unique (begin, _match_cache_pipes.end ()),
+                              _match_cache_pipes.end ());
+    const match_range_t range = {first, _match_cache_pipes.size () - first};
+    for (size_t i = first, end = first + range.count; i != end; ++i)
+        _dist.match (_match_cache_pipes[i]);
+    _match_cache.insert (blob_t (data, size, reference_tag_t ()), range);
+}
+
 void zmq::xpub_t::mark_last_pipe_as_matching (pipe_t *pipe_, xpub_t *self_)
 {
     if (self_->_last_pipe == pipe_)
@@ -314,8 +390,7 @@ int zmq::xpub_t::xsend (msg_t *msg_)
                                   this);
             _last_pipe = NULL;
         } else
-            _subscriptions.match (static_cast<unsigned char *> (msg_->data ()),
-                                  msg_->size (), mark_as_matching, this);
+            match_subscriptions (msg_);
         // If inverted matching is used, reverse the selection now
         if (options.invert_matching) {
             _dist.reverse_match ();
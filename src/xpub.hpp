@@ -31,11 +31,14 @@
 #define __ZMQ_XPUB_HPP_INCLUDED__
 
 #include <deque>
+#include <vector>
 
 #include "socket_base.hpp"
 #include "session_base.hpp"
 #include "mtrie.hpp"
 #include "dist.hpp"
+#include "blob.hpp"
+#include "routing_table.hpp"
 
 namespace zmq
 {
@@ -74,12 +77,36 @@ class xpub_t : public socket_base_t
     //  Function to be applied to each matching pipes.
     static void mark_as_matching (zmq::pipe_t *pipe_, xpub_t *self_);
 
+    //  Marks the pipes subscribed to the topic in the message as matching,
+    //  using and filling the match cache if enabled.
+    void match_subscriptions (zmq::msg_t *msg_);
+
+    void clear_match_cache ();
+
+    static void collect_matching (zmq::pipe_t *pipe_,
+                                  std::vector<zmq::pipe_t *> *pipes_);
+
     //  List of all subscriptions mapped to corresponding pipes.
     mtrie_t _subscriptions;
 
     //  List of manual subscriptions mapped to corresponding pipes.
     mtrie_t _manual_subscriptions;
 
+    //  Pipes matching the topics sent recently, so that a topic sent again
+    //  is distributed without walking the trie. Holds up to
+    //  _match_cache_size topics and is cleared whenever the subscriptions
+    //  change, which includes pipes going away. The pipes matching a topic
+    //  are the count entries of _match_cache_pipes starting at first.
+    struct match_range_t
+    {
+        size_t first;
+        size_t count;
+    };
+    typedef routing_table_t<match_range_t> match_cache_t;
+    match_cache_t _match_cache;
+    std::vector<pipe_t *> _match_cache_pipes;
+    size_t _match_cache_size;
+
     //  Distributor of messages holding the list of outbound pipes.
     dist_t _dist;
 
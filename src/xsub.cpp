@@ -28,6 +28,7 @@
 */
 
 #include "precompiled.hpp"
+#include <new>
 #include <string.h>
 
 #include "macros.hpp"
@@ -36,6 +37,7 @@
 
 zmq::xsub_t::xsub_t (class ctx_t *parent_, uint32_t tid_, int sid_) :
     socket_base_t (parent_, tid_, sid_),
+    _radix_tree (NULL),
     _verbose_unsubs (false),
     _has_message (false),
     _more_send (false),
@@ -49,12 +51,19 @@ zmq::xsub_t::xsub_t (class ctx_t *parent_, uint32_t tid_, int sid_) :
     //  subscription commands are sent to the wire.
     options.linger.store (0);
 
+#ifdef ZMQ_USE_RADIX_TREE
+    _radix_tree = new (std::nothrow) radix_tree_t;
+    alloc_assert (_radix_tree);
+#endif
+
     const int rc = _message.init ();
     errno_assert (rc == 0);
 }
 
 zmq::xsub_t::~xsub_t ()
 {
+    LIBZMQ_DELETE (_radix_tree);
+
     const int rc = _message.close ();
     errno_assert (rc == 0);
 }
@@ -71,7 +80,7 @@ void zmq::xsub_t::xattach_pipe (pipe_t *pipe_,
     _dist.attach (pipe_);
 
     //  Send all the cached subscriptions to the new upstream peer.
-    _subscriptions.apply (send_subscription, pipe_);
+    apply_subscriptions (pipe_);
     pipe_->flush ();
 }
 
@@ -94,7 +103,7 @@ void zmq::xsub_t::xpipe_terminated (pipe_t *pipe_)
 void zmq::xsub_t::xhiccuped (pipe_t *pipe_)
 {
     //  Send all the cached subscriptions to the hiccuped pipe.
-    _subscriptions.apply (send_subscription, pipe_);
+    apply_subscriptions (pipe_);
     pipe_->flush ();
 }
 
@@ -115,6 +124,27 @@ int zmq::xsub_t::xsetsockopt (int option_,
     else if (option_ == ZMQ_XSUB_VERBOSE_UNSUBSCRIBE) {
         _verbose_unsubs = (*static_cast<const int *> (optval_) != 0);
         return 0;
+    } else if (option_ == ZMQ_SUB_RADIX_TREE) {
+        if (optvallen_ != sizeof (int)
+            || *static_cast<const int *> (optval_) < 0) {
+            errno = EINVAL;
+            return -1;
+        }
+        const bool use_radix_tree = *static_cast<const int *> (optval_) != 0;
+
+        //  The subscriptions are not moved from one repository to the other.
+        if (use_radix_tree == (_radix_tree != NULL))
+            return 0;
+        if (has_subscriptions ()) {
+            errno = EINVAL;
+            return -1;
+        }
+        if (use_radix_tree) {
+            _radix_tree = new (std::nothrow) radix_tree_t;
+            alloc_assert (_radix_tree);
+        } else
+            LIBZMQ_DELETE (_radix_tree);
+        return 0;
     }
 #endif
     errno = EINVAL;
@@ -146,7 +176,7 @@ int zmq::xsub_t::xsend (msg_t *msg_)
             data = data + 1;
             size = size - 1;
         }
-        _subscriptions.add (data, size);
+        add_subscription (data, size);
         _process_subscribe = true;
         return _dist.send_to_all (msg_);
     }
@@ -157,7 +187,7 @@ int zmq::xsub_t::xsend (msg_t *msg_)
             size = size - 1;
         }
         _process_subscribe = true;
-        const bool rm_result = _subscriptions.rm (data, size);
+        const bool rm_result = rm_subscription (data, size);
         if (rm_result || _verbose_unsubs)
             return _dist.send_to_all (msg_);
     } else
@@ -259,12 +289,52 @@ bool zmq::xsub_t::xhas_in ()
 
 bool zmq::xsub_t::match (msg_t *msg_)
 {
-    const bool matching = _subscriptions.check (
-      static_cast<unsigned char *> (msg_->data ()), msg_->size ());
+    const unsigned char *const data =
+      static_cast<unsigned char *> (msg_->data ());
+    const bool matching = _radix_tree
+                            ? _radix_tree->check (data, msg_->size ())
+                            : _trie.check (data, msg_->size ());
 
     return matching ^ options.invert_matching;
 }
 
+void zmq::xsub_t::add_subscription (unsigned char *data_, size_t size_)
+{
+    if (_radix_tree)
+        _radix_tree->add (data_, size_);
+    else
+        _trie.add (data_, size_);
+}
+
+bool zmq::xsub_t::rm_subscription (unsigned char *data_, size_t size_)
+{
+    if (_radix_tree)
+        return _radix_tree->rm (data_, size_);
+    return _trie.rm (data_, size_);
+}
+
+void zmq::xsub_t::apply_subscriptions (pipe_t *pipe_)
+{
+    if (_radix_tree)
+        _radix_tree->apply (send_subscription, pipe_);
+    else
+        _trie.apply (send_subscription, pipe_);
+}
+
+static void note_subscription (unsigned char *, size_t, void *arg_)
+{
+    *static_cast<bool *> (arg_) = true;
+}
+
+bool zmq::xsub_t::has_subscriptions ()
+{
+    if (_radix_tree)
+        return _radix_tree->size () > 0;
+    bool found = false;
+    _trie.apply (note_subscription, &found);
+    return found;
+}
+
 void zmq::xsub_t::send_subscription (unsigned char *data_,
                                      size_t size_,
                                      void *arg_)
@@ -34,11 +34,8 @@
 #include "session_base.hpp"
 #include "dist.hpp"
 #include "fq.hpp"
-#ifdef ZMQ_USE_RADIX_TREE
 #include "radix_tree.hpp"
-#else
 #include "trie.hpp"
-#endif
 
 namespace zmq
 {
@@ -73,6 +70,12 @@ class xsub_t : public socket_base_t
     //  Check whether the message matches at least one subscription.
     bool match (zmq::msg_t *msg_);
 
+    //  Operations on whichever repository of subscriptions is in use.
+    void add_subscription (unsigned char *data_, size_t size_);
+    bool rm_subscription (unsigned char *data_, size_t size_);
+    void apply_subscriptions (pipe_t *pipe_);
+    bool has_subscriptions ();
+
     //  Function to be applied to the trie to send all the subsciptions
     //  upstream.
     static void
@@ -84,12 +87,11 @@ class xsub_t : public socket_base_t
     //  Object for distributing the subscriptions upstream.
     dist_t _dist;
 
-    //  The repository of subscriptions.
-#ifdef ZMQ_USE_RADIX_TREE
-    radix_tree_t _subscriptions;
-#else
-    trie_t _subscriptions;
-#endif
+    //  The repositories of subscriptions. The radix tree is used rather
+    //  than the trie if ZMQ_SUB_RADIX_TREE is set. As its node arena
+    //  starts with a sizeable chunk, it only exists in that case.
+    trie_t _trie;
+    radix_tree_t *_radix_tree;
 
     // If true, send all unsubscription messages upstream, not just
     // unique ones
@@ -148,6 +148,16 @@ template <typename T, int N> class ypipe_t ZMQ_FINAL : public ypipe_base_t<T>
         return true;
     }
 
+    //  Check whether an item is available for reading without putting the
+    //  pipe to sleep when it is empty, unlike check_read.
+    bool peek_read ()
+    {
+        if (&_queue.front () != _r && _r)
+            return true;
+        T *const c = _c.load ();
+        return c && c != &_queue.front ();
+    }
+
     //  Reads an item from the pipe. Returns false if there is no value.
     //  available.
     bool read (T *value_)
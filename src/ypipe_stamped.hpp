@@ -0,0 +1,104 @@
+/*
+    Copyright (c) 2007-2016 Contributors as noted in the AUTHORS file
+
+    This file is part of libzmq, the ZeroMQ core engine in C++.
+
+    libzmq is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License (LGPL) as published
+    by the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    As a special exception, the Contributors give you permission to link
+    this library with independent modules to produce an executable,
+    regardless of the license terms of these independent modules, and to
+    copy and distribute the resulting executable under terms of your choice,
+    provided that you also meet, for each linked independent module, the
+    terms and conditions of the license of that module. An independent
+    module is a module which is not derived from or based on this library.
+    If you modify this library, you must extend this exception to your
+    version of the library.
+
+    libzmq is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __ZMQ_YPIPE_STAMPED_HPP_INCLUDED__
+#define __ZMQ_YPIPE_STAMPED_HPP_INCLUDED__
+
+#include "clock.hpp"
+#include "err.hpp"
+#include "ypipe.hpp"
+
+namespace zmq
+{
+//  Lock-free queue which records the time each item was written at, so
+//  that the reader can tell how long the items spent in the queue.
+//  The times are kept in a second queue, written, flushed and read in
+//  lockstep with the items. As they are flushed first, a time is always
+//  available when its item is.
+
+template <typename T, int N> class ypipe_stamped_t ZMQ_FINAL
+    : public ypipe_base_t<T>
+{
+  public:
+    ypipe_stamped_t () : _stamp (0) {}
+
+    void write (const T &value_, bool incomplete_)
+    {
+        _items.write (value_, incomplete_);
+        _stamps.write (clock_t::now_ns (), incomplete_);
+    }
+
+    bool unwrite (T *value_)
+    {
+        if (!_items.unwrite (value_))
+            return false;
+        uint64_t stamp;
+        const bool ok = _stamps.unwrite (&stamp);
+        zmq_assert (ok);
+        return true;
+    }
+
+    bool flush ()
+    {
+        _stamps.flush ();
+        return _items.flush ();
+    }
+
+    bool check_read () { return _items.check_read (); }
+
+    bool read (T *value_)
+    {
+        if (!_items.read (value_))
+            return false;
+        const bool ok = _stamps.read (&_stamp);
+        zmq_assert (ok);
+        return true;
+    }
+
+    bool probe (bool (*fn_) (const T &))
+    {
+        return _items.probe (fn_);
+    }
+
+    //  Returns the time, as per clock_t::now_ns, the item read last was
+    //  written at.
+    uint64_t stamp () const { return _stamp; }
+
+  private:
+    ypipe_t<T, N> _items;
+    ypipe_t<uint64_t, N> _stamps;
+
+    uint64_t _stamp;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (ypipe_stamped_t)
+};
+}
+
+#endif
@@ -71,6 +71,7 @@ class zap_client_common_handshake_t : public zap_client_t
         sending_welcome,
         waiting_for_initiate,
         waiting_for_zap_reply,
+        waiting_for_crypto,
         sending_ready,
         sending_error,
         error_sent,
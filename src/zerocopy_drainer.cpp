@@ -0,0 +1,177 @@
+/*
+    Copyright (c) 2007-2019 Contributors as noted in the AUTHORS file
+
+    This file is part of libzmq, the ZeroMQ core engine in C++.
+
+    libzmq is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License (LGPL) as published
+    by the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    As a special exception, the Contributors give you permission to link
+    this library with independent modules to produce an executable,
+    regardless of the license terms of these independent modules, and to
+    copy and distribute the resulting executable under terms of your choice,
+    provided that you also meet, for each linked independent module, the
+    terms and conditions of the license of that module. An independent
+    module is a module which is not derived from or based on this library.
+    If you modify this library, you must extend this exception to your
+    version of the library.
+
+    libzmq is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "precompiled.hpp"
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+#include "zerocopy_drainer.hpp"
+#include "config.hpp"
+#include "err.hpp"
+#include "io_thread.hpp"
+#include "tcp.hpp"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+bool zmq::release_completed_zerocopy_sends (fd_t s_,
+                                            zerocopy_sends_t &sends_,
+                                            uint32_t &first_)
+{
+    bool found = false;
+    uint32_t lo;
+    uint32_t hi;
+    while (zmq::tcp_read_zerocopy_completion (s_, &lo, &hi) == 0) {
+        found = true;
+        for (uint32_t counter = lo; counter != hi + 1; counter++) {
+            const uint32_t index = counter - first_;
+            if (index < sends_.size ())
+                sends_[index].done = true;
+        }
+        while (!sends_.empty () && sends_.front ().done) {
+            const int rc = sends_.front ().msg.close ();
+            errno_assert (rc == 0);
+            sends_.pop_front ();
+            first_++;
+        }
+    }
+    return found;
+}
+
+zmq::zerocopy_drainer_t::zerocopy_drainer_t (io_thread_t *io_thread_,
+                                             fd_t s_,
+                                             zerocopy_sends_t &sends_,
+                                             uint32_t first_,
+                                             int linger_) :
+    io_object_t (io_thread_),
+    _io_thread (io_thread_),
+    _s (s_),
+    _has_handle (true),
+    _has_linger_timer (false),
+    _has_term_timer (false),
+    _first (first_)
+{
+    _sends.swap (sends_);
+
+    //  Let the peer know the connection is over; the data queued before
+    //  is still transmitted.
+    const int rc = shutdown (_s, SHUT_WR);
+    LIBZMQ_UNUSED (rc);
+
+    //  Completions raise an error condition on the socket, which pollers
+    //  report without being asked for any events. The timer covers those
+    //  that do not, as well as a socket that hangs up.
+    _handle = add_fd (_s);
+    add_timer (zerocopy_drain_interval, poll_timer_id);
+    if (linger_ >= 0) {
+        add_timer (linger_, linger_timer_id);
+        _has_linger_timer = true;
+    }
+    _io_thread->add_zerocopy_drainer (this);
+}
+
+zmq::zerocopy_drainer_t::~zerocopy_drainer_t ()
+{
+    while (!_sends.empty ()) {
+        const int rc = _sends.front ().msg.close ();
+        errno_assert (rc == 0);
+        _sends.pop_front ();
+    }
+}
+
+void zmq::zerocopy_drainer_t::stop ()
+{
+    if (!_has_term_timer) {
+        add_timer (zerocopy_term_timeout, term_timer_id);
+        _has_term_timer = true;
+    }
+}
+
+void zmq::zerocopy_drainer_t::in_event ()
+{
+    if (!drain ()) {
+        //  A hung up socket stays signalled; leave it to the timer.
+        rm_fd (_handle);
+        _has_handle = false;
+        return;
+    }
+    if (_sends.empty ())
+        finish (false);
+}
+
+void zmq::zerocopy_drainer_t::timer_event (int id_)
+{
+    if (id_ == linger_timer_id || id_ == term_timer_id) {
+        if (id_ == linger_timer_id)
+            _has_linger_timer = false;
+        else
+            _has_term_timer = false;
+        finish (true);
+        return;
+    }
+
+    zmq_assert (id_ == poll_timer_id);
+    drain ();
+    if (_sends.empty ())
+        finish (false);
+    else
+        add_timer (zerocopy_drain_interval, poll_timer_id);
+}
+
+bool zmq::zerocopy_drainer_t::drain ()
+{
+    return release_completed_zerocopy_sends (_s, _sends, _first);
+}
+
+void zmq::zerocopy_drainer_t::finish (bool abort_)
+{
+    //  Resetting the connection drops the data the kernel still queues,
+    //  and with it the references to the messages.
+    if (abort_) {
+        const linger l = {1, 0};
+        const int rc = setsockopt (_s, SOL_SOCKET, SO_LINGER, &l, sizeof l);
+        LIBZMQ_UNUSED (rc);
+    }
+
+    if (_has_handle)
+        rm_fd (_handle);
+    cancel_timer (poll_timer_id);
+    if (_has_linger_timer)
+        cancel_timer (linger_timer_id);
+    if (_has_term_timer)
+        cancel_timer (term_timer_id);
+    unplug ();
+    _io_thread->rm_zerocopy_drainer (this);
+
+    const int rc = close (_s);
+    errno_assert (rc == 0);
+
+    delete this;
+}
+
+#endif
@@ -0,0 +1,123 @@
+/*
+    Copyright (c) 2007-2019 Contributors as noted in the AUTHORS file
+
+    This file is part of libzmq, the ZeroMQ core engine in C++.
+
+    libzmq is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License (LGPL) as published
+    by the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    As a special exception, the Contributors give you permission to link
+    this library with independent modules to produce an executable,
+    regardless of the license terms of these independent modules, and to
+    copy and distribute the resulting executable under terms of your choice,
+    provided that you also meet, for each linked independent module, the
+    terms and conditions of the license of that module. An independent
+    module is a module which is not derived from or based on this library.
+    If you modify this library, you must extend this exception to your
+    version of the library.
+
+    libzmq is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __ZMQ_ZEROCOPY_DRAINER_HPP_INCLUDED__
+#define __ZMQ_ZEROCOPY_DRAINER_HPP_INCLUDED__
+
+#if defined ZMQ_HAVE_MSG_ZEROCOPY
+
+#include <deque>
+
+#include "fd.hpp"
+#include "io_object.hpp"
+#include "msg.hpp"
+
+namespace zmq
+{
+class io_thread_t;
+
+//  A message referenced by a MSG_ZEROCOPY send, which must not be released
+//  before the kernel reports the send complete.
+struct zerocopy_send_t
+{
+    msg_t msg;
+    bool done;
+};
+
+//  Outstanding sends in the order of the kernel's send counter.
+typedef std::deque<zerocopy_send_t> zerocopy_sends_t;
+
+//  Reads the completions pending on the error queue of socket s_ and
+//  releases the completed sends at the front of sends_, where first_ is
+//  the counter value of the first one. Returns true if any completion was
+//  found.
+bool release_completed_zerocopy_sends (fd_t s_,
+                                       zerocopy_sends_t &sends_,
+                                       uint32_t &first_);
+
+//  Keeps a socket whose engine is gone open until the kernel reports its
+//  outstanding zero-copy sends complete, as the completions cannot be read
+//  once the socket is closed. Then closes the socket, releases the
+//  messages and destroys itself. If that takes longer than linger_
+//  milliseconds, or than zerocopy_term_timeout once the I/O thread is
+//  stopped, the connection is reset instead, which discards the data
+//  still queued.
+
+class zerocopy_drainer_t ZMQ_FINAL : public io_object_t
+{
+  public:
+    //  Takes over the socket and the sends, leaving sends_ empty.
+    zerocopy_drainer_t (io_thread_t *io_thread_,
+                        fd_t s_,
+                        zerocopy_sends_t &sends_,
+                        uint32_t first_,
+                        int linger_);
+    ~zerocopy_drainer_t ();
+
+    //  Called when the I/O thread stops, bounds the remaining wait.
+    void stop ();
+
+    //  i_poll_events interface implementation.
+    void in_event ();
+    void timer_event (int id_);
+
+  private:
+    enum
+    {
+        poll_timer_id = 1,
+        linger_timer_id = 2,
+        term_timer_id = 3
+    };
+
+    //  Releases the completed sends. Returns true if any completion was
+    //  found.
+    bool drain ();
+
+    //  Closes the socket, resetting the connection if abort_ is true, and
+    //  destroys the drainer.
+    void finish (bool abort_);
+
+    io_thread_t *_io_thread;
+    fd_t _s;
+    handle_t _handle;
+    bool _has_handle;
+    bool _has_linger_timer;
+    bool _has_term_timer;
+
+    zerocopy_sends_t _sends;
+    uint32_t _first;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (zerocopy_drainer_t)
+};
+}
+
+#endif
+
+#endif
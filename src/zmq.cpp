@@ -90,6 +90,7 @@ struct iovec
 #include "ctx.hpp"
 #include "err.hpp"
 #include "msg.hpp"
+#include "msg_pool.hpp"
 #include "fd.hpp"
 #include "metadata.hpp"
 #include "socket_poller.hpp"
@@ -491,6 +492,31 @@ int zmq_sendiov (void *s_, iovec *a_, size_t count_, int flags_)
     return rc;
 }
 
+// Send an array of messages, waking the peers up once for all of them.
+// Returns the number of messages sent.
+int zmq_sendmmsg (
+  void *s_, zmq_msg_t *msgs_, const int *msg_flags_, size_t count_, int flags_)
+{
+    zmq::socket_base_t *s = as_socket_base_t (s_);
+    if (!s)
+        return -1;
+    if (unlikely (count_ > INT_MAX || (count_ && !msgs_))) {
+        errno = EINVAL;
+        return -1;
+    }
+    return s->send_batch (reinterpret_cast<zmq::msg_t *> (msgs_), msg_flags_,
+                          count_, flags_);
+}
+
+// Flush the messages held back by ZMQ_FLUSH_MSGS or ZMQ_FLUSH_BYTES.
+int zmq_flush (void *s_)
+{
+    zmq::socket_base_t *s = as_socket_base_t (s_);
+    if (!s)
+        return -1;
+    return s->flush ();
+}
+
 // Receiving functions.
 
 static int s_recvmsg (zmq::socket_base_t *s_, zmq_msg_t *msg_, int flags_)
@@ -609,6 +635,22 @@ int zmq_recviov (void *s_, iovec *a_, size_t *count_, int flags_)
     return nread;
 }
 
+// Receive the first message as zmq_msg_recv does, followed by as many
+// available messages as fit into the array.
+// Returns the number of messages received.
+int zmq_recvmmsg (void *s_, zmq_msg_t *msgs_, size_t count_, int flags_)
+{
+    zmq::socket_base_t *s = as_socket_base_t (s_);
+    if (!s)
+        return -1;
+    if (unlikely (count_ > INT_MAX || (count_ && !msgs_))) {
+        errno = EINVAL;
+        return -1;
+    }
+    return s->recv_batch (reinterpret_cast<zmq::msg_t *> (msgs_), count_,
+                          flags_);
+}
+
 // Message manipulators.
 
 int zmq_msg_init (zmq_msg_t *msg_)
@@ -749,6 +791,19 @@ const char *zmq_msg_gets (const zmq_msg_t *msg_, const char *property_)
     return NULL;
 }
 
+//  Message pool, shared by the whole process.
+
+int zmq_msg_pool_open ()
+{
+    zmq::msg_pool_open ();
+    return 0;
+}
+
+int zmq_msg_pool_close ()
+{
+    return zmq::msg_pool_close ();
+}
+
 // Polling.
 
 #if defined ZMQ_HAVE_POLLER
@@ -1827,6 +1882,10 @@ int zmq_has (const char *capability_)
 #if defined(ZMQ_HAVE_WSS)
     if (strcmp (capability_, "WSS") == 0)
         return true;
+#endif
+#if defined(ZMQ_HAVE_TLS)
+    if (strcmp (capability_, zmq::protocol_name::tls) == 0)
+        return true;
 #endif
     //  Whatever the application asked for, we don't have
     return false;
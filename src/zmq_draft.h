@@ -72,6 +72,16 @@
 #define ZMQ_BUSY_POLL 113
 #define ZMQ_HICCUP_MSG 114
 #define ZMQ_XSUB_VERBOSE_UNSUBSCRIBE 115
+#define ZMQ_UDP_BATCH_SIZE 116
+#define ZMQ_UDP_OFFLOAD 117
+#define ZMQ_TCP_ZEROCOPY_THRESHOLD 118
+#define ZMQ_RECV_SPIN 119
+#define ZMQ_FLUSH_MSGS 120
+#define ZMQ_FLUSH_BYTES 121
+#define ZMQ_SUB_RADIX_TREE 122
+#define ZMQ_XPUB_MATCH_CACHE 123
+#define ZMQ_LATENCY_STATS 124
+#define ZMQ_WSS_KTLS 125
 
 /*  DRAFT ZMQ_RECONNECT_STOP options                                          */
 #define ZMQ_RECONNECT_STOP_CONN_REFUSED 0x1
@@ -80,6 +90,13 @@
 
 /*  DRAFT Context options                                                     */
 #define ZMQ_ZERO_COPY_RECV 10
+#define ZMQ_IO_URING 11
+#define ZMQ_DECODER_BUFFER_HITS 13
+#define ZMQ_DECODER_BUFFER_MISSES 14
+#define ZMQ_IO_THREAD_NUMA_LOCAL 15
+#define ZMQ_IO_THREAD_HUGEPAGES 16
+#define ZMQ_IO_THREAD_SPIN 17
+#define ZMQ_CRYPTO_THREADS 18
 
 /*  DRAFT Context methods.                                                    */
 int zmq_ctx_set_ext (void *context_,
@@ -94,6 +111,10 @@ int zmq_ctx_get_ext (void *context_,
 /*  DRAFT Socket methods.                                                     */
 int zmq_join (void *s_, const char *group_);
 int zmq_leave (void *s_, const char *group_);
+int zmq_sendmmsg (
+  void *s_, zmq_msg_t *msgs_, const int *msg_flags_, size_t count_, int flags_);
+int zmq_recvmmsg (void *s_, zmq_msg_t *msgs_, size_t count_, int flags_);
+int zmq_flush (void *s_);
 
 /*  DRAFT Msg methods.                                                        */
 int zmq_msg_set_routing_id (zmq_msg_t *msg_, uint32_t routing_id_);
@@ -101,6 +122,8 @@ uint32_t zmq_msg_routing_id (zmq_msg_t *msg_);
 int zmq_msg_set_group (zmq_msg_t *msg_, const char *group_);
 const char *zmq_msg_group (zmq_msg_t *msg_);
 int zmq_msg_init_buffer (zmq_msg_t *msg_, const void *buf_, size_t size_);
+int zmq_msg_pool_open (void);
+int zmq_msg_pool_close (void);
 
 /*  DRAFT Msg property names.                                                 */
 #define ZMQ_MSG_PROPERTY_ROUTING_ID "Routing-Id"
@@ -159,12 +182,14 @@ int zmq_socket_get_peer_state (void *socket_,
 
 /*  DRAFT Socket monitoring events                                            */
 #define ZMQ_EVENT_PIPES_STATS 0x10000
+#define ZMQ_EVENT_PIPES_LATENCY 0x20000
 
 #define ZMQ_CURRENT_EVENT_VERSION 1
 #define ZMQ_CURRENT_EVENT_VERSION_DRAFT 2
 
 #define ZMQ_EVENT_ALL_V1 ZMQ_EVENT_ALL
-#define ZMQ_EVENT_ALL_V2 ZMQ_EVENT_ALL_V1 | ZMQ_EVENT_PIPES_STATS
+#define ZMQ_EVENT_ALL_V2                                                       \
+    ZMQ_EVENT_ALL_V1 | ZMQ_EVENT_PIPES_STATS | ZMQ_EVENT_PIPES_LATENCY
 
 int zmq_socket_monitor_versioned (
   void *s_, const char *addr_, uint64_t events_, int event_version_, int type_);
@@ -183,6 +208,9 @@ int zmq_ppoll (zmq_pollitem_t *items_,
                const void *sigmask_);
 #endif
 
+/*  DRAFT Utility functions.                                                  */
+uint64_t zmq_clock_ns (void);
+
 #endif // ZMQ_BUILD_DRAFT_API
 
 #endif //ifndef __ZMQ_DRAFT_H_INCLUDED__
@@ -80,6 +80,11 @@ unsigned long zmq_stopwatch_stop (void *watch_)
     return res;
 }
 
+uint64_t zmq_clock_ns ()
+{
+    return zmq::clock_t::now_ns ();
+}
+
 void *zmq_threadstart (zmq_thread_fn *func_, void *arg_)
 {
     zmq::thread_t *thread = new (std::nothrow) zmq::thread_t;
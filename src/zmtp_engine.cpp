@@ -99,8 +99,10 @@ zmq::zmtp_engine_t::~zmtp_engine_t ()
 
 void zmq::zmtp_engine_t::plug_internal ()
 {
-    // start optional timer, to prevent handshake hanging on no input
-    set_handshake_timer ();
+    // start optional timer, to prevent handshake hanging on no input,
+    // unless the handshake of a layer below, e.g. TLS, started it already
+    if (!has_handshake_timer ())
+        set_handshake_timer ();
 
     //  Send the 'length' and 'flags' fields of the routing id message.
     //  The 'length' field is encoded in the long format.
@@ -335,8 +337,9 @@ bool zmq::zmtp_engine_t::handshake_v2_0 ()
     _encoder = new (std::nothrow) v2_encoder_t (_options.out_batch_size);
     alloc_assert (_encoder);
 
-    _decoder = new (std::nothrow) v2_decoder_t (
-      _options.in_batch_size, _options.maxmsgsize, _options.zero_copy);
+    _decoder = new (std::nothrow)
+      v2_decoder_t (_options.in_batch_size, _options.maxmsgsize,
+                    _options.zero_copy, _decoder_buffer_pool);
     alloc_assert (_decoder);
 
     return true;
@@ -409,8 +412,9 @@ bool zmq::zmtp_engine_t::handshake_v3_0 ()
     _encoder = new (std::nothrow) v2_encoder_t (_options.out_batch_size);
     alloc_assert (_encoder);
 
-    _decoder = new (std::nothrow) v2_decoder_t (
-      _options.in_batch_size, _options.maxmsgsize, _options.zero_copy);
+    _decoder = new (std::nothrow)
+      v2_decoder_t (_options.in_batch_size, _options.maxmsgsize,
+                    _options.zero_copy, _decoder_buffer_pool);
     alloc_assert (_decoder);
 
     return zmq::zmtp_engine_t::handshake_v3_x (true);
@@ -421,8 +425,9 @@ bool zmq::zmtp_engine_t::handshake_v3_1 ()
     _encoder = new (std::nothrow) v3_1_encoder_t (_options.out_batch_size);
     alloc_assert (_encoder);
 
-    _decoder = new (std::nothrow) v2_decoder_t (
-      _options.in_batch_size, _options.maxmsgsize, _options.zero_copy);
+    _decoder = new (std::nothrow)
+      v2_decoder_t (_options.in_batch_size, _options.maxmsgsize,
+                    _options.zero_copy, _decoder_buffer_pool);
     alloc_assert (_decoder);
 
     return zmq::zmtp_engine_t::handshake_v3_x (false);
@@ -123,6 +123,51 @@ void test_routing_id ()
     test_context_socket_close (client);
 }
 
+void test_stale_routing_id ()
+{
+    void *server, *client;
+    create_inproc_client_server_pair (&server, &client);
+
+    send_string_expect_success (client, "X", 0);
+    zmq_msg_t msg;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_recv (&msg, server, 0));
+    const uint32_t routing_id = zmq_msg_routing_id (&msg);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+
+    //  Reconnect clients until the server has dropped the first one, each
+    //  getting a routing id different from it.
+    test_context_socket_close (client);
+    for (int i = 0; i < 10; ++i) {
+        client = test_context_socket (ZMQ_CLIENT);
+        TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_connect (client, "inproc://test-client-server"));
+        send_string_expect_success (client, "X", 0);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_recv (&msg, server, 0));
+        TEST_ASSERT_NOT_EQUAL (routing_id, zmq_msg_routing_id (&msg));
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+        test_context_socket_close (client);
+    }
+
+    //  The server only notices a peer is gone when it next tries to read
+    //  from it, and forgets it once the termination is acknowledged.
+    char buffer[1];
+    for (int i = 0; i < 2; ++i) {
+        msleep (SETTLE_TIME);
+        TEST_ASSERT_FAILURE_ERRNO (
+          EAGAIN, zmq_recv (server, buffer, sizeof buffer, ZMQ_DONTWAIT));
+    }
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init_size (&msg, 1));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_set_routing_id (&msg, routing_id));
+    TEST_ASSERT_FAILURE_ERRNO (EHOSTUNREACH,
+                               zmq_msg_send (&msg, server, ZMQ_DONTWAIT));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+
+    test_context_socket_close (server);
+}
+
 int main (void)
 {
     setup_test_environment ();
@@ -131,5 +176,6 @@ int main (void)
     RUN_TEST (test_client_sndmore_fails);
     RUN_TEST (test_server_sndmore_fails);
     RUN_TEST (test_routing_id);
+    RUN_TEST (test_stale_routing_id);
     return UNITY_END ();
 }
@@ -28,6 +28,7 @@
 */
 
 #include <limits>
+#include <string.h>
 #include "testutil.hpp"
 #include "testutil_unity.hpp"
 
@@ -205,6 +206,201 @@ void test_ctx_zero_copy ()
 #endif
 }
 
+void test_ctx_io_uring ()
+{
+#ifdef ZMQ_IO_URING
+    // Default value is 1.
+    TEST_ASSERT_EQUAL_INT (1, zmq_ctx_get (get_test_context (), ZMQ_IO_URING));
+
+    // Pollers fall back to epoll when io_uring is disabled (or unsupported),
+    // so messages must flow either way.
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_set (get_test_context (), ZMQ_IO_URING, 0));
+    TEST_ASSERT_EQUAL_INT (0, zmq_ctx_get (get_test_context (), ZMQ_IO_URING));
+
+    void *pull = zmq_socket (get_test_context (), ZMQ_PULL);
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (pull, endpoint, sizeof endpoint);
+
+    void *push = zmq_socket (get_test_context (), ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    send_string_expect_success (push, "abcd", 0);
+    recv_string_expect_success (pull, "abcd", 0);
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_close (push));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_close (pull));
+#endif
+}
+
+#ifdef ZMQ_DECODER_BUFFER_HITS
+// Hold on to the received messages, so that the receive buffers they
+// reference can only be released once the batch is closed. The second
+// batch is received into recycled buffers.
+static void recv_held_batches (int in_batch_size_)
+{
+    void *pull = zmq_socket (get_test_context (), ZMQ_PULL);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (
+      pull, ZMQ_IN_BATCH_SIZE, &in_batch_size_, sizeof in_batch_size_));
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (pull, endpoint, sizeof endpoint);
+
+    void *push = zmq_socket (get_test_context (), ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (
+      push, ZMQ_IN_BATCH_SIZE, &in_batch_size_, sizeof in_batch_size_));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    const int count = 64;
+    const size_t size = 1000;
+    char data[size];
+    zmq_msg_t msgs[count];
+    for (int round = 0; round != 2; ++round) {
+        for (int i = 0; i != count; ++i) {
+            memset (data, 'a' + i % 26, size);
+            TEST_ASSERT_EQUAL_INT (static_cast<int> (size),
+                                   zmq_send (push, data, size, 0));
+        }
+        for (int i = 0; i != count; ++i) {
+            TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msgs[i]));
+            TEST_ASSERT_EQUAL_INT (static_cast<int> (size),
+                                   zmq_msg_recv (&msgs[i], pull, 0));
+        }
+        for (int i = 0; i != count; ++i) {
+            const char *received =
+              static_cast<const char *> (zmq_msg_data (&msgs[i]));
+            TEST_ASSERT_EQUAL_INT ('a' + i % 26, received[0]);
+            TEST_ASSERT_EQUAL_INT ('a' + i % 26, received[size - 1]);
+            TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msgs[i]));
+        }
+    }
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_close (push));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_close (pull));
+}
+#endif
+
+void test_ctx_decoder_buffer_pool ()
+{
+#ifdef ZMQ_DECODER_BUFFER_HITS
+    TEST_ASSERT_EQUAL_INT (
+      0, zmq_ctx_get (get_test_context (), ZMQ_DECODER_BUFFER_HITS));
+    TEST_ASSERT_EQUAL_INT (
+      0, zmq_ctx_get (get_test_context (), ZMQ_DECODER_BUFFER_MISSES));
+
+    recv_held_batches (8192);
+    const int hits = zmq_ctx_get (get_test_context (), ZMQ_DECODER_BUFFER_HITS);
+    TEST_ASSERT_GREATER_THAN_INT (0, hits);
+    TEST_ASSERT_GREATER_THAN_INT (
+      0, zmq_ctx_get (get_test_context (), ZMQ_DECODER_BUFFER_MISSES));
+
+    recv_held_batches (4096);
+    TEST_ASSERT_GREATER_THAN_INT (
+      hits, zmq_ctx_get (get_test_context (), ZMQ_DECODER_BUFFER_HITS));
+#endif
+}
+
+void test_ctx_io_thread_placement ()
+{
+#ifdef ZMQ_IO_THREAD_NUMA_LOCAL
+    // Default values are 0.
+    TEST_ASSERT_EQUAL_INT (
+      0, zmq_ctx_get (get_test_context (), ZMQ_IO_THREAD_NUMA_LOCAL));
+    TEST_ASSERT_EQUAL_INT (
+      0, zmq_ctx_get (get_test_context (), ZMQ_IO_THREAD_HUGEPAGES));
+
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_set (get_test_context (), ZMQ_IO_THREAD_NUMA_LOCAL, 1));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_set (get_test_context (), ZMQ_IO_THREAD_HUGEPAGES, 1));
+    TEST_ASSERT_EQUAL_INT (
+      1, zmq_ctx_get (get_test_context (), ZMQ_IO_THREAD_NUMA_LOCAL));
+    TEST_ASSERT_EQUAL_INT (
+      1, zmq_ctx_get (get_test_context (), ZMQ_IO_THREAD_HUGEPAGES));
+
+    // Receive buffers come from page-backed regions; sockets with different
+    // batch sizes share them. Placement falls back silently where the system
+    // does not support it, so messages must flow either way.
+    const int batch_sizes[] = {8192, 3000};
+    void *pulls[2];
+    void *pushes[2];
+    for (int i = 0; i != 2; ++i) {
+        pulls[i] = zmq_socket (get_test_context (), ZMQ_PULL);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (
+          pulls[i], ZMQ_IN_BATCH_SIZE, &batch_sizes[i], sizeof (int)));
+        char endpoint[MAX_SOCKET_STRING];
+        bind_loopback_ipv4 (pulls[i], endpoint, sizeof endpoint);
+
+        pushes[i] = zmq_socket (get_test_context (), ZMQ_PUSH);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (pushes[i], endpoint));
+    }
+
+    const int count = 32;
+    const size_t size = 1000;
+    char data[size];
+    zmq_msg_t msgs[count];
+    for (int round = 0; round != 4; ++round) {
+        void *const push = pushes[round % 2];
+        void *const pull = pulls[round % 2];
+        for (int i = 0; i != count; ++i) {
+            memset (data, 'a' + i % 26, size);
+            TEST_ASSERT_EQUAL_INT (static_cast<int> (size),
+                                   zmq_send (push, data, size, 0));
+        }
+        for (int i = 0; i != count; ++i) {
+            TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msgs[i]));
+            TEST_ASSERT_EQUAL_INT (static_cast<int> (size),
+                                   zmq_msg_recv (&msgs[i], pull, 0));
+        }
+        for (int i = 0; i != count; ++i) {
+            const char *received =
+              static_cast<const char *> (zmq_msg_data (&msgs[i]));
+            TEST_ASSERT_EQUAL_INT ('a' + i % 26, received[0]);
+            TEST_ASSERT_EQUAL_INT ('a' + i % 26, received[size - 1]);
+            TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msgs[i]));
+        }
+    }
+
+    TEST_ASSERT_GREATER_THAN_INT (
+      0, zmq_ctx_get (get_test_context (), ZMQ_DECODER_BUFFER_HITS));
+
+    for (int i = 0; i != 2; ++i) {
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_close (pushes[i]));
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_close (pulls[i]));
+    }
+#endif
+}
+
+void test_ctx_io_thread_spin ()
+{
+#ifdef ZMQ_IO_THREAD_SPIN
+    // Default value is 0.
+    TEST_ASSERT_EQUAL_INT (
+      0, zmq_ctx_get (get_test_context (), ZMQ_IO_THREAD_SPIN));
+
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_ctx_set (get_test_context (), ZMQ_IO_THREAD_SPIN, -1));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_set (get_test_context (), ZMQ_IO_THREAD_SPIN, 100));
+    TEST_ASSERT_EQUAL_INT (
+      100, zmq_ctx_get (get_test_context (), ZMQ_IO_THREAD_SPIN));
+
+    void *pull = zmq_socket (get_test_context (), ZMQ_PULL);
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (pull, endpoint, sizeof endpoint);
+
+    void *push = zmq_socket (get_test_context (), ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    for (int i = 0; i != 10; ++i) {
+        send_string_expect_success (push, "abcd", 0);
+        recv_string_expect_success (pull, "abcd", 0);
+    }
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_close (push));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_close (pull));
+#endif
+}
+
 void test_ctx_option_max_sockets ()
 {
     TEST_ASSERT_EQUAL_INT (ZMQ_MAX_SOCKETS_DFLT,
@@ -304,6 +500,10 @@ int main (void)
     RUN_TEST (test_ctx_option_ipv6_set);
     RUN_TEST (test_ctx_thread_opts);
     RUN_TEST (test_ctx_zero_copy);
+    RUN_TEST (test_ctx_io_uring);
+    RUN_TEST (test_ctx_decoder_buffer_pool);
+    RUN_TEST (test_ctx_io_thread_placement);
+    RUN_TEST (test_ctx_io_thread_spin);
     RUN_TEST (test_ctx_option_blocky);
     RUN_TEST (test_ctx_option_invalid);
     return UNITY_END ();
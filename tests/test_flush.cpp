@@ -0,0 +1,205 @@
+/*
+    Copyright (c) 2007-2016 Contributors as noted in the AUTHORS file
+
+    This file is part of libzmq, the ZeroMQ core engine in C++.
+
+    libzmq is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License (LGPL) as published
+    by the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    As a special exception, the Contributors give you permission to link
+    this library with independent modules to produce an executable,
+    regardless of the license terms of these independent modules, and to
+    copy and distribute the resulting executable under terms of your choice,
+    provided that you also meet, for each linked independent module, the
+    terms and conditions of the license of that module. An independent
+    module is a module which is not derived from or based on this library.
+    If you modify this library, you must extend this exception to your
+    version of the library.
+
+    libzmq is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+static void set_int (void *socket_, int option_, int value_)
+{
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (socket_, option_, &value_, sizeof value_));
+}
+
+static void expect_nothing (void *socket_)
+{
+    char buffer[16];
+    TEST_ASSERT_FAILURE_ERRNO (EAGAIN, zmq_recv (socket_, buffer, sizeof buffer,
+                                                 ZMQ_DONTWAIT));
+}
+
+static void expect_messages (void *socket_, const char *content_, int count_)
+{
+    for (int i = 0; i != count_; ++i)
+        recv_string_expect_success (socket_, content_, ZMQ_DONTWAIT);
+    expect_nothing (socket_);
+}
+
+void test_options ()
+{
+    void *push = test_context_socket (ZMQ_PUSH);
+
+    int value;
+    size_t value_size = sizeof value;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (push, ZMQ_FLUSH_MSGS, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (0, value);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (push, ZMQ_FLUSH_BYTES, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (0, value);
+
+    set_int (push, ZMQ_FLUSH_BYTES, 65536);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (push, ZMQ_FLUSH_BYTES, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (65536, value);
+
+    value = -1;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_setsockopt (push, ZMQ_FLUSH_MSGS, &value, sizeof value));
+    TEST_ASSERT_FAILURE_ERRNO (ENOTSOCK, zmq_flush (NULL));
+
+    test_context_socket_close (push);
+}
+
+void test_flush_msgs ()
+{
+    void *pull = test_context_socket (ZMQ_PULL);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (pull, "inproc://flush_msgs"));
+    void *push = test_context_socket (ZMQ_PUSH);
+    set_int (push, ZMQ_FLUSH_MSGS, 4);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, "inproc://flush_msgs"));
+
+    //  The messages are held back until the fourth one.
+    for (int i = 0; i != 3; ++i)
+        send_string_expect_success (push, "msg", 0);
+    expect_nothing (pull);
+    send_string_expect_success (push, "msg", 0);
+    expect_messages (pull, "msg", 4);
+
+    //  Or until flushed explicitly.
+    send_string_expect_success (push, "msg", 0);
+    send_string_expect_success (push, "msg", 0);
+    expect_nothing (pull);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_flush (push));
+    expect_messages (pull, "msg", 2);
+
+    //  Message parts count as one message.
+    for (int i = 0; i != 3; ++i) {
+        send_string_expect_success (push, "msg", ZMQ_SNDMORE);
+        send_string_expect_success (push, "msg", 0);
+    }
+    expect_nothing (pull);
+    send_string_expect_success (push, "msg", 0);
+    expect_messages (pull, "msg", 7);
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+void test_flush_bytes ()
+{
+    void *pull = test_context_socket (ZMQ_PULL);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (pull, "inproc://flush_bytes"));
+    void *push = test_context_socket (ZMQ_PUSH);
+    set_int (push, ZMQ_FLUSH_BYTES, 10);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, "inproc://flush_bytes"));
+
+    for (int i = 0; i != 3; ++i)
+        send_string_expect_success (push, "abc", 0);
+    expect_nothing (pull);
+    send_string_expect_success (push, "abc", 0);
+    expect_messages (pull, "abc", 4);
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+void test_flush_on_events ()
+{
+    void *pull = test_context_socket (ZMQ_PULL);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (pull, "inproc://flush_on_events"));
+    void *push = test_context_socket (ZMQ_PUSH);
+    set_int (push, ZMQ_FLUSH_MSGS, 100);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, "inproc://flush_on_events"));
+
+    send_string_expect_success (push, "msg", 0);
+    expect_nothing (pull);
+
+    //  Polling the producer hands over what it has sent.
+    zmq_pollitem_t item = {push, 0, ZMQ_POLLOUT, 0};
+    TEST_ASSERT_EQUAL_INT (1, TEST_ASSERT_SUCCESS_ERRNO (zmq_poll (&item, 1, 0)));
+    expect_messages (pull, "msg", 1);
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+void test_flush_on_recv ()
+{
+    char endpoint[MAX_SOCKET_STRING];
+    void *rep = test_context_socket (ZMQ_REP);
+    bind_loopback_ipv4 (rep, endpoint, sizeof endpoint);
+    void *req = test_context_socket (ZMQ_REQ);
+    set_int (req, ZMQ_FLUSH_MSGS, 100);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (req, endpoint));
+
+    //  Waiting for the reply hands over the request.
+    send_string_expect_success (req, "request", 0);
+    char buffer[16];
+    TEST_ASSERT_FAILURE_ERRNO (
+      EAGAIN, zmq_recv (req, buffer, sizeof buffer, ZMQ_DONTWAIT));
+    recv_string_expect_success (rep, "request", 0);
+    send_string_expect_success (rep, "reply", 0);
+    recv_string_expect_success (req, "reply", 0);
+
+    test_context_socket_close (req);
+    test_context_socket_close (rep);
+}
+
+void test_flush_on_close ()
+{
+    char endpoint[MAX_SOCKET_STRING];
+    void *pull = test_context_socket (ZMQ_PULL);
+    bind_loopback_ipv4 (pull, endpoint, sizeof endpoint);
+    void *push = test_context_socket (ZMQ_PUSH);
+    set_int (push, ZMQ_FLUSH_MSGS, 100);
+    set_int (push, ZMQ_LINGER, -1);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    send_string_expect_success (push, "msg", 0);
+    test_context_socket_close (push);
+    recv_string_expect_success (pull, "msg", 0);
+
+    test_context_socket_close (pull);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_options);
+    RUN_TEST (test_flush_msgs);
+    RUN_TEST (test_flush_bytes);
+    RUN_TEST (test_flush_on_events);
+    RUN_TEST (test_flush_on_recv);
+    RUN_TEST (test_flush_on_close);
+    return UNITY_END ();
+}
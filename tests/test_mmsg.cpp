@@ -0,0 +1,361 @@
+/*
+    Copyright (c) 2007-2016 Contributors as noted in the AUTHORS file
+
+    This file is part of libzmq, the ZeroMQ core engine in C++.
+
+    libzmq is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License (LGPL) as published
+    by the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    As a special exception, the Contributors give you permission to link
+    this library with independent modules to produce an executable,
+    regardless of the license terms of these independent modules, and to
+    copy and distribute the resulting executable under terms of your choice,
+    provided that you also meet, for each linked independent module, the
+    terms and conditions of the license of that module. An independent
+    module is a module which is not derived from or based on this library.
+    If you modify this library, you must extend this exception to your
+    version of the library.
+
+    libzmq is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+#include <string.h>
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+static const int batch = 16;
+
+static void init_batch (zmq_msg_t *msgs_, int count_, int first_)
+{
+    for (int i = 0; i != count_; ++i) {
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init_size (&msgs_[i], 4));
+        memcpy (zmq_msg_data (&msgs_[i]), &first_, 4);
+        ++first_;
+    }
+}
+
+//  Receives count_ messages in batches and checks they are numbered
+//  consecutively, starting at first_.
+static void recv_numbered (void *socket_, int count_, int first_)
+{
+    zmq_msg_t msgs[batch];
+    for (int i = 0; i != batch; ++i)
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msgs[i]));
+
+    while (count_ > 0) {
+        const int n = TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_recvmmsg (socket_, msgs, count_ < batch ? count_ : batch, 0));
+        TEST_ASSERT_GREATER_THAN_INT (0, n);
+        for (int i = 0; i != n; ++i) {
+            TEST_ASSERT_EQUAL_INT (4, zmq_msg_size (&msgs[i]));
+            TEST_ASSERT_EQUAL_INT (0, zmq_msg_more (&msgs[i]));
+            int number;
+            memcpy (&number, zmq_msg_data (&msgs[i]), 4);
+            TEST_ASSERT_EQUAL_INT (first_++, number);
+        }
+        count_ -= n;
+    }
+
+    for (int i = 0; i != batch; ++i)
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msgs[i]));
+}
+
+static void recv_part (void *socket_, const char *expected_, int more_)
+{
+    recv_string_expect_success (socket_, expected_, 0);
+    int more;
+    size_t more_size = sizeof more;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket_, ZMQ_RCVMORE, &more, &more_size));
+    TEST_ASSERT_EQUAL_INT (more_, more);
+}
+
+static void test_batches (const char *endpoint_)
+{
+    void *pull = test_context_socket (ZMQ_PULL);
+    void *push = test_context_socket (ZMQ_PUSH);
+    char my_endpoint[MAX_SOCKET_STRING];
+    if (strcmp (endpoint_, "tcp") == 0) {
+        bind_loopback_ipv4 (pull, my_endpoint, sizeof my_endpoint);
+        endpoint_ = my_endpoint;
+    } else
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (pull, endpoint_));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint_));
+
+    const int rounds = 20;
+    zmq_msg_t msgs[batch];
+    for (int round = 0; round != rounds; ++round) {
+        init_batch (msgs, batch, round * batch);
+        TEST_ASSERT_EQUAL_INT (batch,
+                               zmq_sendmmsg (push, msgs, NULL, batch, 0));
+    }
+    recv_numbered (pull, rounds * batch, 0);
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+void test_batches_inproc ()
+{
+    test_batches ("inproc://batches");
+}
+
+void test_batches_tcp ()
+{
+    test_batches ("tcp");
+}
+
+void test_forward_multipart ()
+{
+    void *front_in = test_context_socket (ZMQ_PAIR);
+    void *front_out = test_context_socket (ZMQ_PAIR);
+    void *back_in = test_context_socket (ZMQ_PAIR);
+    void *back_out = test_context_socket (ZMQ_PAIR);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (front_out, "inproc://front"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (front_in, "inproc://front"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (back_out, "inproc://back"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (back_in, "inproc://back"));
+
+    send_string_expect_success (front_in, "A1", ZMQ_SNDMORE);
+    send_string_expect_success (front_in, "A2", 0);
+    send_string_expect_success (front_in, "B1", ZMQ_SNDMORE);
+    send_string_expect_success (front_in, "B2", ZMQ_SNDMORE);
+    send_string_expect_success (front_in, "B3", 0);
+
+    //  All five parts are queued, so they arrive in one go and keep their
+    //  message boundaries when forwarded.
+    zmq_msg_t msgs[8];
+    for (int i = 0; i != 8; ++i)
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msgs[i]));
+    int n = TEST_ASSERT_SUCCESS_ERRNO (zmq_recvmmsg (front_out, msgs, 8, 0));
+    while (n < 5) {
+        const int rc = TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_recvmmsg (front_out, msgs + n, 8 - n, 0));
+        n += rc;
+    }
+    TEST_ASSERT_EQUAL_INT (5, n);
+    TEST_ASSERT_EQUAL_INT (5, zmq_sendmmsg (back_out, msgs, NULL, n, 0));
+
+    recv_part (back_in, "A1", 1);
+    recv_part (back_in, "A2", 0);
+    recv_part (back_in, "B1", 1);
+    recv_part (back_in, "B2", 1);
+    recv_part (back_in, "B3", 0);
+
+    //  ZMQ_SNDMORE continues the last message of the batch.
+    for (int i = 0; i != 2; ++i) {
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init_size (&msgs[i], 2));
+        memcpy (zmq_msg_data (&msgs[i]), i == 0 ? "C1" : "C2", 2);
+    }
+    TEST_ASSERT_EQUAL_INT (2,
+                           zmq_sendmmsg (back_out, msgs, NULL, 2, ZMQ_SNDMORE));
+    send_string_expect_success (back_out, "C3", 0);
+    recv_part (back_in, "C1", 0);
+    recv_part (back_in, "C2", 1);
+    recv_part (back_in, "C3", 0);
+
+    for (int i = 0; i != 8; ++i)
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msgs[i]));
+    test_context_socket_close (front_in);
+    test_context_socket_close (front_out);
+    test_context_socket_close (back_in);
+    test_context_socket_close (back_out);
+}
+
+void test_multipart_flags ()
+{
+    void *sender = test_context_socket (ZMQ_PAIR);
+    void *receiver = test_context_socket (ZMQ_PAIR);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (receiver, "inproc://flags"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (sender, "inproc://flags"));
+
+    //  Fresh messages are put together into multi-part messages by the
+    //  flags passed along with them.
+    const char *const parts[] = {"A1", "A2", "B1", "C1", "C2", "C3"};
+    const int flags[] = {ZMQ_SNDMORE, 0, 0, ZMQ_SNDMORE, ZMQ_SNDMORE, 0};
+    const int count = 6;
+    zmq_msg_t msgs[count];
+    for (int i = 0; i != count; ++i) {
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init_size (&msgs[i], 2));
+        memcpy (zmq_msg_data (&msgs[i]), parts[i], 2);
+    }
+    TEST_ASSERT_EQUAL_INT (count,
+                           zmq_sendmmsg (sender, msgs, flags, count, 0));
+    for (int i = 0; i != count; ++i)
+        recv_part (receiver, parts[i], flags[i] ? 1 : 0);
+
+    //  The flags take precedence over those the messages carry.
+    send_string_expect_success (sender, "D1", ZMQ_SNDMORE);
+    send_string_expect_success (sender, "D2", 0);
+    for (int i = 0; i != 2; ++i) {
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msgs[i]));
+        TEST_ASSERT_EQUAL_INT (2, zmq_msg_recv (&msgs[i], receiver, 0));
+    }
+    const int split[] = {0, 0};
+    TEST_ASSERT_EQUAL_INT (2, zmq_sendmmsg (receiver, msgs, split, 2, 0));
+    recv_part (sender, "D1", 0);
+    recv_part (sender, "D2", 0);
+
+    for (int i = 0; i != count; ++i)
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msgs[i]));
+    test_context_socket_close (sender);
+    test_context_socket_close (receiver);
+}
+
+void test_partial_send ()
+{
+    void *pull = test_context_socket (ZMQ_PULL);
+    void *push = test_context_socket (ZMQ_PUSH);
+    const int hwm = 4;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (push, ZMQ_SNDHWM, &hwm, sizeof hwm));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (pull, ZMQ_RCVHWM, &hwm, sizeof hwm));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (pull, "inproc://partial"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, "inproc://partial"));
+
+    //  The messages that do not fit stay with the caller.
+    zmq_msg_t msgs[batch];
+    init_batch (msgs, batch, 0);
+    const int sent = TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_sendmmsg (push, msgs, NULL, batch, ZMQ_DONTWAIT));
+    TEST_ASSERT_GREATER_THAN_INT (0, sent);
+    TEST_ASSERT_LESS_THAN_INT (batch, sent);
+    TEST_ASSERT_EQUAL_INT (4, zmq_msg_size (&msgs[sent]));
+
+    recv_numbered (pull, sent, 0);
+
+    //  Blocking sends go on as the receiver catches up.
+    TEST_ASSERT_EQUAL_INT (
+      batch - sent, zmq_sendmmsg (push, msgs + sent, NULL, batch - sent, 0));
+    recv_numbered (pull, batch - sent, sent);
+
+    zmq_msg_t msg;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+    TEST_ASSERT_FAILURE_ERRNO (EAGAIN,
+                               zmq_recvmmsg (pull, &msg, 1, ZMQ_DONTWAIT));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+static void recv_batch_of_one (void *client_)
+{
+    zmq_msg_t msgs[batch];
+    for (int i = 0; i != batch; ++i)
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msgs[i]));
+    TEST_ASSERT_EQUAL_INT (1, zmq_recvmmsg (client_, msgs, batch, 0));
+    TEST_ASSERT_EQUAL_INT (4, zmq_msg_size (&msgs[0]));
+    for (int i = 0; i != batch; ++i)
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msgs[i]));
+}
+
+static void send_batch_over_hwm (void *client_)
+{
+    zmq_msg_t msgs[batch];
+    init_batch (msgs, batch, 0);
+    TEST_ASSERT_EQUAL_INT (batch,
+                           zmq_sendmmsg (client_, msgs, NULL, batch, 0));
+}
+
+//  Connects a CLIENT to a SERVER and returns the routing id of the former.
+static uint32_t connect_client (void *server_, void *client_)
+{
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (server_, "inproc://thread_safe"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (client_, "inproc://thread_safe"));
+    send_string_expect_success (client_, "ping", 0);
+    zmq_msg_t msg;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+    TEST_ASSERT_EQUAL_INT (4, zmq_msg_recv (&msg, server_, 0));
+    const uint32_t routing_id = zmq_msg_routing_id (&msg);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+    return routing_id;
+}
+
+void test_thread_safe_recv ()
+{
+    void *server = test_context_socket (ZMQ_SERVER);
+    void *client = test_context_socket (ZMQ_CLIENT);
+    const int timeout = 3000;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (client, ZMQ_RCVTIMEO, &timeout, sizeof timeout));
+    const uint32_t routing_id = connect_client (server, client);
+
+    //  The thread waiting for a batch must let the peer's commands reach
+    //  the socket.
+    void *thread = zmq_threadstart (recv_batch_of_one, client);
+    msleep (SETTLE_TIME);
+
+    void *watch = zmq_stopwatch_start ();
+    zmq_msg_t msg;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init_size (&msg, 4));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_set_routing_id (&msg, routing_id));
+    TEST_ASSERT_EQUAL_INT (4, zmq_msg_send (&msg, server, 0));
+    TEST_ASSERT_LESS_THAN_UINT32 (1000000, zmq_stopwatch_stop (watch));
+    zmq_threadclose (thread);
+
+    test_context_socket_close (client);
+    test_context_socket_close (server);
+}
+
+void test_thread_safe_send ()
+{
+    void *server = test_context_socket (ZMQ_SERVER);
+    void *client = test_context_socket (ZMQ_CLIENT);
+    const int hwm = 1;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (client, ZMQ_SNDHWM, &hwm, sizeof hwm));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (server, ZMQ_RCVHWM, &hwm, sizeof hwm));
+    connect_client (server, client);
+
+    //  The thread waiting for room to send the batch must let the peer's
+    //  commands reach the socket.
+    void *thread = zmq_threadstart (send_batch_over_hwm, client);
+    msleep (SETTLE_TIME);
+    recv_numbered (server, batch, 0);
+    zmq_threadclose (thread);
+
+    test_context_socket_close (client);
+    test_context_socket_close (server);
+}
+
+void test_invalid ()
+{
+    void *push = test_context_socket (ZMQ_PUSH);
+    TEST_ASSERT_FAILURE_ERRNO (EINVAL, zmq_sendmmsg (push, NULL, NULL, 1, 0));
+    TEST_ASSERT_FAILURE_ERRNO (EINVAL, zmq_recvmmsg (push, NULL, 1, 0));
+    TEST_ASSERT_EQUAL_INT (0, zmq_sendmmsg (push, NULL, NULL, 0, 0));
+    TEST_ASSERT_FAILURE_ERRNO (ENOTSOCK,
+                               zmq_sendmmsg (NULL, NULL, NULL, 0, 0));
+    test_context_socket_close (push);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_batches_inproc);
+    RUN_TEST (test_batches_tcp);
+    RUN_TEST (test_forward_multipart);
+    RUN_TEST (test_multipart_flags);
+    RUN_TEST (test_partial_send);
+    RUN_TEST (test_thread_safe_recv);
+    RUN_TEST (test_thread_safe_send);
+    RUN_TEST (test_invalid);
+    return UNITY_END ();
+}
@@ -436,6 +436,108 @@ void test_monitor_versioned_stats_ipc ()
     test_monitor_versioned_stats (bind_loopback_ipc, prefix);
 }
 #endif // ZMQ_EVENT_PIPES_STATS
+
+#ifdef ZMQ_EVENT_PIPES_LATENCY
+//  Checks the latency summary of one direction: the number of messages,
+//  then the percentiles and the maximum in increasing order.
+static void check_latency_summary (const uint64_t *summary_,
+                                   uint64_t expected_count_)
+{
+    TEST_ASSERT_EQUAL_UINT64 (expected_count_, summary_[0]);
+    if (expected_count_ == 0) {
+        TEST_ASSERT_EQUAL_UINT64 (0, summary_[5]);
+        return;
+    }
+    TEST_ASSERT_GREATER_THAN_UINT64 (0, summary_[1]);
+    for (int i = 2; i < 6; i++)
+        TEST_ASSERT_GREATER_OR_EQUAL_UINT64 (summary_[i - 1], summary_[i]);
+}
+
+void test_monitor_versioned_latency (bind_function_t bind_function_)
+{
+    char server_endpoint[MAX_SOCKET_STRING];
+    const int msg_count = 100;
+
+    void *push = test_context_socket (ZMQ_PUSH);
+    void *pull = test_context_socket (ZMQ_PULL);
+    int enabled = 1;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (push, ZMQ_LATENCY_STATS, &enabled, sizeof (enabled)));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (pull, ZMQ_LATENCY_STATS, &enabled, sizeof (enabled)));
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_socket_monitor_versioned (
+      push, "inproc://monitor-push", ZMQ_EVENT_PIPES_LATENCY, 2, ZMQ_PAIR));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_socket_monitor_versioned (
+      pull, "inproc://monitor-pull", ZMQ_EVENT_PIPES_LATENCY, 2, ZMQ_PAIR));
+    void *push_mon = test_context_socket (ZMQ_PAIR);
+    void *pull_mon = test_context_socket (ZMQ_PAIR);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push_mon, "inproc://monitor-push"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (pull_mon, "inproc://monitor-pull"));
+
+    bind_function_ (pull, server_endpoint, sizeof (server_endpoint));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, server_endpoint));
+
+    for (int i = 0; i < msg_count; ++i)
+        send_string_expect_success (push, "latency", 0);
+    for (int i = 0; i < msg_count; ++i)
+        recv_string_expect_success (pull, "latency", 0);
+
+    //  The pusher's I/O thread read all the messages, the puller's socket
+    //  did. Neither received anything in the other direction.
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_socket_monitor_pipes_stats (push));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_socket_monitor_pipes_stats (pull));
+
+    //  Over inproc, each socket answers the query of the other. Kick both
+    //  application threads to run through their mailboxes, twice.
+    int events;
+    size_t events_size = sizeof (events);
+    for (int i = 0; i < 2; ++i) {
+        msleep (SETTLE_TIME);
+        zmq_getsockopt (push, ZMQ_EVENTS, &events, &events_size);
+        zmq_getsockopt (pull, ZMQ_EVENTS, &events, &events_size);
+    }
+
+    uint64_t *summary = NULL;
+    TEST_ASSERT_EQUAL_INT (
+      ZMQ_EVENT_PIPES_LATENCY,
+      get_monitor_event_v2 (push_mon, &summary, NULL, NULL));
+    check_latency_summary (summary, msg_count);
+    check_latency_summary (summary + 6, 0);
+    free (summary);
+
+    TEST_ASSERT_EQUAL_INT (
+      ZMQ_EVENT_PIPES_LATENCY,
+      get_monitor_event_v2 (pull_mon, &summary, NULL, NULL));
+    check_latency_summary (summary, 0);
+    check_latency_summary (summary + 6, msg_count);
+    free (summary);
+
+    test_context_socket_close_zero_linger (push_mon);
+    test_context_socket_close_zero_linger (pull_mon);
+    test_context_socket_close_zero_linger (push);
+    test_context_socket_close_zero_linger (pull);
+}
+
+void test_monitor_versioned_latency_tcp ()
+{
+    test_monitor_versioned_latency (bind_loopback_ipv4);
+}
+
+static void
+bind_latency_inproc (void *socket_, char *my_endpoint_, size_t len_)
+{
+    static const char endpoint[] = "inproc://latency";
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (socket_, endpoint));
+    strncpy (my_endpoint_, endpoint, len_);
+}
+
+void test_monitor_versioned_latency_inproc ()
+{
+    test_monitor_versioned_latency (bind_latency_inproc);
+}
+#endif
+
 #endif
 
 int main ()
@@ -459,6 +561,10 @@ int main ()
     RUN_TEST (test_monitor_versioned_stats_tcp_ipv6);
     RUN_TEST (test_monitor_versioned_stats_ipc);
 #endif
+#ifdef ZMQ_EVENT_PIPES_LATENCY
+    RUN_TEST (test_monitor_versioned_latency_tcp);
+    RUN_TEST (test_monitor_versioned_latency_inproc);
+#endif
 #endif
 
     return UNITY_END ();
@@ -74,6 +74,57 @@ void test_msg_init_buffer ()
     TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg2));
 }
 
+void test_msg_pool ()
+{
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_pool_open ());
+
+    void *pull = test_context_socket (ZMQ_PULL);
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (pull, endpoint, sizeof endpoint);
+
+    void *push = test_context_socket (ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    // Cover the size classes, including sizes beyond the pooled range.
+    // Messages allocated by the I/O thread are released by this one.
+    const size_t sizes[] = {64, 200, 1000, 4096, 10000, 40000};
+    const int count = sizeof sizes / sizeof sizes[0];
+    for (int round = 0; round != 50; ++round) {
+        for (int i = 0; i != count; ++i) {
+            zmq_msg_t msg;
+            TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init_size (&msg, sizes[i]));
+            memset (zmq_msg_data (&msg), 'a' + i, sizes[i]);
+            TEST_ASSERT_EQUAL_INT (static_cast<int> (sizes[i]),
+                                   zmq_msg_send (&msg, push, 0));
+        }
+        for (int i = 0; i != count; ++i) {
+            zmq_msg_t msg;
+            TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+            TEST_ASSERT_EQUAL_INT (static_cast<int> (sizes[i]),
+                                   zmq_msg_recv (&msg, pull, 0));
+            const char *data = static_cast<const char *> (zmq_msg_data (&msg));
+            TEST_ASSERT_EQUAL_INT ('a' + i, data[0]);
+            TEST_ASSERT_EQUAL_INT ('a' + i, data[sizes[i] - 1]);
+            TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+        }
+    }
+
+    // The pool stays in use until every open is matched by a close.
+    // Messages allocated from it may outlive it.
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_pool_open ());
+    zmq_msg_t pooled;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init_size (&pooled, 1000));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_pool_close ());
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_pool_close ());
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&pooled));
+
+    // A close without an open is an error.
+    TEST_ASSERT_FAILURE_ERRNO (EINVAL, zmq_msg_pool_close ());
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
 int main (void)
 {
     setup_test_environment ();
@@ -82,5 +133,6 @@ int main (void)
     RUN_TEST (test_msg_init);
     RUN_TEST (test_msg_init_size);
     RUN_TEST (test_msg_init_buffer);
+    RUN_TEST (test_msg_pool);
     return UNITY_END ();
 }
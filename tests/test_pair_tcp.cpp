@@ -106,6 +106,46 @@ void test_pair_tcp_connect_by_name ()
     test_context_socket_close (sb);
 }
 
+void test_pair_tcp_mixed_sizes ()
+{
+    //  Small message parts are batched with the headers, larger ones are
+    //  written from the message itself; the stream must come out intact.
+    void *sb = test_context_socket (ZMQ_PAIR);
+    char my_endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (sb, my_endpoint, sizeof my_endpoint);
+
+    void *sc = test_context_socket (ZMQ_PAIR);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (sc, my_endpoint));
+
+    const size_t sizes[] = {0, 5, 300, 1024, 4000, 9000, 70000, 20};
+    const size_t count = sizeof sizes / sizeof sizes[0];
+    for (int round = 0; round < 50; round++) {
+        for (size_t i = 0; i < count; i++) {
+            zmq_msg_t msg;
+            TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init_size (&msg, sizes[i]));
+            memset (zmq_msg_data (&msg), 'a' + (round + i) % 26, sizes[i]);
+            TEST_ASSERT_EQUAL_INT (
+              static_cast<int> (sizes[i]),
+              zmq_msg_send (&msg, sc, i + 1 < count ? ZMQ_SNDMORE : 0));
+        }
+    }
+    for (int round = 0; round < 50; round++) {
+        for (size_t i = 0; i < count; i++) {
+            zmq_msg_t msg;
+            TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+            TEST_ASSERT_EQUAL_INT (static_cast<int> (sizes[i]),
+                                   zmq_msg_recv (&msg, sb, 0));
+            const char *data = static_cast<const char *> (zmq_msg_data (&msg));
+            for (size_t j = 0; j < sizes[i]; j += 97)
+                TEST_ASSERT_EQUAL_INT ('a' + (round + i) % 26, data[j]);
+            TEST_ASSERT_EQUAL_INT (i + 1 < count, zmq_msg_more (&msg));
+            TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+        }
+    }
+
+    test_context_socket_close (sc);
+    test_context_socket_close (sb);
+}
 
 #ifdef ZMQ_BUILD_DRAFT
 void test_pair_tcp_fastpath ()
@@ -114,6 +154,189 @@ void test_pair_tcp_fastpath ()
 }
 #endif
 
+#ifdef ZMQ_BUILD_DRAFT_API
+void test_pair_tcp_zerocopy ()
+{
+    void *sb = test_context_socket (ZMQ_PAIR);
+    void *sc = test_context_socket (ZMQ_PAIR);
+
+    int threshold = 16384;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (sb, ZMQ_TCP_ZEROCOPY_THRESHOLD,
+                                               &threshold, sizeof threshold));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (sc, ZMQ_TCP_ZEROCOPY_THRESHOLD,
+                                               &threshold, sizeof threshold));
+    threshold = 0;
+    size_t size = sizeof threshold;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (sc, ZMQ_TCP_ZEROCOPY_THRESHOLD, &threshold, &size));
+    TEST_ASSERT_EQUAL_INT (16384, threshold);
+
+    char my_endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (sb, my_endpoint, sizeof my_endpoint);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (sc, my_endpoint));
+
+    //  Messages are released by the sender while the kernel may still be
+    //  transmitting them; each must arrive intact.
+    const size_t msg_size = 1024 * 1024;
+    const int count = 16;
+    for (int i = 0; i < count; i++) {
+        zmq_msg_t msg;
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init_size (&msg, msg_size));
+        memset (zmq_msg_data (&msg), 'a' + i, msg_size);
+        TEST_ASSERT_EQUAL_INT (static_cast<int> (msg_size),
+                               zmq_msg_send (&msg, sc, 0));
+    }
+    for (int i = 0; i < count; i++) {
+        zmq_msg_t msg;
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+        TEST_ASSERT_EQUAL_INT (static_cast<int> (msg_size),
+                               zmq_msg_recv (&msg, sb, 0));
+        const char *data = static_cast<const char *> (zmq_msg_data (&msg));
+        TEST_ASSERT_EQUAL_INT ('a' + i, data[0]);
+        TEST_ASSERT_EQUAL_INT ('a' + i, data[msg_size - 1]);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+    }
+
+    bounce (sb, sc);
+
+    test_context_socket_close (sc);
+    test_context_socket_close (sb);
+}
+
+static const size_t zerocopy_close_msg_size = 32 * 1024;
+static const int zerocopy_close_count = 8;
+static char zerocopy_close_buffers[zerocopy_close_count]
+                                  [zerocopy_close_msg_size];
+static int zerocopy_close_released;
+
+//  Overwrites the buffer the way an application reusing it would.
+static void zerocopy_close_free (void *data_, void *hint_)
+{
+    LIBZMQ_UNUSED (hint_);
+    memset (data_, 0, zerocopy_close_msg_size);
+    zerocopy_close_released++;
+}
+
+void test_pair_tcp_zerocopy_close ()
+{
+    void *ctx = zmq_ctx_new ();
+    TEST_ASSERT_NOT_NULL (ctx);
+    void *sb = zmq_socket (ctx, ZMQ_PAIR);
+    TEST_ASSERT_NOT_NULL (sb);
+    void *sc = zmq_socket (ctx, ZMQ_PAIR);
+    TEST_ASSERT_NOT_NULL (sc);
+
+    //  All messages fit into the sender's kernel buffer, but not into the
+    //  receiver's nor its pipe, so that much of the data is still queued
+    //  by the sender when its engine is destroyed.
+    const int threshold = 16384;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (sc, ZMQ_TCP_ZEROCOPY_THRESHOLD,
+                                               &threshold, sizeof threshold));
+    const int sndbuf = 1024 * 1024;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (sc, ZMQ_SNDBUF, &sndbuf, sizeof sndbuf));
+    const int rcvbuf = 32 * 1024;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (sb, ZMQ_RCVBUF, &rcvbuf, sizeof rcvbuf));
+    const int hwm = 1;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (sb, ZMQ_RCVHWM, &hwm, sizeof hwm));
+    const int linger = 5000;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (sc, ZMQ_LINGER, &linger, sizeof linger));
+
+    char my_endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (sb, my_endpoint, sizeof my_endpoint);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (sc, my_endpoint));
+    bounce (sb, sc);
+
+    zerocopy_close_released = 0;
+    for (int i = 0; i < zerocopy_close_count; i++) {
+        memset (zerocopy_close_buffers[i], 'a' + i, zerocopy_close_msg_size);
+        zmq_msg_t msg;
+        TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_msg_init_data (&msg, zerocopy_close_buffers[i],
+                             zerocopy_close_msg_size, zerocopy_close_free,
+                             NULL));
+        TEST_ASSERT_EQUAL_INT (static_cast<int> (zerocopy_close_msg_size),
+                               zmq_msg_send (&msg, sc, 0));
+    }
+
+    //  Closing the sender destroys its engine once the messages are
+    //  written, before the kernel transmitted them.
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_close (sc));
+    msleep (SETTLE_TIME);
+
+    for (int i = 0; i < zerocopy_close_count; i++) {
+        zmq_msg_t msg;
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+        TEST_ASSERT_EQUAL_INT (static_cast<int> (zerocopy_close_msg_size),
+                               zmq_msg_recv (&msg, sb, 0));
+        const char *data = static_cast<const char *> (zmq_msg_data (&msg));
+        for (size_t j = 0; j < zerocopy_close_msg_size; j += 4096)
+            TEST_ASSERT_EQUAL_INT ('a' + i, data[j]);
+        TEST_ASSERT_EQUAL_INT ('a' + i, data[zerocopy_close_msg_size - 1]);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+    }
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_close (sb));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_term (ctx));
+    TEST_ASSERT_EQUAL_INT (zerocopy_close_count, zerocopy_close_released);
+}
+
+void test_pair_tcp_zerocopy_term ()
+{
+    //  The receiver lives in a context of its own, so that it keeps the
+    //  data queued while the sender's context terminates.
+    void *ctx = zmq_ctx_new ();
+    TEST_ASSERT_NOT_NULL (ctx);
+    void *sc = zmq_socket (ctx, ZMQ_PAIR);
+    TEST_ASSERT_NOT_NULL (sc);
+    void *sb = test_context_socket (ZMQ_PAIR);
+
+    const int threshold = 16384;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (sc, ZMQ_TCP_ZEROCOPY_THRESHOLD,
+                                               &threshold, sizeof threshold));
+    const int sndbuf = 1024 * 1024;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (sc, ZMQ_SNDBUF, &sndbuf, sizeof sndbuf));
+    const int rcvbuf = 32 * 1024;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (sb, ZMQ_RCVBUF, &rcvbuf, sizeof rcvbuf));
+    const int hwm = 1;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (sb, ZMQ_RCVHWM, &hwm, sizeof hwm));
+    //  The receiver never reads what it was sent.
+    const int linger = 0;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (sb, ZMQ_LINGER, &linger, sizeof linger));
+
+    char my_endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (sb, my_endpoint, sizeof my_endpoint);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (sc, my_endpoint));
+    bounce (sb, sc);
+
+    zerocopy_close_released = 0;
+    for (int i = 0; i < zerocopy_close_count; i++) {
+        zmq_msg_t msg;
+        TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_msg_init_data (&msg, zerocopy_close_buffers[i],
+                             zerocopy_close_msg_size, zerocopy_close_free,
+                             NULL));
+        TEST_ASSERT_EQUAL_INT (static_cast<int> (zerocopy_close_msg_size),
+                               zmq_msg_send (&msg, sc, 0));
+    }
+
+    //  With the default infinite linger, terminating the context must
+    //  still give up on the sends the receiver never acknowledges.
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_close (sc));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_term (ctx));
+    TEST_ASSERT_EQUAL_INT (zerocopy_close_count, zerocopy_close_released);
+
+    test_context_socket_close (sb);
+}
+#endif
+
 #ifdef _WIN32
 void test_io_completion_port ()
 {
@@ -150,9 +373,15 @@ int main ()
     UNITY_BEGIN ();
     RUN_TEST (test_pair_tcp_regular);
     RUN_TEST (test_pair_tcp_connect_by_name);
+    RUN_TEST (test_pair_tcp_mixed_sizes);
 #ifdef ZMQ_BUILD_DRAFT
     RUN_TEST (test_pair_tcp_fastpath);
 #endif
+#ifdef ZMQ_BUILD_DRAFT_API
+    RUN_TEST (test_pair_tcp_zerocopy);
+    RUN_TEST (test_pair_tcp_zerocopy_close);
+    RUN_TEST (test_pair_tcp_zerocopy_term);
+#endif
 #ifdef _WIN32
     RUN_TEST (test_io_completion_port);
 #endif
@@ -279,6 +279,116 @@ void test_radio_dish_udp (int ipv6_)
 }
 MAKE_TEST_V4V6 (test_radio_dish_udp)
 
+void test_radio_dish_udp_batch (int ipv6_)
+{
+    void *radio = test_context_socket (ZMQ_RADIO);
+    void *dish = test_context_socket (ZMQ_DISH);
+
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (radio, ZMQ_IPV6, &ipv6_, sizeof (int)));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (dish, ZMQ_IPV6, &ipv6_, sizeof (int)));
+
+    int batch_size = 0;
+    TEST_ASSERT_FAILURE_ERRNO (EINVAL,
+                               zmq_setsockopt (radio, ZMQ_UDP_BATCH_SIZE,
+                                               &batch_size, sizeof (int)));
+    batch_size = 16;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (radio, ZMQ_UDP_BATCH_SIZE,
+                                               &batch_size, sizeof (int)));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (dish, ZMQ_UDP_BATCH_SIZE,
+                                               &batch_size, sizeof (int)));
+    size_t size = sizeof (int);
+    batch_size = 0;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (dish, ZMQ_UDP_BATCH_SIZE, &batch_size, &size));
+    TEST_ASSERT_EQUAL_INT (16, batch_size);
+
+    const char *radio_url = ipv6_ ? "udp://[::1]:5556" : "udp://127.0.0.1:5556";
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (dish, "udp://*:5556"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (radio, radio_url));
+
+    msleep (SETTLE_TIME);
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_join (dish, "TV"));
+
+    //  More messages than fit into a single batch, with one too large for
+    //  a datagram in between, which is dropped.
+    const int count = 40;
+    char body[16];
+    static char large_body[9000];
+    memset (large_body, 'x', sizeof large_body - 1);
+    for (int i = 0; i < count; i++) {
+        if (i == count / 2)
+            msg_send_expect_success (radio, "TV", large_body);
+        snprintf (body, sizeof body, "Friends %d", i);
+        msg_send_expect_success (radio, "TV", body);
+    }
+    for (int i = 0; i < count; i++) {
+        snprintf (body, sizeof body, "Friends %d", i);
+        msg_recv_cmp (dish, "TV", body);
+    }
+
+    test_context_socket_close (dish);
+    test_context_socket_close (radio);
+}
+MAKE_TEST_V4V6 (test_radio_dish_udp_batch)
+
+void test_radio_dish_udp_offload (int ipv6_)
+{
+    void *radio = test_context_socket (ZMQ_RADIO);
+    void *dish = test_context_socket (ZMQ_DISH);
+
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (radio, ZMQ_IPV6, &ipv6_, sizeof (int)));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (dish, ZMQ_IPV6, &ipv6_, sizeof (int)));
+
+    int batch_size = 16;
+    int offload = 1;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (radio, ZMQ_UDP_BATCH_SIZE,
+                                               &batch_size, sizeof (int)));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (dish, ZMQ_UDP_BATCH_SIZE,
+                                               &batch_size, sizeof (int)));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (radio, ZMQ_UDP_OFFLOAD, &offload, sizeof (int)));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (dish, ZMQ_UDP_OFFLOAD, &offload, sizeof (int)));
+    size_t size = sizeof (int);
+    offload = 0;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (dish, ZMQ_UDP_OFFLOAD, &offload, &size));
+    TEST_ASSERT_EQUAL_INT (1, offload);
+
+    const char *radio_url = ipv6_ ? "udp://[::1]:5556" : "udp://127.0.0.1:5556";
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (dish, "udp://*:5556"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (radio, radio_url));
+
+    msleep (SETTLE_TIME);
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_join (dish, "TV"));
+
+    //  Runs of equal sized datagrams, each ended by a shorter one.
+    const int count = 40;
+    char body[16];
+    for (int i = 0; i < count; i++) {
+        snprintf (body, sizeof body, i % 10 == 9 ? "Bye %d" : "Friends %02d",
+                  i);
+        msg_send_expect_success (radio, "TV", body);
+    }
+    for (int i = 0; i < count; i++) {
+        snprintf (body, sizeof body, i % 10 == 9 ? "Bye %d" : "Friends %02d",
+                  i);
+        msg_recv_cmp (dish, "TV", body);
+    }
+
+    test_context_socket_close (dish);
+    test_context_socket_close (radio);
+}
+MAKE_TEST_V4V6 (test_radio_dish_udp_offload)
+
 #define MCAST_IPV4 "226.8.5.5"
 #define MCAST_IPV6 "ff02::7a65:726f:6df1:0a01"
 
@@ -544,6 +654,10 @@ int main (void)
     RUN_TEST (test_radio_dish_tcp_poll_ipv6);
     RUN_TEST (test_radio_dish_udp_ipv4);
     RUN_TEST (test_radio_dish_udp_ipv6);
+    RUN_TEST (test_radio_dish_udp_batch_ipv4);
+    RUN_TEST (test_radio_dish_udp_batch_ipv6);
+    RUN_TEST (test_radio_dish_udp_offload_ipv4);
+    RUN_TEST (test_radio_dish_udp_offload_ipv6);
 
     RUN_TEST (test_radio_dish_mcast_ipv4);
     RUN_TEST (test_radio_dish_no_loop_ipv4);
@@ -61,9 +61,18 @@ void *server;
 void *server_mon;
 char my_endpoint[MAX_SOCKET_STRING];
 
+#ifdef ZMQ_BUILD_DRAFT_API
+//  Number of crypto pool threads of the contexts set up by setUp
+int crypto_threads = 0;
+#endif
+
 void setUp ()
 {
     setup_test_context ();
+#ifdef ZMQ_BUILD_DRAFT_API
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_set (
+      get_test_context (), ZMQ_CRYPTO_THREADS, crypto_threads));
+#endif
     setup_context_and_server_side (&handler, &zap_thread, &server, &server_mon,
                                    my_endpoint);
 }
@@ -506,6 +515,63 @@ void test_curve_security_invalid_initiate_command_encrypted_content ()
     close (s);
 }
 
+#ifdef ZMQ_BUILD_DRAFT_API
+void test_crypto_pool_option ()
+{
+    int value;
+    size_t value_size = sizeof value;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_get_ext (
+      get_test_context (), ZMQ_CRYPTO_THREADS, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (crypto_threads, value);
+
+    //  The pool is started with the context, so it cannot change any more.
+    value = crypto_threads + 1;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_set (
+      get_test_context (), ZMQ_CRYPTO_THREADS, value));
+}
+
+void test_crypto_pool_with_valid_credentials ()
+{
+    test_curve_security_with_valid_credentials ();
+}
+
+void test_crypto_pool_with_bogus_client_credentials ()
+{
+    test_curve_security_with_bogus_client_credentials ();
+}
+
+void test_crypto_pool_invalid_initiate_command_encrypted_content ()
+{
+    test_curve_security_invalid_initiate_command_encrypted_content ();
+}
+
+void test_crypto_pool_many_clients ()
+{
+    const int client_count = 16;
+    void *clients[client_count];
+
+    curve_client_data_t curve_client_data = {
+      valid_server_public, valid_client_public, valid_client_secret};
+    for (int i = 0; i < client_count; ++i)
+        clients[i] = create_and_connect_client (
+          my_endpoint, socket_config_curve_client, &curve_client_data, NULL);
+
+    for (int i = 0; i < client_count; ++i)
+        send_string_expect_success (clients[i], "hello", 0);
+    for (int i = 0; i < client_count; ++i)
+        recv_string_expect_success (server, "hello", 0);
+
+    for (int i = 0; i < client_count; ++i) {
+        const int event =
+          get_monitor_event_with_timeout (server_mon, NULL, NULL, -1);
+        TEST_ASSERT_EQUAL_INT (ZMQ_EVENT_HANDSHAKE_SUCCEEDED, event);
+    }
+
+    for (int i = 0; i < client_count; ++i)
+        test_context_socket_close (clients[i]);
+}
+#endif
+
 void test_curve_security_invalid_keysize (void *ctx_)
 {
     //  Check return codes for invalid buffer sizes
@@ -585,6 +651,17 @@ int main (void)
     RUN_TEST (test_curve_security_invalid_initiate_command_encrypted_cookie);
     RUN_TEST (test_curve_security_invalid_initiate_command_encrypted_content);
 
+#ifdef ZMQ_BUILD_DRAFT_API
+    //  tests with the server side handshake crypto on a crypto pool
+    crypto_threads = 2;
+    RUN_TEST (test_crypto_pool_option);
+    RUN_TEST (test_crypto_pool_with_valid_credentials);
+    RUN_TEST (test_crypto_pool_with_bogus_client_credentials);
+    RUN_TEST (test_crypto_pool_invalid_initiate_command_encrypted_content);
+    RUN_TEST (test_crypto_pool_many_clients);
+    crypto_threads = 0;
+#endif
+
     // TODO this requires a deviating test setup, must be moved to a separate executable/fixture
     //  test with a large routing id (resulting in large metadata)
     fprintf (stderr,
@@ -171,6 +171,129 @@ void test_setsockopt_priority ()
 #endif
 }
 
+void test_setsockopt_recv_spin ()
+{
+#ifdef ZMQ_BUILD_DRAFT_API
+    void *sb = test_context_socket (ZMQ_PAIR);
+    void *sc = test_context_socket (ZMQ_PAIR);
+
+    int val = 5;
+    size_t placeholder = sizeof (val);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (sb, ZMQ_RECV_SPIN, &val, &placeholder));
+    TEST_ASSERT_EQUAL_INT (0, val);
+
+    val = -1;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_setsockopt (sb, ZMQ_RECV_SPIN, &val, sizeof (val)));
+
+    //  The spin is cut short by the receive timeout.
+    val = 10000000;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (sb, ZMQ_RECV_SPIN, &val, sizeof (val)));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (sb, ZMQ_RECV_SPIN, &val, &placeholder));
+    TEST_ASSERT_EQUAL_INT (10000000, val);
+    const int timeout = 50;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (sb, ZMQ_RCVTIMEO, &timeout, sizeof (timeout)));
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (sb, "inproc://recv_spin"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (sc, "inproc://recv_spin"));
+
+    void *watch = zmq_stopwatch_start ();
+    char buffer[8];
+    TEST_ASSERT_FAILURE_ERRNO (EAGAIN, zmq_recv (sb, buffer, sizeof buffer, 0));
+    TEST_ASSERT_LESS_THAN_UINT32 (5000000, zmq_stopwatch_stop (watch));
+
+    send_string_expect_success (sc, "spin", 0);
+    recv_string_expect_success (sb, "spin", 0);
+
+    test_context_socket_close (sc);
+    test_context_socket_close (sb);
+#else
+    TEST_IGNORE_MESSAGE ("libzmq without DRAFT support, ignoring "
+                         "setsockopt_recv_spin test");
+#endif
+}
+
+#ifdef ZMQ_BUILD_DRAFT_API
+static void spin_receiver (void *client_)
+{
+    recv_string_expect_success (client_, "pong", 0);
+}
+
+static void spin_batch_receiver (void *client_)
+{
+    zmq_msg_t msgs[4];
+    for (int i = 0; i != 4; ++i)
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msgs[i]));
+    TEST_ASSERT_EQUAL_INT (1, zmq_recvmmsg (client_, msgs, 4, 0));
+    TEST_ASSERT_EQUAL_STRING_LEN ("pong", zmq_msg_data (&msgs[0]), 4);
+    for (int i = 0; i != 4; ++i)
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msgs[i]));
+}
+
+//  A thread spinning in a receive must not keep others off the socket.
+static void test_recv_spin_thread_safe (zmq_thread_fn *receiver_,
+                                        const char *endpoint_)
+{
+    void *server = test_context_socket (ZMQ_SERVER);
+    void *client = test_context_socket (ZMQ_CLIENT);
+
+    const int spin = 2000000;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (client, ZMQ_RECV_SPIN, &spin, sizeof (spin)));
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (server, endpoint_));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (client, endpoint_));
+
+    void *thread = zmq_threadstart (receiver_, client);
+    msleep (SETTLE_TIME);
+
+    void *watch = zmq_stopwatch_start ();
+    send_string_expect_success (client, "ping", 0);
+    TEST_ASSERT_LESS_THAN_UINT32 (1000000, zmq_stopwatch_stop (watch));
+
+    zmq_msg_t msg;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+    TEST_ASSERT_EQUAL_INT (4, zmq_msg_recv (&msg, server, 0));
+    const uint32_t routing_id = zmq_msg_routing_id (&msg);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init_size (&msg, 4));
+    memcpy (zmq_msg_data (&msg), "pong", 4);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_set_routing_id (&msg, routing_id));
+    TEST_ASSERT_EQUAL_INT (4, zmq_msg_send (&msg, server, 0));
+
+    zmq_threadclose (thread);
+
+    test_context_socket_close (client);
+    test_context_socket_close (server);
+}
+#endif
+
+void test_setsockopt_recv_spin_thread_safe ()
+{
+#ifdef ZMQ_BUILD_DRAFT_API
+    test_recv_spin_thread_safe (spin_receiver, "inproc://recv_spin_safe");
+#else
+    TEST_IGNORE_MESSAGE ("libzmq without DRAFT support, ignoring "
+                         "setsockopt_recv_spin_thread_safe test");
+#endif
+}
+
+void test_setsockopt_recv_spin_batch_thread_safe ()
+{
+#ifdef ZMQ_BUILD_DRAFT_API
+    test_recv_spin_thread_safe (spin_batch_receiver,
+                                "inproc://recv_spin_batch_safe");
+#else
+    TEST_IGNORE_MESSAGE ("libzmq without DRAFT support, ignoring "
+                         "setsockopt_recv_spin_batch_thread_safe test");
+#endif
+}
+
 int main ()
 {
     setup_test_environment ();
@@ -181,5 +304,8 @@ int main ()
     RUN_TEST (test_setsockopt_use_fd);
     RUN_TEST (test_setsockopt_bindtodevice);
     RUN_TEST (test_setsockopt_priority);
+    RUN_TEST (test_setsockopt_recv_spin);
+    RUN_TEST (test_setsockopt_recv_spin_thread_safe);
+    RUN_TEST (test_setsockopt_recv_spin_batch_thread_safe);
     return UNITY_END ();
 }
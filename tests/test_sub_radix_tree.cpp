@@ -0,0 +1,125 @@
+/*
+    Copyright (c) 2007-2016 Contributors as noted in the AUTHORS file
+
+    This file is part of libzmq, the ZeroMQ core engine in C++.
+
+    libzmq is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License (LGPL) as published
+    by the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    As a special exception, the Contributors give you permission to link
+    this library with independent modules to produce an executable,
+    regardless of the license terms of these independent modules, and to
+    copy and distribute the resulting executable under terms of your choice,
+    provided that you also meet, for each linked independent module, the
+    terms and conditions of the license of that module. An independent
+    module is a module which is not derived from or based on this library.
+    If you modify this library, you must extend this exception to your
+    version of the library.
+
+    libzmq is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+#include <string.h>
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+const uint8_t unsubscribe_top_msg[] = {0, 't', 'o', 'p'};
+const uint8_t subscribe_topic_msg[] = {1, 't', 'o', 'p', 'i', 'c'};
+const uint8_t unsubscribe_topic_msg[] = {0, 't', 'o', 'p', 'i', 'c'};
+
+static void set_radix_tree (void *socket_, int value_)
+{
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (socket_, ZMQ_SUB_RADIX_TREE, &value_, sizeof value_));
+}
+
+static void subscribe (void *pub_, void *sub_, const char *topic_)
+{
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (sub_, ZMQ_SUBSCRIBE, topic_, strlen (topic_)));
+    char buffer[32];
+    TEST_ASSERT_EQUAL_INT (
+      1 + strlen (topic_),
+      TEST_ASSERT_SUCCESS_ERRNO (zmq_recv (pub_, buffer, sizeof buffer, 0)));
+    TEST_ASSERT_EQUAL_INT (1, buffer[0]);
+}
+
+static void test_filter (int radix_tree_)
+{
+    void *pub = test_context_socket (ZMQ_XPUB);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (pub, "inproc://filter"));
+    void *sub = test_context_socket (ZMQ_SUB);
+    set_radix_tree (sub, radix_tree_);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (sub, "inproc://filter"));
+
+    subscribe (pub, sub, "topic");
+    subscribe (pub, sub, "top");
+    subscribe (pub, sub, "other");
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (sub, ZMQ_UNSUBSCRIBE, "top", 3));
+    recv_array_expect_success (pub, unsubscribe_top_msg, 0);
+
+    send_string_expect_success (pub, "topic.a", 0);
+    send_string_expect_success (pub, "top.b", 0);
+    send_string_expect_success (pub, "otherwise", 0);
+    send_string_expect_success (pub, "none", 0);
+
+    recv_string_expect_success (sub, "topic.a", 0);
+    recv_string_expect_success (sub, "otherwise", 0);
+    TEST_ASSERT_FAILURE_ERRNO (EAGAIN, zmq_recv (sub, NULL, 0, ZMQ_DONTWAIT));
+
+    test_context_socket_close (sub);
+    test_context_socket_close (pub);
+}
+
+void test_filter_trie ()
+{
+    test_filter (0);
+}
+
+void test_filter_radix_tree ()
+{
+    test_filter (1);
+}
+
+void test_switch_with_subscriptions ()
+{
+    void *sub = test_context_socket (ZMQ_XSUB);
+    set_radix_tree (sub, 1);
+    send_array_expect_success (sub, subscribe_topic_msg, 0);
+
+    //  The subscriptions are not moved to the trie.
+    int value = 0;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_setsockopt (sub, ZMQ_SUB_RADIX_TREE, &value, sizeof value));
+    set_radix_tree (sub, 1);
+
+    send_array_expect_success (sub, unsubscribe_topic_msg, 0);
+    set_radix_tree (sub, 0);
+
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_setsockopt (sub, ZMQ_SUB_RADIX_TREE, &value, 1));
+
+    test_context_socket_close (sub);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_filter_trie);
+    RUN_TEST (test_filter_radix_tree);
+    RUN_TEST (test_switch_with_subscriptions);
+    return UNITY_END ();
+}
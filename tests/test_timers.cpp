@@ -210,6 +210,31 @@ void test_timers ()
     TEST_ASSERT_SUCCESS_ERRNO (zmq_timers_destroy (&timers));
 }
 
+void test_clock_ns ()
+{
+    //  Sleep for longer than the clock's calibration period a few times, so
+    //  that both the system time and the timestamp counter are covered.
+    for (int i = 0; i != 3; i++) {
+        void *watch = zmq_stopwatch_start ();
+        const uint64_t start = zmq_clock_ns ();
+        msleep (60);
+        const uint64_t end = zmq_clock_ns ();
+        const unsigned long elapsed_us = zmq_stopwatch_stop (watch);
+
+        TEST_ASSERT_GREATER_OR_EQUAL_UINT64 (start + 55 * 1000000, end);
+        TEST_ASSERT_LESS_OR_EQUAL_UINT64 (start + elapsed_us * 1000ull + 1000,
+                                          end);
+    }
+
+    //  The clock never goes back.
+    uint64_t last = zmq_clock_ns ();
+    for (int i = 0; i != 100000; i++) {
+        const uint64_t now = zmq_clock_ns ();
+        TEST_ASSERT_GREATER_OR_EQUAL_UINT64 (last, now);
+        last = now;
+    }
+}
+
 int main ()
 {
     setup_test_environment ();
@@ -218,5 +243,6 @@ int main ()
     RUN_TEST (test_timers);
     RUN_TEST (test_null_timer_pointers);
     RUN_TEST (test_corner_cases);
+    RUN_TEST (test_clock_ns);
     return UNITY_END ();
 }
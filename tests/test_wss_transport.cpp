@@ -145,12 +145,66 @@ void test_roundtrip ()
     test_context_socket_close (sb);
 }
 
+#ifdef ZMQ_WSS_KTLS
+void test_roundtrip_ktls ()
+{
+    char connect_address[MAX_SOCKET_STRING + strlen ("/roundtrip")];
+    size_t addr_length = sizeof (connect_address);
+    const int ktls = 1;
+    int value = 0;
+    size_t value_size = sizeof value;
+
+    void *sb = test_context_socket (ZMQ_REP);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (sb, ZMQ_WSS_KTLS, &ktls, sizeof ktls));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (sb, ZMQ_WSS_KTLS, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (1, value);
+    zmq_setsockopt (sb, ZMQ_WSS_CERT_PEM, cert, strlen (cert));
+    zmq_setsockopt (sb, ZMQ_WSS_KEY_PEM, key, strlen (key));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (sb, "wss://*:*/roundtrip"));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (sb, ZMQ_LAST_ENDPOINT, connect_address, &addr_length));
+    strcat (connect_address, "/roundtrip");
+
+    void *sc = test_context_socket (ZMQ_REQ);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (sc, ZMQ_WSS_KTLS, &ktls, sizeof ktls));
+    zmq_setsockopt (sc, ZMQ_WSS_TRUST_PEM, cert, strlen (cert));
+    zmq_setsockopt (sc, ZMQ_WSS_HOSTNAME, "zeromq.org", strlen ("zeromq.org"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (sc, connect_address));
+
+    //  Whether or not the kernel takes over the records, the connection
+    //  must carry messages spanning several of them.
+    bounce (sb, sc);
+
+    const size_t size = 100000;
+    char *buffer = static_cast<char *> (malloc (size));
+    TEST_ASSERT_NOT_NULL (buffer);
+    for (size_t i = 0; i < size; i++)
+        buffer[i] = static_cast<char> (i);
+    TEST_ASSERT_EQUAL_INT (size, zmq_send (sc, buffer, size, 0));
+    char *received = static_cast<char *> (malloc (size));
+    TEST_ASSERT_NOT_NULL (received);
+    TEST_ASSERT_EQUAL_INT (size, zmq_recv (sb, received, size, 0));
+    TEST_ASSERT_EQUAL_MEMORY (buffer, received, size);
+    free (received);
+    free (buffer);
+
+    test_context_socket_close (sc);
+    test_context_socket_close (sb);
+}
+#endif
+
 int main ()
 {
     setup_test_environment ();
 
     UNITY_BEGIN ();
     RUN_TEST (test_roundtrip);
+#ifdef ZMQ_WSS_KTLS
+    RUN_TEST (test_roundtrip_ktls);
+#endif
     return UNITY_END ();
 }
 #else
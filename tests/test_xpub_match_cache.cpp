@@ -0,0 +1,180 @@
+/*
+    Copyright (c) 2007-2016 Contributors as noted in the AUTHORS file
+
+    This file is part of libzmq, the ZeroMQ core engine in C++.
+
+    libzmq is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License (LGPL) as published
+    by the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    As a special exception, the Contributors give you permission to link
+    this library with independent modules to produce an executable,
+    regardless of the license terms of these independent modules, and to
+    copy and distribute the resulting executable under terms of your choice,
+    provided that you also meet, for each linked independent module, the
+    terms and conditions of the license of that module. An independent
+    module is a module which is not derived from or based on this library.
+    If you modify this library, you must extend this exception to your
+    version of the library.
+
+    libzmq is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+#include <string.h>
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+const char test_endpoint[] = "inproc://match_cache";
+
+const uint8_t unsubscribe_ab_msg[] = {0, 'A', 'B'};
+
+static void *create_xpub (int cache_size_)
+{
+    void *pub = test_context_socket (ZMQ_XPUB);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (pub, ZMQ_XPUB_MATCH_CACHE,
+                                               &cache_size_, sizeof (int)));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (pub, test_endpoint));
+    return pub;
+}
+
+static void *create_sub (void *pub_, const char *topic_)
+{
+    void *sub = test_context_socket (ZMQ_SUB);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (sub, test_endpoint));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (sub, ZMQ_SUBSCRIBE, topic_, strlen (topic_)));
+
+    //  Wait for the subscription to be applied.
+    char buffer[16];
+    TEST_ASSERT_EQUAL_INT (
+      1 + strlen (topic_),
+      TEST_ASSERT_SUCCESS_ERRNO (zmq_recv (pub_, buffer, sizeof buffer, 0)));
+    return sub;
+}
+
+static void expect_nothing (void *sub_)
+{
+    TEST_ASSERT_FAILURE_ERRNO (EAGAIN, zmq_recv (sub_, NULL, 0, ZMQ_DONTWAIT));
+}
+
+void test_fan_out ()
+{
+    void *pub = create_xpub (16);
+    void *sub_a = create_sub (pub, "A");
+    void *sub_ab = create_sub (pub, "AB");
+    void *sub_b = create_sub (pub, "B");
+
+    //  A subscriber matching a topic through several subscriptions still
+    //  gets each message once.
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (sub_a, ZMQ_SUBSCRIBE, "ABC", 3));
+    char buffer[16];
+    TEST_ASSERT_EQUAL_INT (4, TEST_ASSERT_SUCCESS_ERRNO (
+                                zmq_recv (pub, buffer, sizeof buffer, 0)));
+
+    for (int i = 0; i != 3; ++i)
+        send_string_expect_success (pub, "ABC", 0);
+    send_string_expect_success (pub, "BC", 0);
+
+    for (int i = 0; i != 3; ++i) {
+        recv_string_expect_success (sub_a, "ABC", 0);
+        recv_string_expect_success (sub_ab, "ABC", 0);
+    }
+    recv_string_expect_success (sub_b, "BC", 0);
+    expect_nothing (sub_a);
+    expect_nothing (sub_ab);
+    expect_nothing (sub_b);
+
+    test_context_socket_close (sub_a);
+    test_context_socket_close (sub_ab);
+    test_context_socket_close (sub_b);
+    test_context_socket_close (pub);
+}
+
+void test_new_subscription ()
+{
+    void *pub = create_xpub (16);
+    void *sub_a = create_sub (pub, "A");
+
+    send_string_expect_success (pub, "ABC", 0);
+    recv_string_expect_success (sub_a, "ABC", 0);
+
+    //  The cached match for the topic does not hide the new subscriber.
+    void *sub_ab = create_sub (pub, "AB");
+    send_string_expect_success (pub, "ABC", 0);
+    recv_string_expect_success (sub_a, "ABC", 0);
+    recv_string_expect_success (sub_ab, "ABC", 0);
+
+    //  Nor does it keep sending to a subscriber that unsubscribed.
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (sub_ab, ZMQ_UNSUBSCRIBE, "AB", 2));
+    recv_array_expect_success (pub, unsubscribe_ab_msg, 0);
+    send_string_expect_success (pub, "ABC", 0);
+    recv_string_expect_success (sub_a, "ABC", 0);
+    expect_nothing (sub_ab);
+
+    test_context_socket_close (sub_a);
+    test_context_socket_close (sub_ab);
+    test_context_socket_close (pub);
+}
+
+void test_closed_subscriber ()
+{
+    void *pub = create_xpub (16);
+    void *sub_a = create_sub (pub, "A");
+    void *sub_ab = create_sub (pub, "AB");
+
+    send_string_expect_success (pub, "ABC", 0);
+    recv_string_expect_success (sub_a, "ABC", 0);
+    recv_string_expect_success (sub_ab, "ABC", 0);
+
+    //  Once the subscriber is gone, its pipe must not be used any more.
+    test_context_socket_close (sub_ab);
+    recv_array_expect_success (pub, unsubscribe_ab_msg, 0);
+    send_string_expect_success (pub, "ABC", 0);
+    recv_string_expect_success (sub_a, "ABC", 0);
+
+    test_context_socket_close (sub_a);
+    test_context_socket_close (pub);
+}
+
+void test_full_cache ()
+{
+    void *pub = create_xpub (1);
+    void *sub = create_sub (pub, "");
+
+    //  Topics beyond the size of the cache are matched as usual.
+    const char *topics[] = {"A", "B", "C", "A", "B", "C"};
+    for (int i = 0; i != 6; ++i)
+        send_string_expect_success (pub, topics[i], 0);
+    for (int i = 0; i != 6; ++i)
+        recv_string_expect_success (sub, topics[i], 0);
+
+    int value = -1;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_setsockopt (pub, ZMQ_XPUB_MATCH_CACHE, &value, sizeof value));
+
+    test_context_socket_close (sub);
+    test_context_socket_close (pub);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_fan_out);
+    RUN_TEST (test_new_subscription);
+    RUN_TEST (test_closed_subscriber);
+    RUN_TEST (test_full_cache);
+    return UNITY_END ();
+}
@@ -124,6 +124,70 @@ void test_roundtrip_large ()
     msg.close ();
 }
 
+void test_roundtrip_odd_sizes ()
+{
+    //  Sizes around the 64 byte cipher block and 16 byte MAC block
+    //  boundaries, including the plaintext flags byte and box padding.
+    const size_t sizes[] = {1, 14, 15, 16, 17, 31, 62, 63, 64, 65, 127, 1001};
+    for (size_t i = 0; i < sizeof sizes / sizeof sizes[0]; ++i) {
+        zmq::msg_t msg;
+        msg.init_size (sizes[i]);
+        for (size_t pos = 0; pos < sizes[i]; ++pos)
+            static_cast<uint8_t *> (msg.data ())[pos] =
+              static_cast<uint8_t> (pos * 7 + i);
+
+        test_roundtrip (&msg);
+
+        msg.close ();
+    }
+}
+
+void test_tampered_message_rejected ()
+{
+#ifdef ZMQ_HAVE_CURVE
+    zmq::curve_encoding_t encoding_client ("CurveZMQMESSAGEC",
+                                           "CurveZMQMESSAGES", false);
+    zmq::curve_encoding_t encoding_server ("CurveZMQMESSAGES",
+                                           "CurveZMQMESSAGEC", false);
+
+    uint8_t client_public[32];
+    uint8_t client_secret[32];
+    TEST_ASSERT_SUCCESS_ERRNO (
+      crypto_box_keypair (client_public, client_secret));
+
+    uint8_t server_public[32];
+    uint8_t server_secret[32];
+    TEST_ASSERT_SUCCESS_ERRNO (
+      crypto_box_keypair (server_public, server_secret));
+
+    TEST_ASSERT_SUCCESS_ERRNO (
+      crypto_box_beforenm (encoding_client.get_writable_precom_buffer (),
+                           server_public, client_secret));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      crypto_box_beforenm (encoding_server.get_writable_precom_buffer (),
+                           client_public, server_secret));
+
+    zmq::msg_t msg;
+    msg.init_size (100);
+    memset (msg.data (), 'x', 100);
+    TEST_ASSERT_SUCCESS_ERRNO (encoding_client.encode (&msg));
+
+    //  Flip a bit in the ciphertext, past the header and MAC.
+    static_cast<uint8_t *> (msg.data ())[msg.size () - 1] ^= 1;
+
+    encoding_server.set_peer_nonce (0);
+    int error_event_code = 0;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EPROTO, encoding_server.decode (&msg, &error_event_code));
+    TEST_ASSERT_EQUAL_INT (ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC,
+                           error_event_code);
+
+    msg.close ();
+#else
+    TEST_IGNORE_MESSAGE ("CURVE support is disabled");
+#endif
+}
+
 void test_roundtrip_empty_more ()
 {
     zmq::msg_t msg;
@@ -146,6 +210,8 @@ int main ()
     RUN_TEST (test_roundtrip_empty);
     RUN_TEST (test_roundtrip_small);
     RUN_TEST (test_roundtrip_large);
+    RUN_TEST (test_roundtrip_odd_sizes);
+    RUN_TEST (test_tampered_message_rejected);
 
     RUN_TEST (test_roundtrip_empty_more);
 
@@ -0,0 +1,109 @@
+/*
+Copyright (c) 2018 Contributors as noted in the AUTHORS file
+
+This file is part of 0MQ.
+
+0MQ is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation; either version 3 of the License, or
+(at your option) any later version.
+
+0MQ is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "../tests/testutil.hpp"
+
+#include <latency_histogram.hpp>
+
+#include <unity.h>
+
+void setUp ()
+{
+}
+void tearDown ()
+{
+}
+
+//  Checks that a percentile reported is no less than the exact value and
+//  at most 12.5% above it.
+static void check_percentile (uint64_t exact_, uint64_t reported_)
+{
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT64 (exact_, reported_);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT64 (exact_ + exact_ / 8, reported_);
+}
+
+void test_empty ()
+{
+    zmq::latency_histogram_t histogram;
+    uint64_t summary[zmq::latency_histogram_t::summary_size];
+    histogram.summarize (summary);
+    for (int i = 0; i < zmq::latency_histogram_t::summary_size; ++i)
+        TEST_ASSERT_EQUAL_UINT64 (0, summary[i]);
+}
+
+void test_small_values_exact ()
+{
+    zmq::latency_histogram_t histogram;
+    for (uint64_t i = 0; i < 10; ++i)
+        histogram.record (i);
+
+    uint64_t summary[zmq::latency_histogram_t::summary_size];
+    histogram.summarize (summary);
+    TEST_ASSERT_EQUAL_UINT64 (10, summary[0]);
+    TEST_ASSERT_EQUAL_UINT64 (4, summary[1]);
+    TEST_ASSERT_EQUAL_UINT64 (8, summary[2]);
+    TEST_ASSERT_EQUAL_UINT64 (9, summary[3]);
+    TEST_ASSERT_EQUAL_UINT64 (9, summary[4]);
+    TEST_ASSERT_EQUAL_UINT64 (9, summary[5]);
+}
+
+void test_percentiles ()
+{
+    zmq::latency_histogram_t histogram;
+    //  Record in descending order, the histogram must not depend on it.
+    for (uint64_t i = 100000; i > 0; --i)
+        histogram.record (i * 1000);
+
+    uint64_t summary[zmq::latency_histogram_t::summary_size];
+    histogram.summarize (summary);
+    TEST_ASSERT_EQUAL_UINT64 (100000, summary[0]);
+    check_percentile (50000 * 1000, summary[1]);
+    check_percentile (90000 * 1000, summary[2]);
+    check_percentile (99000 * 1000, summary[3]);
+    check_percentile (99900 * 1000, summary[4]);
+    TEST_ASSERT_EQUAL_UINT64 (100000 * 1000, summary[5]);
+}
+
+void test_outliers ()
+{
+    zmq::latency_histogram_t histogram;
+    for (int i = 0; i < 999; ++i)
+        histogram.record (1000);
+    const uint64_t huge = ~static_cast<uint64_t> (0) - 1;
+    histogram.record (huge);
+
+    uint64_t summary[zmq::latency_histogram_t::summary_size];
+    histogram.summarize (summary);
+    TEST_ASSERT_EQUAL_UINT64 (1000, summary[0]);
+    check_percentile (1000, summary[1]);
+    check_percentile (1000, summary[3]);
+    check_percentile (1000, summary[4]);
+    TEST_ASSERT_EQUAL_UINT64 (huge, summary[5]);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_empty);
+    RUN_TEST (test_small_values_exact);
+    RUN_TEST (test_percentiles);
+    RUN_TEST (test_outliers);
+    return UNITY_END ();
+}
@@ -0,0 +1,146 @@
+/*
+Copyright (c) 2018 Contributors as noted in the AUTHORS file
+
+This file is part of 0MQ.
+
+0MQ is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation; either version 3 of the License, or
+(at your option) any later version.
+
+0MQ is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../tests/testutil.hpp"
+
+#include <mpsc_queue.hpp>
+
+#include <unity.h>
+
+void setUp ()
+{
+}
+void tearDown ()
+{
+}
+
+void test_create ()
+{
+    zmq::mpsc_queue_t<int> queue;
+}
+
+void test_read_empty ()
+{
+    zmq::mpsc_queue_t<int> queue;
+    int read_value = -1;
+    TEST_ASSERT_FALSE (queue.read (&read_value));
+    TEST_ASSERT_EQUAL_INT (-1, read_value);
+}
+
+void test_write_wakes_reader_once ()
+{
+    zmq::mpsc_queue_t<int> queue;
+
+    //  The reader starts asleep, so only the first write asks for a wakeup.
+    TEST_ASSERT_FALSE (queue.write (1));
+    TEST_ASSERT_TRUE (queue.write (2));
+
+    int read_value = -1;
+    TEST_ASSERT_TRUE (queue.read (&read_value));
+    TEST_ASSERT_EQUAL_INT (1, read_value);
+    TEST_ASSERT_TRUE (queue.read (&read_value));
+    TEST_ASSERT_EQUAL_INT (2, read_value);
+
+    //  Once drained, the reader goes asleep again.
+    TEST_ASSERT_FALSE (queue.read (&read_value));
+    TEST_ASSERT_FALSE (queue.write (3));
+    TEST_ASSERT_TRUE (queue.read (&read_value));
+    TEST_ASSERT_EQUAL_INT (3, read_value);
+}
+
+void test_destroy_with_pending_items ()
+{
+    zmq::mpsc_queue_t<int> queue;
+    for (int i = 0; i < 100; ++i)
+        queue.write (i);
+}
+
+const int writer_count = 4;
+const int items_per_writer = 10000;
+
+struct writer_arg_t
+{
+    zmq::mpsc_queue_t<int> *queue;
+    int writer;
+    int wakeups;
+};
+
+static void writer_thread (void *arg_)
+{
+    writer_arg_t *const arg = static_cast<writer_arg_t *> (arg_);
+    for (int i = 0; i < items_per_writer; ++i)
+        if (!arg->queue->write (arg->writer * items_per_writer + i))
+            arg->wakeups++;
+}
+
+void test_concurrent_writers ()
+{
+    zmq::mpsc_queue_t<int> queue;
+    writer_arg_t args[writer_count];
+    void *threads[writer_count];
+    for (int i = 0; i < writer_count; ++i) {
+        args[i].queue = &queue;
+        args[i].writer = i;
+        args[i].wakeups = 0;
+        threads[i] = zmq_threadstart (&writer_thread, &args[i]);
+    }
+
+    //  Items of each writer must arrive in order, and the reader must be
+    //  woken up exactly once each time it has gone asleep.
+    int next[writer_count] = {0};
+    int received = 0;
+    int sleeps = 1;
+    bool asleep = true;
+    while (received < writer_count * items_per_writer) {
+        int value;
+        if (!queue.read (&value)) {
+            if (!asleep)
+                sleeps++;
+            asleep = true;
+            continue;
+        }
+        asleep = false;
+        const int writer = value / items_per_writer;
+        TEST_ASSERT_EQUAL_INT (next[writer], value % items_per_writer);
+        next[writer]++;
+        received++;
+    }
+
+    for (int i = 0; i < writer_count; ++i)
+        zmq_threadclose (threads[i]);
+
+    int wakeups = 0;
+    for (int i = 0; i < writer_count; ++i)
+        wakeups += args[i].wakeups;
+    TEST_ASSERT_EQUAL_INT (sleeps, wakeups);
+}
+
+int main (void)
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_create);
+    RUN_TEST (test_read_empty);
+    RUN_TEST (test_write_wakes_reader_once);
+    RUN_TEST (test_destroy_with_pending_items);
+    RUN_TEST (test_concurrent_writers);
+
+    return UNITY_END ();
+}
@@ -194,6 +194,27 @@ void test_check_null_entry_added ()
     TEST_ASSERT_TRUE (tree_check (tree, "all queries return true"));
 }
 
+static std::string edge_key (int index_)
+{
+    return std::string ("a") + static_cast<char> ('0' + index_);
+}
+
+void test_check_many_edges ()
+{
+    //  Nodes with up to 64 children, so that the children are looked up
+    //  in whole and partial vectors of first bytes.
+    for (int count = 1; count <= 64; ++count) {
+        zmq::radix_tree_t tree;
+
+        for (int i = 0; i < count; ++i)
+            tree_add (tree, edge_key (i));
+        for (int i = 0; i < count; ++i)
+            TEST_ASSERT_TRUE (tree_check (tree, edge_key (i)));
+        TEST_ASSERT_FALSE (tree_check (tree, edge_key (count)));
+        TEST_ASSERT_FALSE (tree_check (tree, edge_key (-1)));
+    }
+}
+
 void test_size ()
 {
     zmq::radix_tree_t tree;
@@ -256,6 +277,41 @@ void test_apply ()
     delete vec;
 }
 
+void test_add_rm_many ()
+{
+    //  Enough keys of varied lengths for nodes to be split, merged and
+    //  resized, with their memory reused, many times over.
+    zmq::radix_tree_t tree;
+    std::set<std::string> keys;
+    unsigned int seed = 1;
+    for (int i = 0; i < 5000; ++i) {
+        std::string key;
+        seed = seed * 1103515245 + 12345;
+        for (unsigned int length = 1 + (seed >> 16) % 12; length > 0;
+             --length) {
+            seed = seed * 1103515245 + 12345;
+            key.push_back (static_cast<char> ('a' + (seed >> 16) % 4));
+        }
+        if (keys.insert (key).second)
+            TEST_ASSERT_TRUE (tree_add (tree, key));
+    }
+
+    std::set<std::string>::iterator it = keys.begin ();
+    while (it != keys.end ()) {
+        TEST_ASSERT_TRUE (tree_rm (tree, *it));
+        keys.erase (it++);
+        if (it != keys.end ())
+            ++it;
+    }
+    TEST_ASSERT_EQUAL_UINT (keys.size (), tree.size ());
+
+    std::vector<std::string> visited;
+    tree.apply (return_key, &visited);
+    TEST_ASSERT_EQUAL_UINT (keys.size (), visited.size ());
+    for (size_t i = 0; i < visited.size (); ++i)
+        TEST_ASSERT_TRUE (keys.count (visited[i]) > 0);
+}
+
 int main (void)
 {
     setup_test_environment ();
@@ -281,10 +337,12 @@ int main (void)
     RUN_TEST (test_check_nonexistent_entry);
     RUN_TEST (test_check_query_longer_than_entry);
     RUN_TEST (test_check_null_entry_added);
+    RUN_TEST (test_check_many_edges);
 
     RUN_TEST (test_size);
 
     RUN_TEST (test_apply);
+    RUN_TEST (test_add_rm_many);
 
     return UNITY_END ();
 }
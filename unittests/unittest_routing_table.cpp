@@ -0,0 +1,207 @@
+/*
+Copyright (c) 2018 Contributors as noted in the AUTHORS file
+
+This file is part of 0MQ.
+
+0MQ is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation; either version 3 of the License, or
+(at your option) any later version.
+
+0MQ is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../tests/testutil.hpp"
+
+#include <routing_table.hpp>
+
+#include <map>
+#include <string>
+
+#include <unity.h>
+
+void setUp ()
+{
+}
+void tearDown ()
+{
+}
+
+typedef zmq::routing_table_t<int> table_t;
+
+zmq::blob_t make_id (const std::string &id_)
+{
+    return zmq::blob_t (reinterpret_cast<const unsigned char *> (id_.data ()),
+                        id_.size ());
+}
+
+bool table_insert (table_t &table_, const std::string &id_, int value_)
+{
+    return table_.insert (make_id (id_), value_);
+}
+
+const int *table_find (table_t &table_, const std::string &id_)
+{
+    return table_.find (make_id (id_));
+}
+
+bool table_erase (table_t &table_, const std::string &id_)
+{
+    return table_.erase (make_id (id_));
+}
+
+//  Ids as generated by ROUTER, a zero byte followed by a 32-bit integer,
+//  or long enough not to be stored inline for odd values of i_.
+std::string peer_id (size_t i_)
+{
+    std::string id (1, '\0');
+    for (int shift = 24; shift >= 0; shift -= 8)
+        id += static_cast<char> ((i_ >> shift) & 0xff);
+    if (i_ % 2)
+        id += "-with-a-long-routing-id";
+    return id;
+}
+
+void test_empty ()
+{
+    table_t table;
+
+    TEST_ASSERT_TRUE (table.empty ());
+    TEST_ASSERT_NULL (table_find (table, "foo"));
+    TEST_ASSERT_FALSE (table_erase (table, "foo"));
+}
+
+void test_insert_find ()
+{
+    table_t table;
+
+    TEST_ASSERT_TRUE (table_insert (table, "foo", 1));
+    TEST_ASSERT_TRUE (table_insert (table, "bar", 2));
+    TEST_ASSERT_EQUAL_UINT (2, table.size ());
+
+    const int *value = table_find (table, "foo");
+    TEST_ASSERT_NOT_NULL (value);
+    TEST_ASSERT_EQUAL_INT (1, *value);
+    value = table_find (table, "bar");
+    TEST_ASSERT_NOT_NULL (value);
+    TEST_ASSERT_EQUAL_INT (2, *value);
+
+    TEST_ASSERT_NULL (table_find (table, "fo"));
+    TEST_ASSERT_NULL (table_find (table, "fooo"));
+}
+
+void test_insert_twice ()
+{
+    table_t table;
+
+    TEST_ASSERT_TRUE (table_insert (table, "foo", 1));
+    TEST_ASSERT_FALSE (table_insert (table, "foo", 2));
+    TEST_ASSERT_EQUAL_UINT (1, table.size ());
+    TEST_ASSERT_EQUAL_INT (1, *table_find (table, "foo"));
+}
+
+void test_long_id ()
+{
+    table_t table;
+    const std::string id (255, 'x');
+
+    TEST_ASSERT_TRUE (table_insert (table, id, 1));
+    TEST_ASSERT_TRUE (table_insert (table, id.substr (1), 2));
+    TEST_ASSERT_EQUAL_INT (1, *table_find (table, id));
+    TEST_ASSERT_EQUAL_INT (2, *table_find (table, id.substr (1)));
+    TEST_ASSERT_TRUE (table_erase (table, id));
+    TEST_ASSERT_NULL (table_find (table, id));
+    TEST_ASSERT_EQUAL_INT (2, *table_find (table, id.substr (1)));
+}
+
+void test_erase_returns_value ()
+{
+    table_t table;
+    int value = 0;
+
+    TEST_ASSERT_TRUE (table_insert (table, "foo", 42));
+    TEST_ASSERT_TRUE (table.erase (make_id ("foo"), &value));
+    TEST_ASSERT_EQUAL_INT (42, value);
+    TEST_ASSERT_TRUE (table.empty ());
+    TEST_ASSERT_FALSE (table.erase (make_id ("foo"), &value));
+}
+
+void test_iterate ()
+{
+    table_t table;
+    int sum = 0;
+
+    for (int i = 0; i < 100; ++i)
+        TEST_ASSERT_TRUE (table_insert (table, peer_id (i), i));
+    for (size_t slot = 0; slot < table.slots (); ++slot) {
+        const int *value = table.at (slot);
+        if (value)
+            sum += *value;
+    }
+    TEST_ASSERT_EQUAL_INT (99 * 100 / 2, sum);
+}
+
+//  Interleaves inserts and erases so that the table grows, shrinks and
+//  shifts entries back into erased slots, checking it against std::map.
+void test_insert_erase_many ()
+{
+    table_t table;
+    std::map<std::string, int> expected;
+
+    for (size_t round = 0; round < 4; ++round) {
+        for (size_t i = 0; i < 5000; ++i) {
+            const std::string id = peer_id ((i * 7919 + round) % 10000);
+            const bool fresh = expected.count (id) == 0;
+            TEST_ASSERT_EQUAL (fresh, table_insert (table, id, (int) i));
+            if (fresh)
+                expected[id] = (int) i;
+        }
+        for (size_t i = 0; i < 10000; i += 3) {
+            const std::string id = peer_id ((i * 104729) % 10000);
+            TEST_ASSERT_EQUAL (expected.erase (id) == 1,
+                               table_erase (table, id));
+        }
+        TEST_ASSERT_EQUAL_UINT (expected.size (), table.size ());
+        for (size_t i = 0; i < 10000; ++i) {
+            const std::string id = peer_id (i);
+            const int *value = table_find (table, id);
+            const std::map<std::string, int>::const_iterator it =
+              expected.find (id);
+            if (it == expected.end ()) {
+                TEST_ASSERT_NULL (value);
+            } else {
+                TEST_ASSERT_NOT_NULL (value);
+                TEST_ASSERT_EQUAL_INT (it->second, *value);
+            }
+        }
+    }
+
+    for (std::map<std::string, int>::const_iterator it = expected.begin ();
+         it != expected.end (); ++it)
+        TEST_ASSERT_TRUE (table_erase (table, it->first));
+    TEST_ASSERT_TRUE (table.empty ());
+    TEST_ASSERT_TRUE (table.slots () <= 16);
+}
+
+int main (void)
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+
+    RUN_TEST (test_empty);
+    RUN_TEST (test_insert_find);
+    RUN_TEST (test_insert_twice);
+    RUN_TEST (test_long_id);
+    RUN_TEST (test_erase_returns_value);
+    RUN_TEST (test_iterate);
+    RUN_TEST (test_insert_erase_many);
+
+    return UNITY_END ();
+}
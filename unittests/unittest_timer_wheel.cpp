@@ -0,0 +1,211 @@
+/*
+Copyright (c) 2018 Contributors as noted in the AUTHORS file
+
+This file is part of 0MQ.
+
+0MQ is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation; either version 3 of the License, or
+(at your option) any later version.
+
+0MQ is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../tests/testutil.hpp"
+
+#include <timer_wheel.hpp>
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include <unity.h>
+
+void setUp ()
+{
+}
+void tearDown ()
+{
+}
+
+typedef zmq::timer_wheel_t<int> wheel_t;
+
+//  Pops the timers due at now_, in any order.
+std::multiset<int> pop_all (wheel_t &wheel_, uint64_t now_)
+{
+    std::multiset<int> res;
+    wheel_t::handle_t handle;
+    int value;
+    while (wheel_.pop (now_, &handle, &value)) {
+        res.insert (value);
+        TEST_ASSERT_TRUE (wheel_.cancel (handle));
+    }
+    return res;
+}
+
+void test_empty ()
+{
+    wheel_t wheel;
+    wheel_t::handle_t handle;
+    int value;
+
+    TEST_ASSERT_TRUE (wheel.empty ());
+    TEST_ASSERT_EQUAL_INT64 (-1, wheel.timeout (1000));
+    TEST_ASSERT_FALSE (wheel.pop (1000, &handle, &value));
+}
+
+void test_expiry ()
+{
+    const uint64_t timeouts[] = {0,    1,    63,    64,     65,
+                                 4095, 4096, 4097,  262143, 300000,
+                                 1u << 30,   uint64_t (1) << 37};
+    const int count = sizeof timeouts / sizeof timeouts[0];
+    const uint64_t start = 123456789;
+    wheel_t wheel;
+
+    for (int i = 0; i < count; ++i)
+        wheel.add (start, timeouts[i], i);
+    TEST_ASSERT_EQUAL_UINT (count, wheel.size ());
+
+    for (int i = 0; i < count; ++i) {
+        const uint64_t expiry = start + timeouts[i];
+        TEST_ASSERT_EQUAL_INT64 (timeouts[i] - (i ? timeouts[i - 1] : 0),
+                                 wheel.timeout (i ? expiry - timeouts[i]
+                                                      + timeouts[i - 1]
+                                                  : start));
+        if (expiry > start)
+            TEST_ASSERT_TRUE (pop_all (wheel, expiry - 1).empty ());
+        const std::multiset<int> due = pop_all (wheel, expiry);
+        TEST_ASSERT_EQUAL_UINT (1, due.size ());
+        TEST_ASSERT_EQUAL_INT (i, *due.begin ());
+    }
+    TEST_ASSERT_TRUE (wheel.empty ());
+}
+
+void test_cancel ()
+{
+    wheel_t wheel;
+
+    const wheel_t::handle_t first = wheel.add (0, 100, 1);
+    const wheel_t::handle_t second = wheel.add (0, 100, 2);
+    TEST_ASSERT_TRUE (wheel.pending (first));
+    TEST_ASSERT_TRUE (wheel.cancel (first));
+    TEST_ASSERT_FALSE (wheel.pending (first));
+    TEST_ASSERT_FALSE (wheel.cancel (first));
+
+    //  The storage of the cancelled timer is reused, but not its handle.
+    const wheel_t::handle_t third = wheel.add (0, 50, 3);
+    TEST_ASSERT_TRUE (third != first);
+    TEST_ASSERT_FALSE (wheel.cancel (first));
+    TEST_ASSERT_TRUE (wheel.pending (second));
+    TEST_ASSERT_TRUE (wheel.pending (third));
+
+    TEST_ASSERT_EQUAL_INT (3, *pop_all (wheel, 50).begin ());
+    TEST_ASSERT_EQUAL_INT (2, *pop_all (wheel, 100).begin ());
+    TEST_ASSERT_TRUE (wheel.empty ());
+}
+
+void test_reschedule ()
+{
+    wheel_t wheel;
+    wheel_t::handle_t handle = wheel.add (0, 100, 1);
+    int value;
+
+    TEST_ASSERT_TRUE (wheel.reschedule (handle, 50, 100));
+    TEST_ASSERT_TRUE (pop_all (wheel, 149).empty ());
+
+    //  A popped timer keeps its handle until it is released.
+    wheel_t::handle_t popped;
+    TEST_ASSERT_TRUE (wheel.pop (150, &popped, &value));
+    TEST_ASSERT_TRUE (popped == handle);
+    TEST_ASSERT_TRUE (wheel.pending (handle));
+    TEST_ASSERT_EQUAL_INT64 (-1, wheel.timeout (150));
+    TEST_ASSERT_TRUE (wheel.reschedule (handle, 150, 10));
+    TEST_ASSERT_EQUAL_INT64 (10, wheel.timeout (150));
+    TEST_ASSERT_EQUAL_UINT (1, pop_all (wheel, 160).size ());
+    TEST_ASSERT_FALSE (wheel.reschedule (handle, 160, 10));
+}
+
+//  Runs random operations against a multimap of expiries, checking that
+//  the timers expire exactly when due.
+void test_random ()
+{
+    wheel_t wheel;
+    std::map<int, std::pair<uint64_t, wheel_t::handle_t> > timers;
+    uint64_t now = 1000;
+    uint32_t seed = 1;
+    int next_value = 0;
+
+    for (int step = 0; step < 20000; ++step) {
+        seed = seed * 1103515245 + 12345;
+        const uint32_t r = seed >> 8;
+        if (r % 4 == 0 && !timers.empty ()) {
+            std::map<int, std::pair<uint64_t, wheel_t::handle_t> >::iterator
+              it = timers.lower_bound (static_cast<int> (r % next_value));
+            if (it == timers.end ())
+                it = timers.begin ();
+            TEST_ASSERT_TRUE (wheel.cancel (it->second.second));
+            timers.erase (it);
+        } else if (r % 4 == 1) {
+            now += (r >> 4) % (r % 3 ? 100 : 10000);
+            std::multiset<int> expected;
+            for (std::map<int, std::pair<uint64_t, wheel_t::handle_t> >::
+                   iterator it = timers.begin ();
+                 it != timers.end ();)
+                if (it->second.first <= now) {
+                    expected.insert (it->first);
+                    timers.erase (it++);
+                } else
+                    ++it;
+            TEST_ASSERT_TRUE (expected == pop_all (wheel, now));
+        } else {
+            //  Mostly short timeouts, some up to hours away.
+            const uint64_t timeout =
+              (r >> 4) % (r % 5 == 0 ? 20000000 : r % 3 ? 5000 : 100);
+            const int value = next_value++;
+            timers[value] = std::make_pair (now + timeout,
+                                            wheel.add (now, timeout, value));
+        }
+
+        TEST_ASSERT_EQUAL_UINT (timers.size (), wheel.size ());
+        uint64_t first = ~uint64_t (0);
+        for (std::map<int, std::pair<uint64_t, wheel_t::handle_t> >::iterator
+               it = timers.begin ();
+             it != timers.end (); ++it)
+            if (it->second.first < first)
+                first = it->second.first;
+        TEST_ASSERT_EQUAL_INT64 (
+          timers.empty () ? -1 : first > now ? int64_t (first - now) : 0,
+          wheel.timeout (now));
+    }
+
+    //  Let the far away timers expire too.
+    std::multiset<int> expected;
+    for (std::map<int, std::pair<uint64_t, wheel_t::handle_t> >::iterator it =
+           timers.begin ();
+         it != timers.end (); ++it)
+        expected.insert (it->first);
+    TEST_ASSERT_TRUE (expected == pop_all (wheel, now + 20000000));
+    TEST_ASSERT_TRUE (wheel.empty ());
+}
+
+int main (void)
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+
+    RUN_TEST (test_empty);
+    RUN_TEST (test_expiry);
+    RUN_TEST (test_cancel);
+    RUN_TEST (test_reschedule);
+    RUN_TEST (test_random);
+
+    return UNITY_END ();
+}